@@ -0,0 +1,146 @@
+#include "cds.h"
+#include <time.h>
+
+
+typedef struct _Bench {
+    double put;
+    double get;
+    double iterate;
+    double remove;
+} Bench;
+
+
+static const unsigned SIZE_DEFAULT = 1000000;
+
+
+double Now()
+{
+    struct timespec spec;
+    clock_gettime(CLOCK_MONOTONIC, &spec);
+    return spec.tv_sec + spec.tv_nsec / 1e9;
+}
+
+intptr_t* PrepareKeys(unsigned size)
+{
+    /* Shuffle the distinct keys 1 ... size with a fixed seed so that both
+       containers see exactly the same sequence. */
+    intptr_t* keys = (intptr_t*)malloc(sizeof(intptr_t) * size);
+    if (!keys)
+        return NULL;
+
+    unsigned i;
+    for (i = 0 ; i < size ; ++i)
+        keys[i] = i + 1;
+
+    srand(0x5eed);
+    for (i = size - 1 ; i > 0 ; --i) {
+        unsigned j = ((unsigned)rand() * (RAND_MAX + 1u) + rand()) % (i + 1);
+        intptr_t temp = keys[i];
+        keys[i] = keys[j];
+        keys[j] = temp;
+    }
+    return keys;
+}
+
+void BenchTreeMap(intptr_t* keys, unsigned size, Bench* bench)
+{
+    TreeMap* map = TreeMapInit();
+    assert(map != NULL);
+
+    unsigned i;
+    double begin = Now();
+    for (i = 0 ; i < size ; ++i)
+        TreeMapPut(map, (void*)keys[i], (void*)keys[i]);
+    bench->put = Now() - begin;
+
+    intptr_t sum = 0;
+    begin = Now();
+    for (i = 0 ; i < size ; ++i)
+        sum += (intptr_t)TreeMapGet(map, (void*)keys[i]);
+    bench->get = Now() - begin;
+    assert(sum == (intptr_t)size * (size + 1) / 2);
+
+    Pair* pair;
+    unsigned count = 0;
+    begin = Now();
+    TreeMapFirst(map);
+    while ((pair = TreeMapNext(map)) != NULL)
+        ++count;
+    bench->iterate = Now() - begin;
+    assert(count == size);
+
+    begin = Now();
+    for (i = 0 ; i < size ; ++i)
+        TreeMapRemove(map, (void*)keys[i]);
+    bench->remove = Now() - begin;
+    assert(TreeMapSize(map) == 0);
+
+    TreeMapDeinit(map);
+}
+
+void BenchBTreeMap(intptr_t* keys, unsigned size, Bench* bench)
+{
+    BTreeMap* map = BTreeMapInit();
+    assert(map != NULL);
+
+    unsigned i;
+    double begin = Now();
+    for (i = 0 ; i < size ; ++i)
+        BTreeMapPut(map, (void*)keys[i], (void*)keys[i]);
+    bench->put = Now() - begin;
+
+    intptr_t sum = 0;
+    begin = Now();
+    for (i = 0 ; i < size ; ++i)
+        sum += (intptr_t)BTreeMapGet(map, (void*)keys[i]);
+    bench->get = Now() - begin;
+    assert(sum == (intptr_t)size * (size + 1) / 2);
+
+    Pair* pair;
+    unsigned count = 0;
+    begin = Now();
+    BTreeMapFirst(map);
+    while ((pair = BTreeMapNext(map)) != NULL)
+        ++count;
+    bench->iterate = Now() - begin;
+    assert(count == size);
+
+    begin = Now();
+    for (i = 0 ; i < size ; ++i)
+        BTreeMapRemove(map, (void*)keys[i]);
+    bench->remove = Now() - begin;
+    assert(BTreeMapSize(map) == 0);
+
+    BTreeMapDeinit(map);
+}
+
+void Report(const char* name, Bench* bench)
+{
+    printf("%-10s put %8.3fs  get %8.3fs  iterate %8.3fs  remove %8.3fs\n",
+           name, bench->put, bench->get, bench->iterate, bench->remove);
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned size = SIZE_DEFAULT;
+    if (argc > 1)
+        size = (unsigned)strtoul(argv[1], NULL, 10);
+    if (size == 0)
+        return 0;
+
+    intptr_t* keys = PrepareKeys(size);
+    if (!keys)
+        return -1;
+
+    printf("Random integer keys: %u\n", size);
+
+    Bench bench;
+    BenchTreeMap(keys, size, &bench);
+    Report("TreeMap", &bench);
+    BenchBTreeMap(keys, size, &bench);
+    Report("BTreeMap", &bench);
+
+    free(keys);
+    return 0;
+}
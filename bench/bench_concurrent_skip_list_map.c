@@ -0,0 +1,158 @@
+#include "cds.h"
+#include <time.h>
+#include <pthread.h>
+
+
+typedef struct _Worker {
+    pthread_t thread;
+    unsigned seed;
+    unsigned ops;
+    unsigned range;
+    void* map;
+    pthread_mutex_t* mutex;
+} Worker;
+
+
+static const unsigned SIZE_DEFAULT = 1000000;
+static const unsigned THREAD_DEFAULT = 4;
+
+/* The operation mix in percentage. The rest are lookups. */
+static const unsigned RATIO_PUT = 10;
+static const unsigned RATIO_REMOVE = 10;
+
+
+double Now()
+{
+    struct timespec spec;
+    clock_gettime(CLOCK_MONOTONIC, &spec);
+    return spec.tv_sec + spec.tv_nsec / 1e9;
+}
+
+static inline
+unsigned Random(unsigned* seed)
+{
+    unsigned x = *seed;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *seed = x;
+    return x;
+}
+
+void* RunTreeMap(void* arg)
+{
+    Worker* worker = (Worker*)arg;
+    TreeMap* map = (TreeMap*)worker->map;
+
+    unsigned i;
+    for (i = 0 ; i < worker->ops ; ++i) {
+        unsigned dice = Random(&worker->seed) % 100;
+        void* key = (void*)(intptr_t)(Random(&worker->seed) % worker->range + 1);
+        pthread_mutex_lock(worker->mutex);
+        if (dice < RATIO_PUT)
+            TreeMapPut(map, key, key);
+        else if (dice < RATIO_PUT + RATIO_REMOVE)
+            TreeMapRemove(map, key);
+        else
+            TreeMapGet(map, key);
+        pthread_mutex_unlock(worker->mutex);
+    }
+    return NULL;
+}
+
+void* RunSkipListMap(void* arg)
+{
+    Worker* worker = (Worker*)arg;
+    ConcurrentSkipListMap* map = (ConcurrentSkipListMap*)worker->map;
+
+    unsigned i;
+    for (i = 0 ; i < worker->ops ; ++i) {
+        unsigned dice = Random(&worker->seed) % 100;
+        void* key = (void*)(intptr_t)(Random(&worker->seed) % worker->range + 1);
+        if (dice < RATIO_PUT)
+            ConcurrentSkipListMapPut(map, key, key);
+        else if (dice < RATIO_PUT + RATIO_REMOVE)
+            ConcurrentSkipListMapRemove(map, key);
+        else
+            ConcurrentSkipListMapGet(map, key);
+    }
+    return NULL;
+}
+
+double Launch(void* (*func)(void*), void* map, pthread_mutex_t* mutex,
+              unsigned size, unsigned count)
+{
+    Worker workers[count];
+    unsigned i;
+    for (i = 0 ; i < count ; ++i) {
+        workers[i].seed = 0x5eed + i * 7919;
+        workers[i].ops = size / count;
+        workers[i].range = size;
+        workers[i].map = map;
+        workers[i].mutex = mutex;
+    }
+
+    double begin = Now();
+    for (i = 0 ; i < count ; ++i)
+        pthread_create(&workers[i].thread, NULL, func, &workers[i]);
+    for (i = 0 ; i < count ; ++i)
+        pthread_join(workers[i].thread, NULL);
+    return Now() - begin;
+}
+
+double BenchTreeMap(unsigned size, unsigned count)
+{
+    TreeMap* map = TreeMapInit();
+    assert(map != NULL);
+    pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+
+    /* Half of the key range is populated in advance. */
+    unsigned i;
+    for (i = 1 ; i <= size ; i += 2)
+        TreeMapPut(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+
+    double elapse = Launch(RunTreeMap, map, &mutex, size, count);
+    TreeMapDeinit(map);
+    return elapse;
+}
+
+double BenchSkipListMap(unsigned size, unsigned count)
+{
+    ConcurrentSkipListMap* map = ConcurrentSkipListMapInit();
+    assert(map != NULL);
+
+    unsigned i;
+    for (i = 1 ; i <= size ; i += 2)
+        ConcurrentSkipListMapPut(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+
+    double elapse = Launch(RunSkipListMap, map, NULL, size, count);
+    ConcurrentSkipListMapDeinit(map);
+    return elapse;
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned size = SIZE_DEFAULT;
+    unsigned thread = THREAD_DEFAULT;
+    if (argc > 1)
+        size = (unsigned)strtoul(argv[1], NULL, 10);
+    if (argc > 2)
+        thread = (unsigned)strtoul(argv[2], NULL, 10);
+    if (size == 0 || thread == 0)
+        return 0;
+
+    printf("Operations: %u (%u%% put, %u%% remove, the rest get)\n",
+           size, RATIO_PUT, RATIO_REMOVE);
+
+    unsigned count;
+    for (count = 1 ; count <= thread ; count <<= 1) {
+        double lock = BenchTreeMap(size, count);
+        double nolock = BenchSkipListMap(size, count);
+        printf("threads %2u  TreeMap+mutex %8.3fs (%6.2f Mops/s)  "
+               "ConcurrentSkipListMap %8.3fs (%6.2f Mops/s)\n", count,
+               lock, size / lock / 1e6, nolock, size / nolock / 1e6);
+    }
+
+    return 0;
+}
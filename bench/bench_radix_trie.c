@@ -0,0 +1,147 @@
+#include "cds.h"
+#include <time.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+
+typedef struct _Bench {
+    double insert;
+    double lookup;
+    double prefix;
+    size_t bytes;
+} Bench;
+
+
+static const unsigned SIZE_DEFAULT = 1000000;
+static const unsigned SIZE_URL = 64;
+static const unsigned COUNT_HOST = 2000;
+
+
+double Now()
+{
+    struct timespec spec;
+    clock_gettime(CLOCK_MONOTONIC, &spec);
+    return spec.tv_sec + spec.tv_nsec / 1e9;
+}
+
+size_t HeapInUse()
+{
+#if defined(__GLIBC__)
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+char** PrepareUrls(unsigned size)
+{
+    /* Generate URL-like strings sharing host names and path segments with a
+       fixed seed so that both tries see exactly the same sequence. */
+    char** urls = (char**)malloc(sizeof(char*) * size);
+    if (!urls)
+        return NULL;
+
+    static const char* paths[] = {"index", "static", "api/v1", "api/v2", "user",
+                                  "search", "img", "doc"};
+    srand(0x5eed);
+    unsigned i;
+    for (i = 0 ; i < size ; ++i) {
+        urls[i] = (char*)malloc(SIZE_URL);
+        snprintf(urls[i], SIZE_URL, "http://www.host%u.com/%s/%u",
+                 (unsigned)rand() % COUNT_HOST, paths[rand() % 8],
+                 (unsigned)rand() % 100000);
+    }
+    return urls;
+}
+
+void BenchTrie(char** urls, unsigned size, Bench* bench)
+{
+    size_t base = HeapInUse();
+    Trie* trie = TrieInit();
+    assert(trie != NULL);
+
+    unsigned i;
+    double begin = Now();
+    for (i = 0 ; i < size ; ++i)
+        TrieInsert(trie, urls[i]);
+    bench->insert = Now() - begin;
+    bench->bytes = HeapInUse() - base;
+
+    unsigned hit = 0;
+    begin = Now();
+    for (i = 0 ; i < size ; ++i)
+        hit += TrieHasExact(trie, urls[i]);
+    bench->lookup = Now() - begin;
+    assert(hit == size);
+
+    begin = Now();
+    for (i = 0 ; i < size ; ++i)
+        hit += TrieHasPrefixAs(trie, "http://www.host1");
+    bench->prefix = Now() - begin;
+
+    TrieDeinit(trie);
+}
+
+void BenchRadixTrie(char** urls, unsigned size, Bench* bench)
+{
+    size_t base = HeapInUse();
+    RadixTrie* trie = RadixTrieInit();
+    assert(trie != NULL);
+
+    unsigned i;
+    double begin = Now();
+    for (i = 0 ; i < size ; ++i)
+        RadixTrieInsert(trie, urls[i]);
+    bench->insert = Now() - begin;
+    bench->bytes = HeapInUse() - base;
+
+    unsigned hit = 0;
+    begin = Now();
+    for (i = 0 ; i < size ; ++i)
+        hit += RadixTrieHasExact(trie, urls[i]);
+    bench->lookup = Now() - begin;
+    assert(hit == size);
+
+    begin = Now();
+    for (i = 0 ; i < size ; ++i)
+        hit += RadixTrieHasPrefixAs(trie, "http://www.host1");
+    bench->prefix = Now() - begin;
+
+    RadixTrieDeinit(trie);
+}
+
+void Report(const char* name, Bench* bench)
+{
+    printf("%-10s insert %8.3fs  lookup %8.3fs  prefix %8.3fs  heap %8.1fMB\n",
+           name, bench->insert, bench->lookup, bench->prefix,
+           bench->bytes / (1024.0 * 1024.0));
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned size = SIZE_DEFAULT;
+    if (argc > 1)
+        size = (unsigned)strtoul(argv[1], NULL, 10);
+    if (size == 0)
+        return 0;
+
+    char** urls = PrepareUrls(size);
+    if (!urls)
+        return -1;
+
+    printf("URL-like string keys: %u\n", size);
+
+    Bench bench;
+    BenchTrie(urls, size, &bench);
+    Report("Trie", &bench);
+    BenchRadixTrie(urls, size, &bench);
+    Report("RadixTrie", &bench);
+
+    unsigned i;
+    for (i = 0 ; i < size ; ++i)
+        free(urls[i]);
+    free(urls);
+    return 0;
+}
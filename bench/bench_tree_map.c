@@ -0,0 +1,174 @@
+#include "cds.h"
+#include <time.h>
+#include <pthread.h>
+
+
+static const unsigned SIZE_DEFAULT = 1000000;
+static const unsigned SIZE_CHUNK = 4096;
+static const int ROUND = 3;
+static const unsigned THREAD_DEFAULT = 4;
+
+/* The node placement strategies. */
+enum {
+    PLACE_MALLOC,
+    PLACE_ARENA,
+    PLACE_BULK,
+    PLACE_COUNT
+};
+
+static const char* NAME_PLACE[] = {"malloc", "arena", "bulk load"};
+
+typedef struct _Scan {
+    pthread_t thread;
+    TreeMapCursor cursor;
+    intptr_t sum;
+} Scan;
+
+
+double Now()
+{
+    struct timespec spec;
+    clock_gettime(CLOCK_MONOTONIC, &spec);
+    return spec.tv_sec + spec.tv_nsec / 1e9;
+}
+
+intptr_t* PrepareKeys(unsigned size)
+{
+    /* Shuffle the distinct keys 1 ... size with a fixed seed. */
+    intptr_t* keys = (intptr_t*)malloc(sizeof(intptr_t) * size);
+    if (!keys)
+        return NULL;
+
+    unsigned i;
+    for (i = 0 ; i < size ; ++i)
+        keys[i] = i + 1;
+
+    srand(0x5eed);
+    for (i = size - 1 ; i > 0 ; --i) {
+        unsigned j = ((unsigned)rand() * (RAND_MAX + 1u) + rand()) % (i + 1);
+        intptr_t temp = keys[i];
+        keys[i] = keys[j];
+        keys[j] = temp;
+    }
+    return keys;
+}
+
+TreeMap* BuildMap(intptr_t* keys, unsigned size, int place)
+{
+    TreeMap* map = TreeMapInit();
+    assert(map != NULL);
+
+    unsigned i;
+    if (place == PLACE_BULK) {
+        Pair* pairs = (Pair*)malloc(sizeof(Pair) * size);
+        assert(pairs != NULL);
+        for (i = 0 ; i < size ; ++i) {
+            pairs[i].key = (void*)(intptr_t)(i + 1);
+            pairs[i].value = pairs[i].key;
+        }
+        bool rc = TreeMapBuildSorted(map, pairs, size);
+        assert(rc == true);
+        free(pairs);
+        return map;
+    }
+
+    if (place == PLACE_ARENA)
+        TreeMapSetArena(map, SIZE_CHUNK);
+    for (i = 0 ; i < size ; ++i)
+        TreeMapPut(map, (void*)keys[i], (void*)keys[i]);
+    return map;
+}
+
+double BenchGet(TreeMap* map, intptr_t* keys, unsigned size)
+{
+    /* Report the best of several rounds of random lookups. */
+    double best = 0;
+    int r;
+    for (r = 0 ; r < ROUND ; ++r) {
+        intptr_t sum = 0;
+        unsigned i;
+        double begin = Now();
+        for (i = 0 ; i < size ; ++i)
+            sum += (intptr_t)TreeMapGet(map, (void*)keys[i]);
+        double elapse = Now() - begin;
+        assert(sum == (intptr_t)size * (size + 1) / 2);
+        if (r == 0 || elapse < best)
+            best = elapse;
+    }
+    return best;
+}
+
+void* RunScan(void* arg)
+{
+    Scan* scan = (Scan*)arg;
+    Pair* pair;
+    intptr_t sum = 0;
+    while ((pair = TreeMapCursorNext(&scan->cursor)) != NULL)
+        sum += (intptr_t)pair->value;
+    scan->sum = sum;
+    return NULL;
+}
+
+double BenchScan(TreeMap* map, unsigned size, unsigned count)
+{
+    /* Each thread walks its own key range with a private cursor. */
+    Scan scans[count];
+    TreeMapCursor cursors[count];
+    unsigned num = TreeMapPartition(map, cursors, count);
+
+    unsigned i;
+    double begin = Now();
+    for (i = 0 ; i < num ; ++i) {
+        scans[i].cursor = cursors[i];
+        pthread_create(&scans[i].thread, NULL, RunScan, &scans[i]);
+    }
+    intptr_t sum = 0;
+    for (i = 0 ; i < num ; ++i) {
+        pthread_join(scans[i].thread, NULL);
+        sum += scans[i].sum;
+    }
+    double elapse = Now() - begin;
+    assert(sum == (intptr_t)size * (size + 1) / 2);
+    return elapse;
+}
+
+
+int main(int argc, char** argv)
+{
+    unsigned size = SIZE_DEFAULT;
+    unsigned thread = THREAD_DEFAULT;
+    if (argc > 1)
+        size = (unsigned)strtoul(argv[1], NULL, 10);
+    if (argc > 2)
+        thread = (unsigned)strtoul(argv[2], NULL, 10);
+    if (size == 0 || thread == 0)
+        return 0;
+
+    intptr_t* keys = PrepareKeys(size);
+    if (!keys)
+        return -1;
+
+    printf("Random lookups over %u integer keys\n", size);
+
+    int place;
+    for (place = 0 ; place < PLACE_COUNT ; ++place) {
+        TreeMap* map = BuildMap(keys, size, place);
+        double elapse = BenchGet(map, keys, size);
+        printf("%-10s get %8.3fs  %7.1f ns/op\n", NAME_PLACE[place], elapse,
+               elapse / size * 1e9);
+        TreeMapDeinit(map);
+    }
+
+    printf("Partitioned scan over %u integer keys\n", size);
+
+    TreeMap* map = BuildMap(keys, size, PLACE_MALLOC);
+    unsigned count;
+    for (count = 1 ; count <= thread ; count <<= 1) {
+        double elapse = BenchScan(map, size, count);
+        printf("threads %2u scan %8.3fs\n", count, elapse);
+    }
+    TreeMapDeinit(map);
+
+    free(keys);
+    return 0;
+}
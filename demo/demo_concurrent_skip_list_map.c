@@ -0,0 +1,110 @@
+#include "cds.h"
+
+
+int CompareKey(void* lhs, void* rhs)
+{
+    return strcmp((char*)lhs, (char*)rhs);
+}
+
+void CleanKey(void* key)
+{
+    free(key);
+}
+
+void CleanValue(void* value)
+{
+    free(value);
+}
+
+
+void ManipulateNumerics()
+{
+    /* We should initialize the container before any operations. */
+    ConcurrentSkipListMap* map = ConcurrentSkipListMapInit();
+
+    /* Insert numerics into the map. The map can be shared by multiple threads
+       once it is initialized. */
+    ConcurrentSkipListMapPut(map, (void*)(intptr_t)1, (void*)(intptr_t)9999);
+    ConcurrentSkipListMapPut(map, (void*)(intptr_t)2, (void*)(intptr_t)999);
+    ConcurrentSkipListMapPut(map, (void*)(intptr_t)3, (void*)(intptr_t)99);
+    ConcurrentSkipListMapPut(map, (void*)(intptr_t)4, (void*)(intptr_t)9);
+
+    /* Retrieve the value with the designated key. */
+    int val = (int)(intptr_t)ConcurrentSkipListMapGet(map, (void*)(intptr_t)1);
+    assert(val == 9999);
+
+    /* Iterate through the map with the cursor owned by this thread. */
+    ConcurrentSkipListMapCursor cursor;
+    ConcurrentSkipListMapFirst(map, &cursor);
+    Pair* ptr_pair;
+    int first = 1, second = 9999;
+    while ((ptr_pair = ConcurrentSkipListMapCursorNext(&cursor)) != NULL) {
+        assert((int)(intptr_t)ptr_pair->key == first);
+        assert((int)(intptr_t)ptr_pair->value == second);
+        ++first;
+        second /= 10;
+    }
+
+    /* Remove the key value pair with the designated key. */
+    ConcurrentSkipListMapRemove(map, (void*)(intptr_t)2);
+    assert(ConcurrentSkipListMapFind(map, (void*)(intptr_t)2) == false);
+    assert(ConcurrentSkipListMapSize(map) == 3);
+
+    /* We should deinitialize the container after all the threads stop. */
+    ConcurrentSkipListMapDeinit(map);
+}
+
+void ManipulateTexts()
+{
+    char* names[2] = {"Alice\0", "Bob\0"};
+
+    /* We should initialize the container before any operations. */
+    ConcurrentSkipListMap* map = ConcurrentSkipListMapInit();
+
+    /* Set the custom functions before sharing the map with other threads. */
+    ConcurrentSkipListMapSetCompare(map, CompareKey);
+    ConcurrentSkipListMapSetCleanKey(map, CleanKey);
+    ConcurrentSkipListMapSetCleanValue(map, CleanValue);
+
+    ConcurrentSkipListMapPut(map, strdup(names[0]), strdup("Engineer"));
+    ConcurrentSkipListMapPut(map, strdup(names[1]), strdup("Designer"));
+
+    /* The removed pair stays readable by the concurrent readers. */
+    char* title = (char*)ConcurrentSkipListMapGet(map, names[0]);
+    ConcurrentSkipListMapRemove(map, names[0]);
+    assert(strcmp(title, "Engineer") == 0);
+
+    /* At a quiescent point, reclaim the retired pairs. */
+    ConcurrentSkipListMapReclaim(map);
+
+    /* We should deinitialize the container after all the threads stop. */
+    ConcurrentSkipListMapDeinit(map);
+}
+
+void ManipulateNumericsCppStyle()
+{
+    /* We should initialize the container before any operations. */
+    ConcurrentSkipListMap* map = ConcurrentSkipListMapInit();
+
+    map->put(map, (void*)(intptr_t)1, (void*)(intptr_t)9999);
+    map->put(map, (void*)(intptr_t)2, (void*)(intptr_t)999);
+
+    Pair* ptr_pair = map->minimum(map);
+    assert((int)(intptr_t)ptr_pair->key == 1);
+    ptr_pair = map->maximum(map);
+    assert((int)(intptr_t)ptr_pair->key == 2);
+
+    map->remove(map, (void*)(intptr_t)1);
+    assert(map->size(map) == 1);
+
+    /* We should deinitialize the container after all the threads stop. */
+    ConcurrentSkipListMapDeinit(map);
+}
+
+int main()
+{
+    ManipulateNumerics();
+    ManipulateTexts();
+    ManipulateNumericsCppStyle();
+    return 0;
+}
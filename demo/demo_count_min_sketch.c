@@ -0,0 +1,55 @@
+#include "cds.h"
+
+
+void ManipulateNumerics()
+{
+    /* We should initialize the container before any operations. */
+    CountMinSketch* lhs = CountMinSketchInit(1024, 4);
+    CountMinSketch* rhs = CountMinSketchInit(1024, 4);
+
+    /* Record the frequencies. Each thread may own a sketch privately. */
+    int key = 7;
+    CountMinSketchUpdate(lhs, &key, sizeof(int), 10);
+    CountMinSketchUpdate(rhs, &key, sizeof(int), 5);
+    key = 8;
+    CountMinSketchUpdate(rhs, &key, sizeof(int), 1);
+
+    /* Combine the sketches. */
+    CountMinSketchMerge(lhs, rhs);
+
+    /* Estimate the frequencies. The estimation never underestimates. */
+    key = 7;
+    assert(CountMinSketchEstimate(lhs, &key, sizeof(int)) >= 15);
+    assert(CountMinSketchTotal(lhs) == 16);
+
+    /* We should deinitialize the container after all the relevant operations. */
+    CountMinSketchDeinit(rhs);
+    CountMinSketchDeinit(lhs);
+}
+
+void ManipulateStringsCppStyle()
+{
+    /* We should initialize the container before any operations. */
+    CountMinSketch* cms = CountMinSketchInit(1024, 4);
+
+    /* Record the frequencies. */
+    char* words[] = {"alpha", "beta", "gamma", "beta", "alpha", "alpha"};
+    int i;
+    for (i = 0 ; i < 6 ; ++i)
+        cms->update(cms, words[i], strlen(words[i]), 1);
+
+    /* Estimate the frequencies. */
+    assert(cms->estimate(cms, "alpha", 5) >= 3);
+    assert(cms->estimate(cms, "gamma", 5) >= 1);
+    assert(cms->total(cms) == 6);
+
+    /* We should deinitialize the container after all the relevant operations. */
+    CountMinSketchDeinit(cms);
+}
+
+int main()
+{
+    ManipulateNumerics();
+    ManipulateStringsCppStyle();
+    return 0;
+}
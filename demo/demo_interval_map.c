@@ -0,0 +1,93 @@
+#include "cds.h"
+
+
+typedef struct Booking_ {
+    int room;
+    char* guest;
+} Booking;
+
+
+void CleanBooking(void* value)
+{
+    Booking* booking = (Booking*)value;
+    free(booking->guest);
+    free(booking);
+}
+
+bool CountInterval(Interval* interval, void* arg)
+{
+    ++*(int*)arg;
+    return true;
+}
+
+bool PrintBooking(Interval* interval, void* arg)
+{
+    Booking* booking = (Booking*)interval->value;
+    printf("Room %d is booked by %s during [%d, %d)\n", booking->room,
+           booking->guest, (int)(intptr_t)interval->low,
+           (int)(intptr_t)interval->high);
+    return true;
+}
+
+
+void ManipulateNumerics()
+{
+    /* We should initialize the container before any operations. */
+    IntervalMap* map = IntervalMapInit();
+
+    /* Insert the half-open intervals [low, high) into the map. */
+    IntervalMapPut(map, (void*)(intptr_t)0, (void*)(intptr_t)10, NULL);
+    IntervalMapPut(map, (void*)(intptr_t)5, (void*)(intptr_t)15, NULL);
+    IntervalMapPut(map, (void*)(intptr_t)20, (void*)(intptr_t)30, NULL);
+
+    /* Count the intervals containing the point. */
+    int count = 0;
+    IntervalMapStab(map, (void*)(intptr_t)7, CountInterval, &count);
+    assert(count == 2);
+
+    /* Count the intervals overlapping the range. */
+    count = 0;
+    IntervalMapOverlap(map, (void*)(intptr_t)12, (void*)(intptr_t)25,
+                       CountInterval, &count);
+    assert(count == 2);
+
+    /* Remove the designated interval. */
+    IntervalMapRemove(map, (void*)(intptr_t)5, (void*)(intptr_t)15);
+    assert(IntervalMapFind(map, (void*)(intptr_t)5, (void*)(intptr_t)15) == false);
+    assert(IntervalMapSize(map) == 2);
+
+    /* We should deinitialize the container after all the relevant operations. */
+    IntervalMapDeinit(map);
+}
+
+void ManipulateBookings()
+{
+    IntervalMap* map = IntervalMapInit();
+
+    /* If we plan to delegate the resource clean task to the container, set the
+       custom clean function. */
+    map->set_clean_value(map, CleanBooking);
+
+    Booking* booking = (Booking*)malloc(sizeof(Booking));
+    booking->room = 101;
+    booking->guest = strdup("Alice");
+    map->put(map, (void*)(intptr_t)1, (void*)(intptr_t)4, booking);
+
+    booking = (Booking*)malloc(sizeof(Booking));
+    booking->room = 102;
+    booking->guest = strdup("Bob");
+    map->put(map, (void*)(intptr_t)3, (void*)(intptr_t)6, booking);
+
+    /* Report the bookings active on day 3. */
+    map->stab(map, (void*)(intptr_t)3, PrintBooking, NULL);
+
+    /* We should deinitialize the container after all the relevant operations. */
+    IntervalMapDeinit(map);
+}
+
+int main()
+{
+    ManipulateNumerics();
+    ManipulateBookings();
+    return 0;
+}
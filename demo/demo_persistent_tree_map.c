@@ -0,0 +1,147 @@
+#include "cds.h"
+
+
+typedef struct Employ_ {
+    int year;
+    int level;
+    int id;
+} Employ;
+
+
+int CompareKey(void* lhs, void* rhs)
+{
+    return strcmp((char*)lhs, (char*)rhs);
+}
+
+void CleanKey(void* key)
+{
+    free(key);
+}
+
+void CleanValue(void* value)
+{
+    free(value);
+}
+
+bool SumValue(Pair* pair, void* arg)
+{
+    *(int*)arg += (int)(intptr_t)pair->value;
+    return true;
+}
+
+
+void ManipulateNumerics()
+{
+    /* We should initialize the container before any operations. */
+    PersistentTreeMap* map = PersistentTreeMapInit();
+
+    /* Insert numerics into the map. */
+    PersistentTreeMapPut(map, (void*)(intptr_t)1, (void*)(intptr_t)9999);
+    PersistentTreeMapPut(map, (void*)(intptr_t)2, (void*)(intptr_t)999);
+    PersistentTreeMapPut(map, (void*)(intptr_t)3, (void*)(intptr_t)99);
+    PersistentTreeMapPut(map, (void*)(intptr_t)4, (void*)(intptr_t)9);
+
+    /* Take the snapshot which freezes the current version for readers. */
+    TreeSnapshot* snap = PersistentTreeMapSnapshot(map);
+
+    /* Keep updating the map. The snapshot is not affected. */
+    PersistentTreeMapRemove(map, (void*)(intptr_t)2);
+    PersistentTreeMapPut(map, (void*)(intptr_t)1, (void*)(intptr_t)1);
+
+    assert(PersistentTreeMapFind(map, (void*)(intptr_t)2) == false);
+    assert((int)(intptr_t)PersistentTreeMapGet(map, (void*)(intptr_t)1) == 1);
+    assert(PersistentTreeMapSize(map) == 3);
+
+    assert(TreeSnapshotFind(snap, (void*)(intptr_t)2) == true);
+    assert((int)(intptr_t)TreeSnapshotGet(snap, (void*)(intptr_t)1) == 9999);
+    assert(TreeSnapshotSize(snap) == 4);
+
+    /* Visit the snapshot in ascending key order. */
+    int sum = 0;
+    TreeSnapshotForEach(snap, SumValue, &sum);
+    assert(sum == 11106);
+
+    /* The snapshot should be released when the reader finishes. */
+    TreeSnapshotRelease(snap);
+
+    /* We should deinitialize the container after all the relevant operations. */
+    PersistentTreeMapDeinit(map);
+}
+
+void ManipulateTexts()
+{
+    char* names[2] = {"Alice\0", "Bob\0"};
+
+    /* We should initialize the container before any operations. */
+    PersistentTreeMap* map = PersistentTreeMapInit();
+
+    /* Set the custom key comparison functions. */
+    PersistentTreeMapSetCompare(map, CompareKey);
+
+    /* If we plan to delegate the resource clean task to the container, set the
+       custom clean functions. The pair is cleaned when neither the map nor the
+       snapshots refer to it. */
+    PersistentTreeMapSetCleanKey(map, CleanKey);
+    PersistentTreeMapSetCleanValue(map, CleanValue);
+
+    char* key = strdup(names[0]);
+    Employ* employ = (Employ*)malloc(sizeof(Employ));
+    employ->id = 1;
+    employ->year = 25;
+    employ->level = 100;
+    PersistentTreeMapPut(map, (void*)key, (void*)employ);
+
+    key = strdup(names[1]);
+    employ = (Employ*)malloc(sizeof(Employ));
+    employ->id = 2;
+    employ->year = 25;
+    employ->level = 90;
+    PersistentTreeMapPut(map, (void*)key, (void*)employ);
+
+    TreeSnapshot* snap = PersistentTreeMapSnapshot(map);
+
+    /* Remove the pair from the map while the snapshot still refers to it. */
+    PersistentTreeMapRemove(map, (void*)names[0]);
+    assert(PersistentTreeMapFind(map, (void*)names[0]) == false);
+
+    employ = (Employ*)TreeSnapshotGet(snap, (void*)names[0]);
+    assert(employ != NULL);
+    assert(employ->id == 1);
+
+    /* Now the removed pair is cleaned. */
+    TreeSnapshotRelease(snap);
+
+    /* We should deinitialize the container after all the relevant operations. */
+    PersistentTreeMapDeinit(map);
+}
+
+void ManipulateNumericsCppStyle()
+{
+    /* We should initialize the container before any operations. */
+    PersistentTreeMap* map = PersistentTreeMapInit();
+
+    map->put(map, (void*)(intptr_t)1, (void*)(intptr_t)9999);
+    map->put(map, (void*)(intptr_t)2, (void*)(intptr_t)999);
+
+    TreeSnapshot* snap = map->snapshot(map);
+    map->remove(map, (void*)(intptr_t)1);
+
+    assert(map->size(map) == 1);
+    assert(TreeSnapshotSize(snap) == 2);
+
+    Pair* ptr_pair = map->minimum(map);
+    assert((int)(intptr_t)ptr_pair->key == 2);
+
+    TreeSnapshotRelease(snap);
+
+    /* We should deinitialize the container after all the relevant operations. */
+    PersistentTreeMapDeinit(map);
+}
+
+int main()
+{
+    ManipulateNumerics();
+    ManipulateTexts();
+    ManipulateNumericsCppStyle();
+    return 0;
+}
@@ -0,0 +1,127 @@
+#include "cds.h"
+
+
+void ManipulateNumerics()
+{
+    /* We should initialize the container before any operations. */
+    RoaringSet* set_lhs = RoaringSetInit();
+    RoaringSet* set_rhs = RoaringSetInit();
+
+    /* Insert integers into the sets. */
+    RoaringSetAdd(set_lhs, 1);
+    RoaringSetAdd(set_lhs, 2);
+    RoaringSetAdd(set_lhs, 3);
+    RoaringSetAdd(set_lhs, 4);
+
+    RoaringSetAdd(set_rhs, 3);
+    RoaringSetAdd(set_rhs, 4);
+    RoaringSetAdd(set_rhs, 5);
+    RoaringSetAdd(set_rhs, 6);
+
+    /* Remove some elements from the sets. */
+    RoaringSetRemove(set_lhs, 1);
+    RoaringSetRemove(set_rhs, 6);
+
+    /* Query for element existence. */
+    assert(RoaringSetFind(set_lhs, 1) == false);
+    assert(RoaringSetFind(set_lhs, 2) == true);
+    assert(RoaringSetFind(set_rhs, 5) == true);
+    assert(RoaringSetFind(set_rhs, 6) == false);
+
+    /* Iterate through the set. The elements are visited in ascending order. */
+    uint32_t element;
+    RoaringSetFirst(set_lhs);
+    while (RoaringSetNext(set_lhs, &element)) {
+        // Consume the element.
+    }
+
+    /* Check the element count in the set. */
+    assert(RoaringSetSize(set_lhs) == 3);
+    assert(RoaringSetSize(set_rhs) == 3);
+
+    /* Perform set union operation. */
+    RoaringSet* merge = RoaringSetUnion(set_lhs, set_rhs);
+    assert(RoaringSetSize(merge) == 4);
+    assert(RoaringSetFind(merge, 2) == true);
+    assert(RoaringSetFind(merge, 5) == true);
+
+    /* Perform set intersection operation. */
+    RoaringSet* inter = RoaringSetIntersect(set_lhs, set_rhs);
+    assert(RoaringSetSize(inter) == 2);
+    assert(RoaringSetFind(inter, 3) == true);
+    assert(RoaringSetFind(inter, 4) == true);
+
+    /* Perform set difference operation. */
+    RoaringSet* only_lhs = RoaringSetDifference(set_lhs, set_rhs);
+    assert(RoaringSetSize(only_lhs) == 1);
+    assert(RoaringSetFind(only_lhs, 2) == true);
+
+    /* We should deinitialize the container after all the relevant operations. */
+    RoaringSetDeinit(only_lhs);
+    RoaringSetDeinit(inter);
+    RoaringSetDeinit(merge);
+    RoaringSetDeinit(set_lhs);
+    RoaringSetDeinit(set_rhs);
+}
+
+void ManipulateSerialization()
+{
+    RoaringSet* set = RoaringSetInit();
+
+    /* Dense ranges are compressed into bitmap containers. */
+    uint32_t i;
+    for (i = 0 ; i < 100000 ; ++i)
+        RoaringSetAdd(set, i);
+
+    /* Serialize the set into the portable byte stream. */
+    uint8_t* buf;
+    size_t size;
+    RoaringSetSerialize(set, &buf, &size);
+
+    /* Restore the set from the byte stream. */
+    RoaringSet* dup = RoaringSetDeserialize(buf, size);
+    assert(RoaringSetSize(dup) == 100000);
+    assert(RoaringSetFind(dup, 99999) == true);
+
+    /* We should free the byte stream and deinitialize the containers. */
+    free(buf);
+    RoaringSetDeinit(dup);
+    RoaringSetDeinit(set);
+}
+
+void ManipulateNumericsCppStyle()
+{
+    /* We should initialize the container before any operations. */
+    RoaringSet* set = RoaringSetInit();
+
+    /* Insert integers into the set. */
+    set->add(set, 1);
+    set->add(set, 2);
+    set->add(set, 3);
+
+    /* Remove an element from the set. */
+    set->remove(set, 1);
+
+    /* Query for element existence. */
+    assert(set->find(set, 1) == false);
+    assert(set->find(set, 2) == true);
+    assert(set->size(set) == 2);
+
+    /* Iterate through the set. */
+    uint32_t element;
+    set->first(set);
+    while (set->next(set, &element)) {
+        // Consume the element.
+    }
+
+    /* We should deinitialize the container after all the relevant operations. */
+    RoaringSetDeinit(set);
+}
+
+int main()
+{
+    ManipulateNumerics();
+    ManipulateSerialization();
+    ManipulateNumericsCppStyle();
+    return 0;
+}
@@ -65,6 +65,13 @@ void TrieDemo()
         free((char*)strs[i]);
     free(strs);
 
+    /* Or stream the matches through a cursor without any allocation. */
+    TrieCursor cursor;
+    TriePrefix(trie, "202-555", buf, BUF_SIZE, &cursor);
+    assert(strcmp(TrieCursorNext(&cursor), nums[0]) == 0);
+    assert(strcmp(TrieCursorNext(&cursor), nums[1]) == 0);
+    assert(TrieCursorNext(&cursor) == NULL);
+
     TrieDeinit(trie);
 }
 
@@ -129,6 +136,16 @@ void TrieDemoCppStyle()
         free((char*)strs[i]);
     free(strs);
 
+    /* Attach the values to the area codes and route a number by its longest
+       matched code. */
+    trie->put(trie, "202", "Washington");
+    trie->put(trie, "202-555", "Directory");
+    void* area;
+    assert(trie->longest_prefix_match(trie, "202-555-0123", &area) == 7);
+    assert(strcmp((char*)area, "Directory") == 0);
+    assert(trie->longest_prefix_match(trie, "202-554-0123", &area) == 3);
+    assert(strcmp((char*)trie->get(trie, "202"), "Washington") == 0);
+
     TrieDeinit(trie);
 }
 
@@ -2,10 +2,18 @@
 #include "container/vector.h"
 #include "container/list.h"
 #include "container/tree_map.h"
+#include "container/btree_map.h"
+#include "container/persistent_tree_map.h"
+#include "container/concurrent_skip_list_map.h"
+#include "container/interval_map.h"
 #include "container/hash_map.h"
 #include "container/hash_set.h"
+#include "container/roaring_set.h"
+#include "container/hyper_log_log.h"
+#include "container/count_min_sketch.h"
 #include "container/stack.h"
 #include "container/queue.h"
 #include "container/priority_queue.h"
 #include "container/trie.h"
+#include "container/radix_trie.h"
 #include "math/hash.h"
\ No newline at end of file
@@ -0,0 +1,321 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+
+
+/**
+ * @file btree_map.h The cache conscious ordered map to store key value pairs.
+ */
+
+#ifndef _BTREE_MAP_H_
+#define _BTREE_MAP_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** BTreeMapData is the data type for the container private information. */
+typedef struct _BTreeMapData BTreeMapData;
+
+/** Compare the equality of two keys. */
+typedef int (*BTreeMapCompare) (void*, void*);
+
+/** Key cleanup function called whenever a live entry is removed. */
+typedef void (*BTreeMapCleanKey) (void*);
+
+/** Value cleanup function called whenever a live entry is removed. */
+typedef void (*BTreeMapCleanValue) (void*);
+
+
+/** The implementation for B+ tree based ordered map. */
+typedef struct _BTreeMap {
+    /** The container private information */
+    BTreeMapData *data;
+
+    /** Insert a key value pair into the map.
+        @see BTreeMapPut */
+    bool (*put) (struct _BTreeMap*, void*, void*);
+
+    /** Retrieve the value corresponding to the designated key.
+        @see BTreeMapGet */
+    void* (*get) (struct _BTreeMap*, void*);
+
+    /** Check if the map contains the designated key.
+        @see BTreeMapFind */
+    bool (*find) (struct _BTreeMap*, void*);
+
+    /** Delete the key value pair corresponding to the designated key.
+        @see BTreeMapRemove */
+    bool (*remove) (struct _BTreeMap*, void*);
+
+    /** Return the number of stored key value pairs.
+        @see BTreeMapSize */
+    unsigned (*size) (struct _BTreeMap*);
+
+    /** Retrieve the key value pair with the minimum order from the map.
+        @see BTreeMapMinimum */
+    Pair* (*minimum) (struct _BTreeMap*);
+
+    /** Retrieve the key value pair with the maximum order from the map.
+        @see BTreeMapMaximum */
+    Pair* (*maximum) (struct _BTreeMap*);
+
+    /** Retrieve the key value pair which is the predecessor of the given key.
+        @see BTreeMapPredecessor */
+    Pair* (*predecessor) (struct _BTreeMap*, void*);
+
+    /** Retrieve the key value pair which is the successor of the given key.
+        @see BTreeMapSuccessor */
+    Pair* (*successor) (struct _BTreeMap*, void*);
+
+    /** Initialize the map iterator.
+        @see BTreeMapFirst */
+    void (*first) (struct _BTreeMap*);
+
+    /** Get the key value pair pointed by the iterator and advance the iterator.
+        @see BTreeMapNext */
+    Pair* (*next) (struct _BTreeMap*);
+
+    /** Get the key value pair pointed by the iterator and advance the iterator
+        in the reverse order.
+        @see BTreeMapReverseNext */
+    Pair* (*reverse_next) (struct _BTreeMap*);
+
+    /** Set the custom key comparison function.
+        @see BTreeMapSetCompare */
+    void (*set_compare) (struct _BTreeMap*, BTreeMapCompare);
+
+    /** Set the custom key cleanup function.
+        @see BTreeMapSetCleanKey */
+    void (*set_clean_key) (struct _BTreeMap*, BTreeMapCleanKey);
+
+    /** Set the custom value cleanup function.
+        @see BTreeMapSetCleanValue */
+    void (*set_clean_value) (struct _BTreeMap*, BTreeMapCleanValue);
+} BTreeMap;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for BTreeMap.
+ *
+ * BTreeMap offers the same interface as TreeMap. The pairs are packed in the
+ * leaf nodes of a B+ tree with about 512 byte nodes, so a lookup touches a few
+ * cache friendly nodes instead of one node per comparison.
+ *
+ * @retval obj          The successfully constructed map
+ * @retval NULL         Insufficient memory for map construction
+ */
+BTreeMap* BTreeMapInit();
+
+/**
+ * @brief The destructor for BTreeMap.
+ *
+ * @param obj           The pointer to the to be destructed map
+ */
+void BTreeMapDeinit(BTreeMap* obj);
+
+/**
+ * @brief Insert a key value pair into the map.
+ *
+ * This function inserts a key value pair into the map. If the designated key is
+ * equal to a certain one stored in the map, the existing pair will be replaced.
+ * Also, the cleanup functions are invoked for that replaced pair.
+ *
+ * @param self          The pointer to BTreeMap structure
+ * @param key           The designated key
+ * @param value         The designated value
+ *
+ * @retval true         The pair is successfully inserted
+ * @retval false        The pair cannot be inserted due to insufficient memory
+ */
+bool BTreeMapPut(BTreeMap* self, void* key, void* value);
+
+/**
+ * @brief Retrieve the value corresponding to the designated key.
+ *
+ * @param self          The pointer to BTreeMap structure
+ * @param key           The designated key
+ *
+ * @retval value        The corresponding value
+ * @retval NULL         The key cannot be found
+ */
+void* BTreeMapGet(BTreeMap* self, void* key);
+
+/**
+ * @brief Check if the map contains the designated key.
+ *
+ * @param self          The pointer to BTreeMap structure
+ * @param key           The designated key
+ *
+ * @retval true         The key can be found
+ * @retval false        The key cannot be found
+ */
+bool BTreeMapFind(BTreeMap* self, void* key);
+
+/**
+ * @brief Remove the key value pair corresponding to the designated key.
+ *
+ * This function removes the key value pair corresponding to the designated key.
+ * Also, the cleanup functions are invoked for that removed pair.
+ *
+ * @param self          The pointer to BTreeMap structure
+ * @param key           The designated key
+ *
+ * @retval true         The pair is successfully removed
+ * @retval false        The key cannot be found
+ */
+bool BTreeMapRemove(BTreeMap* self, void* key);
+
+/**
+ * @brief Return the number of stored key value pairs.
+ *
+ * @param self          The pointer to BTreeMap structure
+ *
+ * @retval size         The number of stored pairs
+ */
+unsigned BTreeMapSize(BTreeMap* self);
+
+/**
+ * @brief Retrieve the key value pair with the minimum order from the map.
+ *
+ * @param self          The pointer to BTreeMap structure
+ *
+ * @retval ptr_pair     The pointer to the target key value pair
+ * @retval NULL         The map is empty
+ *
+ * @note Unlike TreeMap, the pairs move between nodes when the map is modified.
+ *  So the returned pointer is valid only until the next put or remove.
+ */
+Pair* BTreeMapMinimum(BTreeMap* self);
+
+/**
+ * @brief Retrieve the key value pair with the maximum order from the map.
+ *
+ * @param self          The pointer to BTreeMap structure
+ *
+ * @retval ptr_pair     The pointer to the target key value pair
+ * @retval NULL         The map is empty
+ *
+ * @note The returned pointer is valid only until the next put or remove.
+ */
+Pair* BTreeMapMaximum(BTreeMap* self);
+
+/**
+ * @brief Retrieve the key value pair which is the predecessor of the given key.
+ *
+ * @param self          The pointer to BTreeMap structure
+ * @param key           The designated key
+ *
+ * @retval ptr_pair     The pointer to the target key value pair
+ * @retval NULL         The key cannot be found or it has the minimum order
+ *
+ * @note The returned pointer is valid only until the next put or remove.
+ */
+Pair* BTreeMapPredecessor(BTreeMap* self, void* key);
+
+/**
+ * @brief Retrieve the key value pair which is the successor of the given key.
+ *
+ * @param self          The pointer to BTreeMap structure
+ * @param key           The designated key
+ *
+ * @retval ptr_pair     The pointer to the target key value pair
+ * @retval NULL         The key cannot be found or it has the maximum order
+ *
+ * @note The returned pointer is valid only until the next put or remove.
+ */
+Pair* BTreeMapSuccessor(BTreeMap* self, void* key);
+
+/**
+ * @brief Initialize the map iterator.
+ *
+ * @param self          The pointer to BTreeMap structure
+ */
+void BTreeMapFirst(BTreeMap* self);
+
+/**
+ * @brief Get the key value pair pointed by the iterator and advance the iterator.
+ *
+ * @param self          The pointer to BTreeMap structure
+ *
+ * @retval ptr_pair     The pointer to the current key value pair
+ * @retval NULL         The map end is reached
+ *
+ * @note The map should not be modified during the iteration.
+ */
+Pair* BTreeMapNext(BTreeMap* self);
+
+/**
+ * @brief Get the key value pair pointed by the iterator and advance the iterator
+ * in the reverse order.
+ *
+ * @param self          The pointer to BTreeMap structure
+ *
+ * @retval ptr_pair     The pointer to the current key value pair
+ * @retval NULL         The map end is reached
+ *
+ * @note The map should not be modified during the iteration.
+ */
+Pair* BTreeMapReverseNext(BTreeMap* self);
+
+/**
+ * @brief Set the custom key comparison function.
+ *
+ * By default, key is treated as integer.
+ *
+ * @param self          The pointer to BTreeMap structure
+ * @param func          The custom function
+ */
+void BTreeMapSetCompare(BTreeMap* self, BTreeMapCompare func);
+
+/**
+ * @brief Set the custom key cleanup function.
+ *
+ * By default, no cleanup operation for key.
+ *
+ * @param self          The pointer to BTreeMap structure
+ * @param func          The custom function
+ */
+void BTreeMapSetCleanKey(BTreeMap* self, BTreeMapCleanKey func);
+
+/**
+ * @brief Set the custom value cleanup function.
+ *
+ * By default, no cleanup operation for value.
+ *
+ * @param self          The pointer to BTreeMap structure
+ * @param func          The custom function
+ */
+void BTreeMapSetCleanValue(BTreeMap* self, BTreeMapCleanValue func);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
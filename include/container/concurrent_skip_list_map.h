@@ -0,0 +1,307 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file concurrent_skip_list_map.h The ordered map shared by multiple threads.
+ */
+
+#ifndef _CONCURRENT_SKIP_LIST_MAP_H_
+#define _CONCURRENT_SKIP_LIST_MAP_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** ConcurrentSkipListMapData is the data type for the container private
+    information. */
+typedef struct _ConcurrentSkipListMapData ConcurrentSkipListMapData;
+
+/** Compare the equality of two keys. */
+typedef int (*ConcurrentSkipListMapCompare) (void*, void*);
+
+/** Key cleanup function called whenever a retired entry is reclaimed. */
+typedef void (*ConcurrentSkipListMapCleanKey) (void*);
+
+/** Value cleanup function called whenever a retired entry is reclaimed. */
+typedef void (*ConcurrentSkipListMapCleanValue) (void*);
+
+/** The cursor to walk through the map in ascending key order.
+
+    The cursor is allocated by the caller, usually on the stack, and is
+    initialized by ConcurrentSkipListMapFirst. Each thread can hold its own
+    cursors. The walk is weakly consistent: it never returns a pair twice and
+    reflects some of the updates made after the cursor is initialized. */
+typedef struct _ConcurrentSkipListMapCursor {
+    /** The map private information */
+    ConcurrentSkipListMapData *data_;
+
+    /** The skip list node to be visited next */
+    void *node_;
+} ConcurrentSkipListMapCursor;
+
+
+/** The implementation for concurrent ordered map. */
+typedef struct _ConcurrentSkipListMap {
+    /** The container private information */
+    ConcurrentSkipListMapData *data;
+
+    /** Insert a key value pair into the map.
+        @see ConcurrentSkipListMapPut */
+    bool (*put) (struct _ConcurrentSkipListMap*, void*, void*);
+
+    /** Retrieve the value corresponding to the designated key.
+        @see ConcurrentSkipListMapGet */
+    void* (*get) (struct _ConcurrentSkipListMap*, void*);
+
+    /** Check if the map contains the designated key.
+        @see ConcurrentSkipListMapFind */
+    bool (*find) (struct _ConcurrentSkipListMap*, void*);
+
+    /** Delete the key value pair corresponding to the designated key.
+        @see ConcurrentSkipListMapRemove */
+    bool (*remove) (struct _ConcurrentSkipListMap*, void*);
+
+    /** Return the number of stored key value pairs.
+        @see ConcurrentSkipListMapSize */
+    unsigned (*size) (struct _ConcurrentSkipListMap*);
+
+    /** Retrieve the key value pair with the minimum order from the map.
+        @see ConcurrentSkipListMapMinimum */
+    Pair* (*minimum) (struct _ConcurrentSkipListMap*);
+
+    /** Retrieve the key value pair with the maximum order from the map.
+        @see ConcurrentSkipListMapMaximum */
+    Pair* (*maximum) (struct _ConcurrentSkipListMap*);
+
+    /** Initialize the cursor to walk through the map.
+        @see ConcurrentSkipListMapFirst */
+    void (*first) (struct _ConcurrentSkipListMap*,
+                   ConcurrentSkipListMapCursor*);
+
+    /** Reclaim the retired entries while no other thread accesses the map.
+        @see ConcurrentSkipListMapReclaim */
+    void (*reclaim) (struct _ConcurrentSkipListMap*);
+
+    /** Set the custom key comparison function.
+        @see ConcurrentSkipListMapSetCompare */
+    void (*set_compare) (struct _ConcurrentSkipListMap*,
+                         ConcurrentSkipListMapCompare);
+
+    /** Set the custom key cleanup function.
+        @see ConcurrentSkipListMapSetCleanKey */
+    void (*set_clean_key) (struct _ConcurrentSkipListMap*,
+                           ConcurrentSkipListMapCleanKey);
+
+    /** Set the custom value cleanup function.
+        @see ConcurrentSkipListMapSetCleanValue */
+    void (*set_clean_value) (struct _ConcurrentSkipListMap*,
+                             ConcurrentSkipListMapCleanValue);
+} ConcurrentSkipListMap;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for ConcurrentSkipListMap.
+ *
+ * @retval obj          The successfully constructed map
+ * @retval NULL         Insufficient memory for map construction
+ */
+ConcurrentSkipListMap* ConcurrentSkipListMapInit();
+
+/**
+ * @brief The destructor for ConcurrentSkipListMap.
+ *
+ * The destructor should be called after all the other threads stop accessing
+ * the map.
+ *
+ * @param obj           The pointer to the to be destructed map
+ */
+void ConcurrentSkipListMapDeinit(ConcurrentSkipListMap* obj);
+
+/**
+ * @brief Insert a key value pair into the map.
+ *
+ * This function inserts a key value pair into the map with compare-and-swap
+ * and never blocks the other threads. If the designated key is equal to a
+ * certain one stored in the map, the value is atomically replaced. The
+ * replaced value and the given duplicate key are retired and cleaned by
+ * ConcurrentSkipListMapReclaim, since other threads may still read them.
+ *
+ * @param self          The pointer to ConcurrentSkipListMap structure
+ * @param key           The designated key
+ * @param value         The designated value
+ *
+ * @retval true         The pair is successfully inserted
+ * @retval false        The pair cannot be inserted due to insufficient memory
+ */
+bool ConcurrentSkipListMapPut(ConcurrentSkipListMap* self, void* key,
+                              void* value);
+
+/**
+ * @brief Retrieve the value corresponding to the designated key.
+ *
+ * The lookup takes no lock and never writes to the shared memory.
+ *
+ * @param self          The pointer to ConcurrentSkipListMap structure
+ * @param key           The designated key
+ *
+ * @retval value        The corresponding value
+ * @retval NULL         The key cannot be found
+ */
+void* ConcurrentSkipListMapGet(ConcurrentSkipListMap* self, void* key);
+
+/**
+ * @brief Check if the map contains the designated key.
+ *
+ * @param self          The pointer to ConcurrentSkipListMap structure
+ * @param key           The designated key
+ *
+ * @retval true         The key can be found
+ * @retval false        The key cannot be found
+ */
+bool ConcurrentSkipListMapFind(ConcurrentSkipListMap* self, void* key);
+
+/**
+ * @brief Remove the key value pair corresponding to the designated key.
+ *
+ * This function logically deletes the pair by marking the node links and then
+ * unlinks the node. The removed pair is retired and cleaned by
+ * ConcurrentSkipListMapReclaim.
+ *
+ * @param self          The pointer to ConcurrentSkipListMap structure
+ * @param key           The designated key
+ *
+ * @retval true         The pair is successfully removed
+ * @retval false        The key cannot be found
+ */
+bool ConcurrentSkipListMapRemove(ConcurrentSkipListMap* self, void* key);
+
+/**
+ * @brief Return the number of stored key value pairs.
+ *
+ * Under concurrent updates, the number is a momentary estimation.
+ *
+ * @param self          The pointer to ConcurrentSkipListMap structure
+ *
+ * @retval size         The number of stored pairs
+ */
+unsigned ConcurrentSkipListMapSize(ConcurrentSkipListMap* self);
+
+/**
+ * @brief Retrieve the key value pair with the minimum order from the map.
+ *
+ * @param self          The pointer to ConcurrentSkipListMap structure
+ *
+ * @retval ptr_pair     The pointer to the target key value pair
+ * @retval NULL         The map is empty
+ */
+Pair* ConcurrentSkipListMapMinimum(ConcurrentSkipListMap* self);
+
+/**
+ * @brief Retrieve the key value pair with the maximum order from the map.
+ *
+ * @param self          The pointer to ConcurrentSkipListMap structure
+ *
+ * @retval ptr_pair     The pointer to the target key value pair
+ * @retval NULL         The map is empty
+ */
+Pair* ConcurrentSkipListMapMaximum(ConcurrentSkipListMap* self);
+
+/**
+ * @brief Initialize the cursor to walk through the map in ascending key order.
+ *
+ * @param self          The pointer to ConcurrentSkipListMap structure
+ * @param cursor        The pointer to the caller allocated cursor
+ */
+void ConcurrentSkipListMapFirst(ConcurrentSkipListMap* self,
+                                ConcurrentSkipListMapCursor* cursor);
+
+/**
+ * @brief Get the key value pair pointed by the cursor and advance the cursor.
+ *
+ * The pairs removed after the cursor is initialized are skipped.
+ *
+ * @param cursor        The pointer to the cursor
+ *
+ * @retval ptr_pair     The pointer to the key value pair
+ * @retval NULL         The walk is finished
+ */
+Pair* ConcurrentSkipListMapCursorNext(ConcurrentSkipListMapCursor* cursor);
+
+/**
+ * @brief Reclaim the retired nodes and invoke the cleanup functions for the
+ * retired pairs.
+ *
+ * Removed nodes stay readable until this function is called, so the lookups
+ * and the cursors never touch freed memory. The caller should invoke it only
+ * at a quiescent point where no other thread is accessing the map, and all the
+ * pair pointers returned before become invalid.
+ *
+ * @param self          The pointer to ConcurrentSkipListMap structure
+ */
+void ConcurrentSkipListMapReclaim(ConcurrentSkipListMap* self);
+
+/**
+ * @brief Set the custom key comparison function.
+ *
+ * By default, the key is treated as integer. The function should be set
+ * before the map is shared with other threads.
+ *
+ * @param self          The pointer to ConcurrentSkipListMap structure
+ * @param func          The custom function
+ */
+void ConcurrentSkipListMapSetCompare(ConcurrentSkipListMap* self,
+                                     ConcurrentSkipListMapCompare func);
+
+/**
+ * @brief Set the custom key cleanup function.
+ *
+ * By default, no cleanup operation for keys.
+ *
+ * @param self          The pointer to ConcurrentSkipListMap structure
+ * @param func          The custom function
+ */
+void ConcurrentSkipListMapSetCleanKey(ConcurrentSkipListMap* self,
+                                      ConcurrentSkipListMapCleanKey func);
+
+/**
+ * @brief Set the custom value cleanup function.
+ *
+ * By default, no cleanup operation for values.
+ *
+ * @param self          The pointer to ConcurrentSkipListMap structure
+ * @param func          The custom function
+ */
+void ConcurrentSkipListMapSetCleanValue(ConcurrentSkipListMap* self,
+                                        ConcurrentSkipListMapCleanValue func);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
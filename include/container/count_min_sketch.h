@@ -0,0 +1,144 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+
+/**
+ * @file count_min_sketch.h The probabilistic counter to estimate element
+ * frequencies.
+ */
+
+#ifndef _COUNT_MIN_SKETCH_H_
+#define _COUNT_MIN_SKETCH_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** CountMinSketchData is the data type for the container private information. */
+typedef struct _CountMinSketchData CountMinSketchData;
+
+
+/** The implementation for count-min sketch frequency estimator. */
+typedef struct _CountMinSketch {
+    /** The container private information */
+    CountMinSketchData* data;
+
+    /** Increase the frequency of an element.
+        @see CountMinSketchUpdate */
+    void (*update) (struct _CountMinSketch*, void*, size_t, uint64_t);
+
+    /** Estimate the frequency of an element.
+        @see CountMinSketchEstimate */
+    uint64_t (*estimate) (struct _CountMinSketch*, void*, size_t);
+
+    /** Return the sum of all the recorded frequencies.
+        @see CountMinSketchTotal */
+    uint64_t (*total) (struct _CountMinSketch*);
+
+    /** Merge the other sketch into this one.
+        @see CountMinSketchMerge */
+    bool (*merge) (struct _CountMinSketch*, struct _CountMinSketch*);
+} CountMinSketch;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for CountMinSketch.
+ *
+ * The sketch keeps depth rows of width counters. With total recorded frequency
+ * N, an estimation exceeds the true frequency by at most e * N / width with
+ * probability at least 1 - exp(-depth).
+ *
+ * @param width         The number of counters in each row
+ * @param depth         The number of rows
+ *
+ * @retval obj          The successfully constructed sketch
+ * @retval NULL         Zero dimension or insufficient memory for sketch
+ *                      construction
+ */
+CountMinSketch* CountMinSketchInit(unsigned width, unsigned depth);
+
+/**
+ * @brief The destructor for CountMinSketch.
+ *
+ * @param obj           The pointer to the to be destructed sketch
+ */
+void CountMinSketchDeinit(CountMinSketch* obj);
+
+/**
+ * @brief Increase the frequency of an element.
+ *
+ * @param self          The pointer to CountMinSketch structure
+ * @param key           The designated key
+ * @param size          Size of the data pointed by the key in bytes
+ * @param count         The amount to increase
+ */
+void CountMinSketchUpdate(CountMinSketch* self, void* key, size_t size,
+                          uint64_t count);
+
+/**
+ * @brief Estimate the frequency of an element.
+ *
+ * The estimation never underestimates the true frequency.
+ *
+ * @param self          The pointer to CountMinSketch structure
+ * @param key           The designated key
+ * @param size          Size of the data pointed by the key in bytes
+ *
+ * @retval count        The estimated frequency
+ */
+uint64_t CountMinSketchEstimate(CountMinSketch* self, void* key, size_t size);
+
+/**
+ * @brief Return the sum of all the recorded frequencies.
+ *
+ * @param self          The pointer to CountMinSketch structure
+ *
+ * @retval total        The total frequency
+ */
+uint64_t CountMinSketchTotal(CountMinSketch* self);
+
+/**
+ * @brief Merge the other sketch into this one.
+ *
+ * After merging, this sketch estimates the frequencies of the sum of the two
+ * recorded streams. The other sketch is left unchanged.
+ *
+ * @param self          The pointer to CountMinSketch structure
+ * @param other         The pointer to the to be merged sketch
+ *
+ * @retval true         The sketches are successfully merged
+ * @retval false        The two sketches have different dimensions
+ */
+bool CountMinSketchMerge(CountMinSketch* self, CountMinSketch* other);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -50,6 +50,9 @@ typedef void (*HashMapCleanKey) (void*);
 /** Value cleanup function called whenever a live entry is removed. */
 typedef void (*HashMapCleanValue) (void*);
 
+/** Visit a stored pair with the user argument, and return false to stop. */
+typedef bool (*HashMapVisit) (Pair*, void*);
+
 
 /** The implementation for hash map. */
 typedef struct _HashMap {
@@ -84,6 +87,14 @@ typedef struct _HashMap {
         @see HashMapNext */
     Pair* (*next) (struct _HashMap*);
 
+    /** Retrieve a batch of pairs pointed by the iterator and advance the iterator.
+        @see HashMapNextBatch */
+    unsigned (*next_batch) (struct _HashMap*, Pair*, unsigned);
+
+    /** Visit all the stored pairs with the designated function.
+        @see HashMapForEach */
+    bool (*for_each) (struct _HashMap*, HashMapVisit, void*);
+
     /** Set the custom hash function.
         @see HashMapSetHash */
     void (*set_hash) (struct _HashMap*, HashMapHash);
@@ -198,6 +209,40 @@ void HashMapFirst(HashMap* self);
  */
 Pair* HashMapNext(HashMap* self);
 
+/**
+ * @brief Retrieve a batch of pairs pointed by the iterator and advance the
+ * iterator.
+ *
+ * This function copies at most cap key value pairs into the caller provided
+ * buffer, which saves the per pair call and iterator bookkeeping of
+ * HashMapNext(). It shares the iterator with HashMapNext(), so HashMapFirst()
+ * should be called first.
+ *
+ * @param self          The pointer to HashMap structure
+ * @param pairs         The buffer to store the copies of retrieved pairs
+ * @param cap           The buffer capacity
+ *
+ * @retval count        The number of retrieved pairs, which is 0 if the map end
+ *                      is reached
+ */
+unsigned HashMapNextBatch(HashMap* self, Pair* pairs, unsigned cap);
+
+/**
+ * @brief Visit all the stored key value pairs with the designated function.
+ *
+ * The pairs are visited in the same order as the iterator. The visitor receives
+ * the pair and the user argument, and can stop the traversal by returning false.
+ * The visitor may update the value of the pair but should not modify the map.
+ *
+ * @param self          The pointer to HashMap structure
+ * @param func          The visitor function
+ * @param arg           The user argument passed to the visitor
+ *
+ * @retval true         All the pairs are visited
+ * @retval false        The traversal is stopped by the visitor
+ */
+bool HashMapForEach(HashMap* self, HashMapVisit func, void* arg);
+
 /**
  * @brief Set the custom hash function.
  *
@@ -47,6 +47,19 @@ typedef int (*HashSetCompare) (void*, void*);
 /** void* cleanup function called whenever a live entry is removed. */
 typedef void (*HashSetCleanKey) (void*);
 
+/** Visit a stored key with the user argument, and return false to stop. */
+typedef bool (*HashSetVisit) (void*, void*);
+
+/** The strategy to perform set intersection. */
+typedef enum _HashSetIntersectMode {
+    /** Choose the strategy measured to be faster, which is currently probe. */
+    HASH_SET_INTERSECT_AUTO,
+    /** Probe the larger set for each key of the smaller set. */
+    HASH_SET_INTERSECT_PROBE,
+    /** Merge two key arrays sorted by hash value. */
+    HASH_SET_INTERSECT_SORT,
+} HashSetIntersectMode;
+
 
 /** The implementation for hash set. */
 typedef struct _HashSet {
@@ -77,6 +90,14 @@ typedef struct _HashSet {
         @see HashSetNext */
     void* (*next) (struct _HashSet*);
 
+    /** Retrieve a batch of keys pointed by the iterator and advance the iterator.
+        @see HashSetNextBatch */
+    unsigned (*next_batch) (struct _HashSet*, void**, unsigned);
+
+    /** Visit all the stored keys with the designated function.
+        @see HashSetForEach */
+    bool (*for_each) (struct _HashSet*, HashSetVisit, void*);
+
     /** Set the custom hash function.
         @see HashSetSetHash */
     void (*set_hash) (struct _HashSet*, HashSetHash);
@@ -168,6 +189,39 @@ void HashSetFirst(HashSet* self);
  */
 void* HashSetNext(HashSet* self);
 
+/**
+ * @brief Retrieve a batch of keys pointed by the iterator and advance the
+ * iterator.
+ *
+ * This function drains at most cap keys into the caller provided buffer, which
+ * saves the per key call and iterator bookkeeping of HashSetNext(). It shares
+ * the iterator with HashSetNext(), so HashSetFirst() should be called first.
+ *
+ * @param self          The pointer to HashSet structure
+ * @param keys          The buffer to store the retrieved keys
+ * @param cap           The buffer capacity
+ *
+ * @retval count        The number of retrieved keys, which is 0 if the set end
+ *                      is reached
+ */
+unsigned HashSetNextBatch(HashSet* self, void** keys, unsigned cap);
+
+/**
+ * @brief Visit all the stored keys with the designated function.
+ *
+ * The keys are visited in the same order as the iterator. The visitor receives
+ * the key and the user argument, and can stop the traversal by returning false.
+ * The set should not be modified during the traversal.
+ *
+ * @param self          The pointer to HashSet structure
+ * @param func          The visitor function
+ * @param arg           The user argument passed to the visitor
+ *
+ * @retval true         All the keys are visited
+ * @retval false        The traversal is stopped by the visitor
+ */
+bool HashSetForEach(HashSet* self, HashSetVisit func, void* arg);
+
 /**
  * @brief Set the custom hash function.
  *
@@ -228,6 +282,35 @@ HashSet* HashSetUnion(HashSet* lhs, HashSet* rhs);
  */
 HashSet* HashSetIntersect(HashSet* lhs, HashSet* rhs);
 
+/**
+ * @brief Perform intersection operation with the designated strategy.
+ *
+ * The probe strategy looks up the larger set for each key of the smaller set,
+ * which costs a cache miss per lookup when the sets are huge. The sort strategy
+ * extracts both sets into arrays sorted by hash value and merges them linearly.
+ * It is applicable only when both sets share the same hash function, otherwise
+ * the probe strategy is used. The auto strategy currently resolves to the probe
+ * one, since no input size is measured where sorting wins. HashSetIntersect()
+ * is equivalent to the probe strategy.
+ *
+ * Note that the sort strategy must walk every node of both sets to extract the
+ * keys, so it pays off only when probing is unusually expensive. Please measure
+ * with the real workload before switching to it.
+ *
+ * @param lhs           The first source set
+ * @param rhs           The second source set
+ * @param mode          The designated strategy
+ * @param p_used        The pointer to the returned strategy actually applied,
+ *                      which can be NULL if not interested
+ *
+ * @retval result       The result set of intersection operation
+ * @retval NULL         Insufficient memory for result set
+ *
+ * @note The same key clean issue as HashSetIntersect().
+ */
+HashSet* HashSetIntersectEx(HashSet* lhs, HashSet* rhs, HashSetIntersectMode mode,
+                            HashSetIntersectMode* p_used);
+
 /**
  * @brief Perform difference operation for the specified two sets.
  *
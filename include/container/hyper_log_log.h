@@ -0,0 +1,128 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+
+/**
+ * @file hyper_log_log.h The probabilistic counter to estimate the number of
+ * distinct elements.
+ */
+
+#ifndef _HYPER_LOG_LOG_H_
+#define _HYPER_LOG_LOG_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** HyperLogLogData is the data type for the container private information. */
+typedef struct _HyperLogLogData HyperLogLogData;
+
+
+/** The implementation for HyperLogLog cardinality estimator. */
+typedef struct _HyperLogLog {
+    /** The container private information */
+    HyperLogLogData* data;
+
+    /** Record an element in the estimator.
+        @see HyperLogLogAdd */
+    void (*add) (struct _HyperLogLog*, void*, size_t);
+
+    /** Estimate the number of distinct recorded elements.
+        @see HyperLogLogCount */
+    uint64_t (*count) (struct _HyperLogLog*);
+
+    /** Merge the other estimator into this one.
+        @see HyperLogLogMerge */
+    bool (*merge) (struct _HyperLogLog*, struct _HyperLogLog*);
+} HyperLogLog;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for HyperLogLog.
+ *
+ * The estimator keeps 2^precision one byte registers, and the standard error of
+ * the estimation is about 1.04 / sqrt(2^precision). For example, precision 14
+ * costs 16KB and yields roughly 0.8% error.
+ *
+ * @param precision     The number of hash bits used to select a register,
+ *                      ranging from 4 to 18
+ *
+ * @retval obj          The successfully constructed estimator
+ * @retval NULL         Invalid precision or insufficient memory for estimator
+ *                      construction
+ */
+HyperLogLog* HyperLogLogInit(unsigned precision);
+
+/**
+ * @brief The destructor for HyperLogLog.
+ *
+ * @param obj           The pointer to the to be destructed estimator
+ */
+void HyperLogLogDeinit(HyperLogLog* obj);
+
+/**
+ * @brief Record an element in the estimator.
+ *
+ * The element is identified by the content of the designated bytes. So the
+ * same element must always be passed with the same byte representation.
+ *
+ * @param self          The pointer to HyperLogLog structure
+ * @param key           The designated key
+ * @param size          Size of the data pointed by the key in bytes
+ */
+void HyperLogLogAdd(HyperLogLog* self, void* key, size_t size);
+
+/**
+ * @brief Estimate the number of distinct recorded elements.
+ *
+ * @param self          The pointer to HyperLogLog structure
+ *
+ * @retval count        The estimated cardinality
+ */
+uint64_t HyperLogLogCount(HyperLogLog* self);
+
+/**
+ * @brief Merge the other estimator into this one.
+ *
+ * After merging, this estimator approximates the cardinality of the union of
+ * the two recorded multisets. The other estimator is left unchanged.
+ *
+ * @param self          The pointer to HyperLogLog structure
+ * @param other         The pointer to the to be merged estimator
+ *
+ * @retval true         The estimators are successfully merged
+ * @retval false        The two estimators have different precisions
+ */
+bool HyperLogLogMerge(HyperLogLog* self, HyperLogLog* other);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
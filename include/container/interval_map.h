@@ -0,0 +1,251 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file interval_map.h The ordered map to store intervals with overlap queries.
+ */
+
+#ifndef _INTERVAL_MAP_H_
+#define _INTERVAL_MAP_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** IntervalMapData is the data type for the container private information. */
+typedef struct _IntervalMapData IntervalMapData;
+
+/** Compare the order of two interval endpoints. */
+typedef int (*IntervalMapCompare) (void*, void*);
+
+/** Value cleanup function called whenever a live entry is removed. */
+typedef void (*IntervalMapCleanValue) (void*);
+
+/** The half-open interval [low, high) and its associated value. */
+typedef struct _Interval {
+    /** The inclusive lower endpoint */
+    void *low;
+
+    /** The exclusive upper endpoint */
+    void *high;
+
+    /** The associated value */
+    void *value;
+} Interval;
+
+/** The visitor called for each interval reported by a query. Return false to
+    stop the query. */
+typedef bool (*IntervalMapVisit) (Interval*, void*);
+
+
+/** The implementation for interval map. */
+typedef struct _IntervalMap {
+    /** The container private information */
+    IntervalMapData *data;
+
+    /** Insert an interval with its value into the map.
+        @see IntervalMapPut */
+    bool (*put) (struct _IntervalMap*, void*, void*, void*);
+
+    /** Retrieve the value corresponding to the designated interval.
+        @see IntervalMapGet */
+    void* (*get) (struct _IntervalMap*, void*, void*);
+
+    /** Check if the map contains the designated interval.
+        @see IntervalMapFind */
+    bool (*find) (struct _IntervalMap*, void*, void*);
+
+    /** Delete the designated interval and its value.
+        @see IntervalMapRemove */
+    bool (*remove) (struct _IntervalMap*, void*, void*);
+
+    /** Return the number of stored intervals.
+        @see IntervalMapSize */
+    unsigned (*size) (struct _IntervalMap*);
+
+    /** Report the intervals containing the given point.
+        @see IntervalMapStab */
+    bool (*stab) (struct _IntervalMap*, void*, IntervalMapVisit, void*);
+
+    /** Report the intervals overlapping the given interval.
+        @see IntervalMapOverlap */
+    bool (*overlap) (struct _IntervalMap*, void*, void*, IntervalMapVisit,
+                     void*);
+
+    /** Set the custom endpoint comparison function.
+        @see IntervalMapSetCompare */
+    void (*set_compare) (struct _IntervalMap*, IntervalMapCompare);
+
+    /** Set the custom value cleanup function.
+        @see IntervalMapSetCleanValue */
+    void (*set_clean_value) (struct _IntervalMap*, IntervalMapCleanValue);
+} IntervalMap;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for IntervalMap.
+ *
+ * @retval obj          The successfully constructed map
+ * @retval NULL         Insufficient memory for map construction
+ */
+IntervalMap* IntervalMapInit();
+
+/**
+ * @brief The destructor for IntervalMap.
+ *
+ * @param obj           The pointer to the to be destructed map
+ */
+void IntervalMapDeinit(IntervalMap* obj);
+
+/**
+ * @brief Insert an interval with its value into the map.
+ *
+ * The intervals are ordered by the lower endpoint and then the upper one. If
+ * the designated interval is already stored in the map, its value will be
+ * replaced and the cleanup function is invoked for the replaced value.
+ *
+ * @param self          The pointer to IntervalMap structure
+ * @param low           The inclusive lower endpoint
+ * @param high          The exclusive upper endpoint
+ * @param value         The designated value
+ *
+ * @retval true         The interval is successfully inserted
+ * @retval false        The lower endpoint is greater than the upper one or
+ *                      insufficient memory
+ */
+bool IntervalMapPut(IntervalMap* self, void* low, void* high, void* value);
+
+/**
+ * @brief Retrieve the value corresponding to the designated interval.
+ *
+ * @param self          The pointer to IntervalMap structure
+ * @param low           The inclusive lower endpoint
+ * @param high          The exclusive upper endpoint
+ *
+ * @retval value        The corresponding value
+ * @retval NULL         The interval cannot be found
+ */
+void* IntervalMapGet(IntervalMap* self, void* low, void* high);
+
+/**
+ * @brief Check if the map contains the designated interval.
+ *
+ * @param self          The pointer to IntervalMap structure
+ * @param low           The inclusive lower endpoint
+ * @param high          The exclusive upper endpoint
+ *
+ * @retval true         The interval can be found
+ * @retval false        The interval cannot be found
+ */
+bool IntervalMapFind(IntervalMap* self, void* low, void* high);
+
+/**
+ * @brief Remove the designated interval and its value.
+ *
+ * The cleanup function is invoked for the removed value.
+ *
+ * @param self          The pointer to IntervalMap structure
+ * @param low           The inclusive lower endpoint
+ * @param high          The exclusive upper endpoint
+ *
+ * @retval true         The interval is successfully removed
+ * @retval false        The interval cannot be found
+ */
+bool IntervalMapRemove(IntervalMap* self, void* low, void* high);
+
+/**
+ * @brief Return the number of stored intervals.
+ *
+ * @param self          The pointer to IntervalMap structure
+ *
+ * @retval size         The number of stored intervals
+ */
+unsigned IntervalMapSize(IntervalMap* self);
+
+/**
+ * @brief Report the intervals containing the given point in ascending order.
+ *
+ * The stored interval [low, high) contains the point p if low <= p < high.
+ * Each tree node keeps the maximum upper endpoint of its subtree, so the query
+ * skips the subtrees which cannot hold any match.
+ *
+ * @param self          The pointer to IntervalMap structure
+ * @param point         The designated point
+ * @param func          The visitor for each reported interval
+ * @param arg           The argument passed to the visitor
+ *
+ * @retval true         All the matched intervals are reported
+ * @retval false        The visitor stops the query
+ */
+bool IntervalMapStab(IntervalMap* self, void* point, IntervalMapVisit func,
+                     void* arg);
+
+/**
+ * @brief Report the intervals overlapping the given one in ascending order.
+ *
+ * The stored interval [low, high) overlaps the query [lo, hi) if
+ * low < hi and lo < high.
+ *
+ * @param self          The pointer to IntervalMap structure
+ * @param low           The inclusive lower endpoint of the query
+ * @param high          The exclusive upper endpoint of the query
+ * @param func          The visitor for each reported interval
+ * @param arg           The argument passed to the visitor
+ *
+ * @retval true         All the matched intervals are reported
+ * @retval false        The visitor stops the query
+ */
+bool IntervalMapOverlap(IntervalMap* self, void* low, void* high,
+                        IntervalMapVisit func, void* arg);
+
+/**
+ * @brief Set the custom endpoint comparison function.
+ *
+ * By default, endpoint is treated as integer.
+ *
+ * @param self          The pointer to IntervalMap structure
+ * @param func          The custom function
+ */
+void IntervalMapSetCompare(IntervalMap* self, IntervalMapCompare func);
+
+/**
+ * @brief Set the custom value cleanup function.
+ *
+ * By default, no cleanup operation for value.
+ *
+ * @param self          The pointer to IntervalMap structure
+ * @param func          The custom function
+ */
+void IntervalMapSetCleanValue(IntervalMap* self, IntervalMapCleanValue func);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,329 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file persistent_tree_map.h The ordered map with constant time snapshots.
+ */
+
+#ifndef _PERSISTENT_TREE_MAP_H_
+#define _PERSISTENT_TREE_MAP_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** PersistentTreeMapData is the data type for the container private
+    information. */
+typedef struct _PersistentTreeMapData PersistentTreeMapData;
+
+/** TreeSnapshot is the immutable version of the map captured by a snapshot. */
+typedef struct _TreeSnapshot TreeSnapshot;
+
+/** Compare the equality of two keys. */
+typedef int (*PersistentTreeMapCompare) (void*, void*);
+
+/** Key cleanup function called whenever a pair is no longer referred by any
+    version of the map. */
+typedef void (*PersistentTreeMapCleanKey) (void*);
+
+/** Value cleanup function called whenever a pair is no longer referred by any
+    version of the map. */
+typedef void (*PersistentTreeMapCleanValue) (void*);
+
+/** Visit a key value pair stored in the snapshot. Return false to stop. */
+typedef bool (*TreeSnapshotVisit) (Pair*, void*);
+
+
+/** The implementation for persistent ordered map. */
+typedef struct _PersistentTreeMap {
+    /** The container private information */
+    PersistentTreeMapData *data;
+
+    /** Insert a key value pair into the map.
+        @see PersistentTreeMapPut */
+    bool (*put) (struct _PersistentTreeMap*, void*, void*);
+
+    /** Retrieve the value corresponding to the designated key.
+        @see PersistentTreeMapGet */
+    void* (*get) (struct _PersistentTreeMap*, void*);
+
+    /** Check if the map contains the designated key.
+        @see PersistentTreeMapFind */
+    bool (*find) (struct _PersistentTreeMap*, void*);
+
+    /** Delete the key value pair corresponding to the designated key.
+        @see PersistentTreeMapRemove */
+    bool (*remove) (struct _PersistentTreeMap*, void*);
+
+    /** Return the number of stored key value pairs.
+        @see PersistentTreeMapSize */
+    unsigned (*size) (struct _PersistentTreeMap*);
+
+    /** Retrieve the key value pair with the minimum order from the map.
+        @see PersistentTreeMapMinimum */
+    Pair* (*minimum) (struct _PersistentTreeMap*);
+
+    /** Retrieve the key value pair with the maximum order from the map.
+        @see PersistentTreeMapMaximum */
+    Pair* (*maximum) (struct _PersistentTreeMap*);
+
+    /** Capture the current version of the map.
+        @see PersistentTreeMapSnapshot */
+    TreeSnapshot* (*snapshot) (struct _PersistentTreeMap*);
+
+    /** Set the custom key comparison function.
+        @see PersistentTreeMapSetCompare */
+    void (*set_compare) (struct _PersistentTreeMap*, PersistentTreeMapCompare);
+
+    /** Set the custom key cleanup function.
+        @see PersistentTreeMapSetCleanKey */
+    void (*set_clean_key) (struct _PersistentTreeMap*, PersistentTreeMapCleanKey);
+
+    /** Set the custom value cleanup function.
+        @see PersistentTreeMapSetCleanValue */
+    void (*set_clean_value) (struct _PersistentTreeMap*,
+                             PersistentTreeMapCleanValue);
+} PersistentTreeMap;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for PersistentTreeMap.
+ *
+ * The map is a balanced tree updated by path copying. Each update copies only
+ * the nodes on the path to the changed node which are shared with the alive
+ * snapshots. The nodes exclusively owned by the current version are updated in
+ * place, so the map costs no copy at all when no snapshot is alive.
+ *
+ * All the map operations should be issued by one writer thread. The snapshots
+ * can be read and released by any thread.
+ *
+ * @retval obj          The successfully constructed map
+ * @retval NULL         Insufficient memory for map construction
+ */
+PersistentTreeMap* PersistentTreeMapInit();
+
+/**
+ * @brief The destructor for PersistentTreeMap.
+ *
+ * The nodes still referred by the alive snapshots are released together with
+ * the last snapshot.
+ *
+ * @param obj           The pointer to the to be destructed map
+ */
+void PersistentTreeMapDeinit(PersistentTreeMap* obj);
+
+/**
+ * @brief Insert a key value pair into the map.
+ *
+ * This function inserts a key value pair into the map. If the designated key is
+ * equal to a certain one stored in the map, the existing pair will be replaced.
+ * The cleanup functions are invoked for that replaced pair once no snapshot
+ * refers to it.
+ *
+ * @param self          The pointer to PersistentTreeMap structure
+ * @param key           The designated key
+ * @param value         The designated value
+ *
+ * @retval true         The pair is successfully inserted
+ * @retval false        The pair cannot be inserted due to insufficient memory
+ */
+bool PersistentTreeMapPut(PersistentTreeMap* self, void* key, void* value);
+
+/**
+ * @brief Retrieve the value corresponding to the designated key.
+ *
+ * @param self          The pointer to PersistentTreeMap structure
+ * @param key           The designated key
+ *
+ * @retval value        The corresponding value
+ * @retval NULL         The key cannot be found
+ */
+void* PersistentTreeMapGet(PersistentTreeMap* self, void* key);
+
+/**
+ * @brief Check if the map contains the designated key.
+ *
+ * @param self          The pointer to PersistentTreeMap structure
+ * @param key           The designated key
+ *
+ * @retval true         The key can be found
+ * @retval false        The key cannot be found
+ */
+bool PersistentTreeMapFind(PersistentTreeMap* self, void* key);
+
+/**
+ * @brief Remove the key value pair corresponding to the designated key.
+ *
+ * The cleanup functions are invoked for the removed pair once no snapshot
+ * refers to it.
+ *
+ * @param self          The pointer to PersistentTreeMap structure
+ * @param key           The designated key
+ *
+ * @retval true         The pair is successfully removed
+ * @retval false        The key cannot be found or insufficient memory to copy
+ *                      the shared path
+ */
+bool PersistentTreeMapRemove(PersistentTreeMap* self, void* key);
+
+/**
+ * @brief Return the number of stored key value pairs.
+ *
+ * @param self          The pointer to PersistentTreeMap structure
+ *
+ * @retval size         The number of stored pairs
+ */
+unsigned PersistentTreeMapSize(PersistentTreeMap* self);
+
+/**
+ * @brief Retrieve the key value pair with the minimum order from the map.
+ *
+ * @param self          The pointer to PersistentTreeMap structure
+ *
+ * @retval ptr_pair     The pointer to the target key value pair
+ * @retval NULL         The map is empty
+ */
+Pair* PersistentTreeMapMinimum(PersistentTreeMap* self);
+
+/**
+ * @brief Retrieve the key value pair with the maximum order from the map.
+ *
+ * @param self          The pointer to PersistentTreeMap structure
+ *
+ * @retval ptr_pair     The pointer to the target key value pair
+ * @retval NULL         The map is empty
+ */
+Pair* PersistentTreeMapMaximum(PersistentTreeMap* self);
+
+/**
+ * @brief Capture the current version of the map.
+ *
+ * Capturing costs O(1) since it only refers to the current root. The snapshot
+ * is never affected by the subsequent map updates and should be released by
+ * TreeSnapshotRelease, possibly from another thread.
+ *
+ * @param self          The pointer to PersistentTreeMap structure
+ *
+ * @retval snap         The captured snapshot
+ * @retval NULL         Insufficient memory for snapshot construction
+ */
+TreeSnapshot* PersistentTreeMapSnapshot(PersistentTreeMap* self);
+
+/**
+ * @brief Set the custom key comparison function.
+ *
+ * By default, key is treated as integer.
+ *
+ * @param self          The pointer to PersistentTreeMap structure
+ * @param func          The custom function
+ */
+void PersistentTreeMapSetCompare(PersistentTreeMap* self,
+                                 PersistentTreeMapCompare func);
+
+/**
+ * @brief Set the custom key cleanup function.
+ *
+ * By default, no cleanup operation for key.
+ *
+ * @param self          The pointer to PersistentTreeMap structure
+ * @param func          The custom function
+ */
+void PersistentTreeMapSetCleanKey(PersistentTreeMap* self,
+                                  PersistentTreeMapCleanKey func);
+
+/**
+ * @brief Set the custom value cleanup function.
+ *
+ * By default, no cleanup operation for value.
+ *
+ * @param self          The pointer to PersistentTreeMap structure
+ * @param func          The custom function
+ */
+void PersistentTreeMapSetCleanValue(PersistentTreeMap* self,
+                                    PersistentTreeMapCleanValue func);
+
+
+/*===========================================================================*
+ *               Definition for the snapshot operations                      *
+ *===========================================================================*/
+/**
+ * @brief Release the snapshot and the nodes no longer referred by any version.
+ *
+ * @param snap          The pointer to the to be released snapshot
+ */
+void TreeSnapshotRelease(TreeSnapshot* snap);
+
+/**
+ * @brief Retrieve the value corresponding to the designated key.
+ *
+ * @param snap          The pointer to TreeSnapshot structure
+ * @param key           The designated key
+ *
+ * @retval value        The corresponding value
+ * @retval NULL         The key cannot be found
+ */
+void* TreeSnapshotGet(TreeSnapshot* snap, void* key);
+
+/**
+ * @brief Check if the snapshot contains the designated key.
+ *
+ * @param snap          The pointer to TreeSnapshot structure
+ * @param key           The designated key
+ *
+ * @retval true         The key can be found
+ * @retval false        The key cannot be found
+ */
+bool TreeSnapshotFind(TreeSnapshot* snap, void* key);
+
+/**
+ * @brief Return the number of key value pairs in the snapshot.
+ *
+ * @param snap          The pointer to TreeSnapshot structure
+ *
+ * @retval size         The number of pairs
+ */
+unsigned TreeSnapshotSize(TreeSnapshot* snap);
+
+/**
+ * @brief Visit the key value pairs in the snapshot in ascending key order.
+ *
+ * @param snap          The pointer to TreeSnapshot structure
+ * @param func          The visitor function
+ * @param arg           The argument passed to the visitor
+ *
+ * @retval true         All the pairs are visited
+ * @retval false        The visitor stops the traversal
+ */
+bool TreeSnapshotForEach(TreeSnapshot* snap, TreeSnapshotVisit func, void* arg);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
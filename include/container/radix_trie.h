@@ -0,0 +1,179 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+/**
+ * @file radix_trie.h The compact string dictionary based on adaptive radix tree
+ */
+#ifndef _RADIX_TRIE_H_
+#define _RADIX_TRIE_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** RadixTrieData is the data type for the container private information. */
+typedef struct RadixTrieData_ RadixTrieData;
+
+/** The implementation for adaptive radix tree based trie. */
+typedef struct _RadixTrie {
+    /** The container private information. */
+    RadixTrieData *data;
+
+    /** Insert a string into the trie.
+        @see RadixTrieInsert */
+    bool (*insert) (struct _RadixTrie*, const char*);
+
+    /** Insert an array of strings into the trie.
+        @see RadixTrieBulkInsert */
+    bool (*bulk_insert) (struct _RadixTrie*, const char**, unsigned);
+
+    /** Check if the trie contains the specified string.
+        @see RadixTrieHasExact */
+    bool (*has_exact) (struct _RadixTrie*, const char*);
+
+    /** Check if the trie contains the strings matching the specified prefix.
+        @see RadixTrieHasPrefixAs */
+    bool (*has_prefix_as) (struct _RadixTrie*, const char*);
+
+    /** Retrieve the strings from the trie matching the specified prefix.
+        @see RadixTrieGetPrefixAs */
+    bool (*get_prefix_as) (struct _RadixTrie*, const char*, const char***, unsigned*);
+
+    /** Remove a string from the trie.
+        @see RadixTrieRemove */
+    bool (*remove) (struct _RadixTrie*, const char*);
+
+    /** Return the number of strings stored in the trie.
+        @see RadixTrieSize */
+    unsigned (*size) (struct _RadixTrie*);
+} RadixTrie;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for RadixTrie.
+ *
+ * @retval obj          The successfully constructed trie
+ * @retval NULL         Insufficient memory for trie construction
+ */
+RadixTrie* RadixTrieInit();
+
+/**
+ * @brief The destructor for RadixTrie.
+ *
+ * @param obj           The pointer to the to be destructed trie
+ */
+void RadixTrieDeinit(RadixTrie* obj);
+
+/**
+ * @brief Insert a string into the trie.
+ *
+ * @param self          The pointer to RadixTrie structure
+ * @param str           The specified string
+ *
+ * @retval true         The string is successfully inserted
+ * @retval false        The string cannot be inserted due to insufficient memory
+ */
+bool RadixTrieInsert(RadixTrie* self, const char* str);
+
+/**
+ * @brief Insert an array of strings into the trie.
+ *
+ * @param self          The pointer to RadixTrie structure
+ * @param strs          Array of to be inserted strings
+ * @param size          The array size
+ *
+ * @retval true         The strings are successfully inserted
+ * @retval false        The strings cannot be inserted due to insufficient memory
+ */
+bool RadixTrieBulkInsert(RadixTrie* self, const char** strs, unsigned size);
+
+/**
+ * @brief Check if the trie contains the specified string.
+ *
+ * @param self          The pointer to RadixTrie structure
+ * @param str           The specified string
+ *
+ * @retval true         The trie contains the given string
+ * @retval false        No such string
+ */
+bool RadixTrieHasExact(RadixTrie* self, const char* str);
+
+/**
+ * @brief Check if the trie contains the strings matching the specified prefix.
+ *
+ * @param self          The pointer to RadixTrie structure
+ * @param prefix        The specified prefix
+ *
+ * @retval true         The trie contains the given prefix
+ * @retval false        No such prefix
+ */
+bool RadixTrieHasPrefixAs(RadixTrie* self, const char* prefix);
+
+/**
+ * @brief Retrieve the strings from the trie matching the specified prefix.
+ *
+ * @param self          The pointer to RadixTrie structure
+ * @param prefix        The specified prefix
+ * @param p_strs        The pointer to the returned array of strings
+ * @param p_size        The pointer to the returned array size
+ *
+ * @retval true         The strings matching the given prefix are returned
+ * @retval false        No string matching the given prefix or insufficient
+ *                      memory to store the matched strings
+ *
+ * @note The strings are returned in lexical order. Please remember to free
+ * the returned array of strings.
+ */
+bool RadixTrieGetPrefixAs(RadixTrie* self, const char* prefix, const char*** p_strs, unsigned* p_size);
+
+/**
+ * @brief Remove a string from the trie.
+ *
+ * @param self          The pointer to RadixTrie structure
+ * @param str           The specified string
+ *
+ * @retval true         The specified string is successfully removed
+ * @retval false        No such string
+ */
+bool RadixTrieRemove(RadixTrie* self, const char* str);
+
+/**
+ * @brief Return the number of stored strings.
+ *
+ * @param self          The pointer to RadixTrie structure
+ *
+ * @retval size         The number of stored strings
+ */
+unsigned RadixTrieSize(RadixTrie* self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,227 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+
+
+/**
+ * @file roaring_set.h The compressed set to store unique 32 bit integers.
+ */
+
+#ifndef _ROARING_SET_H_
+#define _ROARING_SET_H_
+
+#include "../util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** RoaringSetData is the data type for the container private information. */
+typedef struct _RoaringSetData RoaringSetData;
+
+
+/** The implementation for roaring bitmap based integer set. */
+typedef struct _RoaringSet {
+    /** The container private information */
+    RoaringSetData* data;
+
+    /** Insert an integer into the set.
+        @see RoaringSetAdd */
+    bool (*add) (struct _RoaringSet*, uint32_t);
+
+    /** Check if the set contains the specified integer.
+        @see RoaringSetFind */
+    bool (*find) (struct _RoaringSet*, uint32_t);
+
+    /** Remove the specified integer from the set.
+        @see RoaringSetRemove */
+    bool (*remove) (struct _RoaringSet*, uint32_t);
+
+    /** Return the number of stored unique integers.
+        @see RoaringSetSize */
+    unsigned (*size) (struct _RoaringSet*);
+
+    /** Initialize the set iterator.
+        @see RoaringSetFirst */
+    void (*first) (struct _RoaringSet*);
+
+    /** Get the integer pointed by the iterator and advance the iterator.
+        @see RoaringSetNext */
+    bool (*next) (struct _RoaringSet*, uint32_t*);
+} RoaringSet;
+
+
+/*===========================================================================*
+ *             Definition for the exported member operations                 *
+ *===========================================================================*/
+/**
+ * @brief The constructor for RoaringSet.
+ *
+ * @retval obj          The successfully constructed set
+ * @retval NULL         Insufficient memory for set construction
+ */
+RoaringSet* RoaringSetInit();
+
+/**
+ * @brief The destructor for RoaringSet.
+ *
+ * @param obj           The pointer to the to be destructed set
+ */
+void RoaringSetDeinit(RoaringSet* obj);
+
+/**
+ * @brief Insert an integer into the set.
+ *
+ * @param self          The pointer to RoaringSet structure
+ * @param key           The specified integer
+ *
+ * @retval true         The integer is successfully inserted
+ * @retval false        The integer cannot be inserted due to insufficient memory
+ */
+bool RoaringSetAdd(RoaringSet* self, uint32_t key);
+
+/**
+ * @brief Check if the set contains the specified integer.
+ *
+ * @param self          The pointer to RoaringSet structure
+ * @param key           The specified integer
+ *
+ * @retval true         The integer can be found
+ * @retval false        The integer cannot be found
+ */
+bool RoaringSetFind(RoaringSet* self, uint32_t key);
+
+/**
+ * @brief Remove the specified integer from the set.
+ *
+ * @param self          The pointer to RoaringSet structure
+ * @param key           The specified integer
+ *
+ * @retval true         The integer is successfully removed
+ * @retval false        The integer cannot be found or insufficient memory to
+ *                      compact the container holding it
+ */
+bool RoaringSetRemove(RoaringSet* self, uint32_t key);
+
+/**
+ * @brief Return the number of stored integers.
+ *
+ * @param self          The pointer to RoaringSet structure
+ *
+ * @retval size         The number of stored integers
+ */
+unsigned RoaringSetSize(RoaringSet* self);
+
+/**
+ * @brief Initialize the set iterator.
+ *
+ * @param self          The pointer to RoaringSet structure
+ */
+void RoaringSetFirst(RoaringSet* self);
+
+/**
+ * @brief Get the current integer pointed by the iterator and advance the
+ * iterator.
+ *
+ * Unlike HashSet, the integers are visited in ascending order. Since zero is a
+ * legal member, the integer is returned through the output parameter.
+ *
+ * @param self          The pointer to RoaringSet structure
+ * @param p_key         The pointer to the returned integer
+ *
+ * @retval true         The integer is returned
+ * @retval false        The set end is reached
+ */
+bool RoaringSetNext(RoaringSet* self, uint32_t* p_key);
+
+/**
+ * @brief Perform union operation for the specified two sets.
+ *
+ * @param lhs           The first source set
+ * @param rhs           The second source set
+ *
+ * @retval result       The result set of union operation
+ * @retval NULL         Insufficient memory for result set
+ */
+RoaringSet* RoaringSetUnion(RoaringSet* lhs, RoaringSet* rhs);
+
+/**
+ * @brief Perform intersection operation for the specified two sets.
+ *
+ * @param lhs           The first source set
+ * @param rhs           The second source set
+ *
+ * @retval result       The result set of intersection operation
+ * @retval NULL         Insufficient memory for result set
+ */
+RoaringSet* RoaringSetIntersect(RoaringSet* lhs, RoaringSet* rhs);
+
+/**
+ * @brief Perform difference operation for the specified two sets.
+ *
+ * @param lhs           The first source set
+ * @param rhs           The second source set
+ *
+ * @retval result       The result set of difference operation
+ * @retval NULL         Insufficient memory for result set
+ */
+RoaringSet* RoaringSetDifference(RoaringSet* lhs, RoaringSet* rhs);
+
+/**
+ * @brief Serialize the set into a portable byte stream.
+ *
+ * The stream is encoded in little endian regardless of the host byte order:
+ *  - 4 bytes magic "RSET" and 4 bytes container count.
+ *  - For each container: 2 bytes high 16 bits, 2 bytes container type
+ *    (0 for array, 1 for bitmap), and 4 bytes cardinality.
+ *  - The container payloads in the same order: sorted 16 bit integers for
+ *    the array type, and 1024 64 bit words for the bitmap type.
+ *
+ * @param self          The pointer to RoaringSet structure
+ * @param p_buf         The pointer to the returned byte stream
+ * @param p_size        The pointer to the returned stream size
+ *
+ * @retval true         The set is successfully serialized
+ * @retval false        Insufficient memory to hold the byte stream
+ *
+ * @note Please remember to free the returned byte stream.
+ */
+bool RoaringSetSerialize(RoaringSet* self, uint8_t** p_buf, size_t* p_size);
+
+/**
+ * @brief Restore a set from the byte stream produced by RoaringSetSerialize.
+ *
+ * @param buf           The byte stream
+ * @param size          The stream size
+ *
+ * @retval obj          The successfully restored set
+ * @retval NULL         Malformed stream or insufficient memory
+ */
+RoaringSet* RoaringSetDeserialize(const uint8_t* buf, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
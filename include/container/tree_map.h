@@ -47,6 +47,28 @@ typedef void (*TreeMapCleanKey) (void*);
 /** Value cleanup function called whenever a live entry is removed. */
 typedef void (*TreeMapCleanValue) (void*);
 
+/** The cursor to walk through a key range of the map.
+
+    The cursor is allocated by the caller, usually on the stack, and is
+    initialized by TreeMapBegin, TreeMapRange, their reverse variants, or
+    TreeMapPartition. The walk follows the parent links and needs neither a
+    stack nor the map iterator state, so any number of cursors can walk the
+    same map at once, also from different threads as long as no thread updates
+    the map. It stays valid until the next map update. */
+typedef struct _TreeMapCursor {
+    /** The map private information */
+    TreeMapData *data_;
+
+    /** The tree node to be visited next */
+    void *node_;
+
+    /** The tree node where the walk stops */
+    void *end_;
+
+    /** Whether the walk is in descending key order */
+    bool reverse_;
+} TreeMapCursor;
+
 
 /** The implementation for ordered map. */
 typedef struct _TreeMap {
@@ -89,6 +111,65 @@ typedef struct _TreeMap {
         @see TreeMapSuccessor */
     Pair* (*successor) (struct _TreeMap*, void*);
 
+    /** Retrieve the key value pair with the smallest key not less than the
+        given key.
+        @see TreeMapLowerBound */
+    Pair* (*lower_bound) (struct _TreeMap*, void*);
+
+    /** Retrieve the key value pair with the smallest key greater than the
+        given key.
+        @see TreeMapUpperBound */
+    Pair* (*upper_bound) (struct _TreeMap*, void*);
+
+    /** Initialize the cursor to walk through the map in ascending order.
+        @see TreeMapBegin */
+    void (*begin) (struct _TreeMap*, TreeMapCursor*);
+
+    /** Initialize the cursor to walk through the given key range.
+        @see TreeMapRange */
+    void (*range) (struct _TreeMap*, void*, void*, TreeMapCursor*);
+
+    /** Initialize the cursor to walk through the map in descending order.
+        @see TreeMapReverseBegin */
+    void (*reverse_begin) (struct _TreeMap*, TreeMapCursor*);
+
+    /** Initialize the cursor to walk through the given key range in
+        descending order.
+        @see TreeMapReverseRange */
+    void (*reverse_range) (struct _TreeMap*, void*, void*, TreeMapCursor*);
+
+    /** Split the map into the consecutive key ranges of similar sizes.
+        @see TreeMapPartition */
+    unsigned (*partition) (struct _TreeMap*, TreeMapCursor*, unsigned);
+
+    /** Return the number of stored keys less than the given key.
+        @see TreeMapRank */
+    unsigned (*rank) (struct _TreeMap*, void*);
+
+    /** Retrieve the key value pair with the designated order.
+        @see TreeMapSelect */
+    Pair* (*select) (struct _TreeMap*, unsigned);
+
+    /** Construct the map from the pairs sorted by key in linear time.
+        @see TreeMapBuildSorted */
+    bool (*build_sorted) (struct _TreeMap*, Pair*, unsigned);
+
+    /** Move the pairs with keys not less than the given key to a new map.
+        @see TreeMapSplit */
+    struct _TreeMap* (*split) (struct _TreeMap*, void*);
+
+    /** Move all the pairs of the map with greater keys into this map.
+        @see TreeMapJoin */
+    bool (*join) (struct _TreeMap*, struct _TreeMap*);
+
+    /** Move all the pairs of the other map into this map.
+        @see TreeMapMerge */
+    bool (*merge) (struct _TreeMap*, struct _TreeMap*);
+
+    /** Allocate the tree nodes from the arena chunks.
+        @see TreeMapSetArena */
+    void (*set_arena) (struct _TreeMap*, unsigned);
+
     /** Initialize the map iterator.
         @see TreeMapFirst */
     void (*first) (struct _TreeMap*);
@@ -237,6 +318,148 @@ Pair* TreeMapPredecessor(TreeMap* self, void* key);
  */
 Pair* TreeMapSuccessor(TreeMap* self, void* key);
 
+/**
+ * @brief Retrieve the key value pair with the smallest key not less than the
+ * given key.
+ *
+ * Unlike TreeMapSuccessor, the given key does not need to be stored in the map.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param key           The designated key
+ *
+ * @retval ptr_pair     The pointer to the target key value pair
+ * @retval NULL         All the stored keys are less than the given one
+ */
+Pair* TreeMapLowerBound(TreeMap* self, void* key);
+
+/**
+ * @brief Retrieve the key value pair with the smallest key greater than the
+ * given key.
+ *
+ * Unlike TreeMapSuccessor, the given key does not need to be stored in the map.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param key           The designated key
+ *
+ * @retval ptr_pair     The pointer to the target key value pair
+ * @retval NULL         All the stored keys are not greater than the given one
+ */
+Pair* TreeMapUpperBound(TreeMap* self, void* key);
+
+/**
+ * @brief Initialize the cursor to walk through the map in ascending order.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param cursor        The pointer to the caller allocated cursor
+ */
+void TreeMapBegin(TreeMap* self, TreeMapCursor* cursor);
+
+/**
+ * @brief Initialize the cursor to walk through the key range [lo, hi).
+ *
+ * The cursor is positioned at the lower bound of lo with a single search. Then
+ * each TreeMapCursorNext call advances to the in order successor without
+ * searching again, so a range of k pairs costs O(log n + k).
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param lo            The inclusive lower bound of the range
+ * @param hi            The exclusive upper bound of the range
+ * @param cursor        The pointer to the caller allocated cursor
+ */
+void TreeMapRange(TreeMap* self, void* lo, void* hi, TreeMapCursor* cursor);
+
+/**
+ * @brief Initialize the cursor to walk through the map in descending order.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param cursor        The pointer to the caller allocated cursor
+ */
+void TreeMapReverseBegin(TreeMap* self, TreeMapCursor* cursor);
+
+/**
+ * @brief Initialize the cursor to walk through the key range [lo, hi) in
+ * descending order.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param lo            The inclusive lower bound of the range
+ * @param hi            The exclusive upper bound of the range
+ * @param cursor        The pointer to the caller allocated cursor
+ */
+void TreeMapReverseRange(TreeMap* self, void* lo, void* hi,
+                         TreeMapCursor* cursor);
+
+/**
+ * @brief Split the map into consecutive key ranges of similar sizes for
+ * parallel scans.
+ *
+ * This function initializes one ascending cursor per range. The ranges are
+ * disjoint and together cover the whole map, so each cursor can be handed to
+ * a different thread for a read-only scan. The range boundaries are located
+ * with the subtree counts in O(count * log n).
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param cursors       The array of the caller allocated cursors
+ * @param count         The number of the cursors
+ *
+ * @retval num          The number of the initialized cursors, which is less
+ *                      than count when the map has fewer pairs
+ */
+unsigned TreeMapPartition(TreeMap* self, TreeMapCursor* cursors,
+                          unsigned count);
+
+/**
+ * @brief Get the key value pair pointed by the cursor and advance the cursor.
+ *
+ * @param cursor        The pointer to the initialized cursor
+ *
+ * @retval ptr_pair     The pointer to the current key value pair
+ * @retval NULL         The range end is reached
+ */
+Pair* TreeMapCursorNext(TreeMapCursor* cursor);
+
+/**
+ * @brief Return the number of stored keys less than the given key.
+ *
+ * Each tree node records the size of its subtree, so the rank is computed in a
+ * single descent. The given key does not need to be stored in the map.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param key           The designated key
+ *
+ * @retval rank         The zero based order of the key
+ */
+unsigned TreeMapRank(TreeMap* self, void* key);
+
+/**
+ * @brief Retrieve the key value pair with the designated order.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param idx           The zero based order
+ *
+ * @retval ptr_pair     The pointer to the target key value pair
+ * @retval NULL         The order is out of range
+ */
+Pair* TreeMapSelect(TreeMap* self, unsigned idx);
+
+/**
+ * @brief Construct the map from the pairs sorted by key in linear time.
+ *
+ * This function builds a balanced and properly colored tree directly from the
+ * pair array without any comparison beyond the ascending order check. All the
+ * tree nodes are allocated in one contiguous block laid out in key order. The
+ * map can then be updated as usual, and the block is released when the map is
+ * destructed.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param pairs         The pair array sorted in strictly ascending key order
+ * @param size          The number of pairs
+ *
+ * @retval true         The map is successfully constructed
+ * @retval false        The map is not empty, the pairs are not strictly
+ *                      ascending, or the memory is insufficient
+ */
+bool TreeMapBuildSorted(TreeMap* self, Pair* pairs, unsigned size);
+
 /**
  * @brief Initialize the map iterator.
  *
@@ -265,6 +488,72 @@ Pair* TreeMapNext(TreeMap* self);
  */
 Pair* TreeMapReverseNext(TreeMap* self);
 
+/**
+ * @brief Move the pairs with keys not less than the given key to a new map.
+ *
+ * The tree is split by the red black join algorithm in O(log n) time without
+ * copying any node. The new map inherits the comparison, cleanup and arena
+ * settings, and the arena chunks are shared between the two maps.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param key           The designated key
+ *
+ * @retval obj          The new map holding the pairs with greater keys
+ * @retval NULL         Insufficient memory for map construction
+ */
+TreeMap* TreeMapSplit(TreeMap* self, void* key);
+
+/**
+ * @brief Move all the pairs of the map with greater keys into this map.
+ *
+ * All the keys in the other map should go after all the keys in this map. The
+ * two trees are joined in O(log n) time, and the other map becomes empty but
+ * still needs to be destructed by the caller.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param other         The pointer to the map with greater keys
+ *
+ * @retval true         The maps are successfully joined
+ * @retval false        The key ranges overlap or the memory is insufficient
+ */
+bool TreeMapJoin(TreeMap* self, TreeMap* other);
+
+/**
+ * @brief Move all the pairs of the other map into this map.
+ *
+ * The key ranges can be interleaved. The smaller tree is repeatedly split by
+ * the nodes of the larger one and joined back, which costs O(m log(n/m + 1))
+ * for map sizes m <= n. If a key is stored in both maps, the pair from the
+ * other map replaces the existing one, and the cleanup functions of this map
+ * are invoked for the replaced pair. The other map becomes empty but still
+ * needs to be destructed by the caller.
+ *
+ * Both maps should apply the same key order.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param other         The pointer to the other map
+ *
+ * @retval true         The maps are successfully merged
+ * @retval false        Insufficient memory
+ */
+bool TreeMapMerge(TreeMap* self, TreeMap* other);
+
+/**
+ * @brief Allocate the tree nodes from the arena chunks.
+ *
+ * When the arena is enabled, the tree nodes are carved from the chunks each
+ * holding the designated number of nodes, and the removed nodes are recycled
+ * for subsequent insertion. If no cleanup function is set and all the nodes
+ * come from the chunks, the destructor releases the chunks without visiting
+ * the tree nodes.
+ *
+ * By default, the arena is disabled and each node is individually allocated.
+ *
+ * @param self          The pointer to TreeMap structure
+ * @param chunk         The number of nodes per chunk or 0 to disable the arena
+ */
+void TreeMapSetArena(TreeMap* self, unsigned chunk);
+
 /**
  * @brief Set the custom key comparison function.
  *
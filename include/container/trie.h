@@ -36,6 +36,61 @@ extern "C" {
 /** TrieData is the data type for the container private information. */
 typedef struct TrieData_ TrieData;
 
+/** Value cleanup function called whenever a live string is removed. */
+typedef void (*TrieCleanValue) (void*);
+
+/** Visit a matched string with the user argument, and return false to stop.
+    The string lives in a buffer which is overwritten by the next match. */
+typedef bool (*TrieVisit) (const char*, void*);
+
+/** Visit a matched string with its score and the user argument, and return
+    false to stop. The string lives in a buffer which is overwritten by the
+    next match. */
+typedef bool (*TrieVisitScore) (const char*, unsigned, void*);
+
+/** Visit a matched string with its edit distance to the query and the user
+    argument, and return false to stop. The string lives in a buffer which is
+    overwritten by the next match. */
+typedef bool (*TrieVisitDistance) (const char*, unsigned, void*);
+
+/** The cursor to enumerate the strings matching a prefix.
+
+    The cursor is allocated by the caller and is initialized by TriePrefix. It
+    writes each match into the caller supplied buffer, so the enumeration
+    allocates nothing and can be suspended and resumed at will. It stays valid
+    until the next trie update. */
+typedef struct _TrieCursor {
+    /** The caller supplied buffer holding the current match */
+    char *buf_;
+
+    /** The trie node to be visited next */
+    void *node_;
+
+    /** The trie node ending the prefix where the walk stops */
+    void *stop_;
+
+    /** The buffer position of the token of the next node */
+    unsigned length_;
+
+    /** The traversal direction toward the next node */
+    char direct_;
+} TrieCursor;
+
+/** The memory usage of a trie. */
+typedef struct _TrieStats {
+    /** The number of stored strings */
+    unsigned size;
+
+    /** The number of trie nodes */
+    unsigned count_node;
+
+    /** The length of the longest string ever stored */
+    unsigned depth;
+
+    /** The bytes requested from the allocator for the trie and its nodes */
+    size_t bytes;
+} TrieStats;
+
 /** The implementation for trie. */
 typedef struct _Trie {
     /** The container private information. */
@@ -49,6 +104,10 @@ typedef struct _Trie {
         @see TrieBulkInsert */
     bool (*bulk_insert) (struct _Trie*, const char**, unsigned);
 
+    /** Sort an array of strings and build them into the trie.
+        @see TrieBulkBuild */
+    bool (*bulk_build) (struct _Trie*, const char**, unsigned, unsigned);
+
     /** Check if the trie contains the specified string.
         @see TrieHasExact */
     bool (*has_exact) (struct _Trie*, const char*);
@@ -61,6 +120,45 @@ typedef struct _Trie {
         @see TrieGetPrefixAs */
     bool (*get_prefix_as) (struct _Trie*, const char*, const char***, unsigned*);
 
+    /** Visit the strings matching the specified prefix in lexical order.
+        @see TrieForEachPrefix */
+    unsigned (*for_each_prefix) (struct _Trie*, const char*, unsigned, TrieVisit,
+                                 void*);
+
+    /** Initialize the cursor to enumerate the strings matching the prefix.
+        @see TriePrefix */
+    bool (*prefix) (struct _Trie*, const char*, char*, unsigned, TrieCursor*);
+
+    /** Update the score of a stored string.
+        @see TrieSetScore */
+    bool (*set_score) (struct _Trie*, const char*, unsigned);
+
+    /** Retrieve the score of a stored string.
+        @see TrieGetScore */
+    bool (*get_score) (struct _Trie*, const char*, unsigned*);
+
+    /** Visit the top scored strings matching the specified prefix.
+        @see TrieTopK */
+    unsigned (*top_k) (struct _Trie*, const char*, unsigned, TrieVisitScore,
+                       void*);
+
+    /** Visit the strings within the edit distance bound of the query.
+        @see TrieFuzzySearch */
+    unsigned (*fuzzy_search) (struct _Trie*, const char*, unsigned,
+                              TrieVisitDistance, void*);
+
+    /** Insert a string with its value into the trie.
+        @see TriePut */
+    bool (*put) (struct _Trie*, const char*, void*);
+
+    /** Retrieve the value of a stored string.
+        @see TrieGet */
+    void* (*get) (struct _Trie*, const char*);
+
+    /** Find the longest stored string which prefixes the specified string.
+        @see TrieLongestPrefixMatch */
+    unsigned (*longest_prefix_match) (struct _Trie*, const char*, void**);
+
     /** Remove a string from the trie.
         @see TrieRemove */
     bool (*remove) (struct _Trie*, const char*);
@@ -68,9 +166,109 @@ typedef struct _Trie {
     /** Return the number of strings stored in the trie.
         @see TrieSize */
     unsigned (*size) (struct _Trie*);
+
+    /** Compile the trie into a frozen image file.
+        @see TrieFreeze */
+    bool (*freeze) (struct _Trie*, const char*);
+
+    /** Set the custom value cleanup function.
+        @see TrieSetCleanValue */
+    void (*set_clean_value) (struct _Trie*, TrieCleanValue);
+
+    /** Allocate the trie nodes from the arena chunks.
+        @see TrieSetArena */
+    void (*set_arena) (struct _Trie*, unsigned);
+
+    /** Retrieve the memory usage of the trie.
+        @see TrieGetStats */
+    void (*get_stats) (struct _Trie*, TrieStats*);
 } Trie;
 
 
+/** FrozenTrieData is the data type for the frozen trie private information. */
+typedef struct FrozenTrieData_ FrozenTrieData;
+
+/** The read only trie mapped from the image file compiled by TrieFreeze. */
+typedef struct _FrozenTrie {
+    /** The frozen trie private information. */
+    FrozenTrieData *data;
+
+    /** Check if the frozen trie contains the specified string.
+        @see FrozenTrieHasExact */
+    bool (*has_exact) (struct _FrozenTrie*, const char*);
+
+    /** Check if the frozen trie contains the strings matching the prefix.
+        @see FrozenTrieHasPrefixAs */
+    bool (*has_prefix_as) (struct _FrozenTrie*, const char*);
+
+    /** Visit the strings matching the specified prefix in lexical order.
+        @see FrozenTrieForEachPrefix */
+    unsigned (*for_each_prefix) (struct _FrozenTrie*, const char*, unsigned,
+                                 TrieVisit, void*);
+
+    /** Return the number of strings stored in the frozen trie.
+        @see FrozenTrieSize */
+    unsigned (*size) (struct _FrozenTrie*);
+} FrozenTrie;
+
+
+/** DawgData is the data type for the word graph private information. */
+typedef struct DawgData_ DawgData;
+
+/** The read only minimized word graph compiled from a trie. */
+typedef struct _Dawg {
+    /** The word graph private information. */
+    DawgData *data;
+
+    /** Check if the word graph contains the specified string.
+        @see DawgHasExact */
+    bool (*has_exact) (struct _Dawg*, const char*);
+
+    /** Check if the word graph contains the strings matching the prefix.
+        @see DawgHasPrefixAs */
+    bool (*has_prefix_as) (struct _Dawg*, const char*);
+
+    /** Visit the strings matching the specified prefix in lexical order.
+        @see DawgForEachPrefix */
+    unsigned (*for_each_prefix) (struct _Dawg*, const char*, unsigned,
+                                 TrieVisit, void*);
+
+    /** Retrieve the lexical rank of the specified string.
+        @see DawgIndex */
+    bool (*index) (struct _Dawg*, const char*, unsigned*);
+
+    /** Return the number of strings stored in the word graph.
+        @see DawgSize */
+    unsigned (*size) (struct _Dawg*);
+
+    /** Write the word graph into an image file.
+        @see DawgSave */
+    bool (*save) (struct _Dawg*, const char*);
+} Dawg;
+
+/** TrieScannerData is the data type for the scanner private information. */
+typedef struct TrieScannerData_ TrieScannerData;
+
+/** The callback reporting a matched string, the stream offset just past its
+    end, and the user argument. Return false to stop the scan. */
+typedef bool (*TrieMatch) (const char*, size_t, void*);
+
+/** The Aho-Corasick automaton matching all the strings of a trie at once. */
+typedef struct _TrieScanner {
+    /** The scanner private information. */
+    TrieScannerData *data;
+
+    /** Report all the strings occurring in the next chunk of the stream.
+        @see TrieScannerScan */
+    unsigned (*scan) (struct _TrieScanner*, const char*, size_t, TrieMatch,
+                      void*);
+
+    /** Restart the stream.
+        @see TrieScannerReset */
+    void (*reset) (struct _TrieScanner*);
+} TrieScanner;
+
+
 /*===========================================================================*
  *             Definition for the exported member operations                 *
  *===========================================================================*/
@@ -112,6 +310,31 @@ bool TrieInsert(Trie* self, const char* str);
  */
 bool TrieBulkInsert(Trie* self, const char** strs, unsigned size);
 
+/**
+ * @brief Sort an array of strings and build them into the trie.
+ *
+ * The strings are sorted by a most significant digit radix sort, whose
+ * ranges are shared among the specified number of threads. If the trie is
+ * empty, the nodes are then built in a single pass over the sorted strings and
+ * are carved from one block in depth first order, so that a lookup touches
+ * nearby memory. Each sibling tree is balanced by the number of strings below
+ * its nodes. Otherwise, the distinct strings are merged into the existing
+ * ones by single insertions in median first order, which keeps the new sibling
+ * trees balanced but leaves the nodes individually allocated, or carved from
+ * the arena if it is enabled.
+ *
+ * @param self          The pointer to Trie structure
+ * @param strs          Array of to be inserted strings
+ * @param size          The array size
+ * @param num_thread    The number of sorting threads, where 0 and 1 sort with
+ *                      the calling thread only
+ *
+ * @retval true         The strings are successfully inserted
+ * @retval false        The strings cannot be inserted due to insufficient memory
+ */
+bool TrieBulkBuild(Trie* self, const char** strs, unsigned size,
+                   unsigned num_thread);
+
 /**
  * @brief Check if the trie contains the specified string.
  *
@@ -150,9 +373,182 @@ bool TrieHasPrefixAs(Trie* self, const char* prefix);
  */
 bool TrieGetPrefixAs(Trie* self, const char* prefix, const char*** p_strs, unsigned* p_size);
 
+/**
+ * @brief Visit the strings matching the specified prefix in lexical order.
+ *
+ * Unlike TrieGetPrefixAs, the matches are streamed through a single buffer
+ * allocated once per call, so no string is duplicated. The visitor receives
+ * the matched string and the user argument, and can stop the traversal by
+ * returning false. The trie should not be modified during the traversal.
+ *
+ * @param self          The pointer to Trie structure
+ * @param prefix        The specified prefix
+ * @param limit         The maximum number of strings to visit, or 0 to visit
+ *                      all the matches
+ * @param func          The visitor function
+ * @param arg           The user argument passed to the visitor
+ *
+ * @retval count        The number of visited strings, which is 0 if no string
+ *                      matches the prefix or the buffer cannot be allocated
+ */
+unsigned TrieForEachPrefix(Trie* self, const char* prefix, unsigned limit,
+                           TrieVisit func, void* arg);
+
+/**
+ * @brief Initialize the cursor to enumerate the strings matching the
+ * specified prefix in lexical order.
+ *
+ * The prefix is located with a single descent. Unless the prefix itself is a
+ * stored string, the subtree is then checked like TrieHasPrefixAs, since the
+ * removed strings leave their nodes behind. Each TrieCursorNext call resumes
+ * the walk from where the previous one stopped and writes the next match into
+ * the buffer. Since the buffer must hold any stored string, its size should
+ * exceed the length of the longest string ever inserted.
+ *
+ * @param self          The pointer to Trie structure
+ * @param prefix        The specified prefix
+ * @param buf           The caller supplied buffer for the matches
+ * @param size          The buffer size
+ * @param cursor        The pointer to the caller allocated cursor
+ *
+ * @retval true         The cursor is initialized
+ * @retval false        No such prefix or the buffer is too small, and the
+ *                      cursor yields nothing
+ */
+bool TriePrefix(Trie* self, const char* prefix, char* buf, unsigned size,
+                TrieCursor* cursor);
+
+/**
+ * @brief Write the next matched string into the cursor buffer.
+ *
+ * @param cursor        The pointer to the initialized cursor
+ *
+ * @retval str          The cursor buffer holding the next match
+ * @retval NULL         No more matches
+ */
+const char* TrieCursorNext(TrieCursor* cursor);
+
+/**
+ * @brief Update the score of a stored string.
+ *
+ * A string is inserted with score 0, and its score is dropped when the string
+ * is removed. Each node keeps the maximum score below it, which is refreshed
+ * along the path to the root.
+ *
+ * @param self          The pointer to Trie structure
+ * @param str           The specified string
+ * @param score         The new score
+ *
+ * @retval true         The score is successfully updated
+ * @retval false        No such string
+ */
+bool TrieSetScore(Trie* self, const char* str, unsigned score);
+
+/**
+ * @brief Retrieve the score of a stored string.
+ *
+ * @param self          The pointer to Trie structure
+ * @param str           The specified string
+ * @param p_score       The pointer to the returned score
+ *
+ * @retval true         The score is successfully retrieved
+ * @retval false        No such string
+ */
+bool TrieGetScore(Trie* self, const char* str, unsigned* p_score);
+
+/**
+ * @brief Visit the k top scored strings matching the specified prefix in
+ * descending score order.
+ *
+ * The search is best first. It expands the subtrees in the order of their
+ * maximum scores and emits a string once no unexpanded subtree can beat it.
+ * So the work is bounded by k and the trie depth rather than by the number of
+ * matches. The order of the strings with equal scores is unspecified.
+ *
+ * @param self          The pointer to Trie structure
+ * @param prefix        The specified prefix
+ * @param k             The maximum number of strings to visit
+ * @param func          The visitor function
+ * @param arg           The user argument passed to the visitor
+ *
+ * @retval count        The number of visited strings, which is 0 if no string
+ *                      matches the prefix or the search space cannot be
+ *                      allocated
+ */
+unsigned TrieTopK(Trie* self, const char* prefix, unsigned k,
+                  TrieVisitScore func, void* arg);
+
+/**
+ * @brief Visit the strings whose Levenshtein distance to the query is within
+ * the given bound in lexical order.
+ *
+ * The search walks the trie depth first and keeps one row of the edit
+ * distance table per trie level, so the strings sharing a prefix share the
+ * rows of that prefix. A subtree is pruned as soon as every entry of its row
+ * exceeds the bound, which confines the walk to the neighborhood of the query.
+ *
+ * @param self          The pointer to Trie structure
+ * @param query         The query string
+ * @param max_edits     The maximum number of insertions, deletions, and
+ *                      substitutions
+ * @param func          The visitor function
+ * @param arg           The user argument passed to the visitor
+ *
+ * @retval count        The number of visited strings, which is 0 if no string
+ *                      is close enough or the rows cannot be allocated
+ */
+unsigned TrieFuzzySearch(Trie* self, const char* query, unsigned max_edits,
+                         TrieVisitDistance func, void* arg);
+
+/**
+ * @brief Insert a string with its value into the trie.
+ *
+ * If the string is already stored, its value will be replaced, and the
+ * cleanup function is invoked for the replaced value. The strings inserted by
+ * TrieInsert carry the NULL value.
+ *
+ * @param self          The pointer to Trie structure
+ * @param str           The specified string
+ * @param value         The specified value
+ *
+ * @retval true         The string is successfully inserted
+ * @retval false        The string is empty or cannot be inserted due to
+ *                      insufficient memory
+ */
+bool TriePut(Trie* self, const char* str, void* value);
+
+/**
+ * @brief Retrieve the value of a stored string.
+ *
+ * @param self          The pointer to Trie structure
+ * @param str           The specified string
+ *
+ * @retval value        The corresponding value
+ * @retval NULL         The string cannot be found
+ */
+void* TrieGet(Trie* self, const char* str);
+
+/**
+ * @brief Find the longest stored string which is a prefix of the specified
+ * string.
+ *
+ * The match is found by a single descent along the specified string.
+ *
+ * @param self          The pointer to Trie structure
+ * @param str           The specified string
+ * @param p_value       The pointer to the returned value of the matched string,
+ *                      which is untouched if nothing matches and can be NULL
+ *
+ * @retval length       The length of the matched string
+ * @retval 0            No stored string prefixes the specified string
+ */
+unsigned TrieLongestPrefixMatch(Trie* self, const char* str, void** p_value);
+
 /**
  * @brief Remove a string from the trie.
  *
+ * The cleanup function is invoked for the value of the removed string.
+ *
  * @param self          The pointer to Trie structure
  * @param str           The specified string
  *
@@ -170,6 +566,292 @@ bool TrieRemove(Trie* self, const char* str);
  */
 unsigned TrieSize(Trie* self);
 
+/**
+ * @brief Set the custom value cleanup function.
+ *
+ * By default, no cleanup operation for value. The function is invoked for the
+ * non NULL values only.
+ *
+ * @param self          The pointer to Trie structure
+ * @param func          The custom function
+ */
+void TrieSetCleanValue(Trie* self, TrieCleanValue func);
+
+/**
+ * @brief Allocate the trie nodes from the arena chunks.
+ *
+ * When the arena is enabled, the trie nodes are carved from the chunks each
+ * holding the designated number of nodes, which saves the allocator header of
+ * each node. The removal of strings never releases the nodes, so if no value
+ * cleanup function is set and all the nodes come from the chunks or the bulk
+ * build, the destructor releases the chunks without visiting the trie nodes.
+ *
+ * By default, the arena is disabled and each node is individually allocated.
+ *
+ * @param self          The pointer to Trie structure
+ * @param chunk         The number of nodes per chunk or 0 to disable the arena
+ */
+void TrieSetArena(Trie* self, unsigned chunk);
+
+/**
+ * @brief Retrieve the memory usage of the trie.
+ *
+ * @param self          The pointer to Trie structure
+ * @param stats         The pointer to the returned statistics
+ */
+void TrieGetStats(Trie* self, TrieStats* stats);
+
+/**
+ * @brief Compile the trie into a double array image and write it to the file.
+ *
+ * The image is a header followed by an array of (base, check) pairs. The child
+ * of state s labeled by byte c is state base[s] + c if its check is s, and the
+ * label 0 marks the end of a stored string. It is stored in the host byte
+ * order so that FrozenTrieOpen can map it without any decoding, and several
+ * processes opening the same file share its page cache.
+ *
+ * @param self          The pointer to Trie structure
+ * @param path          The path of the image file
+ *
+ * @retval true         The image is successfully written
+ * @retval false        Insufficient memory or the file cannot be written
+ */
+bool TrieFreeze(Trie* self, const char* path);
+
+/**
+ * @brief Map the image file compiled by TrieFreeze as a read only trie.
+ *
+ * @param path          The path of the image file
+ *
+ * @retval obj          The successfully mapped frozen trie
+ * @retval NULL         The file cannot be mapped, is not a valid image, or
+ *                      was written with a different byte order
+ */
+FrozenTrie* FrozenTrieOpen(const char* path);
+
+/**
+ * @brief Unmap the image file and release the frozen trie.
+ *
+ * @param obj           The pointer to the to be released frozen trie
+ */
+void FrozenTrieClose(FrozenTrie* obj);
+
+/**
+ * @brief Check if the frozen trie contains the specified string.
+ *
+ * @param self          The pointer to FrozenTrie structure
+ * @param str           The specified string
+ *
+ * @retval true         The frozen trie contains the given string
+ * @retval false        No such string
+ */
+bool FrozenTrieHasExact(FrozenTrie* self, const char* str);
+
+/**
+ * @brief Check if the frozen trie contains the strings matching the specified
+ * prefix.
+ *
+ * @param self          The pointer to FrozenTrie structure
+ * @param prefix        The specified prefix
+ *
+ * @retval true         The frozen trie contains the given prefix
+ * @retval false        No such prefix
+ */
+bool FrozenTrieHasPrefixAs(FrozenTrie* self, const char* prefix);
+
+/**
+ * @brief Visit the strings matching the specified prefix in lexical order.
+ *
+ * @param self          The pointer to FrozenTrie structure
+ * @param prefix        The specified prefix
+ * @param limit         The maximum number of strings to visit, or 0 to visit
+ *                      all the matches
+ * @param func          The visitor function
+ * @param arg           The user argument passed to the visitor
+ *
+ * @retval count        The number of visited strings
+ *
+ * @see TrieForEachPrefix
+ */
+unsigned FrozenTrieForEachPrefix(FrozenTrie* self, const char* prefix,
+                                 unsigned limit, TrieVisit func, void* arg);
+
+/**
+ * @brief Return the number of strings stored in the frozen trie.
+ *
+ * @param self          The pointer to FrozenTrie structure
+ *
+ * @retval size         The number of stored strings
+ */
+unsigned FrozenTrieSize(FrozenTrie* self);
+
+/**
+ * @brief Compile the strings of the trie into a minimized word graph.
+ *
+ * The trie shares the common prefixes only. The word graph also merges every
+ * pair of states accepting the same set of suffixes, so the strings sharing
+ * their endings, like the inflected words or the domain names, share the arcs
+ * as well. The graph is built incrementally over the sorted strings, and each
+ * state is merged as soon as no later string can change it. The arcs are
+ * numbered so that DawgIndex maps each string to its lexical rank, which lets
+ * the caller keep the string values in a plain array.
+ *
+ * @param trie          The pointer to the source Trie structure
+ *
+ * @retval obj          The successfully compiled word graph
+ * @retval NULL         Insufficient memory for word graph construction
+ */
+Dawg* DawgInit(Trie* trie);
+
+/**
+ * @brief Map the image file written by DawgSave as a read only word graph.
+ *
+ * @param path          The path of the image file
+ *
+ * @retval obj          The successfully mapped word graph
+ * @retval NULL         The file cannot be mapped, is not a valid image, or
+ *                      was written with a different byte order
+ */
+Dawg* DawgOpen(const char* path);
+
+/**
+ * @brief The destructor for Dawg, which unmaps the image file if the word
+ * graph is opened by DawgOpen.
+ *
+ * @param obj           The pointer to the to be destructed word graph
+ */
+void DawgDeinit(Dawg* obj);
+
+/**
+ * @brief Write the word graph into an image file.
+ *
+ * The image is a header followed by the array of arcs in the host byte order,
+ * so that DawgOpen can map it without any decoding.
+ *
+ * @param self          The pointer to Dawg structure
+ * @param path          The path of the image file
+ *
+ * @retval true         The image is successfully written
+ * @retval false        The file cannot be written
+ */
+bool DawgSave(Dawg* self, const char* path);
+
+/**
+ * @brief Check if the word graph contains the specified string.
+ *
+ * @param self          The pointer to Dawg structure
+ * @param str           The specified string
+ *
+ * @retval true         The word graph contains the given string
+ * @retval false        No such string
+ */
+bool DawgHasExact(Dawg* self, const char* str);
+
+/**
+ * @brief Check if the word graph contains the strings matching the specified
+ * prefix.
+ *
+ * @param self          The pointer to Dawg structure
+ * @param prefix        The specified prefix
+ *
+ * @retval true         The word graph contains the given prefix
+ * @retval false        No such prefix
+ */
+bool DawgHasPrefixAs(Dawg* self, const char* prefix);
+
+/**
+ * @brief Visit the strings matching the specified prefix in lexical order.
+ *
+ * @param self          The pointer to Dawg structure
+ * @param prefix        The specified prefix
+ * @param limit         The maximum number of strings to visit, or 0 to visit
+ *                      all the matches
+ * @param func          The visitor function
+ * @param arg           The user argument passed to the visitor
+ *
+ * @retval count        The number of visited strings
+ *
+ * @see FrozenTrieForEachPrefix
+ */
+unsigned DawgForEachPrefix(Dawg* self, const char* prefix, unsigned limit,
+                           TrieVisit func, void* arg);
+
+/**
+ * @brief Retrieve the lexical rank of the specified string.
+ *
+ * The ranks of the stored strings are distinct and range from 0 to the size
+ * minus 1 in unsigned byte order, so the word graph works as a minimal
+ * perfect hash of the strings.
+ *
+ * @param self          The pointer to Dawg structure
+ * @param str           The specified string
+ * @param p_index       The pointer to the returned rank
+ *
+ * @retval true         The rank is successfully retrieved
+ * @retval false        No such string
+ */
+bool DawgIndex(Dawg* self, const char* str, unsigned* p_index);
+
+/**
+ * @brief Return the number of strings stored in the word graph.
+ *
+ * @param self          The pointer to Dawg structure
+ *
+ * @retval size         The number of stored strings
+ */
+unsigned DawgSize(Dawg* self);
+
+/**
+ * @brief Compile the strings of the trie into an Aho-Corasick automaton.
+ *
+ * The automaton is a snapshot, so later updates to the trie are not seen by
+ * the scanner.
+ *
+ * @param trie          The pointer to the source Trie structure
+ *
+ * @retval obj          The successfully constructed scanner
+ * @retval NULL         Insufficient memory for scanner construction
+ */
+TrieScanner* TrieScannerInit(Trie* trie);
+
+/**
+ * @brief The destructor for TrieScanner.
+ *
+ * @param obj           The pointer to the to be destructed scanner
+ */
+void TrieScannerDeinit(TrieScanner* obj);
+
+/**
+ * @brief Report all the strings occurring in the next chunk of the stream.
+ *
+ * The text is scanned in a single pass no matter how many strings the trie
+ * holds. The scanner keeps its state between the calls, so a string spanning
+ * the boundary of two chunks is reported by the call consuming its last byte,
+ * and the reported offsets count from the start of the stream. The strings
+ * ending at the same offset are reported from the longest to the shortest.
+ * The null byte never occurs in a stored string and simply breaks the match.
+ *
+ * @param self          The pointer to TrieScanner structure
+ * @param text          The chunk of the stream
+ * @param len           The length of the chunk in bytes
+ * @param func          The callback receiving the matches
+ * @param arg           The user argument passed to the callback
+ *
+ * @retval count        The number of reported matches
+ *
+ * @note If the callback returns false, the rest of the chunk is skipped and
+ * the stream resumes right after the byte that ends the stopping match.
+ */
+unsigned TrieScannerScan(TrieScanner* self, const char* text, size_t len,
+                         TrieMatch func, void* arg);
+
+/**
+ * @brief Restart the stream so that the next chunk starts at offset 0.
+ *
+ * @param self          The pointer to TrieScanner structure
+ */
+void TrieScannerReset(TrieScanner* self);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,793 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+
+
+
+#include "container/btree_map.h"
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+/* The node capacities are chosen so that each node occupies about 512 bytes,
+   which is eight cache lines on most platforms. */
+#define LEAF_CAP        30
+#define INNER_CAP       31
+#define MAX_HEIGHT      32
+
+static const unsigned LEAF_MIN = LEAF_CAP / 2;
+static const unsigned INNER_MIN = INNER_CAP / 2;
+
+static const char ITER_STOP = 0;
+static const char ITER_BEGIN = 1;
+static const char ITER_FORWARD = 2;
+static const char ITER_BACKWARD = 3;
+
+
+/** The leaf node storing the sorted pairs. The leaves are doubly linked. */
+typedef struct _LeafNode {
+    unsigned count_;
+    struct _LeafNode* prev_;
+    struct _LeafNode* next_;
+    Pair pairs_[LEAF_CAP];
+} LeafNode;
+
+/** The internal node storing the separator keys. Each separator refers to the
+    minimum key stored in the subtree to its right. */
+typedef struct _InnerNode {
+    unsigned count_;
+    void* keys_[INNER_CAP];
+    void* child_[INNER_CAP + 1];
+} InnerNode;
+
+/** The root to leaf path recorded during descent. */
+typedef struct _Path {
+    unsigned depth_;
+    InnerNode* node_[MAX_HEIGHT];
+    unsigned idx_[MAX_HEIGHT];
+} Path;
+
+struct _BTreeMapData {
+    char iter_direct_;
+    unsigned size_;
+    unsigned height_;
+    unsigned iter_pos_;
+    void* root_;
+    LeafNode* head_;
+    LeafNode* tail_;
+    LeafNode* iter_leaf_;
+    BTreeMapCompare func_cmp_;
+    BTreeMapCleanKey func_clean_key_;
+    BTreeMapCleanValue func_clean_val_;
+};
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * @brief Traverse all the tree nodes and clean the allocated resource.
+ *
+ * @param data          The pointer to the map private data
+ * @param node          The pointer to the root of the subtree
+ * @param height        The height of the subtree
+ */
+void _BTreeMapDeinit(BTreeMapData* data, void* node, unsigned height);
+
+/**
+ * @brief Descend from the root to the leaf which should contain the designated
+ * key.
+ *
+ * @param data          The pointer to the map private data
+ * @param key           The designated key
+ * @param path          The pointer to the returned path, which can be NULL if
+ *                      not interested
+ *
+ * @retval leaf         The target leaf
+ */
+LeafNode* _BTreeMapDescend(BTreeMapData* data, void* key, Path* path);
+
+/**
+ * @brief Insert the pair into the full leaf and split the nodes bottom up.
+ *
+ * @param data          The pointer to the map private data
+ * @param path          The pointer to the path leading to the leaf
+ * @param leaf          The pointer to the full leaf
+ * @param pos           The insert position
+ * @param key           The designated key
+ * @param value         The designated value
+ *
+ * @retval true         The pair is successfully inserted
+ * @retval false        Insufficient memory for node splitting
+ */
+bool _BTreeMapSplitInsert(BTreeMapData* data, Path* path, LeafNode* leaf,
+                          unsigned pos, void* key, void* value);
+
+/**
+ * @brief Restore the minimum occupancy of the underflowed leaf and its
+ * ancestors by borrowing from or merging with the siblings.
+ *
+ * @param data          The pointer to the map private data
+ * @param path          The pointer to the path leading to the leaf
+ * @param leaf          The pointer to the underflowed leaf
+ */
+void _BTreeMapRebalance(BTreeMapData* data, Path* path, LeafNode* leaf);
+
+/**
+ * @brief The default key comparison function.
+ *
+ * @param lhs           The source key
+ * @param rhs           The target key
+ *
+ * @retval  1           The source key should go after the target one.
+ * @retval  0           The source key is equal to the target one.
+ * @retval -1           The source key should go before the target one.
+ */
+int _BTreeMapCompare(void* lhs, void* rhs);
+
+/**
+ * @brief Return the child index to descend for the designated key, which is
+ * the number of separators not greater than the key.
+ */
+static inline
+unsigned INNER_INDEX(InnerNode* node, void* key, BTreeMapCompare func_cmp)
+{
+    unsigned bgn = 0;
+    unsigned end = node->count_;
+    while (bgn < end) {
+        unsigned mid = (bgn + end) >> 1;
+        if (func_cmp(key, node->keys_[mid]) >= 0)
+            bgn = mid + 1;
+        else
+            end = mid;
+    }
+    return bgn;
+}
+
+/**
+ * @brief Return the position of the first pair not less than the designated key.
+ */
+static inline
+unsigned LEAF_INDEX(LeafNode* leaf, void* key, BTreeMapCompare func_cmp,
+                    bool* p_found)
+{
+    unsigned bgn = 0;
+    unsigned end = leaf->count_;
+    while (bgn < end) {
+        unsigned mid = (bgn + end) >> 1;
+        if (func_cmp(leaf->pairs_[mid].key, key) < 0)
+            bgn = mid + 1;
+        else
+            end = mid;
+    }
+    *p_found = (bgn < leaf->count_ && func_cmp(leaf->pairs_[bgn].key, key) == 0);
+    return bgn;
+}
+
+/**
+ * @brief Refresh the separator referring to the minimum key of the leaf, which
+ * lives in the deepest ancestor entered through a non-leftmost child.
+ */
+static inline
+void FIX_SEPARATOR(Path* path, LeafNode* leaf)
+{
+    unsigned level = path->depth_;
+    while (level > 0) {
+        --level;
+        unsigned idx = path->idx_[level];
+        if (idx > 0) {
+            path->node_[level]->keys_[idx - 1] = leaf->pairs_[0].key;
+            return;
+        }
+    }
+}
+
+static inline
+void CLEAN_PAIR(BTreeMapData* data, Pair* pair)
+{
+    if (data->func_clean_key_)
+        data->func_clean_key_(pair->key);
+    if (data->func_clean_val_)
+        data->func_clean_val_(pair->value);
+}
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+BTreeMap* BTreeMapInit()
+{
+    BTreeMap* obj = (BTreeMap*)malloc(sizeof(BTreeMap));
+    if (unlikely(!obj))
+        return NULL;
+
+    BTreeMapData* data = (BTreeMapData*)malloc(sizeof(BTreeMapData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    /* The root starts as an empty leaf. */
+    LeafNode* leaf = (LeafNode*)malloc(sizeof(LeafNode));
+    if (unlikely(!leaf)) {
+        free(data);
+        free(obj);
+        return NULL;
+    }
+    leaf->count_ = 0;
+    leaf->prev_ = NULL;
+    leaf->next_ = NULL;
+
+    data->iter_direct_ = ITER_STOP;
+    data->size_ = 0;
+    data->height_ = 0;
+    data->iter_pos_ = 0;
+    data->root_ = leaf;
+    data->head_ = leaf;
+    data->tail_ = leaf;
+    data->iter_leaf_ = NULL;
+    data->func_cmp_ = _BTreeMapCompare;
+    data->func_clean_key_ = NULL;
+    data->func_clean_val_ = NULL;
+
+    obj->data = data;
+    obj->put = BTreeMapPut;
+    obj->get = BTreeMapGet;
+    obj->find = BTreeMapFind;
+    obj->remove = BTreeMapRemove;
+    obj->size = BTreeMapSize;
+    obj->minimum = BTreeMapMinimum;
+    obj->maximum = BTreeMapMaximum;
+    obj->predecessor = BTreeMapPredecessor;
+    obj->successor = BTreeMapSuccessor;
+    obj->first = BTreeMapFirst;
+    obj->next = BTreeMapNext;
+    obj->reverse_next = BTreeMapReverseNext;
+    obj->set_compare = BTreeMapSetCompare;
+    obj->set_clean_key = BTreeMapSetCleanKey;
+    obj->set_clean_value = BTreeMapSetCleanValue;
+
+    return obj;
+}
+
+void BTreeMapDeinit(BTreeMap* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    BTreeMapData* data = obj->data;
+    _BTreeMapDeinit(data, data->root_, data->height_);
+    free(data);
+    free(obj);
+    return;
+}
+
+bool BTreeMapPut(BTreeMap* self, void* key, void* value)
+{
+    BTreeMapData* data = self->data;
+    Path path;
+    LeafNode* leaf = _BTreeMapDescend(data, key, &path);
+
+    bool found;
+    unsigned pos = LEAF_INDEX(leaf, key, data->func_cmp_, &found);
+
+    /* Conflict with the already stored key value pair. */
+    if (found) {
+        Pair* pair = &(leaf->pairs_[pos]);
+        CLEAN_PAIR(data, pair);
+        pair->key = key;
+        pair->value = value;
+        if (pos == 0)
+            FIX_SEPARATOR(&path, leaf);
+        return true;
+    }
+
+    if (leaf->count_ == LEAF_CAP) {
+        if (!_BTreeMapSplitInsert(data, &path, leaf, pos, key, value))
+            return false;
+        ++(data->size_);
+        return true;
+    }
+
+    memmove(&(leaf->pairs_[pos + 1]), &(leaf->pairs_[pos]),
+            sizeof(Pair) * (leaf->count_ - pos));
+    leaf->pairs_[pos].key = key;
+    leaf->pairs_[pos].value = value;
+    ++(leaf->count_);
+    if (pos == 0)
+        FIX_SEPARATOR(&path, leaf);
+
+    ++(data->size_);
+    return true;
+}
+
+void* BTreeMapGet(BTreeMap* self, void* key)
+{
+    BTreeMapData* data = self->data;
+    LeafNode* leaf = _BTreeMapDescend(data, key, NULL);
+
+    bool found;
+    unsigned pos = LEAF_INDEX(leaf, key, data->func_cmp_, &found);
+    return (found)? leaf->pairs_[pos].value : NULL;
+}
+
+bool BTreeMapFind(BTreeMap* self, void* key)
+{
+    BTreeMapData* data = self->data;
+    LeafNode* leaf = _BTreeMapDescend(data, key, NULL);
+
+    bool found;
+    LEAF_INDEX(leaf, key, data->func_cmp_, &found);
+    return found;
+}
+
+bool BTreeMapRemove(BTreeMap* self, void* key)
+{
+    BTreeMapData* data = self->data;
+    Path path;
+    LeafNode* leaf = _BTreeMapDescend(data, key, &path);
+
+    bool found;
+    unsigned pos = LEAF_INDEX(leaf, key, data->func_cmp_, &found);
+    if (!found)
+        return false;
+
+    Pair pair = leaf->pairs_[pos];
+    --(leaf->count_);
+    memmove(&(leaf->pairs_[pos]), &(leaf->pairs_[pos + 1]),
+            sizeof(Pair) * (leaf->count_ - pos));
+    --(data->size_);
+
+    /* The non-root leaf never becomes empty here, so its new minimum key can
+       take over the separator before the removed key is cleaned. */
+    if (path.depth_ > 0) {
+        if (pos == 0)
+            FIX_SEPARATOR(&path, leaf);
+        if (leaf->count_ < LEAF_MIN)
+            _BTreeMapRebalance(data, &path, leaf);
+    }
+
+    CLEAN_PAIR(data, &pair);
+    return true;
+}
+
+unsigned BTreeMapSize(BTreeMap* self)
+{
+    return self->data->size_;
+}
+
+Pair* BTreeMapMinimum(BTreeMap* self)
+{
+    LeafNode* head = self->data->head_;
+    return (head->count_ > 0)? &(head->pairs_[0]) : NULL;
+}
+
+Pair* BTreeMapMaximum(BTreeMap* self)
+{
+    LeafNode* tail = self->data->tail_;
+    return (tail->count_ > 0)? &(tail->pairs_[tail->count_ - 1]) : NULL;
+}
+
+Pair* BTreeMapPredecessor(BTreeMap* self, void* key)
+{
+    BTreeMapData* data = self->data;
+    LeafNode* leaf = _BTreeMapDescend(data, key, NULL);
+
+    bool found;
+    unsigned pos = LEAF_INDEX(leaf, key, data->func_cmp_, &found);
+    if (!found)
+        return NULL;
+
+    if (pos > 0)
+        return &(leaf->pairs_[pos - 1]);
+    leaf = leaf->prev_;
+    return (leaf)? &(leaf->pairs_[leaf->count_ - 1]) : NULL;
+}
+
+Pair* BTreeMapSuccessor(BTreeMap* self, void* key)
+{
+    BTreeMapData* data = self->data;
+    LeafNode* leaf = _BTreeMapDescend(data, key, NULL);
+
+    bool found;
+    unsigned pos = LEAF_INDEX(leaf, key, data->func_cmp_, &found);
+    if (!found)
+        return NULL;
+
+    if (pos + 1 < leaf->count_)
+        return &(leaf->pairs_[pos + 1]);
+    leaf = leaf->next_;
+    return (leaf)? &(leaf->pairs_[0]) : NULL;
+}
+
+void BTreeMapFirst(BTreeMap* self)
+{
+    self->data->iter_direct_ = ITER_BEGIN;
+    self->data->iter_leaf_ = NULL;
+    self->data->iter_pos_ = 0;
+}
+
+Pair* BTreeMapNext(BTreeMap* self)
+{
+    BTreeMapData* data = self->data;
+    if (data->iter_direct_ == ITER_BEGIN) {
+        data->iter_direct_ = ITER_FORWARD;
+        data->iter_leaf_ = data->head_;
+        data->iter_pos_ = 0;
+    }
+
+    LeafNode* leaf = data->iter_leaf_;
+    unsigned pos = data->iter_pos_;
+    while (leaf && pos >= leaf->count_) {
+        leaf = leaf->next_;
+        pos = 0;
+    }
+
+    data->iter_leaf_ = leaf;
+    if (!leaf)
+        return NULL;
+
+    data->iter_pos_ = pos + 1;
+    return &(leaf->pairs_[pos]);
+}
+
+Pair* BTreeMapReverseNext(BTreeMap* self)
+{
+    BTreeMapData* data = self->data;
+    if (data->iter_direct_ == ITER_BEGIN) {
+        data->iter_direct_ = ITER_BACKWARD;
+        data->iter_leaf_ = data->tail_;
+        data->iter_pos_ = data->tail_->count_;
+    }
+
+    LeafNode* leaf = data->iter_leaf_;
+    unsigned pos = data->iter_pos_;
+    while (leaf && pos == 0) {
+        leaf = leaf->prev_;
+        pos = (leaf)? leaf->count_ : 0;
+    }
+
+    data->iter_leaf_ = leaf;
+    if (!leaf)
+        return NULL;
+
+    data->iter_pos_ = pos - 1;
+    return &(leaf->pairs_[pos - 1]);
+}
+
+void BTreeMapSetCompare(BTreeMap* self, BTreeMapCompare func)
+{
+    self->data->func_cmp_ = func;
+}
+
+void BTreeMapSetCleanKey(BTreeMap* self, BTreeMapCleanKey func)
+{
+    self->data->func_clean_key_ = func;
+}
+
+void BTreeMapSetCleanValue(BTreeMap* self, BTreeMapCleanValue func)
+{
+    self->data->func_clean_val_ = func;
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+void _BTreeMapDeinit(BTreeMapData* data, void* node, unsigned height)
+{
+    if (height == 0) {
+        LeafNode* leaf = (LeafNode*)node;
+        if (data->func_clean_key_ || data->func_clean_val_) {
+            unsigned i;
+            for (i = 0 ; i < leaf->count_ ; ++i)
+                CLEAN_PAIR(data, &(leaf->pairs_[i]));
+        }
+        free(leaf);
+        return;
+    }
+
+    InnerNode* inner = (InnerNode*)node;
+    unsigned i;
+    for (i = 0 ; i <= inner->count_ ; ++i)
+        _BTreeMapDeinit(data, inner->child_[i], height - 1);
+    free(inner);
+    return;
+}
+
+LeafNode* _BTreeMapDescend(BTreeMapData* data, void* key, Path* path)
+{
+    BTreeMapCompare func_cmp = data->func_cmp_;
+    void* node = data->root_;
+    unsigned level;
+    for (level = 0 ; level < data->height_ ; ++level) {
+        InnerNode* inner = (InnerNode*)node;
+        unsigned idx = INNER_INDEX(inner, key, func_cmp);
+        if (path) {
+            path->node_[level] = inner;
+            path->idx_[level] = idx;
+        }
+        node = inner->child_[idx];
+    }
+
+    if (path)
+        path->depth_ = data->height_;
+    return (LeafNode*)node;
+}
+
+bool _BTreeMapSplitInsert(BTreeMapData* data, Path* path, LeafNode* leaf,
+                          unsigned pos, void* key, void* value)
+{
+    /* Allocate all the required nodes in advance so that the tree is left
+       untouched on allocation failure. The split propagates upward through the
+       consecutive full ancestors, and it creates a new root if all are full. */
+    unsigned num_inner = 0;
+    unsigned level = path->depth_;
+    while (level > 0 && path->node_[level - 1]->count_ == INNER_CAP) {
+        ++num_inner;
+        --level;
+    }
+    if (level == 0)
+        ++num_inner;
+    if (unlikely(data->height_ + 1 >= MAX_HEIGHT && level == 0))
+        return false;
+
+    LeafNode* right = (LeafNode*)malloc(sizeof(LeafNode));
+    if (unlikely(!right))
+        return false;
+    InnerNode* spare[MAX_HEIGHT];
+    unsigned i;
+    for (i = 0 ; i < num_inner ; ++i) {
+        spare[i] = (InnerNode*)malloc(sizeof(InnerNode));
+        if (unlikely(!spare[i])) {
+            while (i > 0)
+                free(spare[--i]);
+            free(right);
+            return false;
+        }
+    }
+
+    /* Split the leaf and insert the pair into the proper half. */
+    unsigned half = (LEAF_CAP + 1) >> 1;
+    LeafNode* tge;
+    if (pos < half) {
+        right->count_ = LEAF_CAP - (half - 1);
+        memcpy(right->pairs_, &(leaf->pairs_[half - 1]), sizeof(Pair) * right->count_);
+        leaf->count_ = half - 1;
+        tge = leaf;
+    } else {
+        right->count_ = LEAF_CAP - half;
+        memcpy(right->pairs_, &(leaf->pairs_[half]), sizeof(Pair) * right->count_);
+        leaf->count_ = half;
+        pos -= half;
+        tge = right;
+    }
+    memmove(&(tge->pairs_[pos + 1]), &(tge->pairs_[pos]),
+            sizeof(Pair) * (tge->count_ - pos));
+    tge->pairs_[pos].key = key;
+    tge->pairs_[pos].value = value;
+    ++(tge->count_);
+    if (tge == leaf && pos == 0)
+        FIX_SEPARATOR(path, leaf);
+
+    right->prev_ = leaf;
+    right->next_ = leaf->next_;
+    if (leaf->next_)
+        leaf->next_->prev_ = right;
+    else
+        data->tail_ = right;
+    leaf->next_ = right;
+
+    /* Propagate the separator upward. */
+    void* sep = right->pairs_[0].key;
+    void* child = right;
+    unsigned idx_spare = 0;
+    level = path->depth_;
+    while (level > 0) {
+        --level;
+        InnerNode* node = path->node_[level];
+        unsigned idx = path->idx_[level];
+
+        if (node->count_ < INNER_CAP) {
+            memmove(&(node->keys_[idx + 1]), &(node->keys_[idx]),
+                    sizeof(void*) * (node->count_ - idx));
+            memmove(&(node->child_[idx + 2]), &(node->child_[idx + 1]),
+                    sizeof(void*) * (node->count_ - idx));
+            node->keys_[idx] = sep;
+            node->child_[idx + 1] = child;
+            ++(node->count_);
+            return true;
+        }
+
+        /* Merge the new entry into the full node, and promote the middle key. */
+        void* keys[INNER_CAP + 1];
+        void* childs[INNER_CAP + 2];
+        memcpy(keys, node->keys_, sizeof(void*) * idx);
+        keys[idx] = sep;
+        memcpy(&(keys[idx + 1]), &(node->keys_[idx]), sizeof(void*) * (INNER_CAP - idx));
+        memcpy(childs, node->child_, sizeof(void*) * (idx + 1));
+        childs[idx + 1] = child;
+        memcpy(&(childs[idx + 2]), &(node->child_[idx + 1]),
+               sizeof(void*) * (INNER_CAP - idx));
+
+        unsigned mid = (INNER_CAP + 1) >> 1;
+        InnerNode* sibling = spare[idx_spare++];
+        node->count_ = mid;
+        memcpy(node->keys_, keys, sizeof(void*) * mid);
+        memcpy(node->child_, childs, sizeof(void*) * (mid + 1));
+        sibling->count_ = INNER_CAP - mid;
+        memcpy(sibling->keys_, &(keys[mid + 1]), sizeof(void*) * sibling->count_);
+        memcpy(sibling->child_, &(childs[mid + 1]), sizeof(void*) * (sibling->count_ + 1));
+
+        sep = keys[mid];
+        child = sibling;
+    }
+
+    /* The root is split, so the tree grows by one level. */
+    InnerNode* root = spare[idx_spare];
+    root->count_ = 1;
+    root->keys_[0] = sep;
+    root->child_[0] = data->root_;
+    root->child_[1] = child;
+    data->root_ = root;
+    ++(data->height_);
+    return true;
+}
+
+void _BTreeMapRebalance(BTreeMapData* data, Path* path, LeafNode* leaf)
+{
+    /* Fix the underflowed leaf with its siblings under the same parent. */
+    unsigned level = path->depth_ - 1;
+    InnerNode* parent = path->node_[level];
+    unsigned idx = path->idx_[level];
+    LeafNode* left = (idx > 0)? (LeafNode*)parent->child_[idx - 1] : NULL;
+    LeafNode* right = (idx < parent->count_)? (LeafNode*)parent->child_[idx + 1] : NULL;
+
+    if (right && right->count_ > LEAF_MIN) {
+        leaf->pairs_[leaf->count_++] = right->pairs_[0];
+        --(right->count_);
+        memmove(right->pairs_, &(right->pairs_[1]), sizeof(Pair) * right->count_);
+        parent->keys_[idx] = right->pairs_[0].key;
+        return;
+    }
+    if (left && left->count_ > LEAF_MIN) {
+        memmove(&(leaf->pairs_[1]), leaf->pairs_, sizeof(Pair) * leaf->count_);
+        leaf->pairs_[0] = left->pairs_[--(left->count_)];
+        ++(leaf->count_);
+        parent->keys_[idx - 1] = leaf->pairs_[0].key;
+        return;
+    }
+
+    /* Merge the leaf with one of its siblings. The separator to be removed is
+       at position sep, and the right node of the merged pair is released. */
+    unsigned sep;
+    LeafNode* dst;
+    LeafNode* src;
+    if (right) {
+        dst = leaf;
+        src = right;
+        sep = idx;
+    } else {
+        dst = left;
+        src = leaf;
+        sep = idx - 1;
+    }
+    memcpy(&(dst->pairs_[dst->count_]), src->pairs_, sizeof(Pair) * src->count_);
+    dst->count_ += src->count_;
+    dst->next_ = src->next_;
+    if (src->next_)
+        src->next_->prev_ = dst;
+    else
+        data->tail_ = dst;
+    free(src);
+
+    /* Remove the separator and the released child, and then walk upward to fix
+       the underflowed internal nodes. */
+    while (true) {
+        InnerNode* node = path->node_[level];
+        --(node->count_);
+        memmove(&(node->keys_[sep]), &(node->keys_[sep + 1]),
+                sizeof(void*) * (node->count_ - sep));
+        memmove(&(node->child_[sep + 1]), &(node->child_[sep + 2]),
+                sizeof(void*) * (node->count_ - sep));
+
+        if (level == 0) {
+            /* The empty root is replaced by its only child. */
+            if (node->count_ == 0) {
+                data->root_ = node->child_[0];
+                --(data->height_);
+                free(node);
+            }
+            return;
+        }
+        if (node->count_ >= INNER_MIN)
+            return;
+
+        InnerNode* upper = path->node_[level - 1];
+        idx = path->idx_[level - 1];
+        InnerNode* left_in = (idx > 0)? (InnerNode*)upper->child_[idx - 1] : NULL;
+        InnerNode* right_in = (idx < upper->count_)?
+                              (InnerNode*)upper->child_[idx + 1] : NULL;
+
+        /* Rotate a child from the right sibling through the parent separator. */
+        if (right_in && right_in->count_ > INNER_MIN) {
+            node->keys_[node->count_] = upper->keys_[idx];
+            node->child_[node->count_ + 1] = right_in->child_[0];
+            ++(node->count_);
+            upper->keys_[idx] = right_in->keys_[0];
+            --(right_in->count_);
+            memmove(right_in->keys_, &(right_in->keys_[1]),
+                    sizeof(void*) * right_in->count_);
+            memmove(right_in->child_, &(right_in->child_[1]),
+                    sizeof(void*) * (right_in->count_ + 1));
+            return;
+        }
+
+        /* Rotate a child from the left sibling through the parent separator. */
+        if (left_in && left_in->count_ > INNER_MIN) {
+            memmove(&(node->keys_[1]), node->keys_, sizeof(void*) * node->count_);
+            memmove(&(node->child_[1]), node->child_,
+                    sizeof(void*) * (node->count_ + 1));
+            node->keys_[0] = upper->keys_[idx - 1];
+            node->child_[0] = left_in->child_[left_in->count_];
+            ++(node->count_);
+            upper->keys_[idx - 1] = left_in->keys_[left_in->count_ - 1];
+            --(left_in->count_);
+            return;
+        }
+
+        /* Merge the node with one of its siblings and pull down the separator. */
+        InnerNode* dst_in;
+        InnerNode* src_in;
+        if (right_in) {
+            dst_in = node;
+            src_in = right_in;
+            sep = idx;
+        } else {
+            dst_in = left_in;
+            src_in = node;
+            sep = idx - 1;
+        }
+        dst_in->keys_[dst_in->count_] = upper->keys_[sep];
+        memcpy(&(dst_in->keys_[dst_in->count_ + 1]), src_in->keys_,
+               sizeof(void*) * src_in->count_);
+        memcpy(&(dst_in->child_[dst_in->count_ + 1]), src_in->child_,
+               sizeof(void*) * (src_in->count_ + 1));
+        dst_in->count_ += src_in->count_ + 1;
+        free(src_in);
+
+        --level;
+    }
+}
+
+int _BTreeMapCompare(void* lhs, void* rhs)
+{
+    if ((intptr_t)lhs == (intptr_t)rhs)
+        return 0;
+    return ((intptr_t)lhs >= (intptr_t)rhs)? 1 : (-1);
+}
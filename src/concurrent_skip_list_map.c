@@ -0,0 +1,568 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+#include "container/concurrent_skip_list_map.h"
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+static const int MAX_LEVEL = 24;
+
+
+typedef struct _SkipNode {
+    Pair pair_;
+    struct _SkipNode* retire_;
+    int level_;
+    struct _SkipNode* next_[];
+} SkipNode;
+
+struct _ConcurrentSkipListMapData {
+    unsigned size_;
+    int level_;
+    SkipNode* head_;
+    SkipNode* retire_;
+    ConcurrentSkipListMapCompare func_cmp_;
+    ConcurrentSkipListMapCleanKey func_clean_key_;
+    ConcurrentSkipListMapCleanValue func_clean_val_;
+};
+
+/* The random level generator is private to each thread. */
+static __thread unsigned level_seed;
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * @brief Locate the predecessors and the successors of the designated key at
+ * every level and help unlinking the marked nodes on the way.
+ *
+ * @param data          The pointer to the map private data
+ * @param key           The designated key
+ * @param preds         The array of the returned predecessors
+ * @param succs         The array of the returned successors
+ *
+ * @retval true         The key can be found
+ * @retval false        The key cannot be found
+ */
+bool _ConcurrentSkipListMapSearch(ConcurrentSkipListMapData* data, void* key,
+                                  SkipNode** preds, SkipNode** succs);
+
+/**
+ * @brief Get the unmarked node with the designated key without writing to the
+ * shared memory.
+ *
+ * @param data          The pointer to the map private data
+ * @param key           The designated key
+ *
+ * @retval node         The target node
+ * @retval NULL         The key cannot be found
+ */
+SkipNode* _ConcurrentSkipListMapLookup(ConcurrentSkipListMapData* data,
+                                       void* key);
+
+/**
+ * @brief Push the node to the lock-free retire list.
+ *
+ * @param data          The pointer to the map private data
+ * @param node          The pointer to the retired node
+ */
+void _ConcurrentSkipListMapRetire(ConcurrentSkipListMapData* data,
+                                  SkipNode* node);
+
+/**
+ * @brief The default key comparison function.
+ *
+ * @param lhs           The source key
+ * @param rhs           The target key
+ *
+ * @retval  1           The source key should go after the target one.
+ * @retval  0           The source key is equal to the target one.
+ * @retval -1           The source key should go before the target one.
+ */
+int _ConcurrentSkipListMapCompare(void* lhs, void* rhs);
+
+/* The lowest bit of the link marks the owner node as logically deleted. */
+static inline
+bool MARKED(SkipNode* link)
+{
+    return ((uintptr_t)link & 1) != 0;
+}
+
+static inline
+SkipNode* MARK(SkipNode* link)
+{
+    return (SkipNode*)((uintptr_t)link | 1);
+}
+
+static inline
+SkipNode* UNMARK(SkipNode* link)
+{
+    return (SkipNode*)((uintptr_t)link & ~(uintptr_t)1);
+}
+
+static inline
+SkipNode* LOAD(SkipNode** link)
+{
+    return __atomic_load_n(link, __ATOMIC_ACQUIRE);
+}
+
+static inline
+bool CAS(SkipNode** link, SkipNode* expect, SkipNode* desire)
+{
+    return __atomic_compare_exchange_n(link, &expect, desire, false,
+                                       __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+}
+
+static inline
+SkipNode* NEW_NODE(int level)
+{
+    SkipNode* node = (SkipNode*)malloc(sizeof(SkipNode) +
+                                       sizeof(SkipNode*) * level);
+    if (likely(node)) {
+        node->retire_ = NULL;
+        node->level_ = level;
+    }
+    return node;
+}
+
+static inline
+int RANDOM_LEVEL()
+{
+    /* The xorshift generator, each level is promoted with probability 1/4. */
+    unsigned seed = level_seed;
+    if (unlikely(seed == 0))
+        seed = (unsigned)(uintptr_t)&level_seed | 1;
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    level_seed = seed;
+
+    int level = 1;
+    while ((seed & 3) == 0 && level < MAX_LEVEL) {
+        seed >>= 2;
+        ++level;
+    }
+    return level;
+}
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+ConcurrentSkipListMap* ConcurrentSkipListMapInit()
+{
+    ConcurrentSkipListMap* obj =
+        (ConcurrentSkipListMap*)malloc(sizeof(ConcurrentSkipListMap));
+    if (unlikely(!obj))
+        return NULL;
+
+    ConcurrentSkipListMapData* data =
+        (ConcurrentSkipListMapData*)malloc(sizeof(ConcurrentSkipListMapData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    SkipNode* head = NEW_NODE(MAX_LEVEL);
+    if (unlikely(!head)) {
+        free(data);
+        free(obj);
+        return NULL;
+    }
+    int i;
+    for (i = 0 ; i < MAX_LEVEL ; ++i)
+        head->next_[i] = NULL;
+
+    data->size_ = 0;
+    data->level_ = 1;
+    data->head_ = head;
+    data->retire_ = NULL;
+    data->func_cmp_ = _ConcurrentSkipListMapCompare;
+    data->func_clean_key_ = NULL;
+    data->func_clean_val_ = NULL;
+
+    obj->data = data;
+    obj->put = ConcurrentSkipListMapPut;
+    obj->get = ConcurrentSkipListMapGet;
+    obj->find = ConcurrentSkipListMapFind;
+    obj->remove = ConcurrentSkipListMapRemove;
+    obj->size = ConcurrentSkipListMapSize;
+    obj->minimum = ConcurrentSkipListMapMinimum;
+    obj->maximum = ConcurrentSkipListMapMaximum;
+    obj->first = ConcurrentSkipListMapFirst;
+    obj->reclaim = ConcurrentSkipListMapReclaim;
+    obj->set_compare = ConcurrentSkipListMapSetCompare;
+    obj->set_clean_key = ConcurrentSkipListMapSetCleanKey;
+    obj->set_clean_value = ConcurrentSkipListMapSetCleanValue;
+
+    return obj;
+}
+
+void ConcurrentSkipListMapDeinit(ConcurrentSkipListMap* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    ConcurrentSkipListMapReclaim(obj);
+
+    ConcurrentSkipListMapData* data = obj->data;
+    ConcurrentSkipListMapCleanKey func_clean_key = data->func_clean_key_;
+    ConcurrentSkipListMapCleanValue func_clean_val = data->func_clean_val_;
+
+    SkipNode* curr = data->head_->next_[0];
+    while (curr) {
+        SkipNode* next = curr->next_[0];
+        if (func_clean_key)
+            func_clean_key(curr->pair_.key);
+        if (func_clean_val)
+            func_clean_val(curr->pair_.value);
+        free(curr);
+        curr = next;
+    }
+
+    free(data->head_);
+    free(data);
+    free(obj);
+    return;
+}
+
+bool ConcurrentSkipListMapPut(ConcurrentSkipListMap* self, void* key,
+                              void* value)
+{
+    ConcurrentSkipListMapData* data = self->data;
+    SkipNode* preds[MAX_LEVEL];
+    SkipNode* succs[MAX_LEVEL];
+    SkipNode* node = NULL;
+    int level = RANDOM_LEVEL();
+
+    while (true) {
+        if (_ConcurrentSkipListMapSearch(data, key, preds, succs)) {
+            /* Replace the value and retire the duplicate key with the old
+               value, since the concurrent readers may still hold it. */
+            SkipNode* dup = node;
+            if (!dup) {
+                dup = NEW_NODE(0);
+                if (unlikely(!dup))
+                    return false;
+            }
+            dup->pair_.key = key;
+            dup->pair_.value = __atomic_exchange_n(&succs[0]->pair_.value,
+                                                   value, __ATOMIC_ACQ_REL);
+            _ConcurrentSkipListMapRetire(data, dup);
+            return true;
+        }
+
+        if (!node) {
+            node = NEW_NODE(level);
+            if (unlikely(!node))
+                return false;
+            node->pair_.key = key;
+            node->pair_.value = value;
+        }
+
+        /* Link the node at the bottom level, which makes it visible. */
+        int i;
+        for (i = 0 ; i < level ; ++i)
+            node->next_[i] = succs[i];
+        if (CAS(&preds[0]->next_[0], succs[0], node))
+            break;
+    }
+    __atomic_add_fetch(&data->size_, 1, __ATOMIC_RELAXED);
+
+    int top = __atomic_load_n(&data->level_, __ATOMIC_RELAXED);
+    while (top < level &&
+           !__atomic_compare_exchange_n(&data->level_, &top, level, false,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+
+    /* Link the upper levels. Stop once the node is marked for deletion. */
+    int i;
+    for (i = 1 ; i < level ; ++i) {
+        while (true) {
+            SkipNode* next = LOAD(&node->next_[i]);
+            if (MARKED(next))
+                return true;
+            if (next != succs[i] && !CAS(&node->next_[i], next, succs[i]))
+                continue;
+            if (CAS(&preds[i]->next_[i], succs[i], node))
+                break;
+            if (!_ConcurrentSkipListMapSearch(data, key, preds, succs) ||
+                succs[0] != node)
+                return true;
+        }
+    }
+
+    return true;
+}
+
+void* ConcurrentSkipListMapGet(ConcurrentSkipListMap* self, void* key)
+{
+    SkipNode* node = _ConcurrentSkipListMapLookup(self->data, key);
+    return (node)? __atomic_load_n(&node->pair_.value, __ATOMIC_ACQUIRE) : NULL;
+}
+
+bool ConcurrentSkipListMapFind(ConcurrentSkipListMap* self, void* key)
+{
+    SkipNode* node = _ConcurrentSkipListMapLookup(self->data, key);
+    return (node)? true : false;
+}
+
+bool ConcurrentSkipListMapRemove(ConcurrentSkipListMap* self, void* key)
+{
+    ConcurrentSkipListMapData* data = self->data;
+    SkipNode* preds[MAX_LEVEL];
+    SkipNode* succs[MAX_LEVEL];
+
+    if (!_ConcurrentSkipListMapSearch(data, key, preds, succs))
+        return false;
+    SkipNode* node = succs[0];
+
+    /* Mark the upper levels from top to bottom. */
+    int i;
+    for (i = node->level_ - 1 ; i > 0 ; --i) {
+        SkipNode* next = LOAD(&node->next_[i]);
+        while (!MARKED(next)) {
+            CAS(&node->next_[i], next, MARK(next));
+            next = LOAD(&node->next_[i]);
+        }
+    }
+
+    /* The thread marking the bottom level owns the deletion. */
+    SkipNode* next = LOAD(&node->next_[0]);
+    while (true) {
+        if (MARKED(next))
+            return false;
+        if (CAS(&node->next_[0], next, MARK(next)))
+            break;
+        next = LOAD(&node->next_[0]);
+    }
+
+    /* Unlink the node physically. */
+    _ConcurrentSkipListMapSearch(data, key, preds, succs);
+    _ConcurrentSkipListMapRetire(data, node);
+    __atomic_sub_fetch(&data->size_, 1, __ATOMIC_RELAXED);
+    return true;
+}
+
+unsigned ConcurrentSkipListMapSize(ConcurrentSkipListMap* self)
+{
+    return __atomic_load_n(&self->data->size_, __ATOMIC_RELAXED);
+}
+
+Pair* ConcurrentSkipListMapMinimum(ConcurrentSkipListMap* self)
+{
+    ConcurrentSkipListMapCursor cursor;
+    ConcurrentSkipListMapFirst(self, &cursor);
+    return ConcurrentSkipListMapCursorNext(&cursor);
+}
+
+Pair* ConcurrentSkipListMapMaximum(ConcurrentSkipListMap* self)
+{
+    ConcurrentSkipListMapData* data = self->data;
+    SkipNode* pred = data->head_;
+    SkipNode* last = NULL;
+
+    int i;
+    for (i = __atomic_load_n(&data->level_, __ATOMIC_RELAXED) - 1 ;
+         i >= 0 ; --i) {
+        SkipNode* curr = UNMARK(LOAD(&pred->next_[i]));
+        while (curr) {
+            SkipNode* next = LOAD(&curr->next_[i]);
+            if (!MARKED(LOAD(&curr->next_[0]))) {
+                pred = curr;
+                last = curr;
+            }
+            curr = UNMARK(next);
+        }
+    }
+
+    return (last)? &(last->pair_) : NULL;
+}
+
+void ConcurrentSkipListMapFirst(ConcurrentSkipListMap* self,
+                                ConcurrentSkipListMapCursor* cursor)
+{
+    cursor->data_ = self->data;
+    cursor->node_ = UNMARK(LOAD(&self->data->head_->next_[0]));
+}
+
+Pair* ConcurrentSkipListMapCursorNext(ConcurrentSkipListMapCursor* cursor)
+{
+    SkipNode* curr = (SkipNode*)cursor->node_;
+    while (curr) {
+        SkipNode* next = LOAD(&curr->next_[0]);
+        if (!MARKED(next)) {
+            cursor->node_ = next;
+            return &(curr->pair_);
+        }
+        curr = UNMARK(next);
+    }
+
+    cursor->node_ = NULL;
+    return NULL;
+}
+
+void ConcurrentSkipListMapReclaim(ConcurrentSkipListMap* self)
+{
+    ConcurrentSkipListMapData* data = self->data;
+
+    /* An insertion racing with the deletion may link the node again at an
+       upper level, so sweep all the marked nodes before releasing them. */
+    int i;
+    for (i = 0 ; i < data->level_ ; ++i) {
+        SkipNode* pred = data->head_;
+        SkipNode* curr = pred->next_[i];
+        while (curr) {
+            SkipNode* next = curr->next_[i];
+            if (MARKED(curr->next_[0])) {
+                pred->next_[i] = UNMARK(next);
+            } else
+                pred = curr;
+            curr = UNMARK(next);
+        }
+    }
+
+    SkipNode* node = data->retire_;
+    while (node) {
+        SkipNode* retire = node->retire_;
+        if (data->func_clean_key_)
+            data->func_clean_key_(node->pair_.key);
+        if (data->func_clean_val_)
+            data->func_clean_val_(node->pair_.value);
+        free(node);
+        node = retire;
+    }
+    data->retire_ = NULL;
+}
+
+void ConcurrentSkipListMapSetCompare(ConcurrentSkipListMap* self,
+                                     ConcurrentSkipListMapCompare func)
+{
+    self->data->func_cmp_ = func;
+}
+
+void ConcurrentSkipListMapSetCleanKey(ConcurrentSkipListMap* self,
+                                      ConcurrentSkipListMapCleanKey func)
+{
+    self->data->func_clean_key_ = func;
+}
+
+void ConcurrentSkipListMapSetCleanValue(ConcurrentSkipListMap* self,
+                                        ConcurrentSkipListMapCleanValue func)
+{
+    self->data->func_clean_val_ = func;
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+bool _ConcurrentSkipListMapSearch(ConcurrentSkipListMapData* data, void* key,
+                                  SkipNode** preds, SkipNode** succs)
+{
+    ConcurrentSkipListMapCompare func_cmp = data->func_cmp_;
+    int order;
+
+RETRY:
+    order = 1;
+    SkipNode* pred = data->head_;
+    SkipNode* curr = NULL;
+
+    int i;
+    for (i = MAX_LEVEL - 1 ; i >= 0 ; --i) {
+        curr = UNMARK(LOAD(&pred->next_[i]));
+        while (curr) {
+            SkipNode* next = LOAD(&curr->next_[i]);
+
+            /* Snip the logically deleted node. The failure implies that the
+               predecessor is changed or deleted, so restart from the head. */
+            while (MARKED(next)) {
+                if (!CAS(&pred->next_[i], curr, UNMARK(next)))
+                    goto RETRY;
+                curr = UNMARK(next);
+                if (!curr)
+                    break;
+                next = LOAD(&curr->next_[i]);
+            }
+            if (!curr)
+                break;
+
+            order = func_cmp(curr->pair_.key, key);
+            if (order >= 0)
+                break;
+            pred = curr;
+            curr = UNMARK(next);
+        }
+        preds[i] = pred;
+        succs[i] = curr;
+    }
+
+    return curr && order == 0;
+}
+
+SkipNode* _ConcurrentSkipListMapLookup(ConcurrentSkipListMapData* data,
+                                       void* key)
+{
+    ConcurrentSkipListMapCompare func_cmp = data->func_cmp_;
+    SkipNode* pred = data->head_;
+    SkipNode* curr = NULL;
+    int order = 1;
+
+    int i;
+    for (i = __atomic_load_n(&data->level_, __ATOMIC_RELAXED) - 1 ;
+         i >= 0 ; --i) {
+        curr = UNMARK(LOAD(&pred->next_[i]));
+        while (curr) {
+            order = func_cmp(curr->pair_.key, key);
+            if (order >= 0)
+                break;
+            pred = curr;
+            curr = UNMARK(LOAD(&curr->next_[i]));
+        }
+    }
+
+    if (!curr || order != 0 || MARKED(LOAD(&curr->next_[0])))
+        return NULL;
+    return curr;
+}
+
+void _ConcurrentSkipListMapRetire(ConcurrentSkipListMapData* data,
+                                  SkipNode* node)
+{
+    SkipNode* head = __atomic_load_n(&data->retire_, __ATOMIC_RELAXED);
+    do {
+        node->retire_ = head;
+    } while (!__atomic_compare_exchange_n(&data->retire_, &head, node, true,
+                                          __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+}
+
+int _ConcurrentSkipListMapCompare(void* lhs, void* rhs)
+{
+    if ((intptr_t)lhs == (intptr_t)rhs)
+        return 0;
+    return ((intptr_t)lhs >= (intptr_t)rhs)? 1 : (-1);
+}
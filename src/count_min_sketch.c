@@ -0,0 +1,177 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+
+
+
+#include "container/count_min_sketch.h"
+#include "math/hash.h"
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+struct _CountMinSketchData {
+    unsigned width_;
+    unsigned depth_;
+    uint64_t total_;
+    uint64_t* arr_cnt_;
+};
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * @brief Locate the counter of the designated row.
+ *
+ * The row hash functions are simulated by combining two independent hash values
+ * as h1 + row * h2. The second hash is forced to be odd so that the rows never
+ * degenerate to the same column.
+ *
+ * @param data          The pointer to the sketch private data
+ * @param row           The designated row
+ * @param h1            The first hash value
+ * @param h2            The second hash value
+ *
+ * @retval ptr_cnt      The pointer to the target counter
+ */
+static inline
+uint64_t* LOCATE(CountMinSketchData* data, unsigned row, uint32_t h1, uint32_t h2)
+{
+    uint64_t col = ((uint64_t)h1 + (uint64_t)row * h2) % data->width_;
+    return &(data->arr_cnt_[(uint64_t)row * data->width_ + col]);
+}
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+CountMinSketch* CountMinSketchInit(unsigned width, unsigned depth)
+{
+    if (width == 0 || depth == 0)
+        return NULL;
+
+    CountMinSketch* obj = (CountMinSketch*)malloc(sizeof(CountMinSketch));
+    if (unlikely(!obj))
+        return NULL;
+
+    CountMinSketchData* data =
+        (CountMinSketchData*)malloc(sizeof(CountMinSketchData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    uint64_t* arr_cnt = (uint64_t*)calloc((size_t)width * depth, sizeof(uint64_t));
+    if (unlikely(!arr_cnt)) {
+        free(data);
+        free(obj);
+        return NULL;
+    }
+
+    data->width_ = width;
+    data->depth_ = depth;
+    data->total_ = 0;
+    data->arr_cnt_ = arr_cnt;
+
+    obj->data = data;
+    obj->update = CountMinSketchUpdate;
+    obj->estimate = CountMinSketchEstimate;
+    obj->total = CountMinSketchTotal;
+    obj->merge = CountMinSketchMerge;
+
+    return obj;
+}
+
+void CountMinSketchDeinit(CountMinSketch* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    CountMinSketchData* data = obj->data;
+    free(data->arr_cnt_);
+    free(data);
+    free(obj);
+    return;
+}
+
+void CountMinSketchUpdate(CountMinSketch* self, void* key, size_t size,
+                          uint64_t count)
+{
+    CountMinSketchData* data = self->data;
+    uint32_t h1 = HashMurMur32(key, size);
+    uint32_t h2 = HashJenkins(key, size) | 1;
+
+    unsigned row;
+    for (row = 0 ; row < data->depth_ ; ++row)
+        *LOCATE(data, row, h1, h2) += count;
+
+    data->total_ += count;
+    return;
+}
+
+uint64_t CountMinSketchEstimate(CountMinSketch* self, void* key, size_t size)
+{
+    CountMinSketchData* data = self->data;
+    uint32_t h1 = HashMurMur32(key, size);
+    uint32_t h2 = HashJenkins(key, size) | 1;
+
+    uint64_t min = UINT64_MAX;
+    unsigned row;
+    for (row = 0 ; row < data->depth_ ; ++row) {
+        uint64_t cnt = *LOCATE(data, row, h1, h2);
+        if (cnt < min)
+            min = cnt;
+    }
+
+    return min;
+}
+
+uint64_t CountMinSketchTotal(CountMinSketch* self)
+{
+    return self->data->total_;
+}
+
+bool CountMinSketchMerge(CountMinSketch* self, CountMinSketch* other)
+{
+    CountMinSketchData* data_dst = self->data;
+    CountMinSketchData* data_src = other->data;
+    if (data_dst->width_ != data_src->width_ ||
+        data_dst->depth_ != data_src->depth_)
+        return false;
+
+    size_t num_cnt = (size_t)data_dst->width_ * data_dst->depth_;
+    uint64_t* arr_dst = data_dst->arr_cnt_;
+    uint64_t* arr_src = data_src->arr_cnt_;
+    size_t i;
+    for (i = 0 ; i < num_cnt ; ++i)
+        arr_dst[i] += arr_src[i];
+
+    data_dst->total_ += data_src->total_;
+    return true;
+}
@@ -55,6 +55,28 @@ unsigned HashMurMur32(void* key, size_t size)
     return hash;
 }
 
+unsigned HashJenkins(void* key, size_t size)
+{
+    if (!key || size == 0)
+        return 0;
+
+    /* The one-at-a-time hash published in Dr. Dobb's Journal. */
+    const uint8_t *bytes = (const uint8_t*)key;
+    unsigned hash = 0;
+    size_t i;
+    for (i = 0; i < size; i++) {
+        hash += bytes[i];
+        hash += (hash << 10);
+        hash ^= (hash >> 6);
+    }
+
+    hash += (hash << 3);
+    hash ^= (hash >> 11);
+    hash += (hash << 15);
+
+    return hash;
+}
+
 unsigned HashDjb2(char* key)
 {
     unsigned hash = 5381;
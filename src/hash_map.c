@@ -135,6 +135,8 @@ HashMap* HashMapInit()
     obj->size = HashMapSize;
     obj->first = HashMapFirst;
     obj->next = HashMapNext;
+    obj->next_batch = HashMapNextBatch;
+    obj->for_each = HashMapForEach;
     obj->set_hash = HashMapSetHash;
     obj->set_compare = HashMapSetCompare;
     obj->set_clean_key = HashMapSetCleanKey;
@@ -333,6 +335,51 @@ Pair* HashMapNext(HashMap* self)
     return NULL;
 }
 
+unsigned HashMapNextBatch(HashMap* self, Pair* pairs, unsigned cap)
+{
+    HashMapData* data = self->data;
+
+    /* Keep the iterator state in locals during the drain. */
+    SlotNode** arr_slot = data->arr_slot_;
+    unsigned num_slot = data->num_slot_;
+    unsigned slot = data->iter_slot_;
+    SlotNode* node = data->iter_node_;
+    unsigned count = 0;
+    while (count < cap && slot < num_slot) {
+        if (node) {
+            pairs[count++] = node->pair_;
+            node = node->next_;
+            continue;
+        }
+        ++slot;
+        if (slot == num_slot)
+            break;
+        node = arr_slot[slot];
+    }
+
+    data->iter_slot_ = slot;
+    data->iter_node_ = node;
+    return count;
+}
+
+bool HashMapForEach(HashMap* self, HashMapVisit func, void* arg)
+{
+    HashMapData* data = self->data;
+    SlotNode** arr_slot = data->arr_slot_;
+    unsigned num_slot = data->num_slot_;
+    unsigned i;
+    for (i = 0 ; i < num_slot ; ++i) {
+        SlotNode* curr = arr_slot[i];
+        while (curr) {
+            SlotNode* next = curr->next_;
+            if (!func(&(curr->pair_), arg))
+                return false;
+            curr = next;
+        }
+    }
+    return true;
+}
+
 void HashMapSetHash(HashMap* self, HashMapHash func)
 {
     self->data->func_hash_ = func;
@@ -23,6 +23,10 @@
 
 #include "container/hash_set.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 
 /*===========================================================================*
  *                        The container private data                         *
@@ -35,6 +39,14 @@ static const unsigned magic_primes[] = {
 static const int num_prime = sizeof(magic_primes) / sizeof(unsigned);
 static const double load_factor = 0.75;
 
+/* The merge kernel gallops through the larger array if it is heavily skewed. */
+static const unsigned GALLOP_RATIO = 32;
+
+/* The 32 bit hash values are sorted in three passes of 11 bit digits. */
+#define RADIX_BITS      11
+#define RADIX_SIZE      (1 << RADIX_BITS)
+#define RADIX_PASS      3
+
 
 typedef struct _SlotNode {
     void* key_;
@@ -99,6 +111,133 @@ int _HashSetCompare(void* lhs, void* rhs);
  */
 void _HashSetReHash(HashSetData* data);
 
+/**
+ * @brief Collect the keys of the source set which also belong to the target set
+ * by probing the target set.
+ *
+ * @param set_src       The source set
+ * @param set_tge       The target set
+ * @param result        The result set
+ *
+ * @retval true         The intersection is successfully collected
+ * @retval false        Insufficient memory for the result set
+ */
+bool _HashSetIntersectProbe(HashSet* set_src, HashSet* set_tge, HashSet* result);
+
+/**
+ * @brief Extract the keys of the set into an array sorted by hash value.
+ *
+ * @param data          The pointer to the set private data
+ * @param p_hash        The pointer to the returned array of hash values
+ * @param p_key         The pointer to the returned array of keys
+ *
+ * @retval true         The arrays are successfully extracted
+ * @retval false        Insufficient memory for the arrays
+ *
+ * @note The two returned arrays should be freed by the caller.
+ */
+bool _HashSetExtract(HashSetData* data, unsigned** p_hash, void*** p_key);
+
+/**
+ * @brief Sort the hash values and the accompanying keys with LSD radix sort.
+ *
+ * @param arr_hash      The array of hash values
+ * @param arr_key       The array of keys
+ * @param buf_hash      The auxiliary buffer for hash values
+ * @param buf_key       The auxiliary buffer for keys
+ * @param count         The digit histograms of all the passes
+ * @param size          The array size
+ */
+void _HashSetRadixSort(unsigned* arr_hash, void** arr_key, unsigned* buf_hash,
+                       void** buf_key, unsigned (*count)[RADIX_SIZE], unsigned size);
+
+/**
+ * @brief Collect the keys of the source set which also belong to the target set
+ * by merging the two arrays sorted by hash value.
+ *
+ * @param data_src      The pointer to the source set private data
+ * @param hash_src      The sorted hash values of the source set
+ * @param key_src       The keys of the source set
+ * @param hash_tge      The sorted hash values of the target set
+ * @param key_tge       The keys of the target set
+ * @param size_tge      The size of the target set
+ * @param result        The result set
+ *
+ * @retval true         The intersection is successfully collected
+ * @retval false        Insufficient memory for the result set
+ */
+bool _HashSetIntersectSort(HashSetData* data_src, unsigned* hash_src, void** key_src,
+                           unsigned* hash_tge, void** key_tge, unsigned size_tge,
+                           HashSet* result);
+
+/**
+ * @brief Linearly scan the sorted array for the first element not less than the
+ * designated value.
+ *
+ * @param arr           The sorted array
+ * @param pos           The starting position
+ * @param size          The array size
+ * @param val           The designated value
+ *
+ * @retval pos          The position of the target element or the array size
+ */
+static inline
+unsigned SCAN(const unsigned* arr, unsigned pos, unsigned size, unsigned val)
+{
+#if defined(__SSE2__)
+    /* SSE2 only offers signed comparison, so the sign bits are flipped to keep
+       the unsigned order. The lanes less than the value form a prefix. */
+    const __m128i bias = _mm_set1_epi32((int)0x80000000);
+    const __m128i pivot = _mm_xor_si128(_mm_set1_epi32((int)val), bias);
+    while (pos + 4 <= size) {
+        __m128i block = _mm_loadu_si128((const __m128i*)(arr + pos));
+        block = _mm_xor_si128(block, bias);
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(block, pivot)));
+        if (mask != 0xf)
+            return pos + __builtin_popcount(mask);
+        pos += 4;
+    }
+#endif
+    while (pos < size && arr[pos] < val)
+        ++pos;
+    return pos;
+}
+
+/**
+ * @brief Gallop through the sorted array for the first element not less than
+ * the designated value.
+ *
+ * @param arr           The sorted array
+ * @param pos           The starting position
+ * @param size          The array size
+ * @param val           The designated value
+ *
+ * @retval pos          The position of the target element or the array size
+ */
+static inline
+unsigned GALLOP(const unsigned* arr, unsigned pos, unsigned size, unsigned val)
+{
+    /* Double the stride until the value is bracketed. */
+    unsigned bgn = pos;
+    unsigned end = pos;
+    unsigned step = 1;
+    while (end < size && arr[end] < val) {
+        bgn = end + 1;
+        end = (size - end > step)? end + step : size;
+        step <<= 1;
+    }
+
+    /* Binary search within the bracket. */
+    while (bgn < end) {
+        unsigned mid = bgn + ((end - bgn) >> 1);
+        if (arr[mid] < val)
+            bgn = mid + 1;
+        else
+            end = mid;
+    }
+    return bgn;
+}
+
 
 /*===========================================================================*
  *               Implementation for the exported operations                  *
@@ -267,6 +406,51 @@ void* HashSetNext(HashSet* self)
     return NULL;
 }
 
+unsigned HashSetNextBatch(HashSet* self, void** keys, unsigned cap)
+{
+    HashSetData* data = self->data;
+
+    /* Keep the iterator state in locals during the drain. */
+    SlotNode** arr_slot = data->arr_slot_;
+    unsigned num_slot = data->num_slot_;
+    unsigned slot = data->iter_slot_;
+    SlotNode* node = data->iter_node_;
+    unsigned count = 0;
+    while (count < cap && slot < num_slot) {
+        if (node) {
+            keys[count++] = node->key_;
+            node = node->next_;
+            continue;
+        }
+        ++slot;
+        if (slot == num_slot)
+            break;
+        node = arr_slot[slot];
+    }
+
+    data->iter_slot_ = slot;
+    data->iter_node_ = node;
+    return count;
+}
+
+bool HashSetForEach(HashSet* self, HashSetVisit func, void* arg)
+{
+    HashSetData* data = self->data;
+    SlotNode** arr_slot = data->arr_slot_;
+    unsigned num_slot = data->num_slot_;
+    unsigned i;
+    for (i = 0 ; i < num_slot ; ++i) {
+        SlotNode* curr = arr_slot[i];
+        while (curr) {
+            SlotNode* next = curr->next_;
+            if (!func(curr->key_, arg))
+                return false;
+            curr = next;
+        }
+    }
+    return true;
+}
+
 void HashSetSetHash(HashSet* self, HashSetHash func)
 {
     self->data->func_hash_ = func;
@@ -347,6 +531,12 @@ HashSet* HashSetUnion(HashSet* lhs, HashSet* rhs)
 }
 
 HashSet* HashSetIntersect(HashSet* lhs, HashSet* rhs)
+{
+    return HashSetIntersectEx(lhs, rhs, HASH_SET_INTERSECT_PROBE, NULL);
+}
+
+HashSet* HashSetIntersectEx(HashSet* lhs, HashSet* rhs, HashSetIntersectMode mode,
+                            HashSetIntersectMode* p_used)
 {
     /* Predict the required slot size for the result set. */
     unsigned size_lhs = lhs->data->size_;
@@ -378,32 +568,52 @@ HashSet* HashSetIntersect(HashSet* lhs, HashSet* rhs)
         return NULL;
 
     HashSetData* data_src = set_src->data;
+    HashSetData* data_tge = set_tge->data;
     HashSetData* data_result = result->data;
     data_result->func_hash_ = data_src->func_hash_;
     data_result->func_cmp_ = data_src->func_cmp_;
 
-    /* Collect the keys belonged to both source sets. */
-    SlotNode** arr_slot = data_src->arr_slot_;
-    unsigned num_slot = data_src->num_slot_;
-    unsigned i;
-    for (i = 0 ; i < num_slot ; ++i) {
-        SlotNode* pred;
-        SlotNode* curr = arr_slot[i];
-        while (curr) {
-            pred = curr;
-            curr = curr->next_;
-            void* key = pred->key_;
-            bool status = HashSetFind(set_tge, key);
-            if (!status)
-                continue;
-            status = HashSetAdd(result, key);
-            if (!status) {
-                HashSetDeinit(result);
-                return NULL;
-            }
+    /* Determine the strategy. No input size is measured to favor the sort
+       strategy over the chained buckets, so the auto one always probes. The
+       hash values of two sets are comparable only when they are produced by
+       the same function. */
+    if (mode == HASH_SET_INTERSECT_AUTO)
+        mode = HASH_SET_INTERSECT_PROBE;
+    if (data_src->func_hash_ != data_tge->func_hash_)
+        mode = HASH_SET_INTERSECT_PROBE;
+
+    /* Extract the sorted arrays. If there is no sufficient memory, we still
+       have the chance to apply the probe strategy. */
+    unsigned *hash_src = NULL, *hash_tge = NULL;
+    void **key_src = NULL, **key_tge = NULL;
+    if (mode == HASH_SET_INTERSECT_SORT) {
+        if (!_HashSetExtract(data_src, &hash_src, &key_src))
+            mode = HASH_SET_INTERSECT_PROBE;
+        else if (!_HashSetExtract(data_tge, &hash_tge, &key_tge)) {
+            free(hash_src);
+            free(key_src);
+            mode = HASH_SET_INTERSECT_PROBE;
         }
     }
 
+    bool status;
+    if (mode == HASH_SET_INTERSECT_SORT) {
+        status = _HashSetIntersectSort(data_src, hash_src, key_src,
+                                       hash_tge, key_tge, data_tge->size_, result);
+        free(hash_src);
+        free(key_src);
+        free(hash_tge);
+        free(key_tge);
+    } else
+        status = _HashSetIntersectProbe(set_src, set_tge, result);
+
+    if (!status) {
+        HashSetDeinit(result);
+        return NULL;
+    }
+
+    if (p_used)
+        *p_used = mode;
     return result;
 }
 
@@ -500,6 +710,8 @@ HashSet* _HashSetInit(int idx_prime)
     obj->size = HashSetSize;
     obj->first = HashSetFirst;
     obj->next = HashSetNext;
+    obj->next_batch = HashSetNextBatch;
+    obj->for_each = HashSetForEach;
     obj->set_hash = HashSetSetHash;
     obj->set_compare = HashSetSetCompare;
     obj->set_clean_key = HashSetSetCleanKey;
@@ -577,3 +789,170 @@ void _HashSetReHash(HashSetData* data)
     data->curr_limit_ = (unsigned)((double)num_slot_new * load_factor);
     return;
 }
+
+bool _HashSetIntersectProbe(HashSet* set_src, HashSet* set_tge, HashSet* result)
+{
+    /* Collect the keys belonged to both source sets. */
+    HashSetData* data_src = set_src->data;
+    SlotNode** arr_slot = data_src->arr_slot_;
+    unsigned num_slot = data_src->num_slot_;
+    unsigned i;
+    for (i = 0 ; i < num_slot ; ++i) {
+        SlotNode* pred;
+        SlotNode* curr = arr_slot[i];
+        while (curr) {
+            pred = curr;
+            curr = curr->next_;
+            void* key = pred->key_;
+            bool status = HashSetFind(set_tge, key);
+            if (!status)
+                continue;
+            status = HashSetAdd(result, key);
+            if (!status)
+                return false;
+        }
+    }
+
+    return true;
+}
+
+bool _HashSetExtract(HashSetData* data, unsigned** p_hash, void*** p_key)
+{
+    /* The second half of each array serves as the radix sort buffer. */
+    unsigned size = data->size_;
+    size_t cap = (size > 0)? size : 1;
+    unsigned* arr_hash = (unsigned*)malloc(sizeof(unsigned) * cap * 2);
+    if (unlikely(!arr_hash))
+        return false;
+    void** arr_key = (void**)malloc(sizeof(void*) * cap * 2);
+    if (unlikely(!arr_key)) {
+        free(arr_hash);
+        return false;
+    }
+    unsigned (*count)[RADIX_SIZE] =
+        (unsigned (*)[RADIX_SIZE])calloc(RADIX_PASS, sizeof(unsigned) * RADIX_SIZE);
+    if (unlikely(!count)) {
+        free(arr_key);
+        free(arr_hash);
+        return false;
+    }
+
+    /* Collect the keys and build the digit histograms of all passes at once. */
+    HashSetHash func_hash = data->func_hash_;
+    SlotNode** arr_slot = data->arr_slot_;
+    unsigned num_slot = data->num_slot_;
+    unsigned idx = 0;
+    unsigned i;
+    for (i = 0 ; i < num_slot ; ++i) {
+        SlotNode* curr = arr_slot[i];
+        while (curr) {
+            unsigned hash = func_hash(curr->key_);
+            arr_hash[idx] = hash;
+            arr_key[idx] = curr->key_;
+            ++idx;
+            unsigned pass;
+            for (pass = 0 ; pass < RADIX_PASS ; ++pass)
+                ++count[pass][(hash >> (pass * RADIX_BITS)) & (RADIX_SIZE - 1)];
+            curr = curr->next_;
+        }
+    }
+
+    _HashSetRadixSort(arr_hash, arr_key, arr_hash + cap, arr_key + cap, count, size);
+    free(count);
+
+    *p_hash = arr_hash;
+    *p_key = arr_key;
+    return true;
+}
+
+void _HashSetRadixSort(unsigned* arr_hash, void** arr_key, unsigned* buf_hash,
+                       void** buf_key, unsigned (*count)[RADIX_SIZE], unsigned size)
+{
+    unsigned* src_hash = arr_hash;
+    void** src_key = arr_key;
+    unsigned* dst_hash = buf_hash;
+    void** dst_key = buf_key;
+
+    unsigned pass;
+    for (pass = 0 ; pass < RADIX_PASS ; ++pass) {
+        unsigned shift = pass * RADIX_BITS;
+        unsigned* offset = count[pass];
+
+        /* Skip the pass if all the elements fall into the same bucket. */
+        if (size == 0 || offset[(src_hash[0] >> shift) & (RADIX_SIZE - 1)] == size)
+            continue;
+
+        unsigned sum = 0;
+        unsigned i;
+        for (i = 0 ; i < RADIX_SIZE ; ++i) {
+            unsigned cnt = offset[i];
+            offset[i] = sum;
+            sum += cnt;
+        }
+
+        for (i = 0 ; i < size ; ++i) {
+            unsigned pos = offset[(src_hash[i] >> shift) & (RADIX_SIZE - 1)]++;
+            dst_hash[pos] = src_hash[i];
+            dst_key[pos] = src_key[i];
+        }
+
+        unsigned* tmp_hash = src_hash;
+        src_hash = dst_hash;
+        dst_hash = tmp_hash;
+        void** tmp_key = src_key;
+        src_key = dst_key;
+        dst_key = tmp_key;
+    }
+
+    if (src_hash != arr_hash) {
+        memcpy(arr_hash, src_hash, sizeof(unsigned) * size);
+        memcpy(arr_key, src_key, sizeof(void*) * size);
+    }
+    return;
+}
+
+bool _HashSetIntersectSort(HashSetData* data_src, unsigned* hash_src, void** key_src,
+                           unsigned* hash_tge, void** key_tge, unsigned size_tge,
+                           HashSet* result)
+{
+    HashSetCompare func_cmp = data_src->func_cmp_;
+    unsigned size_src = data_src->size_;
+    bool skew = size_tge / GALLOP_RATIO > size_src;
+
+    unsigned i = 0, j = 0;
+    while (i < size_src && j < size_tge) {
+        unsigned h_src = hash_src[i];
+        unsigned h_tge = hash_tge[j];
+        if (h_src < h_tge) {
+            i = SCAN(hash_src, i, size_src, h_tge);
+            continue;
+        }
+        if (h_tge < h_src) {
+            j = (skew)? GALLOP(hash_tge, j, size_tge, h_src) :
+                        SCAN(hash_tge, j, size_tge, h_src);
+            continue;
+        }
+
+        /* The keys sharing the same hash value are compared pairwise. */
+        unsigned end_src = i + 1;
+        while (end_src < size_src && hash_src[end_src] == h_src)
+            ++end_src;
+        unsigned end_tge = j + 1;
+        while (end_tge < size_tge && hash_tge[end_tge] == h_tge)
+            ++end_tge;
+
+        for ( ; i < end_src ; ++i) {
+            unsigned k;
+            for (k = j ; k < end_tge ; ++k) {
+                if (func_cmp(key_src[i], key_tge[k]) != 0)
+                    continue;
+                if (!HashSetAdd(result, key_src[i]))
+                    return false;
+                break;
+            }
+        }
+        j = end_tge;
+    }
+
+    return true;
+}
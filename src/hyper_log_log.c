@@ -0,0 +1,200 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+
+
+
+#include "container/hyper_log_log.h"
+#include "math/hash.h"
+#include <math.h>
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+static const unsigned MIN_PRECISION = 4;
+static const unsigned MAX_PRECISION = 18;
+
+
+struct _HyperLogLogData {
+    unsigned precision_;
+    unsigned num_reg_;
+    uint8_t* arr_reg_;
+};
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * @brief Derive the 64 bit hash value from the two 32 bit hash functions.
+ *
+ * @param key           The designated key
+ * @param size          Size of the data pointed by the key in bytes
+ *
+ * @retval hash         The 64 bit hash value
+ */
+static inline
+uint64_t HASH64(void* key, size_t size)
+{
+    return ((uint64_t)HashMurMur32(key, size) << 32) |
+           (uint64_t)HashJenkins(key, size);
+}
+
+/**
+ * @brief Return the bias correction constant for the given register count.
+ *
+ * @param num_reg       The number of registers
+ *
+ * @retval alpha        The correction constant
+ */
+static inline
+double ALPHA(unsigned num_reg)
+{
+    switch (num_reg) {
+        case 16:
+            return 0.673;
+        case 32:
+            return 0.697;
+        case 64:
+            return 0.709;
+        default:
+            return 0.7213 / (1.0 + 1.079 / num_reg);
+    }
+}
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+HyperLogLog* HyperLogLogInit(unsigned precision)
+{
+    if (precision < MIN_PRECISION || precision > MAX_PRECISION)
+        return NULL;
+
+    HyperLogLog* obj = (HyperLogLog*)malloc(sizeof(HyperLogLog));
+    if (unlikely(!obj))
+        return NULL;
+
+    HyperLogLogData* data = (HyperLogLogData*)malloc(sizeof(HyperLogLogData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    unsigned num_reg = 1 << precision;
+    uint8_t* arr_reg = (uint8_t*)calloc(num_reg, sizeof(uint8_t));
+    if (unlikely(!arr_reg)) {
+        free(data);
+        free(obj);
+        return NULL;
+    }
+
+    data->precision_ = precision;
+    data->num_reg_ = num_reg;
+    data->arr_reg_ = arr_reg;
+
+    obj->data = data;
+    obj->add = HyperLogLogAdd;
+    obj->count = HyperLogLogCount;
+    obj->merge = HyperLogLogMerge;
+
+    return obj;
+}
+
+void HyperLogLogDeinit(HyperLogLog* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    HyperLogLogData* data = obj->data;
+    free(data->arr_reg_);
+    free(data);
+    free(obj);
+    return;
+}
+
+void HyperLogLogAdd(HyperLogLog* self, void* key, size_t size)
+{
+    HyperLogLogData* data = self->data;
+    unsigned precision = data->precision_;
+    uint64_t hash = HASH64(key, size);
+
+    /* The leading bits select the register, and the remaining bits provide the
+       position of the leftmost one bit. The sentinel bit bounds the rank. */
+    unsigned idx = (unsigned)(hash >> (64 - precision));
+    uint64_t rest = (hash << precision) | ((uint64_t)1 << (precision - 1));
+    uint8_t rank = (uint8_t)(__builtin_clzll(rest) + 1);
+
+    if (rank > data->arr_reg_[idx])
+        data->arr_reg_[idx] = rank;
+    return;
+}
+
+uint64_t HyperLogLogCount(HyperLogLog* self)
+{
+    HyperLogLogData* data = self->data;
+    unsigned num_reg = data->num_reg_;
+    uint8_t* arr_reg = data->arr_reg_;
+
+    double sum = 0;
+    unsigned num_zero = 0;
+    unsigned i;
+    for (i = 0 ; i < num_reg ; ++i) {
+        sum += ldexp(1.0, -(int)arr_reg[i]);
+        if (arr_reg[i] == 0)
+            ++num_zero;
+    }
+
+    double estimate = ALPHA(num_reg) * num_reg * num_reg / sum;
+
+    /* Apply linear counting for the small range where the raw estimation is
+       heavily biased. No large range correction is needed for 64 bit hash. */
+    if (estimate <= 2.5 * num_reg && num_zero > 0)
+        estimate = num_reg * log((double)num_reg / num_zero);
+
+    return (uint64_t)(estimate + 0.5);
+}
+
+bool HyperLogLogMerge(HyperLogLog* self, HyperLogLog* other)
+{
+    HyperLogLogData* data_dst = self->data;
+    HyperLogLogData* data_src = other->data;
+    if (data_dst->precision_ != data_src->precision_)
+        return false;
+
+    uint8_t* arr_dst = data_dst->arr_reg_;
+    uint8_t* arr_src = data_src->arr_reg_;
+    unsigned num_reg = data_dst->num_reg_;
+    unsigned i;
+    for (i = 0 ; i < num_reg ; ++i) {
+        if (arr_src[i] > arr_dst[i])
+            arr_dst[i] = arr_src[i];
+    }
+
+    return true;
+}
@@ -0,0 +1,650 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+#include "container/interval_map.h"
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+static const char COLOR_RED = 0;
+static const char COLOR_BLACK = 1;
+
+
+typedef struct _TreeNode {
+    char color_;
+    Interval interval_;
+    void* max_;
+    struct _TreeNode* parent_;
+    struct _TreeNode* left_;
+    struct _TreeNode* right_;
+} TreeNode;
+
+struct _IntervalMapData {
+    int size_;
+    TreeNode* root_;
+    TreeNode* null_;
+    IntervalMapCompare func_cmp_;
+    IntervalMapCleanValue func_clean_val_;
+};
+
+/* The dummy node representing the NULL pointer of the tree. It is shared by
+   all the maps and is never written. */
+static TreeNode null_node = {
+    .color_ = 1,
+    .interval_ = {NULL, NULL, NULL},
+    .max_ = NULL,
+    .parent_ = &null_node,
+    .left_ = &null_node,
+    .right_ = &null_node
+};
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * @brief Traverse all the tree nodes and clean the allocated resource.
+ *
+ * @param data          The pointer to the map private data
+ */
+void _IntervalMapDeinit(IntervalMapData* data);
+
+/**
+ * @brief Recompute the maximum upper endpoint of the subtree rooted by the
+ * designated node from its children.
+ *
+ * @param data          The pointer to the map private data
+ * @param curr          The pointer to the designated node
+ */
+void _IntervalMapUpdateMax(IntervalMapData* data, TreeNode* curr);
+
+/**
+ * @brief Perform right rotation starting at the designated node and maintain
+ * the subtree maximum endpoints.
+ *
+ * @param data          The pointer to the map private data
+ * @param curr          The pointer to the designated node
+ */
+void _IntervalMapRightRotate(IntervalMapData* data, TreeNode* curr);
+
+/**
+ * @brief Perform left rotation starting at the designated node and maintain
+ * the subtree maximum endpoints.
+ *
+ * @param data          The pointer to the map private data
+ * @param curr          The pointer to the designated node
+ */
+void _IntervalMapLeftRotate(IntervalMapData* data, TreeNode* curr);
+
+/**
+ * @brief Maintain the red black tree property after node insertion. The cases
+ * follow _TreeMapInsertFixup.
+ *
+ * @param data          The pointer to the map private data
+ * @param curr          The pointer to the newly inserted node
+ */
+void _IntervalMapInsertFixup(IntervalMapData* data, TreeNode* curr);
+
+/**
+ * @brief Maintain the red black tree property after node deletion. The cases
+ * follow _TreeMapDeleteFixup.
+ *
+ * @param data          The pointer to the map private data
+ * @param curr          The pointer to the node replacing the deleted one
+ * @param parent        The pointer to the parent of the replacing node
+ */
+void _IntervalMapDeleteFixup(IntervalMapData* data, TreeNode* curr,
+                             TreeNode* parent);
+
+/**
+ * @brief Get the node which stores the designated interval.
+ *
+ * @param data          The pointer to the map private data
+ * @param low           The inclusive lower endpoint
+ * @param high          The exclusive upper endpoint
+ *
+ * @retval node         The target node
+ * @retval null         The interval cannot be found
+ */
+TreeNode* _IntervalMapSearch(IntervalMapData* data, void* low, void* high);
+
+/**
+ * @brief Report the intervals of the subtree which overlap the query in
+ * ascending order.
+ *
+ * @param data          The pointer to the map private data
+ * @param curr          The pointer to the subtree root
+ * @param low           The inclusive lower endpoint of the query
+ * @param high          The upper endpoint of the query
+ * @param closed        Whether the upper endpoint of the query is inclusive
+ * @param func          The visitor for each reported interval
+ * @param arg           The argument passed to the visitor
+ *
+ * @retval true         All the matched intervals are reported
+ * @retval false        The visitor stops the query
+ */
+bool _IntervalMapOverlap(IntervalMapData* data, TreeNode* curr, void* low,
+                         void* high, bool closed, IntervalMapVisit func,
+                         void* arg);
+
+/**
+ * @brief The default endpoint comparison function.
+ *
+ * @param lhs           The source endpoint
+ * @param rhs           The target endpoint
+ *
+ * @retval  1           The source endpoint should go after the target one.
+ * @retval  0           The source endpoint is equal to the target one.
+ * @retval -1           The source endpoint should go before the target one.
+ */
+int _IntervalMapCompare(void* lhs, void* rhs);
+
+static inline
+int ORDER(IntervalMapCompare func_cmp, void* low, void* high, Interval* rhs)
+{
+    int order = func_cmp(low, rhs->low);
+    return (order != 0)? order : func_cmp(high, rhs->high);
+}
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+IntervalMap* IntervalMapInit()
+{
+    IntervalMap* obj = (IntervalMap*)malloc(sizeof(IntervalMap));
+    if (unlikely(!obj))
+        return NULL;
+
+    IntervalMapData* data = (IntervalMapData*)malloc(sizeof(IntervalMapData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    data->size_ = 0;
+    data->null_ = &null_node;
+    data->root_ = &null_node;
+    data->func_cmp_ = _IntervalMapCompare;
+    data->func_clean_val_ = NULL;
+
+    obj->data = data;
+    obj->put = IntervalMapPut;
+    obj->get = IntervalMapGet;
+    obj->find = IntervalMapFind;
+    obj->remove = IntervalMapRemove;
+    obj->size = IntervalMapSize;
+    obj->stab = IntervalMapStab;
+    obj->overlap = IntervalMapOverlap;
+    obj->set_compare = IntervalMapSetCompare;
+    obj->set_clean_value = IntervalMapSetCleanValue;
+
+    return obj;
+}
+
+void IntervalMapDeinit(IntervalMap* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    IntervalMapData* data = obj->data;
+    _IntervalMapDeinit(data);
+
+    free(data);
+    free(obj);
+    return;
+}
+
+bool IntervalMapPut(IntervalMap* self, void* low, void* high, void* value)
+{
+    IntervalMapData* data = self->data;
+    IntervalMapCompare func_cmp = data->func_cmp_;
+    if (func_cmp(low, high) > 0)
+        return false;
+
+    TreeNode* null = data->null_;
+    TreeNode* parent = null;
+    TreeNode* curr = data->root_;
+    int order = 0;
+    while (curr != null) {
+        parent = curr;
+        order = ORDER(func_cmp, low, high, &(curr->interval_));
+        if (order > 0)
+            curr = curr->right_;
+        else if (order < 0)
+            curr = curr->left_;
+        else {
+            /* Conflict with the already stored interval. */
+            if (data->func_clean_val_)
+                data->func_clean_val_(curr->interval_.value);
+            curr->interval_.value = value;
+            return true;
+        }
+    }
+
+    /* Arrive at the proper position. */
+    TreeNode* node = (TreeNode*)malloc(sizeof(TreeNode));
+    if (unlikely(!node))
+        return false;
+
+    node->interval_.low = low;
+    node->interval_.high = high;
+    node->interval_.value = value;
+    node->max_ = high;
+    node->color_ = COLOR_RED;
+    node->left_ = null;
+    node->right_ = null;
+    node->parent_ = parent;
+    if (parent != null) {
+        if (order < 0)
+            parent->left_ = node;
+        else
+            parent->right_ = node;
+    } else
+        data->root_ = node;
+
+    data->size_++;
+
+    /* Propagate the new upper endpoint to the ancestors. */
+    while (parent != null && func_cmp(high, parent->max_) > 0) {
+        parent->max_ = high;
+        parent = parent->parent_;
+    }
+
+    /* Maintain the red black tree structure. */
+    _IntervalMapInsertFixup(data, node);
+
+    return true;
+}
+
+void* IntervalMapGet(IntervalMap* self, void* low, void* high)
+{
+    TreeNode* node = _IntervalMapSearch(self->data, low, high);
+    if (node != self->data->null_)
+        return node->interval_.value;
+    return NULL;
+}
+
+bool IntervalMapFind(IntervalMap* self, void* low, void* high)
+{
+    TreeNode* node = _IntervalMapSearch(self->data, low, high);
+    return (node != self->data->null_)? true : false;
+}
+
+bool IntervalMapRemove(IntervalMap* self, void* low, void* high)
+{
+    IntervalMapData* data = self->data;
+    TreeNode* null = data->null_;
+    TreeNode* curr = _IntervalMapSearch(data, low, high);
+    if (curr == null)
+        return false;
+
+    if (data->func_clean_val_)
+        data->func_clean_val_(curr->interval_.value);
+
+    /* If the specified node has two children, it takes over the interval of
+       its successor, and the successor having at most one child is spliced. */
+    if ((curr->left_ != null) && (curr->right_ != null)) {
+        TreeNode* succ = curr->right_;
+        while (succ->left_ != null)
+            succ = succ->left_;
+        curr->interval_ = succ->interval_;
+        curr = succ;
+    }
+
+    TreeNode* parent = curr->parent_;
+    TreeNode* child = (curr->left_ != null)? curr->left_ : curr->right_;
+    if (child != null)
+        child->parent_ = parent;
+    if (parent != null) {
+        if (curr == parent->left_)
+            parent->left_ = child;
+        else
+            parent->right_ = child;
+    } else
+        data->root_ = child;
+
+    data->size_--;
+
+    /* Refresh the maximum endpoints along the path before the rotations. This
+       also covers the node taking over the successor's interval. */
+    TreeNode* anc = parent;
+    while (anc != null) {
+        _IntervalMapUpdateMax(data, anc);
+        anc = anc->parent_;
+    }
+
+    /* Maintain the red black tree structure. */
+    if (curr->color_ == COLOR_BLACK)
+        _IntervalMapDeleteFixup(data, child, parent);
+
+    free(curr);
+    return true;
+}
+
+unsigned IntervalMapSize(IntervalMap* self)
+{
+    return self->data->size_;
+}
+
+bool IntervalMapStab(IntervalMap* self, void* point, IntervalMapVisit func,
+                     void* arg)
+{
+    /* Stabbing at p is the overlap query with the closed interval [p, p]. */
+    IntervalMapData* data = self->data;
+    return _IntervalMapOverlap(data, data->root_, point, point, true, func,
+                               arg);
+}
+
+bool IntervalMapOverlap(IntervalMap* self, void* low, void* high,
+                        IntervalMapVisit func, void* arg)
+{
+    IntervalMapData* data = self->data;
+    return _IntervalMapOverlap(data, data->root_, low, high, false, func, arg);
+}
+
+void IntervalMapSetCompare(IntervalMap* self, IntervalMapCompare func)
+{
+    self->data->func_cmp_ = func;
+}
+
+void IntervalMapSetCleanValue(IntervalMap* self, IntervalMapCleanValue func)
+{
+    self->data->func_clean_val_ = func;
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+void _IntervalMapDeinit(IntervalMapData* data)
+{
+    TreeNode* null = data->null_;
+    IntervalMapCleanValue func_clean_val = data->func_clean_val_;
+
+    /* Flatten the tree with right rotations so that every node is released
+       once its left subtree becomes empty. */
+    TreeNode* curr = data->root_;
+    while (curr != null) {
+        if (curr->left_ != null) {
+            TreeNode* child = curr->left_;
+            curr->left_ = child->right_;
+            child->right_ = curr;
+            curr = child;
+            continue;
+        }
+
+        TreeNode* temp = curr;
+        curr = curr->right_;
+        if (func_clean_val)
+            func_clean_val(temp->interval_.value);
+        free(temp);
+    }
+
+    return;
+}
+
+void _IntervalMapUpdateMax(IntervalMapData* data, TreeNode* curr)
+{
+    IntervalMapCompare func_cmp = data->func_cmp_;
+    TreeNode* null = data->null_;
+
+    void* max = curr->interval_.high;
+    if (curr->left_ != null && func_cmp(curr->left_->max_, max) > 0)
+        max = curr->left_->max_;
+    if (curr->right_ != null && func_cmp(curr->right_->max_, max) > 0)
+        max = curr->right_->max_;
+    curr->max_ = max;
+}
+
+void _IntervalMapRightRotate(IntervalMapData* data, TreeNode* curr)
+{
+    TreeNode* null = data->null_;
+    TreeNode* child = curr->left_;
+
+    curr->left_ = child->right_;
+    if (child->right_ != null)
+        child->right_->parent_ = curr;
+
+    child->parent_ = curr->parent_;
+    if (curr->parent_ != null) {
+        if (curr == curr->parent_->left_)
+            curr->parent_->left_ = child;
+        else
+            curr->parent_->right_ = child;
+    } else
+        data->root_ = child;
+
+    curr->parent_ = child;
+    child->right_ = curr;
+
+    /* The child now roots the subtree previously rooted by the current node. */
+    child->max_ = curr->max_;
+    _IntervalMapUpdateMax(data, curr);
+
+    return;
+}
+
+void _IntervalMapLeftRotate(IntervalMapData* data, TreeNode* curr)
+{
+    TreeNode* null = data->null_;
+    TreeNode* child = curr->right_;
+
+    curr->right_ = child->left_;
+    if (child->left_ != null)
+        child->left_->parent_ = curr;
+
+    child->parent_ = curr->parent_;
+    if (curr->parent_ != null) {
+        if (curr == curr->parent_->left_)
+            curr->parent_->left_ = child;
+        else
+            curr->parent_->right_ = child;
+    } else
+        data->root_ = child;
+
+    curr->parent_ = child;
+    child->left_ = curr;
+
+    /* The child now roots the subtree previously rooted by the current node. */
+    child->max_ = curr->max_;
+    _IntervalMapUpdateMax(data, curr);
+
+    return;
+}
+
+void _IntervalMapInsertFixup(IntervalMapData* data, TreeNode* curr)
+{
+    TreeNode* uncle;
+
+    while (curr->parent_->color_ == COLOR_RED) {
+        TreeNode* parent = curr->parent_;
+        TreeNode* grand = parent->parent_;
+        if (parent == grand->left_) {
+            uncle = grand->right_;
+            /* Case 1: Recolor and move up. */
+            if (uncle->color_ == COLOR_RED) {
+                parent->color_ = COLOR_BLACK;
+                uncle->color_ = COLOR_BLACK;
+                grand->color_ = COLOR_RED;
+                curr = grand;
+            } else {
+                /* Case 2: Turn into case 3 with a left rotation. */
+                if (curr == parent->right_) {
+                    curr = parent;
+                    _IntervalMapLeftRotate(data, curr);
+                }
+                /* Case 3: Recolor and rotate the grandparent. */
+                curr->parent_->color_ = COLOR_BLACK;
+                curr->parent_->parent_->color_ = COLOR_RED;
+                _IntervalMapRightRotate(data, curr->parent_->parent_);
+            }
+        } else {
+            uncle = grand->left_;
+            if (uncle->color_ == COLOR_RED) {
+                parent->color_ = COLOR_BLACK;
+                uncle->color_ = COLOR_BLACK;
+                grand->color_ = COLOR_RED;
+                curr = grand;
+            } else {
+                if (curr == parent->left_) {
+                    curr = parent;
+                    _IntervalMapRightRotate(data, curr);
+                }
+                curr->parent_->color_ = COLOR_BLACK;
+                curr->parent_->parent_->color_ = COLOR_RED;
+                _IntervalMapLeftRotate(data, curr->parent_->parent_);
+            }
+        }
+    }
+
+    data->root_->color_ = COLOR_BLACK;
+    return;
+}
+
+void _IntervalMapDeleteFixup(IntervalMapData* data, TreeNode* curr,
+                             TreeNode* parent)
+{
+    TreeNode* brother;
+
+    while ((curr != data->root_) && (curr->color_ == COLOR_BLACK)) {
+        if (curr == parent->left_) {
+            brother = parent->right_;
+            /* Case 1: Turn the red brother into a black one. */
+            if (brother->color_ == COLOR_RED) {
+                brother->color_ = COLOR_BLACK;
+                parent->color_ = COLOR_RED;
+                _IntervalMapLeftRotate(data, parent);
+                brother = parent->right_;
+            }
+            /* Case 2: Recolor the brother and move up. */
+            if ((brother->left_->color_ == COLOR_BLACK) &&
+                (brother->right_->color_ == COLOR_BLACK)) {
+                brother->color_ = COLOR_RED;
+                curr = parent;
+                parent = curr->parent_;
+            } else {
+                /* Case 3: Turn into case 4 with a right rotation. */
+                if (brother->right_->color_ == COLOR_BLACK) {
+                    brother->left_->color_ = COLOR_BLACK;
+                    brother->color_ = COLOR_RED;
+                    _IntervalMapRightRotate(data, brother);
+                    brother = parent->right_;
+                }
+                /* Case 4: Recolor and rotate the parent. */
+                brother->color_ = parent->color_;
+                parent->color_ = COLOR_BLACK;
+                brother->right_->color_ = COLOR_BLACK;
+                _IntervalMapLeftRotate(data, parent);
+                curr = data->root_;
+            }
+        } else {
+            brother = parent->left_;
+            if (brother->color_ == COLOR_RED) {
+                brother->color_ = COLOR_BLACK;
+                parent->color_ = COLOR_RED;
+                _IntervalMapRightRotate(data, parent);
+                brother = parent->left_;
+            }
+            if ((brother->left_->color_ == COLOR_BLACK) &&
+                (brother->right_->color_ == COLOR_BLACK)) {
+                brother->color_ = COLOR_RED;
+                curr = parent;
+                parent = curr->parent_;
+            } else {
+                if (brother->left_->color_ == COLOR_BLACK) {
+                    brother->right_->color_ = COLOR_BLACK;
+                    brother->color_ = COLOR_RED;
+                    _IntervalMapLeftRotate(data, brother);
+                    brother = parent->left_;
+                }
+                brother->color_ = parent->color_;
+                parent->color_ = COLOR_BLACK;
+                brother->left_->color_ = COLOR_BLACK;
+                _IntervalMapRightRotate(data, parent);
+                curr = data->root_;
+            }
+        }
+    }
+
+    if (curr != data->null_)
+        curr->color_ = COLOR_BLACK;
+    return;
+}
+
+TreeNode* _IntervalMapSearch(IntervalMapData* data, void* low, void* high)
+{
+    IntervalMapCompare func_cmp = data->func_cmp_;
+    TreeNode* null = data->null_;
+    TreeNode* curr = data->root_;
+    while (curr != null) {
+        int order = ORDER(func_cmp, low, high, &(curr->interval_));
+        if (order == 0)
+            break;
+        curr = (order > 0)? curr->right_ : curr->left_;
+    }
+    return curr;
+}
+
+bool _IntervalMapOverlap(IntervalMapData* data, TreeNode* curr, void* low,
+                         void* high, bool closed, IntervalMapVisit func,
+                         void* arg)
+{
+    IntervalMapCompare func_cmp = data->func_cmp_;
+    TreeNode* null = data->null_;
+
+    /* Recurse into the left subtree and loop along the right one. */
+    while (curr != null) {
+        /* No interval in this subtree ends after the query begins. */
+        if (func_cmp(curr->max_, low) <= 0)
+            return true;
+
+        if (!_IntervalMapOverlap(data, curr->left_, low, high, closed, func,
+                                 arg))
+            return false;
+
+        /* The current interval and the right subtree begin too late. */
+        int order = func_cmp(curr->interval_.low, high);
+        if (order > 0 || (order == 0 && !closed))
+            return true;
+
+        if (func_cmp(curr->interval_.high, low) > 0 &&
+            !func(&(curr->interval_), arg))
+            return false;
+
+        curr = curr->right_;
+    }
+
+    return true;
+}
+
+int _IntervalMapCompare(void* lhs, void* rhs)
+{
+    if ((intptr_t)lhs == (intptr_t)rhs)
+        return 0;
+    return ((intptr_t)lhs >= (intptr_t)rhs)? 1 : (-1);
+}
@@ -0,0 +1,679 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+#include "container/persistent_tree_map.h"
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+static const unsigned SLACK_RESERVE = 3;
+
+
+typedef struct _Entry {
+    unsigned refs_;
+    Pair pair_;
+} Entry;
+
+typedef struct _TreeNode {
+    unsigned refs_;
+    unsigned height_;
+    void* key_;
+    Entry* entry_;
+    struct _TreeNode* left_;
+    struct _TreeNode* right_;
+} TreeNode;
+
+struct _TreeSnapshot {
+    unsigned size_;
+    TreeNode* root_;
+    PersistentTreeMapCompare func_cmp_;
+    PersistentTreeMapCleanKey func_clean_key_;
+    PersistentTreeMapCleanValue func_clean_val_;
+};
+
+struct _PersistentTreeMapData {
+    unsigned size_;
+    unsigned num_spare_;
+    TreeNode* root_;
+    TreeNode* spare_;
+    Entry* spare_entry_;
+    PersistentTreeMapCompare func_cmp_;
+    PersistentTreeMapCleanKey func_clean_key_;
+    PersistentTreeMapCleanValue func_clean_val_;
+};
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * @brief Drop one reference of the designated subtree. The nodes and the pairs
+ * no longer referred by any version are released.
+ *
+ * @param curr          The pointer to the subtree root
+ * @param func_clean_key The key cleanup function
+ * @param func_clean_val The value cleanup function
+ */
+void _PersistentTreeMapRelease(TreeNode* curr,
+                               PersistentTreeMapCleanKey func_clean_key,
+                               PersistentTreeMapCleanValue func_clean_val);
+
+/**
+ * @brief Prepare enough spare nodes and entry so that the update never fails
+ * halfway through path copying.
+ *
+ * @param data          The pointer to the map private data
+ *
+ * @retval true         The spare resource is ready
+ * @retval false        Insufficient memory
+ */
+bool _PersistentTreeMapReserve(PersistentTreeMapData* data);
+
+/**
+ * @brief Insert the key value pair into the designated subtree.
+ *
+ * The function consumes the caller's reference to the subtree and returns the
+ * reference to the updated subtree.
+ *
+ * @param data          The pointer to the map private data
+ * @param curr          The pointer to the subtree root
+ * @param key           The designated key
+ * @param value         The designated value
+ *
+ * @retval node         The updated subtree root
+ */
+TreeNode* _PersistentTreeMapInsert(PersistentTreeMapData* data, TreeNode* curr,
+                                   void* key, void* value);
+
+/**
+ * @brief Remove the pair with the designated key from the subtree. The key
+ * should exist in the subtree.
+ *
+ * The function consumes the caller's reference to the subtree and returns the
+ * reference to the updated subtree.
+ *
+ * @param data          The pointer to the map private data
+ * @param curr          The pointer to the subtree root
+ * @param key           The designated key
+ *
+ * @retval node         The updated subtree root
+ * @retval NULL         The subtree becomes empty
+ */
+TreeNode* _PersistentTreeMapDelete(PersistentTreeMapData* data, TreeNode* curr,
+                                   void* key);
+
+/**
+ * @brief Detach the node with the minimum key from the subtree and hand over
+ * its key and entry.
+ *
+ * @param data          The pointer to the map private data
+ * @param curr          The pointer to the subtree root
+ * @param p_key         The pointer to the returned key
+ * @param p_entry       The pointer to the returned entry
+ *
+ * @retval node         The updated subtree root
+ * @retval NULL         The subtree becomes empty
+ */
+TreeNode* _PersistentTreeMapDeleteMin(PersistentTreeMapData* data,
+                                      TreeNode* curr, void** p_key,
+                                      Entry** p_entry);
+
+/**
+ * @brief Get the node which stores the key having the same order with the
+ * designated one.
+ *
+ * @param curr          The pointer to the subtree root
+ * @param key           The designated key
+ * @param func_cmp      The key comparison function
+ *
+ * @retval node         The target node
+ * @retval NULL         The key cannot be found
+ */
+TreeNode* _PersistentTreeMapSearch(TreeNode* curr, void* key,
+                                   PersistentTreeMapCompare func_cmp);
+
+/**
+ * @brief Visit the pairs of the subtree in ascending key order.
+ *
+ * @param curr          The pointer to the subtree root
+ * @param func          The visitor function
+ * @param arg           The argument passed to the visitor
+ *
+ * @retval true         All the pairs are visited
+ * @retval false        The visitor stops the traversal
+ */
+bool _PersistentTreeMapForEach(TreeNode* curr, TreeSnapshotVisit func,
+                               void* arg);
+
+/**
+ * @brief The default key comparison function.
+ *
+ * @param lhs           The source key
+ * @param rhs           The target key
+ *
+ * @retval  1           The source key should go after the target one.
+ * @retval  0           The source key is equal to the target one.
+ * @retval -1           The source key should go before the target one.
+ */
+int _PersistentTreeMapCompare(void* lhs, void* rhs);
+
+static inline
+unsigned HEIGHT(TreeNode* node)
+{
+    return (node)? node->height_ : 0;
+}
+
+static inline
+void UPDATE_HEIGHT(TreeNode* node)
+{
+    unsigned left = HEIGHT(node->left_);
+    unsigned right = HEIGHT(node->right_);
+    node->height_ = ((left > right)? left : right) + 1;
+}
+
+static inline
+void ACQUIRE(TreeNode* node)
+{
+    if (node)
+        __atomic_add_fetch(&node->refs_, 1, __ATOMIC_RELAXED);
+}
+
+static inline
+void RELEASE_ENTRY(Entry* entry, PersistentTreeMapCleanKey func_clean_key,
+                   PersistentTreeMapCleanValue func_clean_val)
+{
+    if (!entry || __atomic_sub_fetch(&entry->refs_, 1, __ATOMIC_ACQ_REL) != 0)
+        return;
+
+    if (func_clean_key)
+        func_clean_key(entry->pair_.key);
+    if (func_clean_val)
+        func_clean_val(entry->pair_.value);
+    free(entry);
+}
+
+static inline
+TreeNode* TAKE_SPARE(PersistentTreeMapData* data)
+{
+    TreeNode* node = data->spare_;
+    data->spare_ = node->left_;
+    data->num_spare_--;
+    return node;
+}
+
+/**
+ * @brief Return the node which can be updated in place. The node exclusively
+ * owned by the current version is returned directly. Otherwise, the node is
+ * copied and the copy shares the children and the entry with the original.
+ */
+static inline
+TreeNode* MUTABLE(PersistentTreeMapData* data, TreeNode* node)
+{
+    if (__atomic_load_n(&node->refs_, __ATOMIC_ACQUIRE) == 1)
+        return node;
+
+    TreeNode* copy = TAKE_SPARE(data);
+    copy->refs_ = 1;
+    copy->height_ = node->height_;
+    copy->key_ = node->key_;
+    copy->entry_ = node->entry_;
+    copy->left_ = node->left_;
+    copy->right_ = node->right_;
+    __atomic_add_fetch(&copy->entry_->refs_, 1, __ATOMIC_RELAXED);
+    ACQUIRE(copy->left_);
+    ACQUIRE(copy->right_);
+
+    /* Another version may drop its reference concurrently, so the original is
+       released through the general path. */
+    _PersistentTreeMapRelease(node, data->func_clean_key_,
+                              data->func_clean_val_);
+    return copy;
+}
+
+static inline
+TreeNode* ROTATE_RIGHT(PersistentTreeMapData* data, TreeNode* node)
+{
+    TreeNode* left = MUTABLE(data, node->left_);
+    node->left_ = left->right_;
+    left->right_ = node;
+    UPDATE_HEIGHT(node);
+    UPDATE_HEIGHT(left);
+    return left;
+}
+
+static inline
+TreeNode* ROTATE_LEFT(PersistentTreeMapData* data, TreeNode* node)
+{
+    TreeNode* right = MUTABLE(data, node->right_);
+    node->right_ = right->left_;
+    right->left_ = node;
+    UPDATE_HEIGHT(node);
+    UPDATE_HEIGHT(right);
+    return right;
+}
+
+/**
+ * @brief Restore the AVL balance of the mutable node whose subtree heights
+ * differ by at most two.
+ */
+static inline
+TreeNode* BALANCE(PersistentTreeMapData* data, TreeNode* node)
+{
+    unsigned left = HEIGHT(node->left_);
+    unsigned right = HEIGHT(node->right_);
+
+    if (left > right + 1) {
+        TreeNode* child = node->left_;
+        if (HEIGHT(child->left_) < HEIGHT(child->right_)) {
+            child = MUTABLE(data, child);
+            node->left_ = ROTATE_LEFT(data, child);
+        }
+        return ROTATE_RIGHT(data, node);
+    }
+
+    if (right > left + 1) {
+        TreeNode* child = node->right_;
+        if (HEIGHT(child->right_) < HEIGHT(child->left_)) {
+            child = MUTABLE(data, child);
+            node->right_ = ROTATE_RIGHT(data, child);
+        }
+        return ROTATE_LEFT(data, node);
+    }
+
+    node->height_ = ((left > right)? left : right) + 1;
+    return node;
+}
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+PersistentTreeMap* PersistentTreeMapInit()
+{
+    PersistentTreeMap* obj =
+        (PersistentTreeMap*)malloc(sizeof(PersistentTreeMap));
+    if (unlikely(!obj))
+        return NULL;
+
+    PersistentTreeMapData* data =
+        (PersistentTreeMapData*)malloc(sizeof(PersistentTreeMapData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    data->size_ = 0;
+    data->num_spare_ = 0;
+    data->root_ = NULL;
+    data->spare_ = NULL;
+    data->spare_entry_ = NULL;
+    data->func_cmp_ = _PersistentTreeMapCompare;
+    data->func_clean_key_ = NULL;
+    data->func_clean_val_ = NULL;
+
+    obj->data = data;
+    obj->put = PersistentTreeMapPut;
+    obj->get = PersistentTreeMapGet;
+    obj->find = PersistentTreeMapFind;
+    obj->remove = PersistentTreeMapRemove;
+    obj->size = PersistentTreeMapSize;
+    obj->minimum = PersistentTreeMapMinimum;
+    obj->maximum = PersistentTreeMapMaximum;
+    obj->snapshot = PersistentTreeMapSnapshot;
+    obj->set_compare = PersistentTreeMapSetCompare;
+    obj->set_clean_key = PersistentTreeMapSetCleanKey;
+    obj->set_clean_value = PersistentTreeMapSetCleanValue;
+
+    return obj;
+}
+
+void PersistentTreeMapDeinit(PersistentTreeMap* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    PersistentTreeMapData* data = obj->data;
+    _PersistentTreeMapRelease(data->root_, data->func_clean_key_,
+                              data->func_clean_val_);
+
+    while (data->spare_)
+        free(TAKE_SPARE(data));
+    free(data->spare_entry_);
+
+    free(data);
+    free(obj);
+    return;
+}
+
+bool PersistentTreeMapPut(PersistentTreeMap* self, void* key, void* value)
+{
+    PersistentTreeMapData* data = self->data;
+    if (unlikely(!_PersistentTreeMapReserve(data)))
+        return false;
+
+    data->root_ = _PersistentTreeMapInsert(data, data->root_, key, value);
+    return true;
+}
+
+void* PersistentTreeMapGet(PersistentTreeMap* self, void* key)
+{
+    PersistentTreeMapData* data = self->data;
+    TreeNode* node = _PersistentTreeMapSearch(data->root_, key, data->func_cmp_);
+    return (node)? node->entry_->pair_.value : NULL;
+}
+
+bool PersistentTreeMapFind(PersistentTreeMap* self, void* key)
+{
+    PersistentTreeMapData* data = self->data;
+    TreeNode* node = _PersistentTreeMapSearch(data->root_, key, data->func_cmp_);
+    return (node)? true : false;
+}
+
+bool PersistentTreeMapRemove(PersistentTreeMap* self, void* key)
+{
+    /* Search first so that the absent key copies nothing. */
+    PersistentTreeMapData* data = self->data;
+    if (!_PersistentTreeMapSearch(data->root_, key, data->func_cmp_))
+        return false;
+    if (unlikely(!_PersistentTreeMapReserve(data)))
+        return false;
+
+    data->root_ = _PersistentTreeMapDelete(data, data->root_, key);
+    data->size_--;
+    return true;
+}
+
+unsigned PersistentTreeMapSize(PersistentTreeMap* self)
+{
+    return self->data->size_;
+}
+
+Pair* PersistentTreeMapMinimum(PersistentTreeMap* self)
+{
+    TreeNode* curr = self->data->root_;
+    if (!curr)
+        return NULL;
+    while (curr->left_)
+        curr = curr->left_;
+    return &(curr->entry_->pair_);
+}
+
+Pair* PersistentTreeMapMaximum(PersistentTreeMap* self)
+{
+    TreeNode* curr = self->data->root_;
+    if (!curr)
+        return NULL;
+    while (curr->right_)
+        curr = curr->right_;
+    return &(curr->entry_->pair_);
+}
+
+TreeSnapshot* PersistentTreeMapSnapshot(PersistentTreeMap* self)
+{
+    TreeSnapshot* snap = (TreeSnapshot*)malloc(sizeof(TreeSnapshot));
+    if (unlikely(!snap))
+        return NULL;
+
+    PersistentTreeMapData* data = self->data;
+    snap->size_ = data->size_;
+    snap->root_ = data->root_;
+    snap->func_cmp_ = data->func_cmp_;
+    snap->func_clean_key_ = data->func_clean_key_;
+    snap->func_clean_val_ = data->func_clean_val_;
+    ACQUIRE(snap->root_);
+
+    return snap;
+}
+
+void PersistentTreeMapSetCompare(PersistentTreeMap* self,
+                                 PersistentTreeMapCompare func)
+{
+    self->data->func_cmp_ = func;
+}
+
+void PersistentTreeMapSetCleanKey(PersistentTreeMap* self,
+                                  PersistentTreeMapCleanKey func)
+{
+    self->data->func_clean_key_ = func;
+}
+
+void PersistentTreeMapSetCleanValue(PersistentTreeMap* self,
+                                    PersistentTreeMapCleanValue func)
+{
+    self->data->func_clean_val_ = func;
+}
+
+
+/*===========================================================================*
+ *               Implementation for the snapshot operations                  *
+ *===========================================================================*/
+void TreeSnapshotRelease(TreeSnapshot* snap)
+{
+    if (unlikely(!snap))
+        return;
+
+    _PersistentTreeMapRelease(snap->root_, snap->func_clean_key_,
+                              snap->func_clean_val_);
+    free(snap);
+}
+
+void* TreeSnapshotGet(TreeSnapshot* snap, void* key)
+{
+    TreeNode* node = _PersistentTreeMapSearch(snap->root_, key, snap->func_cmp_);
+    return (node)? node->entry_->pair_.value : NULL;
+}
+
+bool TreeSnapshotFind(TreeSnapshot* snap, void* key)
+{
+    TreeNode* node = _PersistentTreeMapSearch(snap->root_, key, snap->func_cmp_);
+    return (node)? true : false;
+}
+
+unsigned TreeSnapshotSize(TreeSnapshot* snap)
+{
+    return snap->size_;
+}
+
+bool TreeSnapshotForEach(TreeSnapshot* snap, TreeSnapshotVisit func, void* arg)
+{
+    return _PersistentTreeMapForEach(snap->root_, func, arg);
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+void _PersistentTreeMapRelease(TreeNode* curr,
+                               PersistentTreeMapCleanKey func_clean_key,
+                               PersistentTreeMapCleanValue func_clean_val)
+{
+    /* Recurse into the left subtree and loop along the right one. */
+    while (curr &&
+           __atomic_sub_fetch(&curr->refs_, 1, __ATOMIC_ACQ_REL) == 0) {
+        _PersistentTreeMapRelease(curr->left_, func_clean_key, func_clean_val);
+        RELEASE_ENTRY(curr->entry_, func_clean_key, func_clean_val);
+        TreeNode* right = curr->right_;
+        free(curr);
+        curr = right;
+    }
+}
+
+bool _PersistentTreeMapReserve(PersistentTreeMapData* data)
+{
+    /* Each level may copy the node on the path and, for double rotation, two
+       more nodes. Plus one node and one entry for the new pair. */
+    unsigned need = SLACK_RESERVE * (HEIGHT(data->root_) + 1) + 1;
+    while (data->num_spare_ < need) {
+        TreeNode* node = (TreeNode*)malloc(sizeof(TreeNode));
+        if (unlikely(!node))
+            return false;
+        node->left_ = data->spare_;
+        data->spare_ = node;
+        data->num_spare_++;
+    }
+
+    if (!data->spare_entry_) {
+        data->spare_entry_ = (Entry*)malloc(sizeof(Entry));
+        if (unlikely(!data->spare_entry_))
+            return false;
+    }
+    return true;
+}
+
+TreeNode* _PersistentTreeMapInsert(PersistentTreeMapData* data, TreeNode* curr,
+                                   void* key, void* value)
+{
+    if (!curr) {
+        Entry* entry = data->spare_entry_;
+        data->spare_entry_ = NULL;
+        entry->refs_ = 1;
+        entry->pair_.key = key;
+        entry->pair_.value = value;
+
+        TreeNode* node = TAKE_SPARE(data);
+        node->refs_ = 1;
+        node->height_ = 1;
+        node->key_ = key;
+        node->entry_ = entry;
+        node->left_ = NULL;
+        node->right_ = NULL;
+        data->size_++;
+        return node;
+    }
+
+    TreeNode* node = MUTABLE(data, curr);
+    int order = data->func_cmp_(key, node->key_);
+    if (order < 0)
+        node->left_ = _PersistentTreeMapInsert(data, node->left_, key, value);
+    else if (order > 0)
+        node->right_ = _PersistentTreeMapInsert(data, node->right_, key, value);
+    else {
+        /* Replace the pair in place if no other version refers to it. */
+        Entry* entry = node->entry_;
+        if (__atomic_load_n(&entry->refs_, __ATOMIC_ACQUIRE) == 1) {
+            if (data->func_clean_key_)
+                data->func_clean_key_(entry->pair_.key);
+            if (data->func_clean_val_)
+                data->func_clean_val_(entry->pair_.value);
+        } else {
+            RELEASE_ENTRY(entry, data->func_clean_key_, data->func_clean_val_);
+            entry = data->spare_entry_;
+            data->spare_entry_ = NULL;
+            entry->refs_ = 1;
+            node->entry_ = entry;
+        }
+        entry->pair_.key = key;
+        entry->pair_.value = value;
+        node->key_ = key;
+        return node;
+    }
+
+    return BALANCE(data, node);
+}
+
+TreeNode* _PersistentTreeMapDelete(PersistentTreeMapData* data, TreeNode* curr,
+                                   void* key)
+{
+    TreeNode* node = MUTABLE(data, curr);
+    int order = data->func_cmp_(key, node->key_);
+    if (order < 0)
+        node->left_ = _PersistentTreeMapDelete(data, node->left_, key);
+    else if (order > 0)
+        node->right_ = _PersistentTreeMapDelete(data, node->right_, key);
+    else {
+        /* Replace the node by its only child. */
+        if (!node->left_ || !node->right_) {
+            TreeNode* child = (node->left_)? node->left_ : node->right_;
+            node->left_ = NULL;
+            node->right_ = NULL;
+            _PersistentTreeMapRelease(node, data->func_clean_key_,
+                                      data->func_clean_val_);
+            return child;
+        }
+
+        /* Take over the key and the entry of the successor. */
+        void* succ_key;
+        Entry* succ_entry;
+        node->right_ = _PersistentTreeMapDeleteMin(data, node->right_,
+                                                   &succ_key, &succ_entry);
+        RELEASE_ENTRY(node->entry_, data->func_clean_key_,
+                      data->func_clean_val_);
+        node->key_ = succ_key;
+        node->entry_ = succ_entry;
+    }
+
+    return BALANCE(data, node);
+}
+
+TreeNode* _PersistentTreeMapDeleteMin(PersistentTreeMapData* data,
+                                      TreeNode* curr, void** p_key,
+                                      Entry** p_entry)
+{
+    TreeNode* node = MUTABLE(data, curr);
+    if (!node->left_) {
+        TreeNode* child = node->right_;
+        *p_key = node->key_;
+        *p_entry = node->entry_;
+        free(node);
+        return child;
+    }
+
+    node->left_ = _PersistentTreeMapDeleteMin(data, node->left_, p_key, p_entry);
+    return BALANCE(data, node);
+}
+
+TreeNode* _PersistentTreeMapSearch(TreeNode* curr, void* key,
+                                   PersistentTreeMapCompare func_cmp)
+{
+    while (curr) {
+        int order = func_cmp(key, curr->key_);
+        if (order == 0)
+            break;
+        curr = (order > 0)? curr->right_ : curr->left_;
+    }
+    return curr;
+}
+
+bool _PersistentTreeMapForEach(TreeNode* curr, TreeSnapshotVisit func,
+                               void* arg)
+{
+    while (curr) {
+        if (!_PersistentTreeMapForEach(curr->left_, func, arg))
+            return false;
+        if (!func(&(curr->entry_->pair_), arg))
+            return false;
+        curr = curr->right_;
+    }
+    return true;
+}
+
+int _PersistentTreeMapCompare(void* lhs, void* rhs)
+{
+    if ((intptr_t)lhs == (intptr_t)rhs)
+        return 0;
+    return ((intptr_t)lhs >= (intptr_t)rhs)? 1 : (-1);
+}
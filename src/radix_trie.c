@@ -0,0 +1,1064 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+#include "container/radix_trie.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+static const uint8_t TYPE_NODE4 = 0;
+static const uint8_t TYPE_NODE16 = 1;
+static const uint8_t TYPE_NODE48 = 2;
+static const uint8_t TYPE_NODE256 = 3;
+
+/* The node capacities and the thresholds to shrink a node to a smaller type.
+   The gaps between them avoid flipping types on alternating insert/remove. */
+static const unsigned CAPA_NODE4 = 4;
+static const unsigned CAPA_NODE16 = 16;
+static const unsigned CAPA_NODE48 = 48;
+static const unsigned SHRINK_NODE16 = 3;
+static const unsigned SHRINK_NODE48 = 12;
+static const unsigned SHRINK_NODE256 = 37;
+
+#define MAX_PREFIX      8
+
+
+/* Every inner node starts with this header. The compressed path of a node
+   may be longer than MAX_PREFIX. Only the leading bytes are kept and the
+   rest is recovered from any leaf below the node. */
+typedef struct RadixNode_ {
+    uint8_t type_;
+    uint16_t count_;
+    uint32_t prefix_len_;
+    uint8_t prefix_[MAX_PREFIX];
+} RadixNode;
+
+typedef struct RadixNode4_ {
+    RadixNode base_;
+    uint8_t keys_[4];
+    RadixNode* children_[4];
+} RadixNode4;
+
+typedef struct RadixNode16_ {
+    RadixNode base_;
+    uint8_t keys_[16];
+    RadixNode* children_[16];
+} RadixNode16;
+
+/* The key byte indexes the slot array with the slot number plus one, and
+   zero marks an absent child. */
+typedef struct RadixNode48_ {
+    RadixNode base_;
+    uint8_t slots_[256];
+    RadixNode* children_[48];
+} RadixNode48;
+
+typedef struct RadixNode256_ {
+    RadixNode base_;
+    RadixNode* children_[256];
+} RadixNode256;
+
+/* The leaf keeps the whole string. A child pointer referring to a leaf is
+   tagged with its lowest bit. The terminating null byte takes part in the
+   key so that no stored string is a prefix of another. */
+typedef struct RadixLeaf_ {
+    unsigned len_;
+    char key_[];
+} RadixLeaf;
+
+typedef struct RadixCollect_ {
+    const char** strs_;
+    unsigned size_;
+    unsigned capacity_;
+} RadixCollect;
+
+struct RadixTrieData_ {
+    unsigned size_;
+    RadixNode* root_;
+};
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * @brief Recursively free the subtree rooted by the designated node.
+ *
+ * @param node          The pointer to the subtree root
+ */
+void _RadixTrieDeinit(RadixNode* node);
+
+/**
+ * @brief Return the slot storing the child labeled by the designated byte.
+ *
+ * @param node          The pointer to the inner node
+ * @param byte          The designated byte
+ *
+ * @retval slot         The pointer to the child slot
+ * @retval NULL         No such child
+ */
+RadixNode** _RadixTrieFindChild(RadixNode* node, uint8_t byte);
+
+/**
+ * @brief Return the leftmost leaf below the designated node.
+ *
+ * @param node          The pointer to the inner node or the tagged leaf
+ *
+ * @retval leaf         The leftmost leaf
+ */
+RadixLeaf* _RadixTrieMinimum(RadixNode* node);
+
+/**
+ * @brief Return the number of compressed path bytes of the node that match
+ * the key starting from the designated depth.
+ *
+ * @param node          The pointer to the inner node
+ * @param key           The key
+ * @param len           The key length
+ * @param depth         The depth of the node
+ *
+ * @retval count        The number of matched bytes
+ */
+unsigned _RadixTrieMatch(RadixNode* node, const uint8_t* key, unsigned len,
+                         unsigned depth);
+
+/**
+ * @brief Attach a child to the node and grow the node if it is full.
+ *
+ * @param ref           The slot referring to the node
+ * @param byte          The label of the child
+ * @param child         The pointer to the child
+ *
+ * @retval true         The child is successfully attached
+ * @retval false        Insufficient memory to grow the node
+ */
+bool _RadixTrieAddChild(RadixNode** ref, uint8_t byte, RadixNode* child);
+
+/**
+ * @brief Detach a child from the node and shrink or collapse the node if it
+ * becomes sparse.
+ *
+ * @param ref           The slot referring to the node
+ * @param byte          The label of the child
+ * @param slot          The slot storing the child
+ */
+void _RadixTrieRemoveChild(RadixNode** ref, uint8_t byte, RadixNode** slot);
+
+/**
+ * @brief Insert the key into the subtree.
+ *
+ * @param ref           The slot referring to the subtree root
+ * @param key           The key including its terminating null byte
+ * @param len           The key length
+ * @param depth         The depth of the subtree root
+ * @param p_new         The pointer to the returned flag telling whether the
+ *                      key is newly inserted
+ *
+ * @retval true         The key is successfully inserted or already stored
+ * @retval false        Insufficient memory
+ */
+bool _RadixTrieInsert(RadixNode** ref, const uint8_t* key, unsigned len,
+                      unsigned depth, bool* p_new);
+
+/**
+ * @brief Remove the key from the subtree.
+ *
+ * @param ref           The slot referring to the subtree root
+ * @param key           The key including its terminating null byte
+ * @param len           The key length
+ * @param depth         The depth of the subtree root
+ *
+ * @retval leaf         The detached leaf
+ * @retval NULL         No such key
+ */
+RadixLeaf* _RadixTrieRemove(RadixNode** ref, const uint8_t* key, unsigned len,
+                            unsigned depth);
+
+/**
+ * @brief Return the subtree holding exactly the keys matching the prefix.
+ *
+ * @param data          The pointer to the trie private data
+ * @param prefix        The prefix excluding its terminating null byte
+ * @param len           The prefix length
+ *
+ * @retval node         The subtree root
+ * @retval NULL         No such prefix
+ */
+RadixNode* _RadixTrieSeek(RadixTrieData* data, const uint8_t* prefix, unsigned len);
+
+/**
+ * @brief Append the strings stored in the subtree in lexical order.
+ *
+ * @param node          The pointer to the subtree root
+ * @param collect       The pointer to the string collector
+ *
+ * @retval true         The strings are successfully appended
+ * @retval false        Insufficient memory
+ */
+bool _RadixTrieCollect(RadixNode* node, RadixCollect* collect);
+
+static inline
+bool IS_LEAF(RadixNode* node)
+{
+    return ((uintptr_t)node & 1) != 0;
+}
+
+static inline
+RadixNode* TAG_LEAF(RadixLeaf* leaf)
+{
+    return (RadixNode*)((uintptr_t)leaf | 1);
+}
+
+static inline
+RadixLeaf* UNTAG_LEAF(RadixNode* node)
+{
+    return (RadixLeaf*)((uintptr_t)node & ~(uintptr_t)1);
+}
+
+static inline
+unsigned MIN(unsigned lhs, unsigned rhs)
+{
+    return (lhs < rhs)? lhs : rhs;
+}
+
+static inline
+bool LEAF_MATCH(RadixLeaf* leaf, const uint8_t* key, unsigned len)
+{
+    return leaf->len_ + 1 == len && memcmp(leaf->key_, key, len) == 0;
+}
+
+static inline
+RadixLeaf* NEW_LEAF(const uint8_t* key, unsigned len)
+{
+    RadixLeaf* leaf = (RadixLeaf*)malloc(sizeof(RadixLeaf) + len);
+    if (unlikely(!leaf))
+        return NULL;
+    leaf->len_ = len - 1;
+    memcpy(leaf->key_, key, len);
+    return leaf;
+}
+
+static inline
+RadixNode* NEW_NODE(uint8_t type)
+{
+    size_t size;
+    if (type == TYPE_NODE4)
+        size = sizeof(RadixNode4);
+    else if (type == TYPE_NODE16)
+        size = sizeof(RadixNode16);
+    else if (type == TYPE_NODE48)
+        size = sizeof(RadixNode48);
+    else
+        size = sizeof(RadixNode256);
+
+    RadixNode* node = (RadixNode*)calloc(1, size);
+    if (unlikely(!node))
+        return NULL;
+    node->type_ = type;
+    return node;
+}
+
+static inline
+void COPY_HEADER(RadixNode* dst, RadixNode* src)
+{
+    dst->count_ = src->count_;
+    dst->prefix_len_ = src->prefix_len_;
+    memcpy(dst->prefix_, src->prefix_, MIN(MAX_PREFIX, src->prefix_len_));
+}
+
+/**
+ * @brief Return the position of the designated byte in the sorted keys of a
+ * Node16, or -1 if it is absent.
+ */
+static inline
+int NODE16_FIND(RadixNode16* node, uint8_t byte)
+{
+    unsigned count = node->base_.count_;
+#if defined(__SSE2__)
+    /* Compare all the keys at once. The lanes beyond the count are masked. */
+    __m128i pivot = _mm_set1_epi8((char)byte);
+    __m128i keys = _mm_loadu_si128((const __m128i*)node->keys_);
+    int mask = _mm_movemask_epi8(_mm_cmpeq_epi8(pivot, keys));
+    mask &= (1 << count) - 1;
+    return (mask)? __builtin_ctz(mask) : -1;
+#else
+    unsigned i;
+    for (i = 0 ; i < count ; ++i) {
+        if (node->keys_[i] == byte)
+            return i;
+    }
+    return -1;
+#endif
+}
+
+/**
+ * @brief Return the position to insert the designated byte into the sorted
+ * keys of a Node16.
+ */
+static inline
+unsigned NODE16_LOWER_BOUND(RadixNode16* node, uint8_t byte)
+{
+    unsigned count = node->base_.count_;
+#if defined(__SSE2__)
+    /* SSE2 only offers signed comparison, so the sign bits are flipped to keep
+       the unsigned order. The lanes greater than the byte form a suffix. */
+    const __m128i bias = _mm_set1_epi8((char)0x80);
+    __m128i pivot = _mm_xor_si128(_mm_set1_epi8((char)byte), bias);
+    __m128i keys = _mm_loadu_si128((const __m128i*)node->keys_);
+    keys = _mm_xor_si128(keys, bias);
+    int mask = _mm_movemask_epi8(_mm_cmplt_epi8(pivot, keys));
+    mask &= (1 << count) - 1;
+    return (mask)? (unsigned)__builtin_ctz(mask) : count;
+#else
+    unsigned i = 0;
+    while (i < count && node->keys_[i] < byte)
+        ++i;
+    return i;
+#endif
+}
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+RadixTrie* RadixTrieInit()
+{
+    RadixTrie* obj = (RadixTrie*)malloc(sizeof(RadixTrie));
+    if (unlikely(!obj))
+        return NULL;
+
+    RadixTrieData* data = (RadixTrieData*)malloc(sizeof(RadixTrieData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    data->size_ = 0;
+    data->root_ = NULL;
+
+    obj->data = data;
+    obj->insert = RadixTrieInsert;
+    obj->bulk_insert = RadixTrieBulkInsert;
+    obj->has_exact = RadixTrieHasExact;
+    obj->has_prefix_as = RadixTrieHasPrefixAs;
+    obj->get_prefix_as = RadixTrieGetPrefixAs;
+    obj->remove = RadixTrieRemove;
+    obj->size = RadixTrieSize;
+    return obj;
+}
+
+void RadixTrieDeinit(RadixTrie* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    RadixTrieData* data = obj->data;
+    _RadixTrieDeinit(data->root_);
+
+    free(data);
+    free(obj);
+    return;
+}
+
+bool RadixTrieInsert(RadixTrie* self, const char* str)
+{
+    if (unlikely(!str))
+        return true;
+    if (unlikely(*str == 0))
+        return true;
+
+    RadixTrieData* data = self->data;
+    unsigned len = strlen(str) + 1;
+
+    bool is_new;
+    if (unlikely(!_RadixTrieInsert(&data->root_, (const uint8_t*)str, len, 0, &is_new)))
+        return false;
+    if (is_new)
+        data->size_++;
+    return true;
+}
+
+bool RadixTrieBulkInsert(RadixTrie* self, const char** strs, unsigned size)
+{
+    unsigned i;
+    for (i = 0 ; i < size ; ++i) {
+        if (unlikely(!RadixTrieInsert(self, strs[i])))
+            return false;
+    }
+    return true;
+}
+
+bool RadixTrieHasExact(RadixTrie* self, const char* str)
+{
+    if (unlikely(!str))
+        return false;
+    if (unlikely(*str == 0))
+        return false;
+
+    const uint8_t* key = (const uint8_t*)str;
+    unsigned len = strlen(str) + 1;
+    RadixNode* curr = self->data->root_;
+    unsigned depth = 0;
+
+    /* Skip the compressed paths optimistically since the reached leaf is
+       verified against the whole key anyway. */
+    while (curr) {
+        if (IS_LEAF(curr))
+            return LEAF_MATCH(UNTAG_LEAF(curr), key, len);
+
+        unsigned prefix_len = curr->prefix_len_;
+        if (prefix_len) {
+            unsigned cmp = MIN(MIN(MAX_PREFIX, prefix_len), len - depth);
+            if (memcmp(curr->prefix_, key + depth, cmp) != 0)
+                return false;
+            depth += prefix_len;
+        }
+        if (depth >= len)
+            return false;
+
+        RadixNode** slot = _RadixTrieFindChild(curr, key[depth]);
+        if (!slot)
+            return false;
+        curr = *slot;
+        ++depth;
+    }
+
+    return false;
+}
+
+bool RadixTrieHasPrefixAs(RadixTrie* self, const char* prefix)
+{
+    if (unlikely(!prefix))
+        return false;
+    if (unlikely(*prefix == 0))
+        return false;
+
+    return _RadixTrieSeek(self->data, (const uint8_t*)prefix, strlen(prefix)) != NULL;
+}
+
+bool RadixTrieGetPrefixAs(RadixTrie* self, const char* prefix, const char*** p_strs, unsigned *p_size)
+{
+    *p_strs = NULL;
+    *p_size = 0;
+
+    if (unlikely(!prefix))
+        return false;
+    if (unlikely(*prefix == 0))
+        return false;
+
+    RadixNode* node = _RadixTrieSeek(self->data, (const uint8_t*)prefix, strlen(prefix));
+    if (!node)
+        return false;
+
+    RadixCollect collect;
+    collect.strs_ = NULL;
+    collect.size_ = 0;
+    collect.capacity_ = 0;
+
+    if (unlikely(!_RadixTrieCollect(node, &collect))) {
+        unsigned i;
+        for (i = 0 ; i < collect.size_ ; ++i)
+            free((char*)collect.strs_[i]);
+        free(collect.strs_);
+        return false;
+    }
+
+    *p_strs = collect.strs_;
+    *p_size = collect.size_;
+    return true;
+}
+
+bool RadixTrieRemove(RadixTrie* self, const char* str)
+{
+    if (unlikely(!str))
+        return false;
+    if (unlikely(*str == 0))
+        return false;
+
+    RadixTrieData* data = self->data;
+    unsigned len = strlen(str) + 1;
+    RadixLeaf* leaf = _RadixTrieRemove(&data->root_, (const uint8_t*)str, len, 0);
+    if (!leaf)
+        return false;
+
+    free(leaf);
+    data->size_--;
+    return true;
+}
+
+unsigned RadixTrieSize(RadixTrie* self)
+{
+    return self->data->size_;
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+void _RadixTrieDeinit(RadixNode* node)
+{
+    if (!node)
+        return;
+    if (IS_LEAF(node)) {
+        free(UNTAG_LEAF(node));
+        return;
+    }
+
+    unsigned i;
+    uint8_t type = node->type_;
+    if (type == TYPE_NODE4) {
+        RadixNode4* node4 = (RadixNode4*)node;
+        for (i = 0 ; i < node->count_ ; ++i)
+            _RadixTrieDeinit(node4->children_[i]);
+    } else if (type == TYPE_NODE16) {
+        RadixNode16* node16 = (RadixNode16*)node;
+        for (i = 0 ; i < node->count_ ; ++i)
+            _RadixTrieDeinit(node16->children_[i]);
+    } else if (type == TYPE_NODE48) {
+        RadixNode48* node48 = (RadixNode48*)node;
+        for (i = 0 ; i < CAPA_NODE48 ; ++i)
+            _RadixTrieDeinit(node48->children_[i]);
+    } else {
+        RadixNode256* node256 = (RadixNode256*)node;
+        for (i = 0 ; i < 256 ; ++i)
+            _RadixTrieDeinit(node256->children_[i]);
+    }
+
+    free(node);
+    return;
+}
+
+RadixNode** _RadixTrieFindChild(RadixNode* node, uint8_t byte)
+{
+    uint8_t type = node->type_;
+    if (type == TYPE_NODE4) {
+        RadixNode4* node4 = (RadixNode4*)node;
+        unsigned i;
+        for (i = 0 ; i < node->count_ ; ++i) {
+            if (node4->keys_[i] == byte)
+                return &node4->children_[i];
+        }
+        return NULL;
+    }
+
+    if (type == TYPE_NODE16) {
+        RadixNode16* node16 = (RadixNode16*)node;
+        int idx = NODE16_FIND(node16, byte);
+        return (idx >= 0)? &node16->children_[idx] : NULL;
+    }
+
+    if (type == TYPE_NODE48) {
+        RadixNode48* node48 = (RadixNode48*)node;
+        uint8_t slot = node48->slots_[byte];
+        return (slot)? &node48->children_[slot - 1] : NULL;
+    }
+
+    RadixNode256* node256 = (RadixNode256*)node;
+    return (node256->children_[byte])? &node256->children_[byte] : NULL;
+}
+
+RadixLeaf* _RadixTrieMinimum(RadixNode* node)
+{
+    while (!IS_LEAF(node)) {
+        uint8_t type = node->type_;
+        if (type == TYPE_NODE4)
+            node = ((RadixNode4*)node)->children_[0];
+        else if (type == TYPE_NODE16)
+            node = ((RadixNode16*)node)->children_[0];
+        else if (type == TYPE_NODE48) {
+            RadixNode48* node48 = (RadixNode48*)node;
+            unsigned i = 0;
+            while (!node48->slots_[i])
+                ++i;
+            node = node48->children_[node48->slots_[i] - 1];
+        } else {
+            RadixNode256* node256 = (RadixNode256*)node;
+            unsigned i = 0;
+            while (!node256->children_[i])
+                ++i;
+            node = node256->children_[i];
+        }
+    }
+    return UNTAG_LEAF(node);
+}
+
+unsigned _RadixTrieMatch(RadixNode* node, const uint8_t* key, unsigned len,
+                         unsigned depth)
+{
+    unsigned prefix_len = node->prefix_len_;
+    unsigned bound = MIN(prefix_len, len - depth);
+    unsigned cmp = MIN(MAX_PREFIX, bound);
+
+    unsigned i;
+    for (i = 0 ; i < cmp ; ++i) {
+        if (node->prefix_[i] != key[depth + i])
+            return i;
+    }
+    if (bound <= MAX_PREFIX)
+        return i;
+
+    /* The truncated part of the compressed path is shared by all the leaves
+       below, so the leftmost one is used to resolve it. */
+    const uint8_t* full = (const uint8_t*)_RadixTrieMinimum(node)->key_;
+    for ( ; i < bound ; ++i) {
+        if (full[depth + i] != key[depth + i])
+            return i;
+    }
+    return i;
+}
+
+bool _RadixTrieAddChild(RadixNode** ref, uint8_t byte, RadixNode* child)
+{
+    RadixNode* node = *ref;
+    uint8_t type = node->type_;
+    unsigned count = node->count_;
+    unsigned i;
+
+    if (type == TYPE_NODE4) {
+        RadixNode4* node4 = (RadixNode4*)node;
+        if (count < CAPA_NODE4) {
+            i = 0;
+            while (i < count && node4->keys_[i] < byte)
+                ++i;
+            memmove(node4->keys_ + i + 1, node4->keys_ + i, count - i);
+            memmove(node4->children_ + i + 1, node4->children_ + i,
+                    sizeof(RadixNode*) * (count - i));
+            node4->keys_[i] = byte;
+            node4->children_[i] = child;
+            node->count_++;
+            return true;
+        }
+
+        RadixNode16* grow = (RadixNode16*)NEW_NODE(TYPE_NODE16);
+        if (unlikely(!grow))
+            return false;
+        COPY_HEADER(&grow->base_, node);
+        memcpy(grow->keys_, node4->keys_, count);
+        memcpy(grow->children_, node4->children_, sizeof(RadixNode*) * count);
+        *ref = (RadixNode*)grow;
+        free(node);
+        return _RadixTrieAddChild(ref, byte, child);
+    }
+
+    if (type == TYPE_NODE16) {
+        RadixNode16* node16 = (RadixNode16*)node;
+        if (count < CAPA_NODE16) {
+            i = NODE16_LOWER_BOUND(node16, byte);
+            memmove(node16->keys_ + i + 1, node16->keys_ + i, count - i);
+            memmove(node16->children_ + i + 1, node16->children_ + i,
+                    sizeof(RadixNode*) * (count - i));
+            node16->keys_[i] = byte;
+            node16->children_[i] = child;
+            node->count_++;
+            return true;
+        }
+
+        RadixNode48* grow = (RadixNode48*)NEW_NODE(TYPE_NODE48);
+        if (unlikely(!grow))
+            return false;
+        COPY_HEADER(&grow->base_, node);
+        memcpy(grow->children_, node16->children_, sizeof(RadixNode*) * count);
+        for (i = 0 ; i < count ; ++i)
+            grow->slots_[node16->keys_[i]] = i + 1;
+        *ref = (RadixNode*)grow;
+        free(node);
+        return _RadixTrieAddChild(ref, byte, child);
+    }
+
+    if (type == TYPE_NODE48) {
+        RadixNode48* node48 = (RadixNode48*)node;
+        if (count < CAPA_NODE48) {
+            i = 0;
+            while (node48->children_[i])
+                ++i;
+            node48->children_[i] = child;
+            node48->slots_[byte] = i + 1;
+            node->count_++;
+            return true;
+        }
+
+        RadixNode256* grow = (RadixNode256*)NEW_NODE(TYPE_NODE256);
+        if (unlikely(!grow))
+            return false;
+        COPY_HEADER(&grow->base_, node);
+        for (i = 0 ; i < 256 ; ++i) {
+            if (node48->slots_[i])
+                grow->children_[i] = node48->children_[node48->slots_[i] - 1];
+        }
+        *ref = (RadixNode*)grow;
+        free(node);
+        return _RadixTrieAddChild(ref, byte, child);
+    }
+
+    RadixNode256* node256 = (RadixNode256*)node;
+    node256->children_[byte] = child;
+    node->count_++;
+    return true;
+}
+
+void _RadixTrieRemoveChild(RadixNode** ref, uint8_t byte, RadixNode** slot)
+{
+    RadixNode* node = *ref;
+    uint8_t type = node->type_;
+    unsigned i, j;
+
+    if (type == TYPE_NODE256) {
+        RadixNode256* node256 = (RadixNode256*)node;
+        node256->children_[byte] = NULL;
+        if (--node->count_ > SHRINK_NODE256)
+            return;
+
+        /* Keep the larger node if the allocation fails since it is still valid. */
+        RadixNode48* shrink = (RadixNode48*)NEW_NODE(TYPE_NODE48);
+        if (unlikely(!shrink))
+            return;
+        COPY_HEADER(&shrink->base_, node);
+        for (i = 0, j = 0 ; i < 256 ; ++i) {
+            if (node256->children_[i]) {
+                shrink->children_[j] = node256->children_[i];
+                shrink->slots_[i] = ++j;
+            }
+        }
+        *ref = (RadixNode*)shrink;
+        free(node);
+        return;
+    }
+
+    if (type == TYPE_NODE48) {
+        RadixNode48* node48 = (RadixNode48*)node;
+        node48->children_[node48->slots_[byte] - 1] = NULL;
+        node48->slots_[byte] = 0;
+        if (--node->count_ > SHRINK_NODE48)
+            return;
+
+        RadixNode16* shrink = (RadixNode16*)NEW_NODE(TYPE_NODE16);
+        if (unlikely(!shrink))
+            return;
+        COPY_HEADER(&shrink->base_, node);
+        for (i = 0, j = 0 ; i < 256 ; ++i) {
+            if (node48->slots_[i]) {
+                shrink->keys_[j] = i;
+                shrink->children_[j] = node48->children_[node48->slots_[i] - 1];
+                ++j;
+            }
+        }
+        *ref = (RadixNode*)shrink;
+        free(node);
+        return;
+    }
+
+    if (type == TYPE_NODE16) {
+        RadixNode16* node16 = (RadixNode16*)node;
+        unsigned pos = slot - node16->children_;
+        unsigned count = --node->count_;
+        memmove(node16->keys_ + pos, node16->keys_ + pos + 1, count - pos);
+        memmove(node16->children_ + pos, node16->children_ + pos + 1,
+                sizeof(RadixNode*) * (count - pos));
+        if (count > SHRINK_NODE16)
+            return;
+
+        RadixNode4* shrink = (RadixNode4*)NEW_NODE(TYPE_NODE4);
+        if (unlikely(!shrink))
+            return;
+        COPY_HEADER(&shrink->base_, node);
+        memcpy(shrink->keys_, node16->keys_, count);
+        memcpy(shrink->children_, node16->children_, sizeof(RadixNode*) * count);
+        *ref = (RadixNode*)shrink;
+        free(node);
+        return;
+    }
+
+    RadixNode4* node4 = (RadixNode4*)node;
+    unsigned pos = slot - node4->children_;
+    unsigned count = --node->count_;
+    memmove(node4->keys_ + pos, node4->keys_ + pos + 1, count - pos);
+    memmove(node4->children_ + pos, node4->children_ + pos + 1,
+            sizeof(RadixNode*) * (count - pos));
+    if (count > 1)
+        return;
+
+    /* Collapse the node with its only child. For an inner child, the compressed
+       path becomes the node path, the child label, and the child path. */
+    RadixNode* child = node4->children_[0];
+    if (!IS_LEAF(child)) {
+        unsigned len = node->prefix_len_;
+        if (len < MAX_PREFIX)
+            node->prefix_[len++] = node4->keys_[0];
+        if (len < MAX_PREFIX) {
+            unsigned sub = MIN(child->prefix_len_, MAX_PREFIX - len);
+            memcpy(node->prefix_ + len, child->prefix_, sub);
+            len += sub;
+        }
+        memcpy(child->prefix_, node->prefix_, MIN(len, MAX_PREFIX));
+        child->prefix_len_ += node->prefix_len_ + 1;
+    }
+    *ref = child;
+    free(node);
+    return;
+}
+
+bool _RadixTrieInsert(RadixNode** ref, const uint8_t* key, unsigned len,
+                      unsigned depth, bool* p_new)
+{
+    *p_new = false;
+
+    while (true) {
+        RadixNode* node = *ref;
+
+        /* Reach an empty slot. */
+        if (!node) {
+            RadixLeaf* leaf = NEW_LEAF(key, len);
+            if (unlikely(!leaf))
+                return false;
+            *ref = TAG_LEAF(leaf);
+            *p_new = true;
+            return true;
+        }
+
+        /* Reach a leaf. Split it with a Node4 holding the common path. */
+        if (IS_LEAF(node)) {
+            RadixLeaf* old_leaf = UNTAG_LEAF(node);
+            if (LEAF_MATCH(old_leaf, key, len))
+                return true;
+
+            const uint8_t* old_key = (const uint8_t*)old_leaf->key_;
+            unsigned bound = MIN(old_leaf->len_ + 1, len);
+            unsigned common = 0;
+            while (depth + common < bound &&
+                   old_key[depth + common] == key[depth + common])
+                ++common;
+
+            RadixNode* split = NEW_NODE(TYPE_NODE4);
+            if (unlikely(!split))
+                return false;
+            RadixLeaf* new_leaf = NEW_LEAF(key, len);
+            if (unlikely(!new_leaf)) {
+                free(split);
+                return false;
+            }
+
+            split->prefix_len_ = common;
+            memcpy(split->prefix_, key + depth, MIN(MAX_PREFIX, common));
+            _RadixTrieAddChild(&split, old_key[depth + common], node);
+            _RadixTrieAddChild(&split, key[depth + common], TAG_LEAF(new_leaf));
+            *ref = split;
+            *p_new = true;
+            return true;
+        }
+
+        /* Split the compressed path at the first mismatch. */
+        if (node->prefix_len_) {
+            unsigned match = _RadixTrieMatch(node, key, len, depth);
+            if (match < node->prefix_len_) {
+                RadixNode* split = NEW_NODE(TYPE_NODE4);
+                if (unlikely(!split))
+                    return false;
+                RadixLeaf* new_leaf = NEW_LEAF(key, len);
+                if (unlikely(!new_leaf)) {
+                    free(split);
+                    return false;
+                }
+
+                split->prefix_len_ = match;
+                memcpy(split->prefix_, node->prefix_, MIN(MAX_PREFIX, match));
+
+                /* Strip the shared path and the branching byte from the node. */
+                uint8_t label;
+                unsigned remain = node->prefix_len_ - match - 1;
+                if (node->prefix_len_ <= MAX_PREFIX) {
+                    label = node->prefix_[match];
+                    memmove(node->prefix_, node->prefix_ + match + 1, remain);
+                } else {
+                    const uint8_t* full = (const uint8_t*)_RadixTrieMinimum(node)->key_;
+                    label = full[depth + match];
+                    memcpy(node->prefix_, full + depth + match + 1,
+                           MIN(MAX_PREFIX, remain));
+                }
+                node->prefix_len_ = remain;
+
+                _RadixTrieAddChild(&split, label, node);
+                _RadixTrieAddChild(&split, key[depth + match], TAG_LEAF(new_leaf));
+                *ref = split;
+                *p_new = true;
+                return true;
+            }
+            depth += node->prefix_len_;
+        }
+
+        RadixNode** slot = _RadixTrieFindChild(node, key[depth]);
+        if (slot) {
+            ref = slot;
+            ++depth;
+            continue;
+        }
+
+        RadixLeaf* new_leaf = NEW_LEAF(key, len);
+        if (unlikely(!new_leaf))
+            return false;
+        if (unlikely(!_RadixTrieAddChild(ref, key[depth], TAG_LEAF(new_leaf)))) {
+            free(new_leaf);
+            return false;
+        }
+        *p_new = true;
+        return true;
+    }
+}
+
+RadixLeaf* _RadixTrieRemove(RadixNode** ref, const uint8_t* key, unsigned len,
+                            unsigned depth)
+{
+    RadixNode* node = *ref;
+    if (!node)
+        return NULL;
+
+    if (IS_LEAF(node)) {
+        RadixLeaf* leaf = UNTAG_LEAF(node);
+        if (!LEAF_MATCH(leaf, key, len))
+            return NULL;
+        *ref = NULL;
+        return leaf;
+    }
+
+    while (true) {
+        if (node->prefix_len_) {
+            if (_RadixTrieMatch(node, key, len, depth) != node->prefix_len_)
+                return NULL;
+            depth += node->prefix_len_;
+        }
+        if (depth >= len)
+            return NULL;
+
+        uint8_t byte = key[depth];
+        RadixNode** slot = _RadixTrieFindChild(node, byte);
+        if (!slot)
+            return NULL;
+
+        RadixNode* child = *slot;
+        if (IS_LEAF(child)) {
+            RadixLeaf* leaf = UNTAG_LEAF(child);
+            if (!LEAF_MATCH(leaf, key, len))
+                return NULL;
+            _RadixTrieRemoveChild(ref, byte, slot);
+            return leaf;
+        }
+
+        ref = slot;
+        node = child;
+        ++depth;
+    }
+}
+
+RadixNode* _RadixTrieSeek(RadixTrieData* data, const uint8_t* prefix, unsigned len)
+{
+    RadixNode* curr = data->root_;
+    unsigned depth = 0;
+
+    while (curr) {
+        if (IS_LEAF(curr)) {
+            RadixLeaf* leaf = UNTAG_LEAF(curr);
+            if (leaf->len_ >= len && memcmp(leaf->key_, prefix, len) == 0)
+                return curr;
+            return NULL;
+        }
+
+        if (curr->prefix_len_) {
+            unsigned match = _RadixTrieMatch(curr, prefix, len, depth);
+            if (depth + match == len)
+                return curr;
+            if (match < curr->prefix_len_)
+                return NULL;
+            depth += curr->prefix_len_;
+        }
+        if (depth == len)
+            return curr;
+
+        RadixNode** slot = _RadixTrieFindChild(curr, prefix[depth]);
+        if (!slot)
+            return NULL;
+        curr = *slot;
+        ++depth;
+    }
+
+    return NULL;
+}
+
+bool _RadixTrieCollect(RadixNode* node, RadixCollect* collect)
+{
+    if (IS_LEAF(node)) {
+        if (collect->size_ == collect->capacity_) {
+            unsigned capacity = (collect->capacity_)? collect->capacity_ << 1 : 16;
+            const char** strs = (const char**)realloc(collect->strs_,
+                                                sizeof(const char*) * capacity);
+            if (unlikely(!strs))
+                return false;
+            collect->strs_ = strs;
+            collect->capacity_ = capacity;
+        }
+
+        char* str = strdup(UNTAG_LEAF(node)->key_);
+        if (unlikely(!str))
+            return false;
+        collect->strs_[collect->size_++] = str;
+        return true;
+    }
+
+    unsigned i;
+    uint8_t type = node->type_;
+    if (type == TYPE_NODE4) {
+        RadixNode4* node4 = (RadixNode4*)node;
+        for (i = 0 ; i < node->count_ ; ++i) {
+            if (unlikely(!_RadixTrieCollect(node4->children_[i], collect)))
+                return false;
+        }
+    } else if (type == TYPE_NODE16) {
+        RadixNode16* node16 = (RadixNode16*)node;
+        for (i = 0 ; i < node->count_ ; ++i) {
+            if (unlikely(!_RadixTrieCollect(node16->children_[i], collect)))
+                return false;
+        }
+    } else if (type == TYPE_NODE48) {
+        RadixNode48* node48 = (RadixNode48*)node;
+        for (i = 0 ; i < 256 ; ++i) {
+            uint8_t slot = node48->slots_[i];
+            if (slot && unlikely(!_RadixTrieCollect(node48->children_[slot - 1], collect)))
+                return false;
+        }
+    } else {
+        RadixNode256* node256 = (RadixNode256*)node;
+        for (i = 0 ; i < 256 ; ++i) {
+            RadixNode* child = node256->children_[i];
+            if (child && unlikely(!_RadixTrieCollect(child, collect)))
+                return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,1211 @@
+/**
+ *   The MIT License (MIT)
+ *   Copyright (C) 2016 ZongXian Shen <andy.zsshen@gmail.com>
+ *
+ *   Permission is hereby granted, free of charge, to any person obtaining a
+ *   copy of this software and associated documentation files (the "Software"),
+ *   to deal in the Software without restriction, including without limitation
+ *   the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ *   and/or sell copies of the Software, and to permit persons to whom the
+ *   Software is furnished to do so, subject to the following conditions:
+ *
+ *   The above copyright notice and this permission notice shall be included in
+ *   all copies or substantial portions of the Software.
+ *
+ *   THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ *   IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ *   FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL
+ *   THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ *   LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ *   OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS
+ *   IN THE SOFTWARE.
+ */
+
+
+
+#include "container/roaring_set.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+
+/*===========================================================================*
+ *                        The container private data                         *
+ *===========================================================================*/
+static const uint8_t TYPE_ARRAY = 0;
+static const uint8_t TYPE_BITMAP = 1;
+
+static const unsigned MAX_ARRAY_CARD = 4096;
+static const unsigned NUM_BITMAP_WORD = 1024;
+static const unsigned INIT_ARRAY_CAP = 4;
+static const unsigned INIT_CONT_CAP = 4;
+
+static const uint8_t MAGIC_SERIAL[] = {'R', 'S', 'E', 'T'};
+static const size_t SIZE_SERIAL_HEAD = 8;
+static const size_t SIZE_CONT_HEAD = 8;
+
+
+/**
+ * The container for the integers sharing the same high 16 bits. The low 16 bits
+ * are stored either as a sorted array or as a 65536 bit bitmap, whichever is
+ * more compact.
+ */
+typedef struct _Container {
+    uint16_t key_;
+    uint8_t type_;
+    uint32_t card_;
+    uint32_t cap_;
+    void* elem_;
+} Container;
+
+struct _RoaringSetData {
+    unsigned size_;
+    unsigned num_cont_;
+    unsigned cap_cont_;
+    unsigned iter_cont_;
+    unsigned iter_pos_;
+    Container* arr_cont_;
+};
+
+
+/*===========================================================================*
+ *                  Definition for internal operations                       *
+ *===========================================================================*/
+#define likely(x)       __builtin_expect(!!(x), 1)
+#define unlikely(x)     __builtin_expect(!!(x), 0)
+
+/**
+ * @brief Initialize the set with the specified container capacity.
+ *
+ * @param cap           The initial container capacity
+ *
+ * @retval obj          The successfully constructed set
+ * @retval NULL         Insufficient memory for set construction
+ */
+RoaringSet* _RoaringSetInit(unsigned cap);
+
+/**
+ * @brief Search the container array for the designated high 16 bits.
+ *
+ * @param data          The pointer to the set private data
+ * @param key           The designated high 16 bits
+ *
+ * @retval idx          The index to the target container
+ * @retval -(pos + 1)   The container cannot be found, and pos is the position
+ *                      to insert the new one
+ */
+int _RoaringSetLocate(RoaringSetData* data, uint16_t key);
+
+/**
+ * @brief Insert an empty array container at the designated position.
+ *
+ * @param data          The pointer to the set private data
+ * @param idx           The designated position
+ * @param key           The high 16 bits represented by the container
+ *
+ * @retval cont         The newly inserted container
+ * @retval NULL         Insufficient memory
+ */
+Container* _RoaringSetInsertContainer(RoaringSetData* data, unsigned idx, uint16_t key);
+
+/**
+ * @brief Remove the container at the designated position.
+ *
+ * @param data          The pointer to the set private data
+ * @param idx           The designated position
+ */
+void _RoaringSetRemoveContainer(RoaringSetData* data, unsigned idx);
+
+/**
+ * @brief Append a container to the tail of the container array. The set takes
+ * the ownership of the container payload.
+ *
+ * @param data          The pointer to the set private data
+ * @param cont          The to be appended container
+ *
+ * @retval true         The container is successfully appended
+ * @retval false        Insufficient memory
+ */
+bool _RoaringSetAppend(RoaringSetData* data, Container* cont);
+
+/**
+ * @brief Return the first position in the sorted array whose element is not
+ * less than the designated value. The search gallops from the given position.
+ *
+ * @param arr           The sorted array
+ * @param bgn           The position to start the search
+ * @param end           The array size
+ * @param val           The designated value
+ *
+ * @retval pos          The target position
+ */
+unsigned _RoaringSetGallop(const uint16_t* arr, unsigned bgn, unsigned end, uint16_t val);
+
+/**
+ * @brief Convert the array container into the bitmap one.
+ *
+ * @param cont          The designated container
+ *
+ * @retval true         The container is successfully converted
+ * @retval false        Insufficient memory
+ */
+bool _RoaringSetArrayToBitmap(Container* cont);
+
+/**
+ * @brief Convert the bitmap container into the array one.
+ *
+ * @param cont          The designated container
+ *
+ * @retval true         The container is successfully converted
+ * @retval false        Insufficient memory
+ */
+bool _RoaringSetBitmapToArray(Container* cont);
+
+/**
+ * @brief Make a deep copy of the designated container.
+ *
+ * @param src           The source container
+ * @param dst           The destination container
+ *
+ * @retval true         The container is successfully copied
+ * @retval false        Insufficient memory
+ */
+bool _RoaringSetCopy(const Container* src, Container* dst);
+
+/**
+ * @brief Word-wise bitmap operations. The result cardinality is returned.
+ */
+uint32_t _RoaringSetBitmapOr(const uint64_t* lhs, const uint64_t* rhs, uint64_t* dst);
+uint32_t _RoaringSetBitmapAnd(const uint64_t* lhs, const uint64_t* rhs, uint64_t* dst);
+uint32_t _RoaringSetBitmapAndNot(const uint64_t* lhs, const uint64_t* rhs, uint64_t* dst);
+
+/**
+ * @brief Container-wise set operations. The result container is filled into
+ * the designated output structure and might be empty.
+ *
+ * @retval true         The operation is successfully done
+ * @retval false        Insufficient memory
+ */
+bool _RoaringSetContUnion(const Container* lhs, const Container* rhs, Container* dst);
+bool _RoaringSetContIntersect(const Container* lhs, const Container* rhs, Container* dst);
+bool _RoaringSetContDifference(const Container* lhs, const Container* rhs, Container* dst);
+
+static inline
+void WRITE_U16(uint8_t* buf, uint16_t val)
+{
+    buf[0] = (uint8_t)val;
+    buf[1] = (uint8_t)(val >> 8);
+}
+
+static inline
+void WRITE_U32(uint8_t* buf, uint32_t val)
+{
+    buf[0] = (uint8_t)val;
+    buf[1] = (uint8_t)(val >> 8);
+    buf[2] = (uint8_t)(val >> 16);
+    buf[3] = (uint8_t)(val >> 24);
+}
+
+static inline
+uint16_t READ_U16(const uint8_t* buf)
+{
+    return (uint16_t)(buf[0] | (buf[1] << 8));
+}
+
+static inline
+uint32_t READ_U32(const uint8_t* buf)
+{
+    return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) |
+           ((uint32_t)buf[2] << 16) | ((uint32_t)buf[3] << 24);
+}
+
+static inline
+void FREE_CONTAINER(Container* cont)
+{
+    free(cont->elem_);
+    cont->elem_ = NULL;
+}
+
+
+/*===========================================================================*
+ *               Implementation for the exported operations                  *
+ *===========================================================================*/
+RoaringSet* RoaringSetInit()
+{
+    return _RoaringSetInit(INIT_CONT_CAP);
+}
+
+void RoaringSetDeinit(RoaringSet* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    RoaringSetData* data = obj->data;
+    unsigned i;
+    for (i = 0 ; i < data->num_cont_ ; ++i)
+        FREE_CONTAINER(&(data->arr_cont_[i]));
+
+    free(data->arr_cont_);
+    free(data);
+    free(obj);
+    return;
+}
+
+bool RoaringSetAdd(RoaringSet* self, uint32_t key)
+{
+    RoaringSetData* data = self->data;
+    uint16_t high = (uint16_t)(key >> 16);
+    uint16_t low = (uint16_t)key;
+
+    /* Locate the container or create a new one. */
+    Container* cont;
+    int idx = _RoaringSetLocate(data, high);
+    if (idx >= 0)
+        cont = &(data->arr_cont_[idx]);
+    else {
+        cont = _RoaringSetInsertContainer(data, -(idx + 1), high);
+        if (unlikely(!cont))
+            return false;
+    }
+
+    if (cont->type_ == TYPE_BITMAP) {
+        uint64_t* map = (uint64_t*)cont->elem_;
+        uint64_t mask = (uint64_t)1 << (low & 63);
+        if (!(map[low >> 6] & mask)) {
+            map[low >> 6] |= mask;
+            ++(cont->card_);
+            ++(data->size_);
+        }
+        return true;
+    }
+
+    uint16_t* arr = (uint16_t*)cont->elem_;
+    unsigned pos = _RoaringSetGallop(arr, 0, cont->card_, low);
+    if (pos < cont->card_ && arr[pos] == low)
+        return true;
+
+    /* The array is full, switch to the bitmap representation. */
+    if (cont->card_ == MAX_ARRAY_CARD) {
+        if (unlikely(!_RoaringSetArrayToBitmap(cont)))
+            return false;
+        uint64_t* map = (uint64_t*)cont->elem_;
+        map[low >> 6] |= (uint64_t)1 << (low & 63);
+        ++(cont->card_);
+        ++(data->size_);
+        return true;
+    }
+
+    if (cont->card_ == cont->cap_) {
+        uint32_t cap = cont->cap_ << 1;
+        if (cap > MAX_ARRAY_CARD)
+            cap = MAX_ARRAY_CARD;
+        uint16_t* new_arr = (uint16_t*)realloc(arr, sizeof(uint16_t) * cap);
+        if (unlikely(!new_arr))
+            return false;
+        arr = new_arr;
+        cont->elem_ = arr;
+        cont->cap_ = cap;
+    }
+
+    memmove(arr + pos + 1, arr + pos, sizeof(uint16_t) * (cont->card_ - pos));
+    arr[pos] = low;
+    ++(cont->card_);
+    ++(data->size_);
+    return true;
+}
+
+bool RoaringSetFind(RoaringSet* self, uint32_t key)
+{
+    RoaringSetData* data = self->data;
+    uint16_t low = (uint16_t)key;
+
+    int idx = _RoaringSetLocate(data, (uint16_t)(key >> 16));
+    if (idx < 0)
+        return false;
+
+    Container* cont = &(data->arr_cont_[idx]);
+    if (cont->type_ == TYPE_BITMAP) {
+        uint64_t* map = (uint64_t*)cont->elem_;
+        return (map[low >> 6] >> (low & 63)) & 1;
+    }
+
+    uint16_t* arr = (uint16_t*)cont->elem_;
+    unsigned pos = _RoaringSetGallop(arr, 0, cont->card_, low);
+    return (pos < cont->card_ && arr[pos] == low)? true : false;
+}
+
+bool RoaringSetRemove(RoaringSet* self, uint32_t key)
+{
+    RoaringSetData* data = self->data;
+    uint16_t low = (uint16_t)key;
+
+    int idx = _RoaringSetLocate(data, (uint16_t)(key >> 16));
+    if (idx < 0)
+        return false;
+
+    Container* cont = &(data->arr_cont_[idx]);
+    if (cont->type_ == TYPE_BITMAP) {
+        uint64_t* map = (uint64_t*)cont->elem_;
+        uint64_t mask = (uint64_t)1 << (low & 63);
+        if (!(map[low >> 6] & mask))
+            return false;
+
+        /* Shrink to the array representation if it becomes sparse enough. If
+           the memory is insufficient, we simply keep the bitmap. */
+        map[low >> 6] &= ~mask;
+        --(cont->card_);
+        --(data->size_);
+        if (cont->card_ <= MAX_ARRAY_CARD)
+            _RoaringSetBitmapToArray(cont);
+        return true;
+    }
+
+    uint16_t* arr = (uint16_t*)cont->elem_;
+    unsigned pos = _RoaringSetGallop(arr, 0, cont->card_, low);
+    if (pos == cont->card_ || arr[pos] != low)
+        return false;
+
+    memmove(arr + pos, arr + pos + 1, sizeof(uint16_t) * (cont->card_ - pos - 1));
+    --(cont->card_);
+    --(data->size_);
+    if (cont->card_ == 0)
+        _RoaringSetRemoveContainer(data, idx);
+
+    return true;
+}
+
+unsigned RoaringSetSize(RoaringSet* self)
+{
+    return self->data->size_;
+}
+
+void RoaringSetFirst(RoaringSet* self)
+{
+    RoaringSetData* data = self->data;
+    data->iter_cont_ = 0;
+    data->iter_pos_ = 0;
+    return;
+}
+
+bool RoaringSetNext(RoaringSet* self, uint32_t* p_key)
+{
+    RoaringSetData* data = self->data;
+
+    while (data->iter_cont_ < data->num_cont_) {
+        Container* cont = &(data->arr_cont_[data->iter_cont_]);
+        uint32_t high = (uint32_t)cont->key_ << 16;
+
+        if (cont->type_ == TYPE_ARRAY) {
+            if (data->iter_pos_ < cont->card_) {
+                uint16_t* arr = (uint16_t*)cont->elem_;
+                *p_key = high | arr[data->iter_pos_++];
+                return true;
+            }
+        } else {
+            /* Scan for the next set bit starting from the iterator position. */
+            uint64_t* map = (uint64_t*)cont->elem_;
+            unsigned pos = data->iter_pos_;
+            unsigned idx_word = pos >> 6;
+            if (idx_word < NUM_BITMAP_WORD) {
+                uint64_t word = map[idx_word] & (~(uint64_t)0 << (pos & 63));
+                while (!word && ++idx_word < NUM_BITMAP_WORD)
+                    word = map[idx_word];
+                if (word) {
+                    pos = (idx_word << 6) + __builtin_ctzll(word);
+                    data->iter_pos_ = pos + 1;
+                    *p_key = high | pos;
+                    return true;
+                }
+            }
+        }
+
+        ++(data->iter_cont_);
+        data->iter_pos_ = 0;
+    }
+
+    return false;
+}
+
+RoaringSet* RoaringSetUnion(RoaringSet* lhs, RoaringSet* rhs)
+{
+    RoaringSetData* data_lhs = lhs->data;
+    RoaringSetData* data_rhs = rhs->data;
+
+    RoaringSet* result = _RoaringSetInit(data_lhs->num_cont_ + data_rhs->num_cont_);
+    if (!result)
+        return NULL;
+
+    /* Merge the two container arrays sorted by the high 16 bits. */
+    unsigned idx_lhs = 0, idx_rhs = 0;
+    while (idx_lhs < data_lhs->num_cont_ || idx_rhs < data_rhs->num_cont_) {
+        Container* cont_lhs = (idx_lhs < data_lhs->num_cont_)?
+                              &(data_lhs->arr_cont_[idx_lhs]) : NULL;
+        Container* cont_rhs = (idx_rhs < data_rhs->num_cont_)?
+                              &(data_rhs->arr_cont_[idx_rhs]) : NULL;
+
+        Container cont;
+        bool status;
+        if (cont_lhs && (!cont_rhs || cont_lhs->key_ < cont_rhs->key_)) {
+            status = _RoaringSetCopy(cont_lhs, &cont);
+            ++idx_lhs;
+        } else if (cont_rhs && (!cont_lhs || cont_rhs->key_ < cont_lhs->key_)) {
+            status = _RoaringSetCopy(cont_rhs, &cont);
+            ++idx_rhs;
+        } else {
+            status = _RoaringSetContUnion(cont_lhs, cont_rhs, &cont);
+            ++idx_lhs;
+            ++idx_rhs;
+        }
+
+        if (unlikely(!status) || unlikely(!_RoaringSetAppend(result->data, &cont))) {
+            RoaringSetDeinit(result);
+            return NULL;
+        }
+    }
+
+    return result;
+}
+
+RoaringSet* RoaringSetIntersect(RoaringSet* lhs, RoaringSet* rhs)
+{
+    RoaringSetData* data_lhs = lhs->data;
+    RoaringSetData* data_rhs = rhs->data;
+
+    unsigned cap = (data_lhs->num_cont_ < data_rhs->num_cont_)?
+                   data_lhs->num_cont_ : data_rhs->num_cont_;
+    RoaringSet* result = _RoaringSetInit(cap);
+    if (!result)
+        return NULL;
+
+    /* Only the containers sharing the same high 16 bits can intersect. */
+    unsigned idx_lhs = 0, idx_rhs = 0;
+    while (idx_lhs < data_lhs->num_cont_ && idx_rhs < data_rhs->num_cont_) {
+        Container* cont_lhs = &(data_lhs->arr_cont_[idx_lhs]);
+        Container* cont_rhs = &(data_rhs->arr_cont_[idx_rhs]);
+        if (cont_lhs->key_ < cont_rhs->key_) {
+            ++idx_lhs;
+            continue;
+        }
+        if (cont_rhs->key_ < cont_lhs->key_) {
+            ++idx_rhs;
+            continue;
+        }
+
+        Container cont;
+        bool status = _RoaringSetContIntersect(cont_lhs, cont_rhs, &cont);
+        if (status)
+            status = _RoaringSetAppend(result->data, &cont);
+        if (unlikely(!status)) {
+            RoaringSetDeinit(result);
+            return NULL;
+        }
+        ++idx_lhs;
+        ++idx_rhs;
+    }
+
+    return result;
+}
+
+RoaringSet* RoaringSetDifference(RoaringSet* lhs, RoaringSet* rhs)
+{
+    RoaringSetData* data_lhs = lhs->data;
+    RoaringSetData* data_rhs = rhs->data;
+
+    RoaringSet* result = _RoaringSetInit(data_lhs->num_cont_);
+    if (!result)
+        return NULL;
+
+    unsigned idx_lhs = 0, idx_rhs = 0;
+    while (idx_lhs < data_lhs->num_cont_) {
+        Container* cont_lhs = &(data_lhs->arr_cont_[idx_lhs]);
+        while (idx_rhs < data_rhs->num_cont_ &&
+               data_rhs->arr_cont_[idx_rhs].key_ < cont_lhs->key_)
+            ++idx_rhs;
+
+        Container cont;
+        bool status;
+        if (idx_rhs < data_rhs->num_cont_ &&
+            data_rhs->arr_cont_[idx_rhs].key_ == cont_lhs->key_)
+            status = _RoaringSetContDifference(cont_lhs,
+                                               &(data_rhs->arr_cont_[idx_rhs]), &cont);
+        else
+            status = _RoaringSetCopy(cont_lhs, &cont);
+
+        if (status)
+            status = _RoaringSetAppend(result->data, &cont);
+        if (unlikely(!status)) {
+            RoaringSetDeinit(result);
+            return NULL;
+        }
+        ++idx_lhs;
+    }
+
+    return result;
+}
+
+bool RoaringSetSerialize(RoaringSet* self, uint8_t** p_buf, size_t* p_size)
+{
+    *p_buf = NULL;
+    *p_size = 0;
+
+    /* Calculate the stream size. */
+    RoaringSetData* data = self->data;
+    size_t size = SIZE_SERIAL_HEAD + SIZE_CONT_HEAD * data->num_cont_;
+    unsigned i;
+    for (i = 0 ; i < data->num_cont_ ; ++i) {
+        Container* cont = &(data->arr_cont_[i]);
+        if (cont->type_ == TYPE_ARRAY)
+            size += sizeof(uint16_t) * cont->card_;
+        else
+            size += sizeof(uint64_t) * NUM_BITMAP_WORD;
+    }
+
+    uint8_t* buf = (uint8_t*)malloc(size);
+    if (unlikely(!buf))
+        return false;
+
+    /* Write the stream header and the container headers. */
+    uint8_t* curr = buf;
+    memcpy(curr, MAGIC_SERIAL, sizeof(MAGIC_SERIAL));
+    WRITE_U32(curr + 4, data->num_cont_);
+    curr += SIZE_SERIAL_HEAD;
+    for (i = 0 ; i < data->num_cont_ ; ++i) {
+        Container* cont = &(data->arr_cont_[i]);
+        WRITE_U16(curr, cont->key_);
+        WRITE_U16(curr + 2, cont->type_);
+        WRITE_U32(curr + 4, cont->card_);
+        curr += SIZE_CONT_HEAD;
+    }
+
+    /* Write the container payloads. */
+    for (i = 0 ; i < data->num_cont_ ; ++i) {
+        Container* cont = &(data->arr_cont_[i]);
+        unsigned j;
+        if (cont->type_ == TYPE_ARRAY) {
+            uint16_t* arr = (uint16_t*)cont->elem_;
+            for (j = 0 ; j < cont->card_ ; ++j) {
+                WRITE_U16(curr, arr[j]);
+                curr += sizeof(uint16_t);
+            }
+        } else {
+            uint64_t* map = (uint64_t*)cont->elem_;
+            for (j = 0 ; j < NUM_BITMAP_WORD ; ++j) {
+                WRITE_U32(curr, (uint32_t)map[j]);
+                WRITE_U32(curr + 4, (uint32_t)(map[j] >> 32));
+                curr += sizeof(uint64_t);
+            }
+        }
+    }
+
+    *p_buf = buf;
+    *p_size = size;
+    return true;
+}
+
+RoaringSet* RoaringSetDeserialize(const uint8_t* buf, size_t size)
+{
+    if (!buf || size < SIZE_SERIAL_HEAD)
+        return NULL;
+    if (memcmp(buf, MAGIC_SERIAL, sizeof(MAGIC_SERIAL)) != 0)
+        return NULL;
+
+    /* There are at most 65536 distinct high 16 bits. */
+    uint32_t num_cont = READ_U32(buf + 4);
+    if (num_cont > 65536)
+        return NULL;
+    if ((size - SIZE_SERIAL_HEAD) / SIZE_CONT_HEAD < num_cont)
+        return NULL;
+
+    RoaringSet* obj = _RoaringSetInit(num_cont);
+    if (!obj)
+        return NULL;
+
+    RoaringSetData* data = obj->data;
+    const uint8_t* head = buf + SIZE_SERIAL_HEAD;
+    const uint8_t* curr = head + SIZE_CONT_HEAD * num_cont;
+    const uint8_t* end = buf + size;
+    uint32_t i;
+    for (i = 0 ; i < num_cont ; ++i, head += SIZE_CONT_HEAD) {
+        Container cont;
+        cont.key_ = READ_U16(head);
+        uint16_t type = READ_U16(head + 2);
+        cont.card_ = READ_U32(head + 4);
+
+        /* The containers should be sorted and non-empty. */
+        if (i > 0 && cont.key_ <= data->arr_cont_[i - 1].key_)
+            goto ERROR;
+        if (cont.card_ == 0 || cont.card_ > 65536)
+            goto ERROR;
+
+        unsigned j;
+        if (type == TYPE_ARRAY) {
+            if (cont.card_ > MAX_ARRAY_CARD)
+                goto ERROR;
+            if ((size_t)(end - curr) < sizeof(uint16_t) * cont.card_)
+                goto ERROR;
+
+            uint16_t* arr = (uint16_t*)malloc(sizeof(uint16_t) * cont.card_);
+            if (unlikely(!arr))
+                goto ERROR;
+            for (j = 0 ; j < cont.card_ ; ++j) {
+                arr[j] = READ_U16(curr);
+                curr += sizeof(uint16_t);
+                if (j > 0 && arr[j] <= arr[j - 1]) {
+                    free(arr);
+                    goto ERROR;
+                }
+            }
+            cont.type_ = TYPE_ARRAY;
+            cont.cap_ = cont.card_;
+            cont.elem_ = arr;
+        } else if (type == TYPE_BITMAP) {
+            if ((size_t)(end - curr) < sizeof(uint64_t) * NUM_BITMAP_WORD)
+                goto ERROR;
+
+            uint64_t* map = (uint64_t*)malloc(sizeof(uint64_t) * NUM_BITMAP_WORD);
+            if (unlikely(!map))
+                goto ERROR;
+            uint32_t card = 0;
+            for (j = 0 ; j < NUM_BITMAP_WORD ; ++j) {
+                map[j] = (uint64_t)READ_U32(curr) |
+                         ((uint64_t)READ_U32(curr + 4) << 32);
+                card += __builtin_popcountll(map[j]);
+                curr += sizeof(uint64_t);
+            }
+            if (card != cont.card_) {
+                free(map);
+                goto ERROR;
+            }
+            cont.type_ = TYPE_BITMAP;
+            cont.cap_ = 0;
+            cont.elem_ = map;
+        } else
+            goto ERROR;
+
+        /* The capacity is reserved in advance, so appending cannot fail. */
+        _RoaringSetAppend(data, &cont);
+    }
+
+    if (curr != end)
+        goto ERROR;
+
+    return obj;
+
+ERROR:
+    RoaringSetDeinit(obj);
+    return NULL;
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+RoaringSet* _RoaringSetInit(unsigned cap)
+{
+    RoaringSet* obj = (RoaringSet*)malloc(sizeof(RoaringSet));
+    if (unlikely(!obj))
+        return NULL;
+
+    RoaringSetData* data = (RoaringSetData*)malloc(sizeof(RoaringSetData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    if (cap < INIT_CONT_CAP)
+        cap = INIT_CONT_CAP;
+    Container* arr_cont = (Container*)malloc(sizeof(Container) * cap);
+    if (unlikely(!arr_cont)) {
+        free(data);
+        free(obj);
+        return NULL;
+    }
+
+    data->size_ = 0;
+    data->num_cont_ = 0;
+    data->cap_cont_ = cap;
+    data->iter_cont_ = 0;
+    data->iter_pos_ = 0;
+    data->arr_cont_ = arr_cont;
+
+    obj->data = data;
+    obj->add = RoaringSetAdd;
+    obj->find = RoaringSetFind;
+    obj->remove = RoaringSetRemove;
+    obj->size = RoaringSetSize;
+    obj->first = RoaringSetFirst;
+    obj->next = RoaringSetNext;
+
+    return obj;
+}
+
+int _RoaringSetLocate(RoaringSetData* data, uint16_t key)
+{
+    Container* arr_cont = data->arr_cont_;
+    int num_cont = data->num_cont_;
+
+    /* Short cut for the ascending insertion pattern. */
+    if (num_cont > 0 && arr_cont[num_cont - 1].key_ == key)
+        return num_cont - 1;
+
+    int bgn = 0;
+    int end = num_cont - 1;
+    while (bgn <= end) {
+        int mid = (bgn + end) >> 1;
+        uint16_t curr = arr_cont[mid].key_;
+        if (curr == key)
+            return mid;
+        if (curr < key)
+            bgn = mid + 1;
+        else
+            end = mid - 1;
+    }
+    return -(bgn + 1);
+}
+
+Container* _RoaringSetInsertContainer(RoaringSetData* data, unsigned idx, uint16_t key)
+{
+    uint16_t* arr = (uint16_t*)malloc(sizeof(uint16_t) * INIT_ARRAY_CAP);
+    if (unlikely(!arr))
+        return NULL;
+
+    if (data->num_cont_ == data->cap_cont_) {
+        unsigned cap = data->cap_cont_ << 1;
+        Container* new_cont = (Container*)realloc(data->arr_cont_,
+                                                  sizeof(Container) * cap);
+        if (unlikely(!new_cont)) {
+            free(arr);
+            return NULL;
+        }
+        data->arr_cont_ = new_cont;
+        data->cap_cont_ = cap;
+    }
+
+    Container* arr_cont = data->arr_cont_;
+    memmove(arr_cont + idx + 1, arr_cont + idx,
+            sizeof(Container) * (data->num_cont_ - idx));
+    ++(data->num_cont_);
+
+    Container* cont = &(arr_cont[idx]);
+    cont->key_ = key;
+    cont->type_ = TYPE_ARRAY;
+    cont->card_ = 0;
+    cont->cap_ = INIT_ARRAY_CAP;
+    cont->elem_ = arr;
+    return cont;
+}
+
+void _RoaringSetRemoveContainer(RoaringSetData* data, unsigned idx)
+{
+    Container* arr_cont = data->arr_cont_;
+    FREE_CONTAINER(&(arr_cont[idx]));
+    memmove(arr_cont + idx, arr_cont + idx + 1,
+            sizeof(Container) * (data->num_cont_ - idx - 1));
+    --(data->num_cont_);
+    return;
+}
+
+bool _RoaringSetAppend(RoaringSetData* data, Container* cont)
+{
+    /* The empty container produced by set operations is simply discarded. */
+    if (cont->card_ == 0) {
+        FREE_CONTAINER(cont);
+        return true;
+    }
+
+    if (data->num_cont_ == data->cap_cont_) {
+        unsigned cap = data->cap_cont_ << 1;
+        Container* new_cont = (Container*)realloc(data->arr_cont_,
+                                                  sizeof(Container) * cap);
+        if (unlikely(!new_cont)) {
+            FREE_CONTAINER(cont);
+            return false;
+        }
+        data->arr_cont_ = new_cont;
+        data->cap_cont_ = cap;
+    }
+
+    data->arr_cont_[data->num_cont_++] = *cont;
+    data->size_ += cont->card_;
+    return true;
+}
+
+unsigned _RoaringSetGallop(const uint16_t* arr, unsigned bgn, unsigned end, uint16_t val)
+{
+    /* Exponentially probe for the range containing the target. */
+    unsigned step = 1;
+    unsigned low = bgn;
+    unsigned high = bgn;
+    while (high < end && arr[high] < val) {
+        low = high + 1;
+        high += step;
+        step <<= 1;
+    }
+    if (high > end)
+        high = end;
+
+    /* Then apply binary search within that range. */
+    while (low < high) {
+        unsigned mid = (low + high) >> 1;
+        if (arr[mid] < val)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+    return low;
+}
+
+bool _RoaringSetArrayToBitmap(Container* cont)
+{
+    uint64_t* map = (uint64_t*)malloc(sizeof(uint64_t) * NUM_BITMAP_WORD);
+    if (unlikely(!map))
+        return false;
+    memset(map, 0, sizeof(uint64_t) * NUM_BITMAP_WORD);
+
+    uint16_t* arr = (uint16_t*)cont->elem_;
+    unsigned i;
+    for (i = 0 ; i < cont->card_ ; ++i)
+        map[arr[i] >> 6] |= (uint64_t)1 << (arr[i] & 63);
+
+    free(arr);
+    cont->type_ = TYPE_BITMAP;
+    cont->cap_ = 0;
+    cont->elem_ = map;
+    return true;
+}
+
+bool _RoaringSetBitmapToArray(Container* cont)
+{
+    unsigned cap = (cont->card_ > 0)? cont->card_ : 1;
+    uint16_t* arr = (uint16_t*)malloc(sizeof(uint16_t) * cap);
+    if (unlikely(!arr))
+        return false;
+
+    uint64_t* map = (uint64_t*)cont->elem_;
+    unsigned pos = 0;
+    unsigned i;
+    for (i = 0 ; i < NUM_BITMAP_WORD ; ++i) {
+        uint64_t word = map[i];
+        while (word) {
+            arr[pos++] = (uint16_t)((i << 6) + __builtin_ctzll(word));
+            word &= word - 1;
+        }
+    }
+
+    free(map);
+    cont->type_ = TYPE_ARRAY;
+    cont->cap_ = cap;
+    cont->elem_ = arr;
+    return true;
+}
+
+bool _RoaringSetCopy(const Container* src, Container* dst)
+{
+    size_t size = (src->type_ == TYPE_ARRAY)?
+                  sizeof(uint16_t) * src->card_ : sizeof(uint64_t) * NUM_BITMAP_WORD;
+    void* elem = malloc(size);
+    if (unlikely(!elem))
+        return false;
+    memcpy(elem, src->elem_, size);
+
+    *dst = *src;
+    dst->cap_ = (src->type_ == TYPE_ARRAY)? src->card_ : 0;
+    dst->elem_ = elem;
+    return true;
+}
+
+uint32_t _RoaringSetBitmapOr(const uint64_t* lhs, const uint64_t* rhs, uint64_t* dst)
+{
+    unsigned i;
+#if defined(__SSE2__)
+    for (i = 0 ; i < NUM_BITMAP_WORD ; i += 2) {
+        __m128i vec_lhs = _mm_loadu_si128((const __m128i*)(lhs + i));
+        __m128i vec_rhs = _mm_loadu_si128((const __m128i*)(rhs + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_or_si128(vec_lhs, vec_rhs));
+    }
+#else
+    for (i = 0 ; i < NUM_BITMAP_WORD ; ++i)
+        dst[i] = lhs[i] | rhs[i];
+#endif
+
+    uint32_t card = 0;
+    for (i = 0 ; i < NUM_BITMAP_WORD ; ++i)
+        card += __builtin_popcountll(dst[i]);
+    return card;
+}
+
+uint32_t _RoaringSetBitmapAnd(const uint64_t* lhs, const uint64_t* rhs, uint64_t* dst)
+{
+    unsigned i;
+#if defined(__SSE2__)
+    for (i = 0 ; i < NUM_BITMAP_WORD ; i += 2) {
+        __m128i vec_lhs = _mm_loadu_si128((const __m128i*)(lhs + i));
+        __m128i vec_rhs = _mm_loadu_si128((const __m128i*)(rhs + i));
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_and_si128(vec_lhs, vec_rhs));
+    }
+#else
+    for (i = 0 ; i < NUM_BITMAP_WORD ; ++i)
+        dst[i] = lhs[i] & rhs[i];
+#endif
+
+    uint32_t card = 0;
+    for (i = 0 ; i < NUM_BITMAP_WORD ; ++i)
+        card += __builtin_popcountll(dst[i]);
+    return card;
+}
+
+uint32_t _RoaringSetBitmapAndNot(const uint64_t* lhs, const uint64_t* rhs, uint64_t* dst)
+{
+    unsigned i;
+#if defined(__SSE2__)
+    for (i = 0 ; i < NUM_BITMAP_WORD ; i += 2) {
+        __m128i vec_lhs = _mm_loadu_si128((const __m128i*)(lhs + i));
+        __m128i vec_rhs = _mm_loadu_si128((const __m128i*)(rhs + i));
+        /* Note that _mm_andnot_si128 negates its first operand. */
+        _mm_storeu_si128((__m128i*)(dst + i), _mm_andnot_si128(vec_rhs, vec_lhs));
+    }
+#else
+    for (i = 0 ; i < NUM_BITMAP_WORD ; ++i)
+        dst[i] = lhs[i] & ~rhs[i];
+#endif
+
+    uint32_t card = 0;
+    for (i = 0 ; i < NUM_BITMAP_WORD ; ++i)
+        card += __builtin_popcountll(dst[i]);
+    return card;
+}
+
+bool _RoaringSetContUnion(const Container* lhs, const Container* rhs, Container* dst)
+{
+    dst->key_ = lhs->key_;
+
+    /* Case 1: Both are arrays. Merge them if the result is still sparse. */
+    if (lhs->type_ == TYPE_ARRAY && rhs->type_ == TYPE_ARRAY) {
+        if (lhs->card_ + rhs->card_ <= MAX_ARRAY_CARD) {
+            unsigned cap = lhs->card_ + rhs->card_;
+            uint16_t* arr = (uint16_t*)malloc(sizeof(uint16_t) * cap);
+            if (unlikely(!arr))
+                return false;
+
+            const uint16_t* arr_lhs = (const uint16_t*)lhs->elem_;
+            const uint16_t* arr_rhs = (const uint16_t*)rhs->elem_;
+            unsigned i = 0, j = 0, k = 0;
+            while (i < lhs->card_ && j < rhs->card_) {
+                if (arr_lhs[i] < arr_rhs[j])
+                    arr[k++] = arr_lhs[i++];
+                else if (arr_rhs[j] < arr_lhs[i])
+                    arr[k++] = arr_rhs[j++];
+                else {
+                    arr[k++] = arr_lhs[i++];
+                    ++j;
+                }
+            }
+            while (i < lhs->card_)
+                arr[k++] = arr_lhs[i++];
+            while (j < rhs->card_)
+                arr[k++] = arr_rhs[j++];
+
+            dst->type_ = TYPE_ARRAY;
+            dst->card_ = k;
+            dst->cap_ = cap;
+            dst->elem_ = arr;
+            return true;
+        }
+
+        /* Otherwise, spill the first array into a bitmap and fall through. */
+        Container temp;
+        if (unlikely(!_RoaringSetCopy(lhs, &temp)))
+            return false;
+        if (unlikely(!_RoaringSetArrayToBitmap(&temp))) {
+            FREE_CONTAINER(&temp);
+            return false;
+        }
+        bool status = _RoaringSetContUnion(&temp, rhs, dst);
+        FREE_CONTAINER(&temp);
+
+        /* The duplicates might make the result sparse. If the memory is
+           insufficient, we simply keep the bitmap. */
+        if (status && dst->card_ <= MAX_ARRAY_CARD)
+            _RoaringSetBitmapToArray(dst);
+        return status;
+    }
+
+    /* Case 2: Both are bitmaps. */
+    if (lhs->type_ == TYPE_BITMAP && rhs->type_ == TYPE_BITMAP) {
+        uint64_t* map = (uint64_t*)malloc(sizeof(uint64_t) * NUM_BITMAP_WORD);
+        if (unlikely(!map))
+            return false;
+        dst->type_ = TYPE_BITMAP;
+        dst->cap_ = 0;
+        dst->elem_ = map;
+        dst->card_ = _RoaringSetBitmapOr((const uint64_t*)lhs->elem_,
+                                         (const uint64_t*)rhs->elem_, map);
+        return true;
+    }
+
+    /* Case 3: One bitmap and one array. Set the array bits in the bitmap copy. */
+    const Container* map_cont = (lhs->type_ == TYPE_BITMAP)? lhs : rhs;
+    const Container* arr_cont = (lhs->type_ == TYPE_BITMAP)? rhs : lhs;
+    if (unlikely(!_RoaringSetCopy(map_cont, dst)))
+        return false;
+    dst->key_ = lhs->key_;
+
+    uint64_t* map = (uint64_t*)dst->elem_;
+    const uint16_t* arr = (const uint16_t*)arr_cont->elem_;
+    unsigned i;
+    for (i = 0 ; i < arr_cont->card_ ; ++i) {
+        uint16_t val = arr[i];
+        uint64_t mask = (uint64_t)1 << (val & 63);
+        dst->card_ += !(map[val >> 6] & mask);
+        map[val >> 6] |= mask;
+    }
+    return true;
+}
+
+bool _RoaringSetContIntersect(const Container* lhs, const Container* rhs, Container* dst)
+{
+    dst->key_ = lhs->key_;
+
+    /* Case 1: Both are bitmaps. Shrink the result if it becomes sparse. */
+    if (lhs->type_ == TYPE_BITMAP && rhs->type_ == TYPE_BITMAP) {
+        uint64_t* map = (uint64_t*)malloc(sizeof(uint64_t) * NUM_BITMAP_WORD);
+        if (unlikely(!map))
+            return false;
+        dst->type_ = TYPE_BITMAP;
+        dst->cap_ = 0;
+        dst->elem_ = map;
+        dst->card_ = _RoaringSetBitmapAnd((const uint64_t*)lhs->elem_,
+                                          (const uint64_t*)rhs->elem_, map);
+        if (dst->card_ <= MAX_ARRAY_CARD)
+            _RoaringSetBitmapToArray(dst);
+        return true;
+    }
+
+    /* The result is no larger than the smaller array. */
+    const Container* small = (lhs->type_ == TYPE_ARRAY)? lhs : rhs;
+    const Container* large = (small == lhs)? rhs : lhs;
+    if (large->type_ == TYPE_ARRAY && large->card_ < small->card_) {
+        const Container* temp = small;
+        small = large;
+        large = temp;
+    }
+
+    unsigned cap = (small->card_ > 0)? small->card_ : 1;
+    uint16_t* arr = (uint16_t*)malloc(sizeof(uint16_t) * cap);
+    if (unlikely(!arr))
+        return false;
+
+    const uint16_t* arr_small = (const uint16_t*)small->elem_;
+    unsigned k = 0;
+    unsigned i;
+
+    /* Case 2: One bitmap and one array. Probe the bitmap with array elements. */
+    if (large->type_ == TYPE_BITMAP) {
+        const uint64_t* map = (const uint64_t*)large->elem_;
+        for (i = 0 ; i < small->card_ ; ++i) {
+            uint16_t val = arr_small[i];
+            arr[k] = val;
+            k += (map[val >> 6] >> (val & 63)) & 1;
+        }
+    }
+    /* Case 3: Both are arrays. Gallop the larger one if the sizes are skewed,
+       otherwise apply linear merge. */
+    else {
+        const uint16_t* arr_large = (const uint16_t*)large->elem_;
+        unsigned j = 0;
+        if (large->card_ > (small->card_ << 5)) {
+            for (i = 0 ; i < small->card_ && j < large->card_ ; ++i) {
+                j = _RoaringSetGallop(arr_large, j, large->card_, arr_small[i]);
+                if (j < large->card_ && arr_large[j] == arr_small[i])
+                    arr[k++] = arr_small[i];
+            }
+        } else {
+            i = 0;
+            while (i < small->card_ && j < large->card_) {
+                if (arr_small[i] < arr_large[j])
+                    ++i;
+                else if (arr_large[j] < arr_small[i])
+                    ++j;
+                else {
+                    arr[k++] = arr_small[i];
+                    ++i;
+                    ++j;
+                }
+            }
+        }
+    }
+
+    dst->type_ = TYPE_ARRAY;
+    dst->card_ = k;
+    dst->cap_ = cap;
+    dst->elem_ = arr;
+    return true;
+}
+
+bool _RoaringSetContDifference(const Container* lhs, const Container* rhs, Container* dst)
+{
+    dst->key_ = lhs->key_;
+    unsigned i;
+
+    /* Case 1: The first operand is a bitmap. Clear the bits owned by the second
+       operand and shrink the result if it becomes sparse. */
+    if (lhs->type_ == TYPE_BITMAP) {
+        if (rhs->type_ == TYPE_BITMAP) {
+            uint64_t* map = (uint64_t*)malloc(sizeof(uint64_t) * NUM_BITMAP_WORD);
+            if (unlikely(!map))
+                return false;
+            dst->type_ = TYPE_BITMAP;
+            dst->cap_ = 0;
+            dst->elem_ = map;
+            dst->card_ = _RoaringSetBitmapAndNot((const uint64_t*)lhs->elem_,
+                                                 (const uint64_t*)rhs->elem_, map);
+        } else {
+            if (unlikely(!_RoaringSetCopy(lhs, dst)))
+                return false;
+            uint64_t* map = (uint64_t*)dst->elem_;
+            const uint16_t* arr = (const uint16_t*)rhs->elem_;
+            for (i = 0 ; i < rhs->card_ ; ++i) {
+                uint16_t val = arr[i];
+                uint64_t mask = (uint64_t)1 << (val & 63);
+                dst->card_ -= (map[val >> 6] & mask)? 1 : 0;
+                map[val >> 6] &= ~mask;
+            }
+        }
+
+        if (dst->card_ <= MAX_ARRAY_CARD)
+            _RoaringSetBitmapToArray(dst);
+        return true;
+    }
+
+    /* Case 2: The first operand is an array. Filter out the shared elements. */
+    unsigned cap = (lhs->card_ > 0)? lhs->card_ : 1;
+    uint16_t* arr = (uint16_t*)malloc(sizeof(uint16_t) * cap);
+    if (unlikely(!arr))
+        return false;
+
+    const uint16_t* arr_lhs = (const uint16_t*)lhs->elem_;
+    unsigned k = 0;
+    if (rhs->type_ == TYPE_BITMAP) {
+        const uint64_t* map = (const uint64_t*)rhs->elem_;
+        for (i = 0 ; i < lhs->card_ ; ++i) {
+            uint16_t val = arr_lhs[i];
+            arr[k] = val;
+            k += !((map[val >> 6] >> (val & 63)) & 1);
+        }
+    } else {
+        const uint16_t* arr_rhs = (const uint16_t*)rhs->elem_;
+        unsigned j = 0;
+        for (i = 0 ; i < lhs->card_ ; ++i) {
+            j = _RoaringSetGallop(arr_rhs, j, rhs->card_, arr_lhs[i]);
+            if (j == rhs->card_ || arr_rhs[j] != arr_lhs[i])
+                arr[k++] = arr_lhs[i];
+        }
+    }
+
+    dst->type_ = TYPE_ARRAY;
+    dst->card_ = k;
+    dst->cap_ = cap;
+    dst->elem_ = arr;
+    return true;
+}
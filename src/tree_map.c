@@ -40,25 +40,63 @@ static const char UP_LEFT = 3;
 static const char UP_RIGHT = 4;
 
 
+/* On LP64 the node takes 48 bytes: the color, the block flag and the subtree
+   count share the first word, followed by the pair and three links. Packing
+   the color into the low bit of the parent link does not shrink it, since the
+   32 bit count still occupies that word, and the links are needed by the
+   stackless iteration and the cursors. */
 typedef struct _TreeNode {
     char color_;
+    char block_;
+    unsigned count_;
     Pair pair_;
     struct _TreeNode* parent_;
     struct _TreeNode* left_;
     struct _TreeNode* right_;
 } TreeNode;
 
+typedef struct _SubTree {
+    TreeNode* root_;
+    unsigned height_;
+} SubTree;
+
+typedef struct _TreeBlock {
+    unsigned refs_;
+    TreeNode nodes_[];
+} TreeBlock;
+
 struct _TreeMapData {
     char iter_direct_;
     int size_;
     TreeNode* root_;
     TreeNode* null_;
     TreeNode* iter_node_;
+    TreeBlock** blocks_;
+    unsigned num_block_;
+    unsigned cap_block_;
+    TreeNode* free_;
+    TreeNode* bump_;
+    TreeNode* limit_;
+    unsigned chunk_;
+    bool heap_;
     TreeMapCompare func_cmp_;
     TreeMapCleanKey func_clean_key_;
     TreeMapCleanValue func_clean_val_;
 };
 
+/* The dummy node representing the NULL pointer of the tree. It is shared by
+   all the maps and is never written, so that the tree nodes can be moved
+   between maps without relinking their leaves. */
+static TreeNode null_node = {
+    .color_ = 1,
+    .block_ = false,
+    .count_ = 0,
+    .pair_ = {NULL, NULL},
+    .parent_ = &null_node,
+    .left_ = &null_node,
+    .right_ = &null_node
+};
+
 
 /*===========================================================================*
  *                  Definition for internal operations                       *
@@ -115,6 +153,15 @@ TreeNode* _TreeMapSuccessor(TreeNode* null, TreeNode* curr);
  */
 TreeNode* _TreeMapPredecessor(TreeNode* null, TreeNode* curr);
 
+/**
+ * @brief Adjust the subtree sizes of the designated node and all its ancestors.
+ *
+ * @param null          The pointer to the dummy node
+ * @param curr          The pointer to the designated node
+ * @param diff          The size difference
+ */
+void _TreeMapUpdateCount(TreeNode* null, TreeNode* curr, int diff);
+
 /**
  * @brief Make right rotation for the subtree rooted by the designated node.
  *
@@ -142,16 +189,33 @@ void _TreeMapLeftRotate(TreeMapData* data, TreeNode* curr);
  *
  * @param data          The pointer to the tree private data
  * @param curr          The pointer to the designated node
+ *
+ * @retval true         The red root is recolored, which increases the black
+ *                      height of the tree
+ * @retval false        The black height of the tree is unchanged
  */
-void _TreeMapInsertFixup(TreeMapData* data, TreeNode* curr);
+bool _TreeMapInsertFixup(TreeMapData* data, TreeNode* curr);
 
 /**
  * @brief Maintain the red black tree property after node deletion.
  *
+ * The parent is passed explicitly since the designated node can be the shared
+ * dummy node whose links are never updated.
+ *
+ * @param data          The pointer to the tree private data
+ * @param curr          The pointer to the designated node
+ * @param parent        The pointer to the parent of the designated node
+ */
+void _TreeMapDeleteFixup(TreeMapData* data, TreeNode* curr, TreeNode* parent);
+
+/**
+ * @brief Splice the designated node having at most one child out of the tree
+ * and maintain the subtree sizes and the red black tree property.
+ *
  * @param data          The pointer to the tree private data
  * @param curr          The pointer to the designated node
  */
-void _TreeMapDeleteFixup(TreeMapData* data, TreeNode* curr);
+void _TreeMapUnlink(TreeMapData* data, TreeNode* curr);
 
 /**
  * @brief Get the node which stores the key having the same order with the
@@ -165,6 +229,119 @@ void _TreeMapDeleteFixup(TreeMapData* data, TreeNode* curr);
  */
 TreeNode* _TreeMapSearch(TreeMapData* data, void* key);
 
+/**
+ * @brief Get the node which stores the smallest key not less than, or greater
+ * than if strict is specified, the designated one.
+ *
+ * @param data          The pointer to tree private data
+ * @param key           The designated key
+ * @param strict        Whether the key of the target node should be greater
+ *                      than the designated one
+ *
+ * @retval node         The target node
+ * @retval null         No such node
+ */
+TreeNode* _TreeMapBound(TreeMapData* data, void* key, bool strict);
+
+/**
+ * @brief Get the node storing the key with the designated order.
+ *
+ * @param data          The pointer to tree private data
+ * @param idx           The zero based order of the key
+ *
+ * @retval node         The target node
+ * @retval null         The order is out of range
+ */
+TreeNode* _TreeMapSelect(TreeMapData* data, unsigned idx);
+
+/**
+ * @brief Build the balanced subtree for the pairs indexed in [lo, hi).
+ *
+ * @param data          The pointer to tree private data
+ * @param nodes         The node block parallel to the pair array
+ * @param pairs         The sorted pair array
+ * @param lo            The inclusive lower index
+ * @param hi            The exclusive upper index
+ * @param parent        The parent of the subtree root
+ * @param depth         The depth of the subtree root
+ * @param red           The depth of the nodes to be colored red
+ *
+ * @retval node         The subtree root
+ * @retval null         The index range is empty
+ */
+TreeNode* _TreeMapBuild(TreeMapData* data, TreeNode* nodes, Pair* pairs,
+                        unsigned lo, unsigned hi, TreeNode* parent,
+                        unsigned depth, unsigned red);
+
+/**
+ * @brief Record the designated node block in the sorted block array.
+ *
+ * @param data          The pointer to tree private data
+ * @param block         The pointer to the designated block
+ *
+ * @retval true         The block is successfully recorded
+ * @retval false        Insufficient memory to grow the block array
+ */
+bool _TreeMapAddBlock(TreeMapData* data, TreeBlock* block);
+
+/**
+ * @brief Let the destination map also refer to all the node blocks of the
+ * source map, so that the nodes can be moved between them.
+ *
+ * @param dst           The pointer to the destination map private data
+ * @param src           The pointer to the source map private data
+ *
+ * @retval true         The blocks are successfully shared
+ * @retval false        Insufficient memory to grow the block array
+ */
+bool _TreeMapShareBlocks(TreeMapData* dst, TreeMapData* src);
+
+/**
+ * @brief Join two subtrees and a middle node into a balanced tree. All the keys
+ * in the left subtree should go before the middle one, and all the keys in the
+ * right subtree should go after it.
+ *
+ * The black height of a subtree counts its root as black, since the root is
+ * blackened before joining. Joining costs O(1 + |difference of heights|).
+ *
+ * @param null          The pointer to the dummy node
+ * @param lhs           The left subtree
+ * @param mid           The middle node
+ * @param rhs           The right subtree
+ *
+ * @retval tree         The joined tree
+ */
+SubTree _TreeMapJoin(TreeNode* null, SubTree lhs, TreeNode* mid, SubTree rhs);
+
+/**
+ * @brief Split the subtree into the one with keys going before the designated
+ * key, the node having the same key, and the one with keys going after it.
+ *
+ * @param data          The pointer to tree private data
+ * @param tree          The designated subtree
+ * @param key           The designated key
+ * @param p_lhs         The pointer to the returned left subtree
+ * @param p_mid         The pointer to the returned node with equal key
+ * @param p_rhs         The pointer to the returned right subtree
+ */
+void _TreeMapSplit(TreeMapData* data, SubTree tree, void* key,
+                   SubTree* p_lhs, TreeNode** p_mid, SubTree* p_rhs);
+
+/**
+ * @brief Merge two subtrees. For each pair of nodes with equal keys, the one
+ * from the source subtree is kept and the other is released.
+ *
+ * The smaller subtree is split by the nodes of the larger one, which costs
+ * O(m log(n/m + 1)) for subtree sizes m <= n.
+ *
+ * @param data          The pointer to tree private data
+ * @param dst           The destination subtree
+ * @param src           The source subtree
+ *
+ * @retval tree         The merged tree
+ */
+SubTree _TreeMapUnion(TreeMapData* data, SubTree dst, SubTree src);
+
 /**
  * @brief The default hash key comparison function.
  *
@@ -178,6 +355,113 @@ TreeNode* _TreeMapSearch(TreeMapData* data, void* key);
 int _TreeMapCompare(void* lhs, void* rhs);
 
 
+static inline
+void DETACH(TreeNode* null, TreeNode* node)
+{
+    if (node != null)
+        node->parent_ = null;
+}
+
+static inline
+SubTree SUBTREE(TreeNode* root, unsigned height)
+{
+    SubTree tree;
+    tree.root_ = root;
+    tree.height_ = height;
+    return tree;
+}
+
+/**
+ * @brief Detach the child from the designated subtree. Its black height is
+ * derived from the one of its parent since the child is counted only when it
+ * is black.
+ */
+static inline
+SubTree CHILD(TreeNode* null, SubTree tree, TreeNode* child)
+{
+    DETACH(null, child);
+    unsigned height = tree.height_ - ((child->color_ == COLOR_BLACK)? 1 : 0);
+    return SUBTREE(child, height);
+}
+
+static inline
+unsigned BLACK_HEIGHT(TreeNode* null, TreeNode* curr)
+{
+    unsigned height = 0;
+    while (curr != null) {
+        if (curr->color_ == COLOR_BLACK)
+            ++height;
+        curr = curr->left_;
+    }
+    return height;
+}
+
+static inline
+void RELEASE_PAIR(TreeMapData* data, TreeNode* node)
+{
+    if (data->func_clean_key_)
+        data->func_clean_key_(node->pair_.key);
+    if (data->func_clean_val_)
+        data->func_clean_val_(node->pair_.value);
+}
+
+/**
+ * @brief Allocate a tree node. The recycled block node is reused first. Then
+ * the node is carved from the current arena chunk if the arena is enabled.
+ */
+static inline
+TreeNode* NEW_NODE(TreeMapData* data)
+{
+    TreeNode* node = data->free_;
+    if (node) {
+        data->free_ = node->parent_;
+        return node;
+    }
+
+    if (data->chunk_ == 0) {
+        node = (TreeNode*)malloc(sizeof(TreeNode));
+        if (unlikely(!node))
+            return NULL;
+        node->block_ = false;
+        data->heap_ = true;
+        return node;
+    }
+
+    if (data->bump_ == data->limit_) {
+        TreeBlock* block = (TreeBlock*)malloc(sizeof(TreeBlock) +
+                                              sizeof(TreeNode) * data->chunk_);
+        if (unlikely(!block))
+            return NULL;
+        if (unlikely(!_TreeMapAddBlock(data, block))) {
+            free(block);
+            return NULL;
+        }
+        data->bump_ = block->nodes_;
+        data->limit_ = block->nodes_ + data->chunk_;
+    }
+
+    node = data->bump_++;
+    node->block_ = true;
+    return node;
+}
+
+/**
+ * @brief Release a tree node. The block node is chained for recycling, since
+ * its memory is owned by the block.
+ */
+static inline
+void FREE_NODE(TreeMapData* data, TreeNode* node)
+{
+    if (node->block_) {
+        node->parent_ = data->free_;
+        data->free_ = node;
+        return;
+    }
+
+    free(node);
+}
+
+
 /*===========================================================================*
  *               Implementation for the exported operations                  *
  *===========================================================================*/
@@ -193,23 +477,17 @@ TreeMap* TreeMapInit()
         return NULL;
     }
 
-    /* Create the dummy node representing the NULL pointer of the tree. */
-    TreeNode* null = (TreeNode*)malloc(sizeof(TreeNode));
-    if (unlikely(!null)) {
-        free(data);
-        free(obj);
-        return NULL;
-    }
-
-    null->color_ = COLOR_BLACK;
-    null->parent_ = NULL;
-    null->parent_ = null;
-    null->right_ = null;
-    null->left_ = null;
-
     data->size_ = 0;
-    data->null_ = null;
-    data->root_ = null;
+    data->null_ = &null_node;
+    data->root_ = &null_node;
+    data->blocks_ = NULL;
+    data->num_block_ = 0;
+    data->cap_block_ = 0;
+    data->free_ = NULL;
+    data->bump_ = NULL;
+    data->limit_ = NULL;
+    data->chunk_ = 0;
+    data->heap_ = false;
     data->func_cmp_ = _TreeMapCompare;
     data->func_clean_key_ = NULL;
     data->func_clean_val_ = NULL;
@@ -224,6 +502,20 @@ TreeMap* TreeMapInit()
     obj->maximum = TreeMapMaximum;
     obj->predecessor = TreeMapPredecessor;
     obj->successor = TreeMapSuccessor;
+    obj->lower_bound = TreeMapLowerBound;
+    obj->upper_bound = TreeMapUpperBound;
+    obj->begin = TreeMapBegin;
+    obj->range = TreeMapRange;
+    obj->reverse_begin = TreeMapReverseBegin;
+    obj->reverse_range = TreeMapReverseRange;
+    obj->partition = TreeMapPartition;
+    obj->rank = TreeMapRank;
+    obj->select = TreeMapSelect;
+    obj->build_sorted = TreeMapBuildSorted;
+    obj->split = TreeMapSplit;
+    obj->join = TreeMapJoin;
+    obj->merge = TreeMapMerge;
+    obj->set_arena = TreeMapSetArena;
     obj->first = TreeMapFirst;
     obj->next = TreeMapNext;
     obj->reverse_next = TreeMapReverseNext;
@@ -241,7 +533,17 @@ void TreeMapDeinit(TreeMap* obj)
 
     TreeMapData* data = obj->data;
     _TreeMapDeinit(data);
-    free(data->null_);
+
+    /* Release the node blocks allocated by bulk loading and the arena unless
+       they are still referred by the other maps. */
+    unsigned i;
+    for (i = 0 ; i < data->num_block_ ; ++i) {
+        TreeBlock* block = data->blocks_[i];
+        if (--block->refs_ == 0)
+            free(block);
+    }
+    free(data->blocks_);
+
     free(data);
     free(obj);
     return;
@@ -249,23 +551,12 @@ void TreeMapDeinit(TreeMap* obj)
 
 bool TreeMapPut(TreeMap* self, void* key, void* value)
 {
-    TreeNode* node = (TreeNode*)malloc(sizeof(TreeNode));
-    if (unlikely(!node))
-        return false;
-
     TreeMapData* data = self->data;
     TreeNode* null = data->null_;
-    node->pair_.key = key;
-    node->pair_.value = value;
-    node->color_ = COLOR_RED;
-    node->parent_ = null;
-    node->left_ = null;
-    node->right_ = null;
-
     TreeMapCompare func_cmp = data->func_cmp_;
     TreeNode* parent = null;
     TreeNode* curr = data->root_;
-    char direct;
+    char direct = DIRECT_LEFT;
     while (curr != null) {
         parent = curr;
         int order = func_cmp(key, curr->pair_.key);
@@ -279,7 +570,6 @@ bool TreeMapPut(TreeMap* self, void* key, void* value)
         }
         else {
             /* Conflict with the already stored key value pair. */
-            free(node);
             if (data->func_clean_key_)
                 data->func_clean_key_(curr->pair_.key);
             if (data->func_clean_val_)
@@ -292,6 +582,16 @@ bool TreeMapPut(TreeMap* self, void* key, void* value)
     }
 
     /* Arrive at the proper position. */
+    TreeNode* node = NEW_NODE(data);
+    if (unlikely(!node))
+        return false;
+
+    node->pair_.key = key;
+    node->pair_.value = value;
+    node->color_ = COLOR_RED;
+    node->count_ = 1;
+    node->left_ = null;
+    node->right_ = null;
     node->parent_ = parent;
     if (parent != null) {
         if (direct == DIRECT_LEFT)
@@ -303,6 +603,9 @@ bool TreeMapPut(TreeMap* self, void* key, void* value)
 
     data->size_++;
 
+    /* Count the new node in the subtree sizes of all its ancestors. */
+    _TreeMapUpdateCount(null, parent, 1);
+
     /* Maintain the red black tree structure. */
     _TreeMapInsertFixup(data, node);
 
@@ -331,82 +634,21 @@ bool TreeMapRemove(TreeMap* self, void* key)
     if (curr == null)
         return false;
 
-    TreeNode* child;
-    char color;
-    /* The specified node has no child. */
-    if ((curr->left_ == null) && (curr->right_ == null)) {
-        if (curr->parent_ != null) {
-            if (curr == curr->parent_->left_)
-                curr->parent_->left_ = null;
-            else
-                curr->parent_->right_ = null;
-        } else
-            data->root_ = null;
-
-        color = curr->color_;
-        child = null;
-        child->parent_ = curr->parent_;
-        if (data->func_clean_key_)
-            data->func_clean_key_(curr->pair_.key);
-        if (data->func_clean_val_)
-            data->func_clean_val_(curr->pair_.value);
-        free(curr);
-    } else {
-        /* The specified node has two children. */
-        if ((curr->left_ != null) && (curr->right_ != null)) {
-            TreeNode* succ = _TreeMapSuccessor(null, curr);
-
-            child = succ->left_;
-            if (child == null)
-                child = succ->right_;
-
-            child->parent_ = succ->parent_;
-
-            if (succ == succ->parent_->left_)
-                succ->parent_->left_ = child;
-            else
-                succ->parent_->right_ = child;
-
-            color = succ->color_;
-            if (data->func_clean_key_)
-                data->func_clean_key_(curr->pair_.key);
-            if (data->func_clean_val_)
-                data->func_clean_val_(curr->pair_.value);
-            curr->pair_.key = succ->pair_.key;
-            curr->pair_.value = succ->pair_.value;
-            free(succ);
-        }
-        /* The specified node has one child. */
-        else {
-            child = curr->left_;
-            if (child == null)
-                child = curr->right_;
-
-            child->parent_ = curr->parent_;
-
-            if (curr->parent_ != null) {
-                if (curr == curr->parent_->left_)
-                    curr->parent_->left_ = child;
-                else
-                    curr->parent_->right_ = child;
-            } else
-                data->root_ = child;
-
-            color = curr->color_;
-            if (data->func_clean_key_)
-                data->func_clean_key_(curr->pair_.key);
-            if (data->func_clean_val_)
-                data->func_clean_val_(curr->pair_.value);
-            free(curr);
-        }
+    if (data->func_clean_key_)
+        data->func_clean_key_(curr->pair_.key);
+    if (data->func_clean_val_)
+        data->func_clean_val_(curr->pair_.value);
+
+    /* If the specified node has two children, it takes over the pair of its
+       successor, and the successor having at most one child is spliced. */
+    if ((curr->left_ != null) && (curr->right_ != null)) {
+        TreeNode* succ = _TreeMapSuccessor(null, curr);
+        curr->pair_ = succ->pair_;
+        curr = succ;
     }
 
-    /* Decrease the size. */
-    data->size_--;
-
-    /* Maintain the balanced tree structure. */
-    if (color == COLOR_BLACK)
-        _TreeMapDeleteFixup(data, child);
+    _TreeMapUnlink(data, curr);
+    FREE_NODE(data, curr);
 
     return true;
 }
@@ -458,6 +700,313 @@ Pair* TreeMapSuccessor(TreeMap* self, void* key)
     return NULL;
 }
 
+Pair* TreeMapLowerBound(TreeMap* self, void* key)
+{
+    TreeNode* node = _TreeMapBound(self->data, key, false);
+    if (node != self->data->null_)
+        return &(node->pair_);
+    return NULL;
+}
+
+Pair* TreeMapUpperBound(TreeMap* self, void* key)
+{
+    TreeNode* node = _TreeMapBound(self->data, key, true);
+    if (node != self->data->null_)
+        return &(node->pair_);
+    return NULL;
+}
+
+void TreeMapBegin(TreeMap* self, TreeMapCursor* cursor)
+{
+    TreeMapData* data = self->data;
+    cursor->data_ = data;
+    cursor->node_ = _TreeMapMinimal(data->null_, data->root_);
+    cursor->end_ = data->null_;
+    cursor->reverse_ = false;
+}
+
+void TreeMapRange(TreeMap* self, void* lo, void* hi, TreeMapCursor* cursor)
+{
+    TreeMapData* data = self->data;
+    cursor->data_ = data;
+    cursor->reverse_ = false;
+
+    /* Resolve both boundaries to nodes up front, so that the walk compares
+       node addresses instead of keys. */
+    if (data->func_cmp_(lo, hi) >= 0) {
+        cursor->node_ = data->null_;
+        cursor->end_ = data->null_;
+        return;
+    }
+    cursor->node_ = _TreeMapBound(data, lo, false);
+    cursor->end_ = _TreeMapBound(data, hi, false);
+}
+
+void TreeMapReverseBegin(TreeMap* self, TreeMapCursor* cursor)
+{
+    TreeMapData* data = self->data;
+    cursor->data_ = data;
+    cursor->node_ = _TreeMapMaximal(data->null_, data->root_);
+    cursor->end_ = data->null_;
+    cursor->reverse_ = true;
+}
+
+void TreeMapReverseRange(TreeMap* self, void* lo, void* hi,
+                         TreeMapCursor* cursor)
+{
+    TreeMapData* data = self->data;
+    TreeNode* null = data->null_;
+    cursor->data_ = data;
+    cursor->reverse_ = true;
+
+    if (data->func_cmp_(lo, hi) >= 0) {
+        cursor->node_ = null;
+        cursor->end_ = null;
+        return;
+    }
+
+    /* The walk starts from the last key less than hi and stops at the last
+       key less than lo. */
+    TreeNode* node = _TreeMapBound(data, hi, false);
+    cursor->node_ = (node != null)? _TreeMapPredecessor(null, node) :
+                                    _TreeMapMaximal(null, data->root_);
+    node = _TreeMapBound(data, lo, false);
+    cursor->end_ = (node != null)? _TreeMapPredecessor(null, node) :
+                                   _TreeMapMaximal(null, data->root_);
+}
+
+unsigned TreeMapPartition(TreeMap* self, TreeMapCursor* cursors,
+                          unsigned count)
+{
+    TreeMapData* data = self->data;
+    TreeNode* null = data->null_;
+    unsigned size = data->root_->count_;
+    if (count > size)
+        count = size;
+
+    /* The i-th range begins at the pair of rank i * size / count. */
+    TreeNode* begin = _TreeMapSelect(data, 0);
+    unsigned i;
+    for (i = 0 ; i < count ; ++i) {
+        TreeNode* end = null;
+        if (i + 1 < count) {
+            unsigned idx = (unsigned long long)(i + 1) * size / count;
+            end = _TreeMapSelect(data, idx);
+        }
+        cursors[i].data_ = data;
+        cursors[i].node_ = begin;
+        cursors[i].end_ = end;
+        cursors[i].reverse_ = false;
+        begin = end;
+    }
+
+    return count;
+}
+
+Pair* TreeMapCursorNext(TreeMapCursor* cursor)
+{
+    TreeNode* null = cursor->data_->null_;
+    TreeNode* curr = (TreeNode*)cursor->node_;
+    if (curr == null || curr == cursor->end_)
+        return NULL;
+
+    cursor->node_ = (cursor->reverse_)? _TreeMapPredecessor(null, curr) :
+                                        _TreeMapSuccessor(null, curr);
+    return &(curr->pair_);
+}
+
+unsigned TreeMapRank(TreeMap* self, void* key)
+{
+    TreeMapCompare func_cmp = self->data->func_cmp_;
+    TreeNode* null = self->data->null_;
+    TreeNode* curr = self->data->root_;
+
+    /* Accumulate the sizes of the left subtrees we skip over. */
+    unsigned rank = 0;
+    while (curr != null) {
+        int order = func_cmp(key, curr->pair_.key);
+        if (order > 0) {
+            rank += curr->left_->count_ + 1;
+            curr = curr->right_;
+        } else if (order < 0)
+            curr = curr->left_;
+        else
+            return rank + curr->left_->count_;
+    }
+    return rank;
+}
+
+Pair* TreeMapSelect(TreeMap* self, unsigned idx)
+{
+    TreeNode* node = _TreeMapSelect(self->data, idx);
+    if (node != self->data->null_)
+        return &(node->pair_);
+    return NULL;
+}
+
+bool TreeMapBuildSorted(TreeMap* self, Pair* pairs, unsigned size)
+{
+    TreeMapData* data = self->data;
+    if (data->root_ != data->null_)
+        return false;
+
+    /* Reject the input which is not strictly ascending. */
+    TreeMapCompare func_cmp = data->func_cmp_;
+    unsigned i;
+    for (i = 1 ; i < size ; ++i) {
+        if (func_cmp(pairs[i - 1].key, pairs[i].key) >= 0)
+            return false;
+    }
+    if (size == 0)
+        return true;
+
+    TreeBlock* block =
+        (TreeBlock*)malloc(sizeof(TreeBlock) + sizeof(TreeNode) * size);
+    if (unlikely(!block))
+        return false;
+    if (unlikely(!_TreeMapAddBlock(data, block))) {
+        free(block);
+        return false;
+    }
+
+    /* Splitting at the middle keeps all the leaves within the two deepest
+       levels. Coloring the deepest level red then gives every path the same
+       number of black nodes. */
+    unsigned depth = 0;
+    while ((2u << depth) <= size)
+        ++depth;
+
+    TreeNode* root = _TreeMapBuild(data, block->nodes_, pairs, 0, size,
+                                   data->null_, 0, depth);
+    root->color_ = COLOR_BLACK;
+    data->root_ = root;
+    data->size_ = size;
+
+    return true;
+}
+
+TreeMap* TreeMapSplit(TreeMap* self, void* key)
+{
+    TreeMap* obj = TreeMapInit();
+    if (unlikely(!obj))
+        return NULL;
+
+    TreeMapData* data = self->data;
+    TreeMapData* other = obj->data;
+    if (unlikely(!_TreeMapShareBlocks(other, data))) {
+        TreeMapDeinit(obj);
+        return NULL;
+    }
+
+    other->func_cmp_ = data->func_cmp_;
+    other->func_clean_key_ = data->func_clean_key_;
+    other->func_clean_val_ = data->func_clean_val_;
+    other->chunk_ = data->chunk_;
+
+    /* Which side the individually allocated nodes go to is not known, so
+       both maps keep the flag. */
+    other->heap_ = data->heap_;
+
+    TreeNode* null = data->null_;
+    SubTree tree = SUBTREE(data->root_, BLACK_HEIGHT(null, data->root_));
+    SubTree lhs, rhs;
+    TreeNode* mid;
+    _TreeMapSplit(data, tree, key, &lhs, &mid, &rhs);
+    if (mid != null)
+        rhs = _TreeMapJoin(null, SUBTREE(null, 0), mid, rhs);
+
+    /* The split subtree can be rooted by a red node. */
+    if (lhs.root_ != null)
+        lhs.root_->color_ = COLOR_BLACK;
+    if (rhs.root_ != null)
+        rhs.root_->color_ = COLOR_BLACK;
+
+    data->root_ = lhs.root_;
+    data->size_ = lhs.root_->count_;
+    data->iter_node_ = null;
+    other->root_ = rhs.root_;
+    other->size_ = rhs.root_->count_;
+
+    return obj;
+}
+
+bool TreeMapJoin(TreeMap* self, TreeMap* other)
+{
+    TreeMapData* data = self->data;
+    TreeMapData* src = other->data;
+    TreeNode* null = data->null_;
+    if (src->root_ == null)
+        return true;
+    if (self == other)
+        return false;
+
+    /* The key ranges should be disjoint. */
+    TreeNode* max = _TreeMapMaximal(null, data->root_);
+    if (max != null) {
+        TreeNode* min = _TreeMapMinimal(null, src->root_);
+        if (data->func_cmp_(max->pair_.key, min->pair_.key) >= 0)
+            return false;
+    }
+
+    if (unlikely(!_TreeMapShareBlocks(data, src)))
+        return false;
+
+    /* Take the maximum node out of the left tree as the joining node. */
+    if (max != null) {
+        _TreeMapUnlink(data, max);
+        SubTree lhs = SUBTREE(data->root_, BLACK_HEIGHT(null, data->root_));
+        SubTree rhs = SUBTREE(src->root_, BLACK_HEIGHT(null, src->root_));
+        data->root_ = _TreeMapJoin(null, lhs, max, rhs).root_;
+    } else
+        data->root_ = src->root_;
+
+    data->size_ = data->root_->count_;
+    data->heap_ = data->heap_ || src->heap_;
+    data->iter_node_ = null;
+    if (!data->free_) {
+        data->free_ = src->free_;
+        src->free_ = NULL;
+    }
+
+    src->root_ = null;
+    src->size_ = 0;
+    src->heap_ = false;
+    src->iter_node_ = null;
+
+    return true;
+}
+
+bool TreeMapMerge(TreeMap* self, TreeMap* other)
+{
+    TreeMapData* data = self->data;
+    TreeMapData* src = other->data;
+    TreeNode* null = data->null_;
+    if (self == other || src->root_ == null)
+        return true;
+
+    if (unlikely(!_TreeMapShareBlocks(data, src)))
+        return false;
+
+    data->heap_ = data->heap_ || src->heap_;
+    SubTree dst = SUBTREE(data->root_, BLACK_HEIGHT(null, data->root_));
+    SubTree tree = SUBTREE(src->root_, BLACK_HEIGHT(null, src->root_));
+    data->root_ = _TreeMapUnion(data, dst, tree).root_;
+    data->root_->color_ = COLOR_BLACK;
+    data->size_ = data->root_->count_;
+    data->iter_node_ = null;
+    if (!data->free_) {
+        data->free_ = src->free_;
+        src->free_ = NULL;
+    }
+
+    src->root_ = null;
+    src->size_ = 0;
+    src->heap_ = false;
+    src->iter_node_ = null;
+
+    return true;
+}
+
 void TreeMapFirst(TreeMap* self)
 {
     self->data->iter_direct_ = DOWN_LEFT;
@@ -598,6 +1147,11 @@ Pair* TreeMapReverseNext(TreeMap* self)
     return NULL;
 }
 
+void TreeMapSetArena(TreeMap* self, unsigned chunk)
+{
+    self->data->chunk_ = chunk;
+}
+
 void TreeMapSetCompare(TreeMap* self, TreeMapCompare func)
 {
     self->data->func_cmp_ = func;
@@ -623,8 +1177,12 @@ void _TreeMapDeinit(TreeMapData* data)
     if (data->root_ == null)
         return;
 
+    /* If all the nodes live in the blocks and there is nothing to clean, the
+       blocks can be released without visiting any node. */
     TreeMapCleanKey func_clean_key = data->func_clean_key_;
     TreeMapCleanValue func_clean_val = data->func_clean_val_;
+    if (!data->heap_ && !func_clean_key && !func_clean_val)
+        return;
 
     char direct = DOWN_LEFT;
     TreeNode* curr = data->root_;
@@ -652,7 +1210,8 @@ void _TreeMapDeinit(TreeMapData* data)
                 func_clean_key(temp->pair_.key);
             if (func_clean_val)
                 func_clean_val(temp->pair_.value);
-            free(temp);
+            if (!temp->block_)
+                free(temp);
             continue;
         }
 
@@ -674,7 +1233,8 @@ void _TreeMapDeinit(TreeMapData* data)
                 func_clean_key(temp->pair_.key);
             if (func_clean_val)
                 func_clean_val(temp->pair_.value);
-            free(temp);
+            if (!temp->block_)
+                free(temp);
             continue;
         }
 
@@ -689,7 +1249,8 @@ void _TreeMapDeinit(TreeMapData* data)
             func_clean_key(temp->pair_.key);
         if (func_clean_val)
             func_clean_val(temp->pair_.value);
-        free(temp);
+        if (!temp->block_)
+            free(temp);
     }
 
     return;
@@ -751,6 +1312,14 @@ TreeNode* _TreeMapPredecessor(TreeNode* null, TreeNode* curr)
     return curr;
 }
 
+void _TreeMapUpdateCount(TreeNode* null, TreeNode* curr, int diff)
+{
+    while (curr != null) {
+        curr->count_ += diff;
+        curr = curr->parent_;
+    }
+}
+
 void _TreeMapRightRotate(TreeMapData* data, TreeNode* curr)
 {
     TreeNode* null = data->null_;
@@ -786,6 +1355,10 @@ void _TreeMapRightRotate(TreeMapData* data, TreeNode* curr)
     curr->parent_ = child;
     child->right_ = curr;
 
+    /* x now roots the subtree previously rooted by y. */
+    child->count_ = curr->count_;
+    curr->count_ = curr->left_->count_ + curr->right_->count_ + 1;
+
     return;
 }
 
@@ -824,10 +1397,14 @@ void _TreeMapLeftRotate(TreeMapData* data, TreeNode* curr)
     curr->parent_ = child;
     child->left_ = curr;
 
+    /* y now roots the subtree previously rooted by x. */
+    child->count_ = curr->count_;
+    curr->count_ = curr->left_->count_ + curr->right_->count_ + 1;
+
     return;
 }
 
-void _TreeMapInsertFixup(TreeMapData* data, TreeNode* curr)
+bool _TreeMapInsertFixup(TreeMapData* data, TreeNode* curr)
 {
     TreeNode* uncle;
 
@@ -924,19 +1501,20 @@ void _TreeMapInsertFixup(TreeMapData* data, TreeNode* curr)
         }
     }
 
+    bool grow = (data->root_->color_ == COLOR_RED);
     data->root_->color_ = COLOR_BLACK;
-    return;
+    return grow;
 }
 
-void _TreeMapDeleteFixup(TreeMapData* data, TreeNode* curr)
+void _TreeMapDeleteFixup(TreeMapData* data, TreeNode* curr, TreeNode* parent)
 {
     TreeNode* brother;
 
     /* Denote the current node as x. */
     while ((curr != data->root_) && (curr->color_ == COLOR_BLACK)) {
         /* x is its parent's left child. */
-        if (curr == curr->parent_->left_) {
-            brother = curr->parent_->right_;
+        if (curr == parent->left_) {
+            brother = parent->right_;
             /**
              * Case 1: The color of x's brother is red.
              * Set the color of x's brother to black.
@@ -953,9 +1531,9 @@ void _TreeMapDeleteFixup(TreeMapData* data, TreeNode* curr)
              */
             if (brother->color_ == COLOR_RED) {
                 brother->color_ = COLOR_BLACK;
-                curr->parent_->color_ = COLOR_RED;
-                _TreeMapLeftRotate(data, curr->parent_);
-                brother = curr->parent_->right_;
+                parent->color_ = COLOR_RED;
+                _TreeMapLeftRotate(data, parent);
+                brother = parent->right_;
             }
             /**
              * Case 2: The color of x's brother is black, and both of its
@@ -972,7 +1550,8 @@ void _TreeMapDeleteFixup(TreeMapData* data, TreeNode* curr)
             if ((brother->left_->color_ == COLOR_BLACK) &&
                 (brother->right_->color_ == COLOR_BLACK)) {
                 brother->color_ = COLOR_RED;
-                curr = curr->parent_;
+                curr = parent;
+                parent = curr->parent_;
             } else {
                 /**
                  * Case 3: The color of x's brother is black, and the colors of
@@ -994,7 +1573,7 @@ void _TreeMapDeleteFixup(TreeMapData* data, TreeNode* curr)
                     brother->left_->color_ = COLOR_BLACK;
                     brother->color_ = COLOR_RED;
                     _TreeMapRightRotate(data, brother);
-                    brother = curr->parent_->right_;
+                    brother = parent->right_;
                 }
                 /**
                  * Case 4: The color of x's brother is black, and its right child
@@ -1013,29 +1592,30 @@ void _TreeMapDeleteFixup(TreeMapData* data, TreeNode* curr)
                  *                    / \
                  *                   A   B
                  */
-                brother->color_ = curr->parent_->color_;
-                curr->parent_->color_ = COLOR_BLACK;
+                brother->color_ = parent->color_;
+                parent->color_ = COLOR_BLACK;
                 brother->right_->color_ = COLOR_BLACK;
-                _TreeMapLeftRotate(data, curr->parent_);
+                _TreeMapLeftRotate(data, parent);
                 curr = data->root_;
             }
         }
         /* x is its parent's right child */
         else {
-            brother = curr->parent_->left_;
+            brother = parent->left_;
             /* Case 1: The color of x's brother is red. */
             if (brother->color_ == COLOR_RED) {
                 brother->color_ = COLOR_BLACK;
-                curr->parent_->color_ = COLOR_RED;
-                _TreeMapRightRotate(data, curr->parent_);
-                brother = curr->parent_->left_;
+                parent->color_ = COLOR_RED;
+                _TreeMapRightRotate(data, parent);
+                brother = parent->left_;
             }
             /* Case 2: The color of x's brother is black, and both of its
                children are also black. */
             if ((brother->left_->color_ == COLOR_BLACK) &&
                 (brother->right_->color_ == COLOR_BLACK)) {
                 brother->color_ = COLOR_RED;
-                curr = curr->parent_;
+                curr = parent;
+                parent = curr->parent_;
             } else {
                 /* Case 3: The color of x's brother is black and the colors of its
                    right and left child are red and black respectively. */
@@ -1043,20 +1623,48 @@ void _TreeMapDeleteFixup(TreeMapData* data, TreeNode* curr)
                     brother->right_->color_ = COLOR_BLACK;
                     brother->color_ = COLOR_RED;
                     _TreeMapLeftRotate(data, brother);
-                    brother = curr->parent_->left_;
+                    brother = parent->left_;
                 }
                 /* Case 4: The color of x's brother is black, and its left child
                    is red. */
-                brother->color_ = curr->parent_->color_;
-                curr->parent_->color_ = COLOR_BLACK;
+                brother->color_ = parent->color_;
+                parent->color_ = COLOR_BLACK;
                 brother->left_->color_ = COLOR_BLACK;
-                _TreeMapRightRotate(data, curr->parent_);
+                _TreeMapRightRotate(data, parent);
                 curr = data->root_;
             }
         }
     }
 
-    curr->color_ = COLOR_BLACK;
+    if (curr != data->null_)
+        curr->color_ = COLOR_BLACK;
+    return;
+}
+
+void _TreeMapUnlink(TreeMapData* data, TreeNode* curr)
+{
+    TreeNode* null = data->null_;
+    TreeNode* parent = curr->parent_;
+    TreeNode* child = (curr->left_ != null)? curr->left_ : curr->right_;
+
+    if (child != null)
+        child->parent_ = parent;
+    if (parent != null) {
+        if (curr == parent->left_)
+            parent->left_ = child;
+        else
+            parent->right_ = child;
+    } else
+        data->root_ = child;
+
+    /* Decrease the size. */
+    data->size_--;
+    _TreeMapUpdateCount(null, parent, -1);
+
+    /* Maintain the balanced tree structure. */
+    if (curr->color_ == COLOR_BLACK)
+        _TreeMapDeleteFixup(data, child, parent);
+
     return;
 }
 
@@ -1079,6 +1687,281 @@ TreeNode* _TreeMapSearch(TreeMapData* data, void* key)
     return curr;
 }
 
+TreeNode* _TreeMapSelect(TreeMapData* data, unsigned idx)
+{
+    TreeNode* curr = data->root_;
+    if (idx >= curr->count_)
+        return data->null_;
+
+    while (true) {
+        unsigned left = curr->left_->count_;
+        if (idx < left)
+            curr = curr->left_;
+        else if (idx > left) {
+            idx -= left + 1;
+            curr = curr->right_;
+        } else
+            break;
+    }
+    return curr;
+}
+
+TreeNode* _TreeMapBuild(TreeMapData* data, TreeNode* nodes, Pair* pairs,
+                        unsigned lo, unsigned hi, TreeNode* parent,
+                        unsigned depth, unsigned red)
+{
+    TreeNode* null = data->null_;
+    if (lo >= hi)
+        return null;
+
+    unsigned mid = lo + (hi - lo) / 2;
+    TreeNode* node = nodes + mid;
+    node->color_ = (depth == red)? COLOR_RED : COLOR_BLACK;
+    node->block_ = true;
+    node->count_ = hi - lo;
+    node->pair_ = pairs[mid];
+    node->parent_ = parent;
+    node->left_ = _TreeMapBuild(data, nodes, pairs, lo, mid, node,
+                                depth + 1, red);
+    node->right_ = _TreeMapBuild(data, nodes, pairs, mid + 1, hi, node,
+                                 depth + 1, red);
+    return node;
+}
+
+TreeNode* _TreeMapBound(TreeMapData* data, void* key, bool strict)
+{
+    TreeMapCompare func_cmp = data->func_cmp_;
+    TreeNode* null = data->null_;
+    TreeNode* curr = data->root_;
+    TreeNode* bound = null;
+
+    /* Record the last node where the search turns left. That is the smallest
+       node whose key goes after the designated one. */
+    while (curr != null) {
+        int order = func_cmp(key, curr->pair_.key);
+        if (order == 0 && !strict)
+            return curr;
+        if (order < 0) {
+            bound = curr;
+            curr = curr->left_;
+        } else
+            curr = curr->right_;
+    }
+    return bound;
+}
+
+bool _TreeMapAddBlock(TreeMapData* data, TreeBlock* block)
+{
+    if (data->num_block_ == data->cap_block_) {
+        unsigned cap = (data->cap_block_ == 0)? 4 : data->cap_block_ << 1;
+        TreeBlock** blocks =
+            (TreeBlock**)realloc(data->blocks_, sizeof(TreeBlock*) * cap);
+        if (unlikely(!blocks))
+            return false;
+        data->blocks_ = blocks;
+        data->cap_block_ = cap;
+    }
+
+    /* Keep the array sorted by address so that sharing can merge it. */
+    unsigned idx = data->num_block_;
+    while (idx > 0 && data->blocks_[idx - 1] > block) {
+        data->blocks_[idx] = data->blocks_[idx - 1];
+        --idx;
+    }
+    data->blocks_[idx] = block;
+    data->num_block_++;
+    block->refs_ = 1;
+
+    return true;
+}
+
+bool _TreeMapShareBlocks(TreeMapData* dst, TreeMapData* src)
+{
+    if (src->num_block_ == 0)
+        return true;
+
+    unsigned cap = dst->num_block_ + src->num_block_;
+    TreeBlock** blocks = (TreeBlock**)malloc(sizeof(TreeBlock*) * cap);
+    if (unlikely(!blocks))
+        return false;
+
+    /* Merge the two sorted arrays and count the newly referred blocks. */
+    unsigned i = 0, j = 0, k = 0;
+    while (i < dst->num_block_ || j < src->num_block_) {
+        if (j == src->num_block_ ||
+            (i < dst->num_block_ && dst->blocks_[i] < src->blocks_[j]))
+            blocks[k++] = dst->blocks_[i++];
+        else if (i == dst->num_block_ || src->blocks_[j] < dst->blocks_[i]) {
+            src->blocks_[j]->refs_++;
+            blocks[k++] = src->blocks_[j++];
+        } else {
+            blocks[k++] = dst->blocks_[i++];
+            ++j;
+        }
+    }
+
+    free(dst->blocks_);
+    dst->blocks_ = blocks;
+    dst->num_block_ = k;
+    dst->cap_block_ = cap;
+
+    return true;
+}
+
+SubTree _TreeMapJoin(TreeNode* null, SubTree lhs, TreeNode* mid, SubTree rhs)
+{
+    /* The subtree roots are treated as black. */
+    if (lhs.root_ != null)
+        lhs.root_->color_ = COLOR_BLACK;
+    if (rhs.root_ != null)
+        rhs.root_->color_ = COLOR_BLACK;
+
+    mid->parent_ = null;
+    if (lhs.height_ == rhs.height_) {
+        mid->color_ = COLOR_BLACK;
+        mid->left_ = lhs.root_;
+        mid->right_ = rhs.root_;
+        mid->count_ = lhs.root_->count_ + rhs.root_->count_ + 1;
+        if (lhs.root_ != null)
+            lhs.root_->parent_ = mid;
+        if (rhs.root_ != null)
+            rhs.root_->parent_ = mid;
+        return SUBTREE(mid, lhs.height_ + 1);
+    }
+
+    /* Descend along the inner spine of the taller tree to the black node with
+       the black height of the shorter tree. The middle node then replaces
+       that node as a red node, and the insertion fixup resolves the possible
+       red violation. */
+    TreeMapData scratch;
+    scratch.null_ = null;
+
+    TreeNode* parent = null;
+    unsigned height;
+    if (lhs.height_ > rhs.height_) {
+        TreeNode* curr = lhs.root_;
+        height = lhs.height_;
+        while (curr->color_ != COLOR_BLACK || height != rhs.height_) {
+            parent = curr;
+            if (curr->color_ == COLOR_BLACK)
+                --height;
+            curr = curr->right_;
+        }
+
+        mid->left_ = curr;
+        mid->right_ = rhs.root_;
+        mid->count_ = curr->count_ + rhs.root_->count_ + 1;
+        parent->right_ = mid;
+        if (curr != null)
+            curr->parent_ = mid;
+        if (rhs.root_ != null)
+            rhs.root_->parent_ = mid;
+        _TreeMapUpdateCount(null, parent, rhs.root_->count_ + 1);
+        scratch.root_ = lhs.root_;
+        height = lhs.height_;
+    } else {
+        TreeNode* curr = rhs.root_;
+        height = rhs.height_;
+        while (curr->color_ != COLOR_BLACK || height != lhs.height_) {
+            parent = curr;
+            if (curr->color_ == COLOR_BLACK)
+                --height;
+            curr = curr->left_;
+        }
+
+        mid->left_ = lhs.root_;
+        mid->right_ = curr;
+        mid->count_ = lhs.root_->count_ + curr->count_ + 1;
+        parent->left_ = mid;
+        if (curr != null)
+            curr->parent_ = mid;
+        if (lhs.root_ != null)
+            lhs.root_->parent_ = mid;
+        _TreeMapUpdateCount(null, parent, lhs.root_->count_ + 1);
+        scratch.root_ = rhs.root_;
+        height = rhs.height_;
+    }
+
+    mid->parent_ = parent;
+    mid->color_ = COLOR_RED;
+    if (_TreeMapInsertFixup(&scratch, mid))
+        ++height;
+
+    return SUBTREE(scratch.root_, height);
+}
+
+void _TreeMapSplit(TreeMapData* data, SubTree tree, void* key,
+                   SubTree* p_lhs, TreeNode** p_mid, SubTree* p_rhs)
+{
+    TreeNode* null = data->null_;
+    TreeNode* curr = tree.root_;
+    if (curr == null) {
+        *p_lhs = *p_rhs = tree;
+        *p_mid = null;
+        return;
+    }
+
+    SubTree left = CHILD(null, tree, curr->left_);
+    SubTree right = CHILD(null, tree, curr->right_);
+
+    int order = data->func_cmp_(key, curr->pair_.key);
+    if (order < 0) {
+        SubTree rhs;
+        _TreeMapSplit(data, left, key, p_lhs, p_mid, &rhs);
+        *p_rhs = _TreeMapJoin(null, rhs, curr, right);
+    } else if (order > 0) {
+        SubTree lhs;
+        _TreeMapSplit(data, right, key, &lhs, p_mid, p_rhs);
+        *p_lhs = _TreeMapJoin(null, left, curr, lhs);
+    } else {
+        *p_lhs = left;
+        *p_mid = curr;
+        *p_rhs = right;
+    }
+    return;
+}
+
+SubTree _TreeMapUnion(TreeMapData* data, SubTree dst, SubTree src)
+{
+    TreeNode* null = data->null_;
+    if (dst.root_ == null)
+        return src;
+    if (src.root_ == null)
+        return dst;
+
+    /* Pick the root of the larger subtree as the pivot to split the smaller
+       one. The pair from the source subtree wins the key conflict. */
+    bool pivot_src = (src.root_->count_ >= dst.root_->count_);
+    SubTree pivot = (pivot_src)? src : dst;
+    SubTree other = (pivot_src)? dst : src;
+
+    TreeNode* node = pivot.root_;
+    SubTree left = CHILD(null, pivot, node->left_);
+    SubTree right = CHILD(null, pivot, node->right_);
+
+    SubTree lhs, rhs;
+    TreeNode* mid;
+    _TreeMapSplit(data, other, node->pair_.key, &lhs, &mid, &rhs);
+    if (mid != null) {
+        if (pivot_src) {
+            RELEASE_PAIR(data, mid);
+        } else {
+            RELEASE_PAIR(data, node);
+            node->pair_ = mid->pair_;
+        }
+        FREE_NODE(data, mid);
+    }
+
+    if (pivot_src) {
+        lhs = _TreeMapUnion(data, lhs, left);
+        rhs = _TreeMapUnion(data, rhs, right);
+    } else {
+        lhs = _TreeMapUnion(data, left, lhs);
+        rhs = _TreeMapUnion(data, right, rhs);
+    }
+    return _TreeMapJoin(null, lhs, node, rhs);
+}
+
 int _TreeMapCompare(void* lhs, void* rhs)
 {
     if ((intptr_t)lhs == (intptr_t)rhs)
@@ -22,6 +22,11 @@
  */
 
 #include "container/trie.h"
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
 
 
 /*===========================================================================*
@@ -38,22 +43,251 @@ static const char DOWN_MIDDLE = 3;
 static const char UP_LEFT = 4;
 static const char UP_RIGHT = 5;
 static const char UP_MIDDLE = 6;
+static const char TURN_MIDDLE = 7;
+static const char BEGIN = 8;
 
+/* The radix sort falls back to insertion sort for the small ranges, and the
+   parallel sort hands out ranges of about a fraction of the input per thread
+   to balance the load. */
+static const unsigned SORT_CUTOFF = 32;
+static const unsigned SORT_SHARE = 8;
+static const unsigned SORT_GRAIN = 4096;
 
+/* The sort buckets by token. The end of the string sorts first, followed by
+   the tokens in the order of the sibling comparison. */
+#define SORT_BUCKET     257
+
+
+/* The best_ field keeps the maximum score of the strings stored in the
+   subtree, which includes the left and the right siblings. The pooled_ field
+   marks the nodes carved from a block by the bulk build or the arena. */
 typedef struct TrieNode_ {
     bool endstr_;
     char token_;
+    bool pooled_;
+    unsigned score_;
+    unsigned best_;
+    void* value_;
     struct TrieNode_* left_;
     struct TrieNode_* middle_;
     struct TrieNode_* right_;
     struct TrieNode_* parent_;
 } TrieNode;
 
+/* The node block allocated by the bulk build or the arena, which is released
+   as a whole by the destructor. */
+typedef struct TrieBlock_ {
+    struct TrieBlock_* next_;
+    TrieNode nodes_[];
+} TrieBlock;
+
 struct TrieData_ {
     unsigned size_;
     unsigned count_node_;
     unsigned depth_;
     TrieNode* root_;
+    TrieBlock* blocks_;
+    TrieNode* bump_;
+    TrieNode* limit_;
+    unsigned chunk_;
+    unsigned heap_;
+    size_t bytes_;
+    TrieCleanValue func_clean_val_;
+};
+
+/* The shared state of the parallel sort. The workers claim the ranges in
+   turn until all of them are sorted. */
+typedef struct TrieSortRange_ {
+    unsigned lo_;
+    unsigned hi_;
+    unsigned depth_;
+} TrieSortRange;
+
+typedef struct TrieSort_ {
+    const char** strs_;
+    const char** aux_;
+    TrieSortRange* ranges_;
+    unsigned count_range_;
+    unsigned next_range_;
+} TrieSort;
+
+/* The cursor over the sorted strings while the bulk build carves the nodes
+   from the block in depth first order. */
+typedef struct TrieBuild_ {
+    const char** strs_;
+    TrieNode* nodes_;
+    unsigned count_node_;
+} TrieBuild;
+
+
+/* The frozen image header. The byte order mark rejects the images written by
+   a host of the other order, and the header size keeps the units aligned. */
+static const char FROZEN_MAGIC[8] = "CDSTRIE";
+static const uint32_t FROZEN_ORDER = 0x01020304;
+static const uint32_t FROZEN_VERSION = 2;
+
+/* The check value of the unoccupied units, and the occupancy ratio above which
+   the base search skips the scanned region for good. */
+static const int32_t FROZEN_FREE = -1;
+static const double FROZEN_DENSITY = 0.95;
+
+/* The word graph image header, whose layout follows the frozen image. The
+   arc flags mark the arc ending a stored string and the last arc leaving a
+   state. */
+static const char DAWG_MAGIC[8] = "CDSDAWG";
+static const uint32_t DAWG_VERSION = 1;
+static const uint8_t DAWG_FINAL = 1;
+static const uint8_t DAWG_LAST = 2;
+
+/* The number of arcs leaving a state is bounded by the byte labels. */
+#define DAWG_FANOUT     256
+
+/* The best first search frontier. An entry is either a subtree ranked by its
+   maximum score or a single string ranked by its own score. */
+typedef struct TrieRank_ {
+    unsigned score_;
+    bool single_;
+    TrieNode* node_;
+} TrieRank;
+
+typedef struct TrieHeap_ {
+    TrieRank* ranks_;
+    unsigned size_;
+    unsigned capacity_;
+} TrieHeap;
+
+/* The approximate search state. The edit distance rows are stacked by trie
+   level, and the row at level d holds the distances between the first d
+   tokens of the current path and every prefix of the query. */
+typedef struct TrieFuzzy_ {
+    const char* query_;
+    unsigned length_;
+    unsigned max_edits_;
+    unsigned* rows_;
+    char* record_;
+    unsigned count_;
+    TrieVisitDistance func_;
+    void* arg_;
+} TrieFuzzy;
+
+
+typedef struct FrozenHeader_ {
+    char magic_[8];
+    uint32_t order_;
+    uint32_t version_;
+    uint32_t size_;
+    uint32_t depth_;
+    uint32_t count_unit_;
+    uint32_t reserve_;
+} FrozenHeader;
+
+typedef struct FrozenUnit_ {
+    int32_t base_;
+    int32_t check_;
+} FrozenUnit;
+
+typedef struct FrozenBuild_ {
+    FrozenUnit* units_;
+    unsigned capacity_;
+    unsigned count_unit_;
+    unsigned next_free_;
+    char* pool_;
+    const char** strs_;
+    unsigned count_str_;
+} FrozenBuild;
+
+typedef struct FrozenVisit_ {
+    const FrozenUnit* units_;
+    unsigned count_unit_;
+    unsigned depth_;
+    char* record_;
+    unsigned limit_;
+    unsigned count_;
+    TrieVisit func_;
+    void* arg_;
+} FrozenVisit;
+
+/* The scanner shares the double array transitions with the frozen image.
+   The arrays indexed by state give the failure link, the nearest state on the
+   failure chain ending a string, and the pool offset plus one of the string
+   ending at the state. */
+struct TrieScannerData_ {
+    FrozenUnit* units_;
+    unsigned count_unit_;
+    uint32_t* fail_;
+    uint32_t* output_;
+    uint32_t* word_;
+    char* pool_;
+    unsigned state_;
+    size_t offset_;
+};
+
+struct FrozenTrieData_ {
+    void* image_;
+    size_t length_;
+    const FrozenUnit* units_;
+    unsigned count_unit_;
+    unsigned size_;
+    unsigned depth_;
+};
+
+typedef struct DawgHeader_ {
+    char magic_[8];
+    uint32_t order_;
+    uint32_t version_;
+    uint32_t size_;
+    uint32_t depth_;
+    uint32_t count_arc_;
+    uint32_t root_;
+} DawgHeader;
+
+/* The arcs leaving a state are stored contiguously in label order, and a
+   state is referred to by the index of its first arc. The arc 0 is a sentinel,
+   so the target 0 denotes the state without any arc. The rank_ field counts
+   the strings reachable through the preceding arcs of the same state. */
+typedef struct DawgArc_ {
+    uint32_t target_;
+    uint32_t rank_;
+    uint8_t label_;
+    uint8_t flag_;
+    uint16_t reserve_;
+} DawgArc;
+
+/* The minimization state. The states on the path of the last inserted string
+   are still open and are kept per depth, while the closed states are unique
+   and are registered in a hash table of their first arcs. */
+typedef struct DawgBuild_ {
+    DawgArc* arcs_;
+    uint32_t* words_;
+    unsigned count_arc_;
+    unsigned capacity_;
+    uint32_t* table_;
+    unsigned count_state_;
+    unsigned capacity_table_;
+    DawgArc* path_;
+    unsigned* count_path_;
+} DawgBuild;
+
+typedef struct DawgVisit_ {
+    const DawgArc* arcs_;
+    unsigned count_arc_;
+    unsigned depth_;
+    char* record_;
+    unsigned limit_;
+    unsigned count_;
+    TrieVisit func_;
+    void* arg_;
+} DawgVisit;
+
+struct DawgData_ {
+    void* image_;
+    size_t length_;
+    DawgArc* owned_;
+    const DawgArc* arcs_;
+    unsigned count_arc_;
+    unsigned root_;
+    unsigned size_;
+    unsigned depth_;
 };
 
 
@@ -70,6 +304,484 @@ struct TrieData_ {
  */
 void _TrieDeinit(TrieData* data);
 
+/**
+ * @brief Append the string to the trie if it is absent.
+ *
+ * @param data          The pointer to the trie private data
+ * @param str           The specified non empty string
+ *
+ * @retval node         The node ending the string
+ * @retval NULL         Insufficient memory for node allocation
+ */
+TrieNode* _TrieAppend(TrieData* data, const char* str);
+
+/**
+ * @brief Sort the strings by a most significant digit radix sort.
+ *
+ * The ranges of the leading tokens are split by the calling thread until they
+ * are small enough to balance the load, and are then sorted by the workers.
+ *
+ * @param strs          The strings to sort
+ * @param aux           The auxiliary array of the same size
+ * @param size          The number of strings
+ * @param num_thread    The number of sorting threads
+ *
+ * @retval true         The strings are sorted
+ * @retval false        Insufficient memory for the range list
+ */
+bool _TrieSort(const char** strs, const char** aux, unsigned size,
+               unsigned num_thread);
+
+/**
+ * @brief Sort the string range starting from the designated token.
+ *
+ * @param strs          The strings to sort
+ * @param aux           The auxiliary array of the same size
+ * @param lo            The begin of the range
+ * @param hi            The end of the range
+ * @param depth         The position of the first token which may differ
+ */
+void _TrieSortRange(const char** strs, const char** aux, unsigned lo,
+                    unsigned hi, unsigned depth);
+
+/**
+ * @brief Distribute the string range into the buckets of its first differing
+ * token.
+ *
+ * @param strs          The strings to distribute
+ * @param aux           The auxiliary array of the same size
+ * @param lo            The begin of the range
+ * @param hi            The end of the range
+ * @param p_depth       The pointer to the position of the first token which
+ *                      may differ, which is advanced over the common prefix
+ * @param bounds        The returned bucket boundaries
+ */
+void _TrieSortSplit(const char** strs, const char** aux, unsigned lo,
+                    unsigned hi, unsigned* p_depth, unsigned* bounds);
+
+/**
+ * @brief The sorting worker.
+ *
+ * @param arg           The pointer to the shared sort state
+ *
+ * @retval NULL         Always
+ */
+void* _TrieSortWork(void* arg);
+
+/**
+ * @brief Build the sibling tree of the sorted distinct strings sharing the
+ * prefix of the designated length.
+ *
+ * The sibling splitting the range by the number of strings becomes the root,
+ * so the frequent branches are reached by fewer sibling hops. The nodes are
+ * carved from the block in depth first order.
+ *
+ * @param build         The pointer to the build state
+ * @param lo            The begin of the string range
+ * @param hi            The end of the string range
+ * @param depth         The length of the shared prefix
+ * @param parent        The parent of the sibling tree
+ *
+ * @retval node         The root of the sibling tree
+ */
+TrieNode* _TrieBuild(TrieBuild* build, unsigned lo, unsigned hi,
+                     unsigned depth, TrieNode* parent);
+
+/**
+ * @brief Insert the sorted distinct strings into the non empty trie in median
+ * first order.
+ *
+ * Inserting the sorted strings in their order would grow each new sibling tree
+ * into a chain leaning right. Inserting the median of the range first, and
+ * then the medians of both halves, keeps the new sibling trees balanced.
+ *
+ * @param data          The pointer to the trie private data
+ * @param strs          The sorted array of strings
+ * @param lo            The begin of the string range
+ * @param hi            The end of the string range
+ *
+ * @retval true         The strings are successfully inserted
+ * @retval false        Insufficient memory
+ */
+bool _TrieBulkMerge(TrieData* data, const char** strs, unsigned lo,
+                    unsigned hi);
+
+/**
+ * @brief Locate the trie node ending the specified prefix.
+ *
+ * @param data          The pointer to the trie private data
+ * @param prefix        The specified prefix
+ *
+ * @retval node         The node holding the last token of the prefix
+ * @retval NULL         No such prefix
+ */
+TrieNode* _TrieSeek(TrieData* data, const char* prefix);
+
+/**
+ * @brief Resume the in order walk of the cursor until the next string end.
+ *
+ * The walk visits the left subtree, the node itself, the middle subtree, and
+ * the right subtree in turn, which yields the strings in lexical order. The
+ * parent links make the walk resumable from the node and the direction alone.
+ *
+ * @param cursor        The pointer to the cursor
+ *
+ * @retval true         The next match is written into the cursor buffer
+ * @retval false        No more matches
+ */
+bool _TrieCursorNext(TrieCursor* cursor);
+
+/**
+ * @brief Refresh the maximum scores from the designated node up to the root.
+ *
+ * @param node          The pointer to the node whose subtree is changed
+ */
+void _TrieRefresh(TrieNode* node);
+
+/**
+ * @brief Push an entry into the best first search frontier.
+ *
+ * @param heap          The pointer to the frontier
+ * @param score         The rank of the entry
+ * @param single        Whether the entry is a single string
+ * @param node          The pointer to the node of the entry
+ *
+ * @retval true         The entry is successfully pushed
+ * @retval false        Insufficient memory
+ */
+bool _TrieHeapPush(TrieHeap* heap, unsigned score, bool single, TrieNode* node);
+
+/**
+ * @brief Pop the highest ranked entry from the best first search frontier.
+ *
+ * @param heap          The pointer to the non-empty frontier
+ * @param rank          The pointer to the returned entry
+ */
+void _TrieHeapPop(TrieHeap* heap, TrieRank* rank);
+
+/**
+ * @brief Spell the string ending at the node below the prefix into the record.
+ *
+ * @param node          The pointer to the node ending the string
+ * @param stop          The pointer to the node ending the prefix
+ * @param record        The record already holding the prefix
+ * @param length        The prefix length
+ */
+void _TrieSpell(TrieNode* node, TrieNode* stop, char* record, unsigned length);
+
+/**
+ * @brief Walk the sibling tree of the designated node and visit the strings
+ * close enough to the query.
+ *
+ * @param fuzzy         The pointer to the search state
+ * @param node          The pointer to the root of the sibling tree
+ * @param depth         The level of the sibling tree
+ *
+ * @retval true         The walk finishes
+ * @retval false        The visitor stops the search
+ */
+bool _TrieFuzzyVisit(TrieFuzzy* fuzzy, TrieNode* node, unsigned depth);
+
+/**
+ * @brief Gather the stored strings in unsigned byte order.
+ *
+ * @param data          The pointer to the trie private data
+ * @param build         The pointer to the returned string pool, which should
+ *                      be released by FROZEN_RELEASE whatever the result is
+ *
+ * @retval true         The strings are successfully gathered
+ * @retval false        Insufficient memory
+ */
+bool _TrieGather(TrieData* data, FrozenBuild* build);
+
+/**
+ * @brief Gather the stored strings in unsigned byte order and build their
+ * double array.
+ *
+ * @param data          The pointer to the trie private data
+ * @param build         The pointer to the returned double array, which should
+ *                      be released by FROZEN_RELEASE whatever the result is
+ *
+ * @retval true         The double array is successfully built
+ * @retval false        Insufficient memory
+ */
+bool _TrieCompile(TrieData* data, FrozenBuild* build);
+
+/**
+ * @brief Place the children of the state holding the sorted strings sharing
+ * the first depth bytes, and then recursively build the child states.
+ *
+ * @param build         The pointer to the double array under construction
+ * @param strs          The sorted array of strings
+ * @param lo            The first string of the state
+ * @param hi            The one past the last string of the state
+ * @param depth         The depth of the state
+ * @param state         The state index
+ *
+ * @retval true         The subtree is successfully built
+ * @retval false        Insufficient memory
+ */
+bool _TrieFreezeBuild(FrozenBuild* build, const char** strs, unsigned lo,
+                      unsigned hi, unsigned depth, unsigned state);
+
+/**
+ * @brief Find the lowest base placing all the labels at unoccupied units
+ * beyond the parent state.
+ *
+ * @param build         The pointer to the double array under construction
+ * @param labels        The ascending labels
+ * @param num           The number of labels
+ * @param state         The parent state
+ *
+ * @retval base         The located base
+ * @retval -1           Insufficient memory to extend the array
+ */
+int32_t _TrieFreezeLocate(FrozenBuild* build, const uint8_t* labels,
+                          unsigned num, unsigned state);
+
+/**
+ * @brief Close the open state at the designated depth, and redirect the last
+ * arc of its parent to the registered state having the same arcs.
+ *
+ * @param build         The pointer to the word graph under construction
+ * @param depth         The depth of the state
+ *
+ * @retval true         The state is successfully closed
+ * @retval false        Insufficient memory
+ */
+bool _DawgClose(DawgBuild* build, unsigned depth);
+
+/**
+ * @brief Find the registered state having the designated arcs, or register
+ * the arcs as a new state.
+ *
+ * @param build         The pointer to the word graph under construction
+ * @param arcs          The arcs of the state
+ * @param num           The number of arcs
+ * @param p_state       The pointer to the returned state
+ *
+ * @retval true         The state is successfully located
+ * @retval false        Insufficient memory
+ */
+bool _DawgRegister(DawgBuild* build, const DawgArc* arcs, unsigned num,
+                   unsigned* p_state);
+
+/**
+ * @brief Visit the strings below the word graph state in lexical order.
+ *
+ * @param visit         The pointer to the traversal context
+ * @param state         The state index
+ * @param length        The length of the string leading to the state
+ *
+ * @retval true         The traversal continues
+ * @retval false        The traversal is stopped by the limit or the visitor
+ */
+bool _DawgVisit(DawgVisit* visit, unsigned state, unsigned length);
+
+/**
+ * @brief Visit the strings below the frozen state in lexical order.
+ *
+ * @param visit         The pointer to the traversal context
+ * @param state         The state index
+ * @param length        The length of the string leading to the state
+ *
+ * @retval true         The traversal continues
+ * @retval false        The traversal is stopped by the limit or the visitor
+ */
+bool _FrozenTrieVisit(FrozenVisit* visit, unsigned state, unsigned length);
+
+static inline
+bool FROZEN_RESERVE(FrozenBuild* build, unsigned count)
+{
+    if (likely(count <= build->capacity_))
+        return true;
+
+    unsigned capacity = (build->capacity_)? build->capacity_ : count;
+    while (capacity < count)
+        capacity <<= 1;
+    FrozenUnit* units = (FrozenUnit*)realloc(build->units_,
+                                             sizeof(FrozenUnit) * capacity);
+    if (unlikely(!units))
+        return false;
+
+    unsigned i;
+    for (i = build->capacity_ ; i < capacity ; ++i) {
+        units[i].base_ = 0;
+        units[i].check_ = FROZEN_FREE;
+    }
+    build->units_ = units;
+    build->capacity_ = capacity;
+    return true;
+}
+
+static inline
+void FROZEN_RELEASE(FrozenBuild* build)
+{
+    free(build->units_);
+    free(build->strs_);
+    free(build->pool_);
+    build->units_ = NULL;
+    build->strs_ = NULL;
+    build->pool_ = NULL;
+}
+
+static inline
+bool FROZEN_CHILD(const FrozenUnit* units, unsigned count, unsigned state,
+                  uint8_t label, unsigned* p_child)
+{
+    unsigned child = (uint32_t)units[state].base_ + label;
+    if (child >= count || units[child].check_ != (int32_t)state)
+        return false;
+    *p_child = child;
+    return true;
+}
+
+static inline
+bool FROZEN_WALK(FrozenTrieData* data, const char* str, unsigned* p_state)
+{
+    const FrozenUnit* units = data->units_;
+    unsigned count = data->count_unit_;
+    unsigned state = 0;
+
+    while (*str) {
+        unsigned next = (uint32_t)units[state].base_ + (uint8_t)*str;
+        if (next >= count || next <= state ||
+            units[next].check_ != (int32_t)state)
+            return false;
+        state = next;
+        ++str;
+    }
+
+    *p_state = state;
+    return true;
+}
+
+static inline
+unsigned DAWG_HASH(const DawgArc* arcs, unsigned num)
+{
+    unsigned hash = 2166136261u;
+    unsigned i;
+    for (i = 0 ; i < num ; ++i) {
+        unsigned key = ((unsigned)arcs[i].label_ << 1) |
+                       (arcs[i].flag_ & DAWG_FINAL);
+        hash = (hash ^ key ^ (arcs[i].target_ * 2654435761u)) * 16777619u;
+    }
+    return hash;
+}
+
+static inline
+bool DAWG_ARC(const DawgArc* arcs, unsigned count, unsigned state,
+              uint8_t label, const DawgArc** p_arc)
+{
+    if (state == 0)
+        return false;
+
+    unsigned i;
+    for (i = state ; i < count ; ++i) {
+        const DawgArc* arc = arcs + i;
+        if (arc->label_ == label) {
+            *p_arc = arc;
+            return true;
+        }
+        if (arc->label_ > label || (arc->flag_ & DAWG_LAST))
+            break;
+    }
+    return false;
+}
+
+static inline
+bool DAWG_WALK(DawgData* data, const char* str, const DawgArc** p_arc)
+{
+    const DawgArc* arc = NULL;
+    unsigned state = data->root_;
+    while (*str) {
+        if (!DAWG_ARC(data->arcs_, data->count_arc_, state, (uint8_t)*str,
+                      &arc))
+            return false;
+        state = arc->target_;
+        ++str;
+    }
+
+    *p_arc = arc;
+    return true;
+}
+
+static inline
+int COMPARE_STRING(const void* lhs, const void* rhs)
+{
+    return strcmp(*(const char**)lhs, *(const char**)rhs);
+}
+
+static inline
+unsigned SORT_KEY(const char* str, unsigned depth)
+{
+    /* Flip the sign bit so that the unsigned bytes follow the order of the
+       plain char tokens. */
+    uint8_t flip = (CHAR_MIN < 0)? 0x80 : 0;
+    return (str[depth] == 0)? 0 : ((uint8_t)str[depth] ^ flip) + 1;
+}
+
+static inline
+void SORT_INSERT(const char** strs, unsigned lo, unsigned hi, unsigned depth)
+{
+    unsigned i, j;
+    for (i = lo + 1 ; i < hi ; ++i) {
+        const char* str = strs[i];
+        for (j = i ; j > lo ; --j) {
+            const char* pred = strs[j - 1];
+            unsigned k = depth;
+            while (str[k] != 0 && str[k] == pred[k])
+                ++k;
+            if (SORT_KEY(pred, k) <= SORT_KEY(str, k))
+                break;
+            strs[j] = pred;
+        }
+        strs[j] = str;
+    }
+}
+
+static inline
+TrieNode* NEW_NODE(TrieData* data)
+{
+    TrieNode* node;
+    if (data->chunk_ == 0) {
+        node = (TrieNode*)malloc(sizeof(TrieNode));
+        if (unlikely(!node))
+            return NULL;
+        node->pooled_ = false;
+        data->heap_++;
+        data->bytes_ += sizeof(TrieNode);
+        return node;
+    }
+
+    /* The nodes are only released by the destructor, so a chunk is simply
+       carved until it is exhausted. */
+    if (data->bump_ == data->limit_) {
+        TrieBlock* block = (TrieBlock*)malloc(sizeof(TrieBlock) +
+                                              sizeof(TrieNode) * data->chunk_);
+        if (unlikely(!block))
+            return NULL;
+        block->next_ = data->blocks_;
+        data->blocks_ = block;
+        data->bump_ = block->nodes_;
+        data->limit_ = block->nodes_ + data->chunk_;
+        data->bytes_ += sizeof(TrieBlock) + sizeof(TrieNode) * data->chunk_;
+    }
+
+    node = data->bump_++;
+    node->pooled_ = true;
+    return node;
+}
+
+static inline
+void RELEASE_NODE(TrieData* data, TrieNode* node)
+{
+    if (node->endstr_ && node->value_ && data->func_clean_val_)
+        data->func_clean_val_(node->value_);
+    if (!node->pooled_)
+        free(node);
+}
+
 static inline
 char DECIDE_BACKWARD_DIRECTION(TrieNode** p_curr)
 {
@@ -113,15 +825,36 @@ Trie* TrieInit()
     data->count_node_ = 0;
     data->depth_ = 0;
     data->root_ = NULL;
+    data->blocks_ = NULL;
+    data->bump_ = NULL;
+    data->limit_ = NULL;
+    data->chunk_ = 0;
+    data->heap_ = 0;
+    data->bytes_ = sizeof(Trie) + sizeof(TrieData);
+    data->func_clean_val_ = NULL;
 
     obj->data = data;
     obj->insert = TrieInsert;
     obj->bulk_insert = TrieBulkInsert;
+    obj->bulk_build = TrieBulkBuild;
     obj->has_exact = TrieHasExact;
     obj->has_prefix_as = TrieHasPrefixAs;
     obj->get_prefix_as = TrieGetPrefixAs;
+    obj->for_each_prefix = TrieForEachPrefix;
+    obj->prefix = TriePrefix;
+    obj->set_score = TrieSetScore;
+    obj->get_score = TrieGetScore;
+    obj->top_k = TrieTopK;
+    obj->fuzzy_search = TrieFuzzySearch;
+    obj->put = TriePut;
+    obj->get = TrieGet;
+    obj->longest_prefix_match = TrieLongestPrefixMatch;
     obj->remove = TrieRemove;
     obj->size = TrieSize;
+    obj->freeze = TrieFreeze;
+    obj->set_clean_value = TrieSetCleanValue;
+    obj->set_arena = TrieSetArena;
+    obj->get_stats = TrieGetStats;
     return obj;
 }
 
@@ -130,8 +863,18 @@ void TrieDeinit(Trie* obj)
     if (unlikely(!obj))
         return;
 
+    /* Without any individually allocated node or value to release, the blocks
+       can be released without visiting the nodes. */
     TrieData* data = obj->data;
-    _TrieDeinit(data);
+    if (data->heap_ > 0 || data->func_clean_val_)
+        _TrieDeinit(data);
+
+    TrieBlock* block = data->blocks_;
+    while (block) {
+        TrieBlock* next = block->next_;
+        free(block);
+        block = next;
+    }
 
     free(data);
     free(obj);
@@ -145,147 +888,111 @@ bool TrieInsert(Trie* self, const char* str)
     if (unlikely(*str == 0))
         return true;
 
+    return _TrieAppend(self->data, str) != NULL;
+}
+
+bool TrieBulkInsert(Trie* self, const char** strs, unsigned size)
+{
     TrieData* data = self->data;
-    TrieNode* curr = data->root_;
-    TrieNode* pred = NULL;
-    unsigned depth = 0;
 
-    /* Longest prefix matching. */
-    char ch, direct;
-    while (curr && ((ch = *str) != 0)) {
-        pred = curr;
-        char token = curr->token_;
-        if (ch == token) {
-            curr = curr->middle_;
-            direct = DIRECT_MIDDLE;
-            ++str;
-            ++depth;
-        } else {
-            if (ch < token) {
-                curr = curr->left_;
-                direct = DIRECT_LEFT;
-            } else {
-                curr = curr->right_;
-                direct = DIRECT_RIGHT;
-            }
-        }
-    }
+    unsigned i;
+    for (i = 0 ; i < size ; ++i) {
+        const char* str = strs[i];
+        if (!str)
+            continue;
+        if (*str == 0)
+            continue;
 
-    /* Cascade the trie node for the remaining suffix. */
-    while ((ch = *str) != 0) {
-        TrieNode* new_node = (TrieNode*)malloc(sizeof(TrieNode));
-        if (unlikely(!new_node))
+        if (unlikely(!_TrieAppend(data, str)))
             return false;
-        new_node->middle_ = new_node->left_ = new_node->right_ = NULL;
-        new_node->parent_ = pred;
-        new_node->token_ = ch;
-        new_node->endstr_ = false;
-
-        if (unlikely(!pred))
-            data->root_ = new_node;
-        else {
-            if (likely(direct == DIRECT_MIDDLE))
-                pred->middle_ = new_node;
-            else {
-                if (direct == DIRECT_LEFT)
-                    pred->left_ = new_node;
-                else
-                    pred->right_ = new_node;
-            }
-        }
-
-        pred = new_node;
-        direct = DIRECT_MIDDLE;
-        data->count_node_++;
-        ++str;
-        ++depth;
-    }
-
-    if (!(pred->endstr_)) {
-        pred->endstr_ = true;
-        data->size_++;
     }
-    if (depth > data->depth_)
-        data->depth_ = depth;
 
     return true;
 }
 
-bool TrieBulkInsert(Trie* self, const char** strs, unsigned size)
+bool TrieBulkBuild(Trie* self, const char** strs, unsigned size,
+                   unsigned num_thread)
 {
     TrieData* data = self->data;
 
+    /* Sort a private copy of the non empty strings. */
+    const char** sorted = (const char**)malloc(sizeof(char*) * (size + 1));
+    const char** aux = (const char**)malloc(sizeof(char*) * (size + 1));
+    if (unlikely(!sorted || !aux)) {
+        free(sorted);
+        free(aux);
+        return false;
+    }
+
+    unsigned count = 0;
     unsigned i;
     for (i = 0 ; i < size ; ++i) {
-        const char* str = strs[i];
-        if (!str)
-            continue;
-        if (*str == 0)
-            continue;
+        if (strs[i] && *strs[i] != 0)
+            sorted[count++] = strs[i];
+    }
 
-        TrieNode* curr = data->root_;
-        TrieNode* pred = NULL;
-        unsigned depth = 0;
+    bool done = _TrieSort(sorted, aux, count, num_thread);
+    free(aux);
+    if (unlikely(!done)) {
+        free(sorted);
+        return false;
+    }
 
-        /* Longest prefix matching. */
-        char ch, direct;
-        while (curr && ((ch = *str) != 0)) {
-            pred = curr;
-            char token = curr->token_;
-            if (ch == token) {
-                curr = curr->middle_;
-                direct = DIRECT_MIDDLE;
-                ++str;
-                ++depth;
-            } else {
-                if (ch < token) {
-                    curr = curr->left_;
-                    direct = DIRECT_LEFT;
-                } else {
-                    curr = curr->right_;
-                    direct = DIRECT_RIGHT;
-                }
-            }
-        }
+    /* Drop the duplicates and count the nodes, which are the tokens not
+       shared with the preceding string. */
+    unsigned unique = 0;
+    unsigned count_node = 0;
+    unsigned depth = data->depth_;
+    const char* pred = "";
+    for (i = 0 ; i < count ; ++i) {
+        const char* str = sorted[i];
+        unsigned common = 0;
+        while (str[common] != 0 && str[common] == pred[common])
+            ++common;
+        if (str[common] == 0 && pred[common] == 0)
+            continue;
 
-        /* Cascade the trie node for the remaining suffix. */
-        while ((ch = *str) != 0) {
-            TrieNode* new_node = (TrieNode*)malloc(sizeof(TrieNode));
-            if (unlikely(!new_node))
-                return false;
-            new_node->middle_ = new_node->left_ = new_node->right_ = NULL;
-            new_node->parent_ = pred;
-            new_node->token_ = ch;
-            new_node->endstr_ = false;
+        unsigned length = common + strlen(str + common);
+        count_node += length - common;
+        if (length > depth)
+            depth = length;
+        sorted[unique++] = str;
+        pred = str;
+    }
 
-            if (unlikely(!pred))
-                data->root_ = new_node;
-            else {
-                if (likely(direct == DIRECT_MIDDLE))
-                    pred->middle_ = new_node;
-                else {
-                    if (direct == DIRECT_LEFT)
-                        pred->left_ = new_node;
-                    else
-                        pred->right_ = new_node;
-                }
-            }
+    /* Merge into the existing strings in median first order. */
+    if (data->root_) {
+        done = _TrieBulkMerge(data, sorted, 0, unique);
+        free(sorted);
+        return done;
+    }
 
-            pred = new_node;
-            direct = DIRECT_MIDDLE;
-            data->count_node_++;
-            ++str;
-            ++depth;
-        }
+    if (unique == 0) {
+        free(sorted);
+        return true;
+    }
 
-        if (!(pred->endstr_)) {
-            pred->endstr_ = true;
-            data->size_++;
-        }
-        if (depth > data->depth_)
-            data->depth_ = depth;
+    TrieBlock* block =
+        (TrieBlock*)malloc(sizeof(TrieBlock) + sizeof(TrieNode) * count_node);
+    if (unlikely(!block)) {
+        free(sorted);
+        return false;
     }
 
+    TrieBuild build;
+    build.strs_ = sorted;
+    build.nodes_ = block->nodes_;
+    build.count_node_ = 0;
+    data->root_ = _TrieBuild(&build, 0, unique, 0, NULL);
+
+    block->next_ = data->blocks_;
+    data->blocks_ = block;
+    data->bytes_ += sizeof(TrieBlock) + sizeof(TrieNode) * count_node;
+    data->size_ = unique;
+    data->count_node_ = count_node;
+    data->depth_ = depth;
+
+    free(sorted);
     return true;
 }
 
@@ -357,9 +1064,10 @@ bool TrieHasPrefixAs(Trie* self, const char* prefix)
     if (curr && pred && pred->endstr_)
         return true;
 
-    /* The slow trie traversal to find any node marked as string end. */
+    /* The slow traversal of the subtree below the prefix to find any node
+       marked as string end. */
     char direct = DOWN_LEFT;
-    while (direct != STOP) {
+    while (direct != STOP && curr != pred) {
         if (direct == DOWN_LEFT || direct == DOWN_MIDDLE || direct == DOWN_RIGHT) {
             if (curr->endstr_)
                 return true;
@@ -427,19 +1135,354 @@ bool TrieGetPrefixAs(Trie* self, const char* prefix, const char*** p_strs, unsig
     if (unlikely(*prefix == 0))
         return false;
 
+    /* Prepare the prefix record. */
+    unsigned sum = self->data->depth_ + 1;
+    char* record = (char*)malloc(sizeof(char) * sum);
+    if (unlikely(!record))
+        return false;
+
+    TrieCursor cursor;
+    if (!TriePrefix(self, prefix, record, sum, &cursor)) {
+        free(record);
+        return false;
+    }
+
+    /* Duplicate each match into the to be returned array of strings. */
+    unsigned capacity = 0;
+    unsigned size = 0;
+    const char** strs = NULL;
+    while (_TrieCursorNext(&cursor)) {
+        if (size == capacity) {
+            capacity = (capacity)? (capacity << 1) : 16;
+            const char** new_strs = (const char**)realloc(strs,
+                                        sizeof(const char*) * capacity);
+            if (unlikely(!new_strs)) {
+                FREE_LOCAL_RESOURCE(strs, size, record);
+                return false;
+            }
+            strs = new_strs;
+        }
+        char* dup = strdup(record);
+        if (unlikely(!dup)) {
+            FREE_LOCAL_RESOURCE(strs, size, record);
+            return false;
+        }
+        strs[size++] = dup;
+    }
+
+    if (size == 0) {
+        FREE_LOCAL_RESOURCE(strs, size, record);
+        return false;
+    }
+
+    const char** new_strs = (const char**)realloc(strs, sizeof(const char*) * size);
+    if (likely(new_strs))
+        strs = new_strs;
+    free(record);
+
+    *p_strs = strs;
+    *p_size = size;
+    return true;
+}
+
+unsigned TrieForEachPrefix(Trie* self, const char* prefix, unsigned limit,
+                           TrieVisit func, void* arg)
+{
+    if (unlikely(!prefix))
+        return 0;
+    if (unlikely(*prefix == 0))
+        return 0;
+
+    unsigned sum = self->data->depth_ + 1;
+    char* record = (char*)malloc(sizeof(char) * sum);
+    if (unlikely(!record))
+        return 0;
+
+    TrieCursor cursor;
+    unsigned count = 0;
+    if (TriePrefix(self, prefix, record, sum, &cursor)) {
+        while ((limit == 0 || count < limit) && _TrieCursorNext(&cursor)) {
+            ++count;
+            if (!func(record, arg))
+                break;
+        }
+    }
+
+    free(record);
+    return count;
+}
+
+bool TriePrefix(Trie* self, const char* prefix, char* buf, unsigned size,
+                TrieCursor* cursor)
+{
+    cursor->buf_ = buf;
+    cursor->node_ = NULL;
+    cursor->stop_ = NULL;
+    cursor->length_ = 0;
+    cursor->direct_ = STOP;
+
+    if (unlikely(!prefix))
+        return false;
+    if (unlikely(*prefix == 0))
+        return false;
+
+    TrieData* data = self->data;
+    if (size <= data->depth_)
+        return false;
+
+    TrieNode* pred = _TrieSeek(data, prefix);
+    if (!pred)
+        return false;
+
+    /* The removed strings leave their nodes behind, so make sure that some
+       string still lives below the prefix. */
+    if (!pred->endstr_ && !TrieHasPrefixAs(self, prefix))
+        return false;
+
+    /* The walk starts from the node ending the prefix, which may itself be a
+       stored string, and then goes down its middle subtree. */
+    unsigned length = strlen(prefix);
+    memcpy(buf, prefix, length);
+    cursor->node_ = pred;
+    cursor->stop_ = pred;
+    cursor->length_ = length;
+    cursor->direct_ = BEGIN;
+    return true;
+}
+
+const char* TrieCursorNext(TrieCursor* cursor)
+{
+    return (_TrieCursorNext(cursor))? cursor->buf_ : NULL;
+}
+
+bool TrieSetScore(Trie* self, const char* str, unsigned score)
+{
+    if (unlikely(!str))
+        return false;
+    if (unlikely(*str == 0))
+        return false;
+
+    TrieNode* node = _TrieSeek(self->data, str);
+    if (!node || !node->endstr_)
+        return false;
+
+    if (node->score_ != score) {
+        node->score_ = score;
+        _TrieRefresh(node);
+    }
+    return true;
+}
+
+bool TrieGetScore(Trie* self, const char* str, unsigned* p_score)
+{
+    if (unlikely(!str))
+        return false;
+    if (unlikely(*str == 0))
+        return false;
+
+    TrieNode* node = _TrieSeek(self->data, str);
+    if (!node || !node->endstr_)
+        return false;
+
+    *p_score = node->score_;
+    return true;
+}
+
+unsigned TrieTopK(Trie* self, const char* prefix, unsigned k,
+                  TrieVisitScore func, void* arg)
+{
+    if (unlikely(!prefix))
+        return 0;
+    if (unlikely(*prefix == 0))
+        return 0;
+    if (unlikely(k == 0))
+        return 0;
+
+    TrieData* data = self->data;
+    TrieNode* stop = _TrieSeek(data, prefix);
+    if (!stop)
+        return 0;
+
+    char* record = (char*)malloc(sizeof(char) * (data->depth_ + 1));
+    if (unlikely(!record))
+        return 0;
+    unsigned length = strlen(prefix);
+    memcpy(record, prefix, length);
+
+    TrieHeap heap;
+    heap.ranks_ = NULL;
+    heap.size_ = 0;
+    heap.capacity_ = 0;
+
+    /* Seed the frontier with the prefix itself and the subtree below it. */
+    unsigned count = 0;
+    bool fine = true;
+    if (stop->endstr_)
+        fine = _TrieHeapPush(&heap, stop->score_, true, stop);
+    if (fine && stop->middle_)
+        fine = _TrieHeapPush(&heap, stop->middle_->best_, false, stop->middle_);
+
+    while (fine && heap.size_ > 0) {
+        TrieRank rank;
+        _TrieHeapPop(&heap, &rank);
+        TrieNode* node = rank.node_;
+
+        /* No entry left in the frontier outranks this string. */
+        if (rank.single_) {
+            _TrieSpell(node, stop, record, length);
+            ++count;
+            if (!func(record, rank.score_, arg) || count == k)
+                break;
+            continue;
+        }
+
+        /* Split the subtree into its string and its child subtrees. */
+        if (node->endstr_)
+            fine = _TrieHeapPush(&heap, node->score_, true, node);
+        if (fine && node->left_)
+            fine = _TrieHeapPush(&heap, node->left_->best_, false, node->left_);
+        if (fine && node->middle_)
+            fine = _TrieHeapPush(&heap, node->middle_->best_, false, node->middle_);
+        if (fine && node->right_)
+            fine = _TrieHeapPush(&heap, node->right_->best_, false, node->right_);
+    }
+
+    free(heap.ranks_);
+    free(record);
+    return count;
+}
+
+unsigned TrieFuzzySearch(Trie* self, const char* query, unsigned max_edits,
+                         TrieVisitDistance func, void* arg)
+{
+    if (unlikely(!query))
+        return 0;
+
+    TrieData* data = self->data;
+    if (!data->root_)
+        return 0;
+
+    /* No distance exceeds the longer of the query and the longest string, so
+       clamp the larger bounds to keep the band arithmetic from wrapping. */
+    unsigned length = strlen(query);
+    unsigned longest = (length > data->depth_)? length : data->depth_;
+    if (max_edits > longest)
+        max_edits = longest;
+
+    unsigned width = length + 1;
+    unsigned* rows =
+        (unsigned*)malloc(sizeof(unsigned) * width * (data->depth_ + 1));
+    char* record = (char*)malloc(sizeof(char) * (data->depth_ + 1));
+    if (unlikely(!rows || !record)) {
+        free(rows);
+        free(record);
+        return 0;
+    }
+
+    /* The empty path is as far from each query prefix as its length. */
+    unsigned i;
+    for (i = 0 ; i < width ; ++i)
+        rows[i] = (i <= max_edits)? i : max_edits + 1;
+
+    TrieFuzzy fuzzy;
+    fuzzy.query_ = query;
+    fuzzy.length_ = length;
+    fuzzy.max_edits_ = max_edits;
+    fuzzy.rows_ = rows;
+    fuzzy.record_ = record;
+    fuzzy.count_ = 0;
+    fuzzy.func_ = func;
+    fuzzy.arg_ = arg;
+    _TrieFuzzyVisit(&fuzzy, data->root_, 0);
+
+    free(rows);
+    free(record);
+    return fuzzy.count_;
+}
+
+bool TriePut(Trie* self, const char* str, void* value)
+{
+    if (unlikely(!str))
+        return false;
+    if (unlikely(*str == 0))
+        return false;
+
+    TrieData* data = self->data;
+    TrieNode* node = _TrieAppend(data, str);
+    if (unlikely(!node))
+        return false;
+
+    if (node->value_ && data->func_clean_val_)
+        data->func_clean_val_(node->value_);
+    node->value_ = value;
+    return true;
+}
+
+void* TrieGet(Trie* self, const char* str)
+{
+    if (unlikely(!str))
+        return NULL;
+    if (unlikely(*str == 0))
+        return NULL;
+
+    TrieNode* node = _TrieSeek(self->data, str);
+    return (node && node->endstr_)? node->value_ : NULL;
+}
+
+unsigned TrieLongestPrefixMatch(Trie* self, const char* str, void** p_value)
+{
+    if (unlikely(!str))
+        return 0;
+
+    TrieNode* curr = self->data->root_;
+    TrieNode* best = NULL;
+    unsigned length = 0;
+    unsigned match = 0;
+
+    /* Remember the last string end passed by the single descent. */
+    char ch;
+    while (curr && ((ch = *str) != 0)) {
+        char token = curr->token_;
+        if (ch == token) {
+            ++length;
+            if (curr->endstr_) {
+                best = curr;
+                match = length;
+            }
+            curr = curr->middle_;
+            ++str;
+        } else {
+            if (ch < token)
+                curr = curr->left_;
+            else
+                curr = curr->right_;
+        }
+    }
+
+    if (best && p_value)
+        *p_value = best->value_;
+    return match;
+}
+
+bool TrieRemove(Trie* self, const char* str)
+{
+    if (unlikely(!str))
+        return false;
+    if (unlikely(*str == 0))
+        return false;
+
     TrieData* data = self->data;
     TrieNode* curr = data->root_;
     TrieNode* pred = NULL;
 
     /* Longest prefix matching. */
-    const char* dup = prefix;
     char ch;
-    while (curr && ((ch = *dup) != 0)) {
+    while (curr && ((ch = *str) != 0)) {
         pred = curr;
         char token = curr->token_;
         if (ch == token) {
             curr = curr->middle_;
-            ++dup;
+            ++str;
         } else {
             if (ch < token)
                 curr = curr->left_;
@@ -448,174 +1491,1087 @@ bool TrieGetPrefixAs(Trie* self, const char* prefix, const char*** p_strs, unsig
         }
     }
 
-    /* No such prefix and early return. */
-    if (*dup != 0)
-        return false;
-    if (!curr && !(pred->endstr_))
-        return false;
+    /* At the end of a specific string. */
+    if (pred && pred->endstr_ && *str == 0) {
+        pred->endstr_ = false;
+        if (pred->value_) {
+            if (data->func_clean_val_)
+                data->func_clean_val_(pred->value_);
+            pred->value_ = NULL;
+        }
+        if (pred->score_) {
+            pred->score_ = 0;
+            _TrieRefresh(pred);
+        }
+        data->size_--;
+        return true;
+    }
+    return false;
+}
 
-    /* Prepare the prefix record. */
-    unsigned depth = data->depth_;
-    unsigned length = strlen(prefix);
-    unsigned sum = depth + length + 1;
-    char* record = (char*)malloc(sizeof(char) * sum);
-    if (unlikely(!record))
-        return false;
-    memset(record, 0, sizeof(char) * sum);
-    strncpy(record, prefix, length);
+unsigned TrieSize(Trie* self)
+{
+    return self->data->size_;
+}
 
-    /* Prepare the to be returned array of strings. */
-    unsigned capacity = depth;
-    unsigned size = 0;
-    const char** strs = (const char**)malloc(sizeof(const char*) * capacity);
-    if (unlikely(!strs)) {
-        free(record);
-        return false;
+void TrieSetCleanValue(Trie* self, TrieCleanValue func)
+{
+    self->data->func_clean_val_ = func;
+}
+
+void TrieSetArena(Trie* self, unsigned chunk)
+{
+    self->data->chunk_ = chunk;
+}
+
+void TrieGetStats(Trie* self, TrieStats* stats)
+{
+    TrieData* data = self->data;
+    stats->size = data->size_;
+    stats->count_node = data->count_node_;
+    stats->depth = data->depth_;
+    stats->bytes = data->bytes_;
+}
+
+bool TrieFreeze(Trie* self, const char* path)
+{
+    TrieData* data = self->data;
+
+    bool done = false;
+    FrozenBuild build;
+    if (unlikely(!_TrieCompile(data, &build)))
+        goto EXIT;
+
+    FrozenHeader header;
+    memset(&header, 0, sizeof(FrozenHeader));
+    memcpy(header.magic_, FROZEN_MAGIC, sizeof(FROZEN_MAGIC));
+    header.order_ = FROZEN_ORDER;
+    header.version_ = FROZEN_VERSION;
+    header.size_ = build.count_str_;
+    header.depth_ = data->depth_;
+    header.count_unit_ = build.count_unit_;
+
+    FILE* file = fopen(path, "wb");
+    if (unlikely(!file))
+        goto EXIT;
+    done = fwrite(&header, sizeof(FrozenHeader), 1, file) == 1 &&
+           fwrite(build.units_, sizeof(FrozenUnit), build.count_unit_, file)
+           == build.count_unit_;
+    if (fclose(file) != 0)
+        done = false;
+
+EXIT:
+    FROZEN_RELEASE(&build);
+    return done;
+}
+
+TrieScanner* TrieScannerInit(Trie* trie)
+{
+    TrieScanner* obj = (TrieScanner*)malloc(sizeof(TrieScanner));
+    if (unlikely(!obj))
+        return NULL;
+
+    TrieScannerData* data = (TrieScannerData*)malloc(sizeof(TrieScannerData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    FrozenBuild build;
+    if (unlikely(!_TrieCompile(trie->data, &build)))
+        goto FAIL;
+
+    unsigned count = build.count_unit_;
+    data->fail_ = (uint32_t*)calloc(count, sizeof(uint32_t));
+    data->output_ = (uint32_t*)calloc(count, sizeof(uint32_t));
+    data->word_ = (uint32_t*)calloc(count, sizeof(uint32_t));
+    uint32_t* queue = (uint32_t*)malloc(sizeof(uint32_t) * count);
+    if (unlikely(!data->fail_ || !data->output_ || !data->word_ || !queue)) {
+        free(queue);
+        free(data->word_);
+        free(data->output_);
+        free(data->fail_);
+        goto FAIL;
+    }
+
+    const FrozenUnit* units = build.units_;
+    uint32_t* fail = data->fail_;
+    uint32_t* output = data->output_;
+    uint32_t* word = data->word_;
+
+    /* Mark the states ending the strings. */
+    unsigned i;
+    for (i = 0 ; i < build.count_str_ ; ++i) {
+        const char* str = build.strs_[i];
+        unsigned state = 0;
+        while (*str)
+            FROZEN_CHILD(units, count, state, (uint8_t)*str++, &state);
+        word[state] = build.strs_[i] - build.pool_ + 1;
+    }
+
+    /* Link the states in breadth first order, so the failure target of a
+       state, which is always shallower, is linked before the state. */
+    unsigned head = 0, tail = 0;
+    queue[tail++] = 0;
+    while (head < tail) {
+        unsigned state = queue[head++];
+        unsigned label;
+        for (label = 1 ; label < 256 ; ++label) {
+            unsigned child;
+            if (!FROZEN_CHILD(units, count, state, label, &child))
+                continue;
+            queue[tail++] = child;
+
+            unsigned target = 0;
+            if (state != 0) {
+                unsigned back = fail[state];
+                while (true) {
+                    if (FROZEN_CHILD(units, count, back, label, &target))
+                        break;
+                    if (back == 0) {
+                        target = 0;
+                        break;
+                    }
+                    back = fail[back];
+                }
+            }
+            fail[child] = target;
+            output[child] = (word[target])? target : output[target];
+        }
+    }
+    free(queue);
+
+    free(build.strs_);
+    data->units_ = build.units_;
+    data->count_unit_ = count;
+    data->pool_ = build.pool_;
+    data->state_ = 0;
+    data->offset_ = 0;
+
+    obj->data = data;
+    obj->scan = TrieScannerScan;
+    obj->reset = TrieScannerReset;
+    return obj;
+
+FAIL:
+    FROZEN_RELEASE(&build);
+    free(data);
+    free(obj);
+    return NULL;
+}
+
+void TrieScannerDeinit(TrieScanner* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    TrieScannerData* data = obj->data;
+    free(data->units_);
+    free(data->fail_);
+    free(data->output_);
+    free(data->word_);
+    free(data->pool_);
+
+    free(data);
+    free(obj);
+    return;
+}
+
+unsigned TrieScannerScan(TrieScanner* self, const char* text, size_t len,
+                         TrieMatch func, void* arg)
+{
+    TrieScannerData* data = self->data;
+    const FrozenUnit* units = data->units_;
+    unsigned count = data->count_unit_;
+    const uint32_t* fail = data->fail_;
+    const uint32_t* output = data->output_;
+    const uint32_t* word = data->word_;
+    const char* pool = data->pool_;
+
+    unsigned state = data->state_;
+    unsigned found = 0;
+    size_t i;
+    for (i = 0 ; i < len ; ++i) {
+        uint8_t label = text[i];
+
+        /* The label 0 only marks the string ends, and no string contains it. */
+        if (unlikely(label == 0)) {
+            state = 0;
+            continue;
+        }
+
+        unsigned next;
+        while (!FROZEN_CHILD(units, count, state, label, &next) && state != 0)
+            state = fail[state];
+        if (FROZEN_CHILD(units, count, state, label, &next))
+            state = next;
+
+        /* Report the string ending here and its suffixes in the dictionary. */
+        unsigned hit = (word[state])? state : output[state];
+        bool stop = false;
+        while (hit && !stop) {
+            ++found;
+            stop = !func(pool + word[hit] - 1, data->offset_ + i + 1, arg);
+            hit = output[hit];
+        }
+        if (stop) {
+            ++i;
+            break;
+        }
+    }
+
+    data->state_ = state;
+    data->offset_ += i;
+    return found;
+}
+
+void TrieScannerReset(TrieScanner* self)
+{
+    self->data->state_ = 0;
+    self->data->offset_ = 0;
+}
+
+FrozenTrie* FrozenTrieOpen(const char* path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(FrozenHeader)) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t length = info.st_size;
+    void* image = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (image == MAP_FAILED)
+        return NULL;
+
+    /* Validate the header before trusting any unit index. */
+    const FrozenHeader* header = (const FrozenHeader*)image;
+    if (memcmp(header->magic_, FROZEN_MAGIC, sizeof(FROZEN_MAGIC)) != 0 ||
+        header->order_ != FROZEN_ORDER || header->version_ != FROZEN_VERSION ||
+        header->count_unit_ == 0 ||
+        (length - sizeof(FrozenHeader)) / sizeof(FrozenUnit) != header->count_unit_) {
+        munmap(image, length);
+        return NULL;
+    }
+
+    FrozenTrie* obj = (FrozenTrie*)malloc(sizeof(FrozenTrie));
+    if (unlikely(!obj)) {
+        munmap(image, length);
+        return NULL;
+    }
+
+    FrozenTrieData* data = (FrozenTrieData*)malloc(sizeof(FrozenTrieData));
+    if (unlikely(!data)) {
+        free(obj);
+        munmap(image, length);
+        return NULL;
+    }
+
+    data->image_ = image;
+    data->length_ = length;
+    data->units_ = (const FrozenUnit*)(header + 1);
+    data->count_unit_ = header->count_unit_;
+    data->size_ = header->size_;
+    data->depth_ = header->depth_;
+
+    obj->data = data;
+    obj->has_exact = FrozenTrieHasExact;
+    obj->has_prefix_as = FrozenTrieHasPrefixAs;
+    obj->for_each_prefix = FrozenTrieForEachPrefix;
+    obj->size = FrozenTrieSize;
+    return obj;
+}
+
+void FrozenTrieClose(FrozenTrie* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    FrozenTrieData* data = obj->data;
+    munmap(data->image_, data->length_);
+
+    free(data);
+    free(obj);
+    return;
+}
+
+bool FrozenTrieHasExact(FrozenTrie* self, const char* str)
+{
+    if (unlikely(!str))
+        return false;
+    if (unlikely(*str == 0))
+        return false;
+
+    FrozenTrieData* data = self->data;
+    unsigned state;
+    if (!FROZEN_WALK(data, str, &state))
+        return false;
+
+    /* The label 0 marks the end of a stored string. */
+    unsigned term = data->units_[state].base_;
+    return term < data->count_unit_ && term > state &&
+           data->units_[term].check_ == (int32_t)state;
+}
+
+bool FrozenTrieHasPrefixAs(FrozenTrie* self, const char* prefix)
+{
+    if (unlikely(!prefix))
+        return false;
+    if (unlikely(*prefix == 0))
+        return false;
+
+    /* Every state leads to at least one stored string. */
+    unsigned state;
+    return FROZEN_WALK(self->data, prefix, &state);
+}
+
+unsigned FrozenTrieForEachPrefix(FrozenTrie* self, const char* prefix,
+                                 unsigned limit, TrieVisit func, void* arg)
+{
+    if (unlikely(!prefix))
+        return 0;
+    if (unlikely(*prefix == 0))
+        return 0;
+
+    FrozenTrieData* data = self->data;
+    unsigned state;
+    if (!FROZEN_WALK(data, prefix, &state))
+        return 0;
+
+    unsigned length = strlen(prefix);
+    if (length > data->depth_)
+        return 0;
+    char* record = (char*)malloc(sizeof(char) * (data->depth_ + 1));
+    if (unlikely(!record))
+        return 0;
+    memcpy(record, prefix, length);
+
+    FrozenVisit visit;
+    visit.units_ = data->units_;
+    visit.count_unit_ = data->count_unit_;
+    visit.depth_ = data->depth_;
+    visit.record_ = record;
+    visit.limit_ = limit;
+    visit.count_ = 0;
+    visit.func_ = func;
+    visit.arg_ = arg;
+    _FrozenTrieVisit(&visit, state, length);
+
+    free(record);
+    return visit.count_;
+}
+
+unsigned FrozenTrieSize(FrozenTrie* self)
+{
+    return self->data->size_;
+}
+
+Dawg* DawgInit(Trie* trie)
+{
+    Dawg* obj = (Dawg*)malloc(sizeof(Dawg));
+    if (unlikely(!obj))
+        return NULL;
+
+    DawgData* data = (DawgData*)malloc(sizeof(DawgData));
+    if (unlikely(!data)) {
+        free(obj);
+        return NULL;
+    }
+
+    FrozenBuild strings;
+    DawgBuild build;
+    memset(&build, 0, sizeof(DawgBuild));
+    if (unlikely(!_TrieGather(trie->data, &strings)))
+        goto FAIL;
+
+    /* Reserve the open states along the longest string and the sentinel. */
+    unsigned count = strings.count_str_;
+    unsigned depth = 0;
+    unsigned i;
+    for (i = 0 ; i < count ; ++i) {
+        unsigned length = strlen(strings.strs_[i]);
+        if (length > depth)
+            depth = length;
+    }
+    build.path_ = (DawgArc*)malloc(sizeof(DawgArc) * DAWG_FANOUT * (depth + 1));
+    build.count_path_ = (unsigned*)calloc(depth + 1, sizeof(unsigned));
+    build.capacity_ = 1024;
+    build.arcs_ = (DawgArc*)malloc(sizeof(DawgArc) * build.capacity_);
+    build.words_ = (uint32_t*)malloc(sizeof(uint32_t) * build.capacity_);
+    build.capacity_table_ = 1024;
+    build.table_ = (uint32_t*)calloc(build.capacity_table_, sizeof(uint32_t));
+    if (unlikely(!build.path_ || !build.count_path_ || !build.arcs_ ||
+                 !build.words_ || !build.table_))
+        goto FAIL;
+    memset(build.arcs_, 0, sizeof(DawgArc));
+    build.words_[0] = 0;
+    build.count_arc_ = 1;
+
+    /* Insert the sorted strings. Once the next string diverges from the last
+       one, the states below the divergence can no longer change, so they are
+       closed and merged with their registered equivalents. */
+    const char* pred = "";
+    unsigned pred_length = 0;
+    for (i = 0 ; i < count ; ++i) {
+        const char* str = strings.strs_[i];
+        unsigned common = 0;
+        while (str[common] != 0 && str[common] == pred[common])
+            ++common;
+
+        unsigned level;
+        for (level = pred_length ; level > common ; --level) {
+            if (unlikely(!_DawgClose(&build, level)))
+                goto FAIL;
+        }
+
+        unsigned length = common + strlen(str + common);
+        for (level = common ; level < length ; ++level) {
+            DawgArc* arc = build.path_ + DAWG_FANOUT * level +
+                           build.count_path_[level]++;
+            arc->target_ = 0;
+            arc->rank_ = 0;
+            arc->label_ = (uint8_t)str[level];
+            arc->flag_ = (level + 1 == length)? DAWG_FINAL : 0;
+            arc->reserve_ = 0;
+            build.count_path_[level + 1] = 0;
+        }
+
+        pred = str;
+        pred_length = length;
+    }
+
+    unsigned level;
+    for (level = pred_length ; level > 0 ; --level) {
+        if (unlikely(!_DawgClose(&build, level)))
+            goto FAIL;
+    }
+    unsigned root;
+    if (unlikely(!_DawgRegister(&build, build.path_, build.count_path_[0],
+                                &root)))
+        goto FAIL;
+
+    /* Trim the arcs to the exact size. */
+    DawgArc* arcs = (DawgArc*)realloc(build.arcs_,
+                                      sizeof(DawgArc) * build.count_arc_);
+    if (arcs)
+        build.arcs_ = arcs;
+
+    data->image_ = NULL;
+    data->length_ = 0;
+    data->owned_ = build.arcs_;
+    data->arcs_ = build.arcs_;
+    data->count_arc_ = build.count_arc_;
+    data->root_ = root;
+    data->size_ = count;
+    data->depth_ = depth;
+
+    free(build.words_);
+    free(build.table_);
+    free(build.path_);
+    free(build.count_path_);
+    FROZEN_RELEASE(&strings);
+
+    obj->data = data;
+    obj->has_exact = DawgHasExact;
+    obj->has_prefix_as = DawgHasPrefixAs;
+    obj->for_each_prefix = DawgForEachPrefix;
+    obj->index = DawgIndex;
+    obj->size = DawgSize;
+    obj->save = DawgSave;
+    return obj;
+
+FAIL:
+    free(build.arcs_);
+    free(build.words_);
+    free(build.table_);
+    free(build.path_);
+    free(build.count_path_);
+    FROZEN_RELEASE(&strings);
+    free(data);
+    free(obj);
+    return NULL;
+}
+
+Dawg* DawgOpen(const char* path)
+{
+    int fd = open(path, O_RDONLY);
+    if (fd < 0)
+        return NULL;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < (off_t)sizeof(DawgHeader)) {
+        close(fd);
+        return NULL;
+    }
+
+    size_t length = info.st_size;
+    void* image = mmap(NULL, length, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (image == MAP_FAILED)
+        return NULL;
+
+    /* Validate the header before trusting any arc index. */
+    const DawgHeader* header = (const DawgHeader*)image;
+    if (memcmp(header->magic_, DAWG_MAGIC, sizeof(DAWG_MAGIC)) != 0 ||
+        header->order_ != FROZEN_ORDER || header->version_ != DAWG_VERSION ||
+        header->count_arc_ == 0 || header->root_ >= header->count_arc_ ||
+        (length - sizeof(DawgHeader)) / sizeof(DawgArc) != header->count_arc_) {
+        munmap(image, length);
+        return NULL;
+    }
+
+    Dawg* obj = (Dawg*)malloc(sizeof(Dawg));
+    if (unlikely(!obj)) {
+        munmap(image, length);
+        return NULL;
+    }
+
+    DawgData* data = (DawgData*)malloc(sizeof(DawgData));
+    if (unlikely(!data)) {
+        free(obj);
+        munmap(image, length);
+        return NULL;
+    }
+
+    data->image_ = image;
+    data->length_ = length;
+    data->owned_ = NULL;
+    data->arcs_ = (const DawgArc*)(header + 1);
+    data->count_arc_ = header->count_arc_;
+    data->root_ = header->root_;
+    data->size_ = header->size_;
+    data->depth_ = header->depth_;
+
+    obj->data = data;
+    obj->has_exact = DawgHasExact;
+    obj->has_prefix_as = DawgHasPrefixAs;
+    obj->for_each_prefix = DawgForEachPrefix;
+    obj->index = DawgIndex;
+    obj->size = DawgSize;
+    obj->save = DawgSave;
+    return obj;
+}
+
+void DawgDeinit(Dawg* obj)
+{
+    if (unlikely(!obj))
+        return;
+
+    DawgData* data = obj->data;
+    if (data->image_)
+        munmap(data->image_, data->length_);
+    free(data->owned_);
+
+    free(data);
+    free(obj);
+    return;
+}
+
+bool DawgSave(Dawg* self, const char* path)
+{
+    DawgData* data = self->data;
+
+    DawgHeader header;
+    memset(&header, 0, sizeof(DawgHeader));
+    memcpy(header.magic_, DAWG_MAGIC, sizeof(DAWG_MAGIC));
+    header.order_ = FROZEN_ORDER;
+    header.version_ = DAWG_VERSION;
+    header.size_ = data->size_;
+    header.depth_ = data->depth_;
+    header.count_arc_ = data->count_arc_;
+    header.root_ = data->root_;
+
+    FILE* file = fopen(path, "wb");
+    if (unlikely(!file))
+        return false;
+    bool done = fwrite(&header, sizeof(DawgHeader), 1, file) == 1 &&
+                fwrite(data->arcs_, sizeof(DawgArc), data->count_arc_, file)
+                == data->count_arc_;
+    if (fclose(file) != 0)
+        done = false;
+    return done;
+}
+
+bool DawgHasExact(Dawg* self, const char* str)
+{
+    if (unlikely(!str))
+        return false;
+    if (unlikely(*str == 0))
+        return false;
+
+    const DawgArc* arc;
+    if (!DAWG_WALK(self->data, str, &arc))
+        return false;
+    return (arc->flag_ & DAWG_FINAL) != 0;
+}
+
+bool DawgHasPrefixAs(Dawg* self, const char* prefix)
+{
+    if (unlikely(!prefix))
+        return false;
+    if (unlikely(*prefix == 0))
+        return false;
+
+    /* Every arc leads to at least one stored string. */
+    const DawgArc* arc;
+    return DAWG_WALK(self->data, prefix, &arc);
+}
+
+unsigned DawgForEachPrefix(Dawg* self, const char* prefix, unsigned limit,
+                           TrieVisit func, void* arg)
+{
+    if (unlikely(!prefix))
+        return 0;
+    if (unlikely(*prefix == 0))
+        return 0;
+
+    DawgData* data = self->data;
+    const DawgArc* arc;
+    if (!DAWG_WALK(data, prefix, &arc))
+        return 0;
+
+    unsigned length = strlen(prefix);
+    char* record = (char*)malloc(sizeof(char) * (data->depth_ + 1));
+    if (unlikely(!record) || length > data->depth_) {
+        free(record);
+        return 0;
+    }
+    memcpy(record, prefix, length);
+
+    DawgVisit visit;
+    visit.arcs_ = data->arcs_;
+    visit.count_arc_ = data->count_arc_;
+    visit.depth_ = data->depth_;
+    visit.record_ = record;
+    visit.limit_ = limit;
+    visit.count_ = 0;
+    visit.func_ = func;
+    visit.arg_ = arg;
+
+    /* The prefix itself precedes its extensions. */
+    bool next = true;
+    if (arc->flag_ & DAWG_FINAL) {
+        record[length] = 0;
+        ++visit.count_;
+        next = func(record, arg) && visit.count_ != limit;
+    }
+    if (next)
+        _DawgVisit(&visit, arc->target_, length);
+
+    free(record);
+    return visit.count_;
+}
+
+bool DawgIndex(Dawg* self, const char* str, unsigned* p_index)
+{
+    if (unlikely(!str))
+        return false;
+    if (unlikely(*str == 0))
+        return false;
+
+    /* Sum up the strings ordered before the path, which are the ones below
+       the preceding arcs and the ones ending at the passed arcs. */
+    DawgData* data = self->data;
+    unsigned state = data->root_;
+    unsigned index = 0;
+    const DawgArc* arc;
+    while (true) {
+        if (!DAWG_ARC(data->arcs_, data->count_arc_, state, (uint8_t)*str,
+                      &arc))
+            return false;
+        index += arc->rank_;
+        if (*++str == 0)
+            break;
+        if (arc->flag_ & DAWG_FINAL)
+            ++index;
+        state = arc->target_;
+    }
+
+    if (!(arc->flag_ & DAWG_FINAL))
+        return false;
+    *p_index = index;
+    return true;
+}
+
+unsigned DawgSize(Dawg* self)
+{
+    return self->data->size_;
+}
+
+
+/*===========================================================================*
+ *               Implementation for internal operations                      *
+ *===========================================================================*/
+bool _TrieSort(const char** strs, const char** aux, unsigned size,
+               unsigned num_thread)
+{
+    if (num_thread <= 1 || size < SORT_GRAIN) {
+        _TrieSortRange(strs, aux, 0, size, 0);
+        return true;
+    }
+
+    /* Split the large ranges with the calling thread, where the pending ones
+       are kept at the tail of the range list. */
+    unsigned grain = size / (num_thread * SORT_SHARE);
+    if (grain < SORT_GRAIN)
+        grain = SORT_GRAIN;
+
+    unsigned capacity = SORT_BUCKET * 2;
+    TrieSortRange* ranges =
+        (TrieSortRange*)malloc(sizeof(TrieSortRange) * capacity);
+    if (unlikely(!ranges))
+        return false;
+
+    unsigned count = 0;
+    unsigned top = capacity;
+    ranges[--top].lo_ = 0;
+    ranges[top].hi_ = size;
+    ranges[top].depth_ = 0;
+
+    unsigned bounds[SORT_BUCKET + 1];
+    while (top < capacity) {
+        TrieSortRange range = ranges[top++];
+        if (range.hi_ - range.lo_ <= grain) {
+            ranges[count++] = range;
+            continue;
+        }
+
+        /* Reserve room for the buckets between the two lists. */
+        if (top - count < SORT_BUCKET) {
+            unsigned pending = capacity - top;
+            unsigned new_capacity = capacity << 1;
+            TrieSortRange* new_ranges = (TrieSortRange*)realloc(ranges,
+                sizeof(TrieSortRange) * new_capacity);
+            if (unlikely(!new_ranges)) {
+                free(ranges);
+                return false;
+            }
+            ranges = new_ranges;
+            memmove(ranges + new_capacity - pending, ranges + top,
+                    sizeof(TrieSortRange) * pending);
+            top = new_capacity - pending;
+            capacity = new_capacity;
+        }
+
+        unsigned depth = range.depth_;
+        _TrieSortSplit(strs, aux, range.lo_, range.hi_, &depth, bounds);
+        unsigned k;
+        for (k = 1 ; k < SORT_BUCKET ; ++k) {
+            if (bounds[k + 1] - bounds[k] < 2)
+                continue;
+            ranges[--top].lo_ = bounds[k];
+            ranges[top].hi_ = bounds[k + 1];
+            ranges[top].depth_ = depth + 1;
+        }
+    }
+
+    TrieSort sort;
+    sort.strs_ = strs;
+    sort.aux_ = aux;
+    sort.ranges_ = ranges;
+    sort.count_range_ = count;
+    sort.next_range_ = 0;
+
+    /* The calling thread works as well, so the sort proceeds even if no
+       worker can be spawned. */
+    pthread_t* threads = (pthread_t*)malloc(sizeof(pthread_t) * num_thread);
+    unsigned count_thread = 0;
+    if (likely(threads)) {
+        while (count_thread < num_thread - 1) {
+            if (pthread_create(threads + count_thread, NULL, _TrieSortWork,
+                               &sort) != 0)
+                break;
+            ++count_thread;
+        }
+    }
+    _TrieSortWork(&sort);
+
+    unsigned i;
+    for (i = 0 ; i < count_thread ; ++i)
+        pthread_join(threads[i], NULL);
+
+    free(threads);
+    free(ranges);
+    return true;
+}
+
+void _TrieSortRange(const char** strs, const char** aux, unsigned lo,
+                    unsigned hi, unsigned depth)
+{
+    if (hi - lo <= SORT_CUTOFF) {
+        SORT_INSERT(strs, lo, hi, depth);
+        return;
+    }
+
+    unsigned bounds[SORT_BUCKET + 1];
+    _TrieSortSplit(strs, aux, lo, hi, &depth, bounds);
+
+    /* The strings in the first bucket are all equal. */
+    unsigned k;
+    for (k = 1 ; k < SORT_BUCKET ; ++k) {
+        if (bounds[k + 1] - bounds[k] > 1)
+            _TrieSortRange(strs, aux, bounds[k], bounds[k + 1], depth + 1);
+    }
+}
+
+void _TrieSortSplit(const char** strs, const char** aux, unsigned lo,
+                    unsigned hi, unsigned* p_depth, unsigned* bounds)
+{
+    unsigned depth = *p_depth;
+    unsigned counts[SORT_BUCKET];
+
+    /* Skip the common prefix without moving any string. */
+    while (true) {
+        memset(counts, 0, sizeof(unsigned) * SORT_BUCKET);
+        unsigned i;
+        for (i = lo ; i < hi ; ++i)
+            ++counts[SORT_KEY(strs[i], depth)];
+
+        unsigned key = SORT_KEY(strs[lo], depth);
+        if (key == 0 || counts[key] != hi - lo)
+            break;
+        ++depth;
+    }
+
+    unsigned k;
+    bounds[0] = lo;
+    for (k = 0 ; k < SORT_BUCKET ; ++k)
+        bounds[k + 1] = bounds[k] + counts[k];
+
+    unsigned i;
+    for (k = 0 ; k < SORT_BUCKET ; ++k)
+        counts[k] = bounds[k];
+    for (i = lo ; i < hi ; ++i)
+        aux[counts[SORT_KEY(strs[i], depth)]++] = strs[i];
+    memcpy(strs + lo, aux + lo, sizeof(char*) * (hi - lo));
+
+    *p_depth = depth;
+}
+
+void* _TrieSortWork(void* arg)
+{
+    TrieSort* sort = (TrieSort*)arg;
+    while (true) {
+        unsigned idx = __atomic_fetch_add(&sort->next_range_, 1,
+                                          __ATOMIC_RELAXED);
+        if (idx >= sort->count_range_)
+            break;
+        TrieSortRange* range = sort->ranges_ + idx;
+        _TrieSortRange(sort->strs_, sort->aux_, range->lo_, range->hi_,
+                       range->depth_);
+    }
+    return NULL;
+}
+
+TrieNode* _TrieBuild(TrieBuild* build, unsigned lo, unsigned hi,
+                     unsigned depth, TrieNode* parent)
+{
+    if (lo == hi)
+        return NULL;
+
+    /* Locate the sibling holding the median string. */
+    const char** strs = build->strs_;
+    unsigned mid = lo + ((hi - lo) >> 1);
+    char token = strs[mid][depth];
+    unsigned first = mid, last = mid + 1;
+    while (first > lo && strs[first - 1][depth] == token)
+        --first;
+    while (last < hi && strs[last][depth] == token)
+        ++last;
+
+    TrieNode* node = build->nodes_ + build->count_node_++;
+    node->token_ = token;
+    node->pooled_ = true;
+    node->score_ = 0;
+    node->best_ = 0;
+    node->value_ = NULL;
+    node->parent_ = parent;
+
+    /* The string ending here sorts first among its extensions. */
+    node->endstr_ = strs[first][depth + 1] == 0;
+    if (node->endstr_)
+        ++first;
+
+    node->left_ = _TrieBuild(build, lo, (node->endstr_)? first - 1 : first,
+                             depth, node);
+    node->middle_ = _TrieBuild(build, first, last, depth + 1, node);
+    node->right_ = _TrieBuild(build, last, hi, depth, node);
+    return node;
+}
+
+bool _TrieBulkMerge(TrieData* data, const char** strs, unsigned lo,
+                    unsigned hi)
+{
+    while (lo < hi) {
+        unsigned mid = lo + ((hi - lo) >> 1);
+        if (unlikely(!_TrieAppend(data, strs[mid])))
+            return false;
+        if (unlikely(!_TrieBulkMerge(data, strs, lo, mid)))
+            return false;
+        /* The right half continues in the loop. */
+        lo = mid + 1;
+    }
+    return true;
+}
+
+TrieNode* _TrieAppend(TrieData* data, const char* str)
+{
+    TrieNode* curr = data->root_;
+    TrieNode* pred = NULL;
+    unsigned depth = 0;
+
+    /* Longest prefix matching. */
+    char ch, direct;
+    while (curr && ((ch = *str) != 0)) {
+        pred = curr;
+        char token = curr->token_;
+        if (ch == token) {
+            curr = curr->middle_;
+            direct = DIRECT_MIDDLE;
+            ++str;
+            ++depth;
+        } else {
+            if (ch < token) {
+                curr = curr->left_;
+                direct = DIRECT_LEFT;
+            } else {
+                curr = curr->right_;
+                direct = DIRECT_RIGHT;
+            }
+        }
+    }
+
+    /* Cascade the trie node for the remaining suffix. */
+    while ((ch = *str) != 0) {
+        TrieNode* new_node = NEW_NODE(data);
+        if (unlikely(!new_node))
+            return NULL;
+        new_node->middle_ = new_node->left_ = new_node->right_ = NULL;
+        new_node->parent_ = pred;
+        new_node->token_ = ch;
+        new_node->endstr_ = false;
+        new_node->score_ = 0;
+        new_node->best_ = 0;
+        new_node->value_ = NULL;
+
+        if (unlikely(!pred))
+            data->root_ = new_node;
+        else {
+            if (likely(direct == DIRECT_MIDDLE))
+                pred->middle_ = new_node;
+            else {
+                if (direct == DIRECT_LEFT)
+                    pred->left_ = new_node;
+                else
+                    pred->right_ = new_node;
+            }
+        }
+
+        pred = new_node;
+        direct = DIRECT_MIDDLE;
+        data->count_node_++;
+        ++str;
+        ++depth;
     }
 
-    /* The given prefix is exactly a stored string. */
-    if (pred->endstr_) {
-        dup = strdup(record);
-        strs[size++] = dup;
+    if (!(pred->endstr_)) {
+        pred->endstr_ = true;
+        data->size_++;
     }
+    if (depth > data->depth_)
+        data->depth_ = depth;
+
+    return pred;
+}
+
+void _TrieDeinit(TrieData* data)
+{
+    TrieNode* curr = data->root_;
+    if (!curr)
+        return;
 
-    /* The full trie traversal to find any node marked as string end. */
     char direct = DOWN_LEFT;
-    while (curr && (curr != pred)) {
+    while (direct != STOP) {
         if (direct == DOWN_LEFT || direct == DOWN_MIDDLE || direct == DOWN_RIGHT) {
             if (curr->left_) {
                 curr = curr->left_;
-                record[length] = curr->token_;
                 direct = DOWN_LEFT;
                 continue;
             }
-
-            record[length] = curr->token_;
-            if (curr->endstr_) {
-                if (size == capacity) {
-                    capacity <<= 1;
-                    const char** new_strs = (const char**)realloc(strs,
-                                                sizeof(const char*) * capacity);
-                    if (unlikely(!new_strs))
-                        FREE_LOCAL_RESOURCE(strs, size, record);
-                    strs = new_strs;
-                }
-                strs[size++] = strdup(record);
-            }
-
             if (curr->middle_) {
                 curr = curr->middle_;
-                record[++length] = curr->token_;
                 direct = DOWN_MIDDLE;
                 continue;
             }
             if (curr->right_) {
                 curr = curr->right_;
-                record[length] = curr->token_;
                 direct = DOWN_RIGHT;
                 continue;
             }
 
+            TrieNode* temp = curr;
             direct = DECIDE_BACKWARD_DIRECTION(&curr);
-            if (direct == UP_MIDDLE)
-                record[length--] = 0;
+            RELEASE_NODE(data, temp);
             continue;
         }
 
         if (direct == UP_LEFT) {
-            record[length] = curr->token_;
-            if (curr->endstr_) {
-                if (size == capacity) {
-                    capacity <<= 1;
-                    const char** new_strs = (const char**)realloc(strs,
-                                                sizeof(const char*) * capacity);
-                    if (unlikely(!new_strs))
-                        FREE_LOCAL_RESOURCE(strs, size, record);
-                    strs = new_strs;
-                }
-                strs[size++] = strdup(record);
-            }
-
             if (curr->middle_) {
                 curr = curr->middle_;
-                record[++length] = curr->token_;
                 direct = DOWN_MIDDLE;
                 continue;
             }
             if (curr->right_) {
                 curr = curr->right_;
-                record[length] = curr->token_;
                 direct = DOWN_RIGHT;
                 continue;
             }
 
+            TrieNode* temp = curr;
             direct = DECIDE_BACKWARD_DIRECTION(&curr);
-            if (direct == UP_MIDDLE)
-                record[length--] = 0;
+            RELEASE_NODE(data, temp);
             continue;
         }
 
         if (direct == UP_MIDDLE) {
             if (curr->right_) {
                 curr = curr->right_;
-                record[length] = curr->token_;
                 direct = DOWN_RIGHT;
                 continue;
             }
 
+            TrieNode* temp = curr;
             direct = DECIDE_BACKWARD_DIRECTION(&curr);
-            if (direct == UP_MIDDLE)
-                record[length--] = 0;
+            RELEASE_NODE(data, temp);
             continue;
         }
 
+        TrieNode* temp = curr;
         direct = DECIDE_BACKWARD_DIRECTION(&curr);
-        if (direct == UP_MIDDLE)
-            record[length--] = 0;
-        continue;
-    }
-
-    bool ever_found;
-    if (size > 0) {
-        const char** new_strs = (const char**)realloc(strs, sizeof(const char**) * size);
-        if (unlikely(!new_strs)) {
-            FREE_LOCAL_RESOURCE(strs, size, record);
-            ever_found = false;
-        }
-        strs = new_strs;
-        ever_found = true;
-    } else {
-        FREE_LOCAL_RESOURCE(strs, size, record);
-        ever_found = false;
+        RELEASE_NODE(data, temp);
     }
 
-    if (ever_found) {
-        *p_strs = strs;
-        *p_size = size;
-        free(record);
-    }
-    return ever_found;
+    return;
 }
 
-bool TrieRemove(Trie* self, const char* str)
+TrieNode* _TrieSeek(TrieData* data, const char* prefix)
 {
-    if (unlikely(!str))
-        return false;
-    if (unlikely(*str == 0))
-        return false;
-
-    TrieData* data = self->data;
     TrieNode* curr = data->root_;
     TrieNode* pred = NULL;
 
     /* Longest prefix matching. */
     char ch;
-    while (curr && ((ch = *str) != 0)) {
+    while (curr && ((ch = *prefix) != 0)) {
         pred = curr;
         char token = curr->token_;
         if (ch == token) {
             curr = curr->middle_;
-            ++str;
+            ++prefix;
         } else {
             if (ch < token)
                 curr = curr->left_;
@@ -624,70 +2580,56 @@ bool TrieRemove(Trie* self, const char* str)
         }
     }
 
-    /* At the end of a specific string. */
-    if (pred && pred->endstr_ && *str == 0) {
-        pred->endstr_ = false;
-        data->size_--;
-        return true;
-    }
-    return false;
-}
-
-unsigned TrieSize(Trie* self)
-{
-    return self->data->size_;
+    return (*prefix == 0)? pred : NULL;
 }
 
-
-/*===========================================================================*
- *               Implementation for internal operations                      *
- *===========================================================================*/
-void _TrieDeinit(TrieData* data)
+bool _TrieCursorNext(TrieCursor* cursor)
 {
-    TrieNode* curr = data->root_;
-    if (!curr)
-        return;
+    TrieNode* curr = (TrieNode*)cursor->node_;
+    TrieNode* stop = (TrieNode*)cursor->stop_;
+    char* record = cursor->buf_;
+    unsigned length = cursor->length_;
+    char direct = cursor->direct_;
+    bool found = false;
+
+    if (direct == BEGIN) {
+        if (curr->endstr_) {
+            record[length] = 0;
+            found = true;
+        }
+        curr = curr->middle_;
+        direct = DOWN_MIDDLE;
+    }
 
-    char direct = DOWN_LEFT;
-    while (direct != STOP) {
+    while (!found && curr && curr != stop) {
         if (direct == DOWN_LEFT || direct == DOWN_MIDDLE || direct == DOWN_RIGHT) {
             if (curr->left_) {
                 curr = curr->left_;
                 direct = DOWN_LEFT;
                 continue;
             }
-            if (curr->middle_) {
-                curr = curr->middle_;
-                direct = DOWN_MIDDLE;
-                continue;
-            }
-            if (curr->right_) {
-                curr = curr->right_;
-                direct = DOWN_RIGHT;
-                continue;
-            }
-
-            TrieNode* temp = curr;
-            direct = DECIDE_BACKWARD_DIRECTION(&curr);
-            free(temp);
+            direct = UP_LEFT;
             continue;
         }
 
         if (direct == UP_LEFT) {
+            record[length] = curr->token_;
+            direct = TURN_MIDDLE;
+            if (curr->endstr_) {
+                record[length + 1] = 0;
+                found = true;
+            }
+            continue;
+        }
+
+        if (direct == TURN_MIDDLE) {
             if (curr->middle_) {
                 curr = curr->middle_;
+                ++length;
                 direct = DOWN_MIDDLE;
                 continue;
             }
-            if (curr->right_) {
-                curr = curr->right_;
-                direct = DOWN_RIGHT;
-                continue;
-            }
-
-            TrieNode* temp = curr;
-            direct = DECIDE_BACKWARD_DIRECTION(&curr);
-            free(temp);
+            direct = UP_MIDDLE;
             continue;
         }
 
@@ -697,17 +2639,521 @@ void _TrieDeinit(TrieData* data)
                 direct = DOWN_RIGHT;
                 continue;
             }
+        }
 
-            TrieNode* temp = curr;
-            direct = DECIDE_BACKWARD_DIRECTION(&curr);
-            free(temp);
+        direct = DECIDE_BACKWARD_DIRECTION(&curr);
+        if (direct == UP_MIDDLE)
+            --length;
+    }
+
+    cursor->node_ = curr;
+    cursor->length_ = length;
+    cursor->direct_ = direct;
+    return found;
+}
+
+bool _TrieFuzzyVisit(TrieFuzzy* fuzzy, TrieNode* node, unsigned depth)
+{
+    const char* query = fuzzy->query_;
+    unsigned length = fuzzy->length_;
+    unsigned bound = fuzzy->max_edits_;
+    unsigned width = length + 1;
+    const unsigned* prev = fuzzy->rows_ + width * depth;
+    unsigned* curr = fuzzy->rows_ + width * (depth + 1);
+
+    /* Follow the right links iteratively, and recurse only into the left and
+       the middle subtrees. */
+    while (node) {
+        if (node->left_ && !_TrieFuzzyVisit(fuzzy, node->left_, depth))
+            return false;
+
+        /* Only the entries within the bound of the diagonal can stay within
+           the bound, and the ones around the band are capped as sentinels. */
+        char token = node->token_;
+        unsigned level = depth + 1;
+        unsigned lo = (level > bound)? level - bound : 0;
+        unsigned hi = (level + bound < length)? level + bound : length;
+        unsigned least = bound + 1;
+        if (lo == 0) {
+            curr[0] = level;
+            least = level;
+            lo = 1;
+        } else if (lo <= length)
+            curr[lo - 1] = bound + 1;
+        unsigned j;
+        for (j = lo ; j <= hi ; ++j) {
+            unsigned dist = prev[j - 1] + ((query[j - 1] == token)? 0 : 1);
+            if (prev[j] + 1 < dist)
+                dist = prev[j] + 1;
+            if (curr[j - 1] + 1 < dist)
+                dist = curr[j - 1] + 1;
+            if (dist > bound)
+                dist = bound + 1;
+            curr[j] = dist;
+            if (dist < least)
+                least = dist;
+        }
+        if (hi < length)
+            curr[hi + 1] = bound + 1;
+
+        /* Every extension of the path is at least as far as the row minimum. */
+        if (least <= bound) {
+            fuzzy->record_[depth] = token;
+            if (node->endstr_ && hi == length && curr[length] <= bound) {
+                fuzzy->record_[depth + 1] = 0;
+                ++fuzzy->count_;
+                if (!fuzzy->func_(fuzzy->record_, curr[length], fuzzy->arg_))
+                    return false;
+            }
+            if (node->middle_ &&
+                !_TrieFuzzyVisit(fuzzy, node->middle_, depth + 1))
+                return false;
+        }
+
+        node = node->right_;
+    }
+
+    return true;
+}
+
+bool _TrieCompile(TrieData* data, FrozenBuild* build)
+{
+    if (unlikely(!_TrieGather(data, build)))
+        return false;
+
+    if (unlikely(!FROZEN_RESERVE(build, 1024)))
+        return false;
+    build->units_[0].check_ = 0;
+    return _TrieFreezeBuild(build, build->strs_, 0, build->count_str_, 0, 0);
+}
+
+bool _TrieGather(TrieData* data, FrozenBuild* build)
+{
+    unsigned size = data->size_;
+    unsigned sum = data->depth_ + 1;
+
+    build->units_ = NULL;
+    build->capacity_ = 0;
+    build->count_unit_ = 1;
+    build->next_free_ = 1;
+    build->count_str_ = 0;
+
+    /* Gather all the stored strings into a single pool. */
+    size_t pool_size = 0;
+    size_t pool_capacity = sum;
+    build->pool_ = (char*)malloc(pool_capacity);
+    build->strs_ = (const char**)malloc(sizeof(const char*) * (size + 1));
+    char* record = (char*)malloc(sizeof(char) * sum);
+    size_t* offsets = (size_t*)malloc(sizeof(size_t) * (size + 1));
+
+    bool done = false;
+    if (unlikely(!build->pool_ || !build->strs_ || !record || !offsets))
+        goto EXIT;
+
+    TrieCursor cursor;
+    cursor.buf_ = record;
+    cursor.node_ = data->root_;
+    cursor.stop_ = NULL;
+    cursor.length_ = 0;
+    cursor.direct_ = DOWN_MIDDLE;
+
+    unsigned count = 0;
+    while (_TrieCursorNext(&cursor)) {
+        size_t length = strlen(record) + 1;
+        if (pool_size + length > pool_capacity) {
+            pool_capacity = (pool_capacity << 1) + length;
+            char* new_pool = (char*)realloc(build->pool_, pool_capacity);
+            if (unlikely(!new_pool))
+                goto EXIT;
+            build->pool_ = new_pool;
+        }
+        memcpy(build->pool_ + pool_size, record, length);
+        offsets[count++] = pool_size;
+        pool_size += length;
+    }
+
+    /* The traversal follows the signed token order, so sort the strings again
+       to follow the unsigned byte order of the labels. */
+    const char** strs = build->strs_;
+    unsigned i;
+    for (i = 0 ; i < count ; ++i)
+        strs[i] = build->pool_ + offsets[i];
+    qsort(strs, count, sizeof(const char*), COMPARE_STRING);
+    build->count_str_ = count;
+    done = true;
+
+EXIT:
+    free(offsets);
+    free(record);
+    return done;
+}
+
+bool _TrieFreezeBuild(FrozenBuild* build, const char** strs, unsigned lo,
+                      unsigned hi, unsigned depth, unsigned state)
+{
+    if (lo == hi)
+        return true;
+
+    /* Group the strings by their bytes at this depth. The string ending here
+       comes first with the label 0. */
+    uint8_t labels[256] = {0};
+    unsigned bounds[257];
+    unsigned num = 0;
+    unsigned i = lo;
+    while (i < hi) {
+        uint8_t label = strs[i][depth];
+        labels[num] = label;
+        bounds[num++] = i;
+        while (i < hi && (uint8_t)strs[i][depth] == label)
+            ++i;
+    }
+    bounds[num] = hi;
+
+    int32_t base = _TrieFreezeLocate(build, labels, num, state);
+    if (unlikely(base < 0))
+        return false;
+
+    /* Claim all the child units before descending into any of them. */
+    FrozenUnit* units = build->units_;
+    units[state].base_ = base;
+    unsigned k;
+    for (k = 0 ; k < num ; ++k) {
+        unsigned child = base + labels[k];
+        units[child].check_ = state;
+        if (child >= build->count_unit_)
+            build->count_unit_ = child + 1;
+    }
+
+    for (k = 0 ; k < num ; ++k) {
+        if (labels[k] == 0)
+            continue;
+        if (unlikely(!_TrieFreezeBuild(build, strs, bounds[k], bounds[k + 1],
+                                       depth + 1, base + labels[k])))
+            return false;
+    }
+
+    return true;
+}
+
+int32_t _TrieFreezeLocate(FrozenBuild* build, const uint8_t* labels,
+                          unsigned num, unsigned state)
+{
+    /* The children are placed beyond their parent, so that the reader can
+       reject the malformed image leading a walk back into a loop. */
+    unsigned begin = build->next_free_;
+    unsigned pos = (begin > labels[0])? begin : labels[0] + 1u;
+    if (pos <= state)
+        pos = state + 1;
+    unsigned occupied = 0;
+
+    while (true) {
+        if (unlikely(!FROZEN_RESERVE(build, pos + 256)))
+            return -1;
+
+        FrozenUnit* units = build->units_;
+        if (units[pos].check_ != FROZEN_FREE) {
+            ++occupied;
+            ++pos;
             continue;
         }
 
-        TrieNode* temp = curr;
-        direct = DECIDE_BACKWARD_DIRECTION(&curr);
-        free(temp);
+        unsigned base = pos - labels[0];
+        unsigned k = 1;
+        while (k < num && units[base + labels[k]].check_ == FROZEN_FREE)
+            ++k;
+        if (k == num)
+            break;
+        ++pos;
+    }
+
+    /* Skip the densely occupied region in the later searches. */
+    if (occupied >= FROZEN_DENSITY * (pos - begin + 1))
+        build->next_free_ = pos;
+
+    return pos - labels[0];
+}
+
+bool _FrozenTrieVisit(FrozenVisit* visit, unsigned state, unsigned length)
+{
+    const FrozenUnit* units = visit->units_;
+    unsigned base = units[state].base_;
+    char* record = visit->record_;
+
+    /* The children beyond the parent and the depth bound keep the walk on a
+       malformed image within the record. */
+    unsigned label;
+    for (label = 0 ; label < 256 ; ++label) {
+        unsigned next = base + label;
+        if (next >= visit->count_unit_)
+            break;
+        if (next <= state || units[next].check_ != (int32_t)state)
+            continue;
+
+        if (label == 0) {
+            if (visit->limit_ && visit->count_ == visit->limit_)
+                return false;
+            record[length] = 0;
+            ++visit->count_;
+            if (!visit->func_(record, visit->arg_))
+                return false;
+            continue;
+        }
+
+        if (length >= visit->depth_)
+            break;
+        record[length] = (char)label;
+        if (!_FrozenTrieVisit(visit, next, length + 1))
+            return false;
+    }
+
+    return true;
+}
+
+bool _DawgClose(DawgBuild* build, unsigned depth)
+{
+    unsigned state;
+    if (unlikely(!_DawgRegister(build, build->path_ + DAWG_FANOUT * depth,
+                                build->count_path_[depth], &state)))
+        return false;
+
+    DawgArc* parent = build->path_ + DAWG_FANOUT * (depth - 1);
+    parent[build->count_path_[depth - 1] - 1].target_ = state;
+    build->count_path_[depth] = 0;
+    return true;
+}
+
+bool _DawgRegister(DawgBuild* build, const DawgArc* arcs, unsigned num,
+                   unsigned* p_state)
+{
+    if (num == 0) {
+        *p_state = 0;
+        return true;
     }
 
+    /* Look for the registered state with the same arcs. */
+    unsigned mask = build->capacity_table_ - 1;
+    unsigned slot = DAWG_HASH(arcs, num) & mask;
+    while (build->table_[slot]) {
+        const DawgArc* other = build->arcs_ + build->table_[slot];
+        unsigned i;
+        for (i = 0 ; i < num ; ++i) {
+            if (other[i].label_ != arcs[i].label_ ||
+                other[i].target_ != arcs[i].target_ ||
+                (other[i].flag_ & DAWG_FINAL) != (arcs[i].flag_ & DAWG_FINAL) ||
+                ((other[i].flag_ & DAWG_LAST) != 0) != (i + 1 == num))
+                break;
+        }
+        if (i == num) {
+            *p_state = build->table_[slot];
+            return true;
+        }
+        slot = (slot + 1) & mask;
+    }
+
+    /* Append the arcs as a new state. */
+    if (build->count_arc_ + num > build->capacity_) {
+        unsigned capacity = build->capacity_ << 1;
+        while (capacity < build->count_arc_ + num)
+            capacity <<= 1;
+        DawgArc* new_arcs =
+            (DawgArc*)realloc(build->arcs_, sizeof(DawgArc) * capacity);
+        if (unlikely(!new_arcs))
+            return false;
+        build->arcs_ = new_arcs;
+        uint32_t* new_words =
+            (uint32_t*)realloc(build->words_, sizeof(uint32_t) * capacity);
+        if (unlikely(!new_words))
+            return false;
+        build->words_ = new_words;
+        build->capacity_ = capacity;
+    }
+
+    unsigned state = build->count_arc_;
+    DawgArc* dst = build->arcs_ + state;
+    unsigned rank = 0;
+    unsigned i;
+    for (i = 0 ; i < num ; ++i) {
+        dst[i] = arcs[i];
+        dst[i].rank_ = rank;
+        dst[i].flag_ = (arcs[i].flag_ & DAWG_FINAL) |
+                       ((i + 1 == num)? DAWG_LAST : 0);
+        rank += (arcs[i].flag_ & DAWG_FINAL) + build->words_[arcs[i].target_];
+    }
+    build->words_[state] = rank;
+    build->count_arc_ += num;
+    build->table_[slot] = state;
+    ++build->count_state_;
+
+    /* Keep the register at most half full. */
+    if ((build->count_state_ << 1) <= build->capacity_table_) {
+        *p_state = state;
+        return true;
+    }
+
+    unsigned capacity = build->capacity_table_ << 1;
+    uint32_t* table = (uint32_t*)calloc(capacity, sizeof(uint32_t));
+    if (unlikely(!table))
+        return false;
+    mask = capacity - 1;
+    for (i = 0 ; i < build->capacity_table_ ; ++i) {
+        unsigned other = build->table_[i];
+        if (!other)
+            continue;
+        unsigned size = 1;
+        while (!(build->arcs_[other + size - 1].flag_ & DAWG_LAST))
+            ++size;
+        slot = DAWG_HASH(build->arcs_ + other, size) & mask;
+        while (table[slot])
+            slot = (slot + 1) & mask;
+        table[slot] = other;
+    }
+    free(build->table_);
+    build->table_ = table;
+    build->capacity_table_ = capacity;
+
+    *p_state = state;
+    return true;
+}
+
+bool _DawgVisit(DawgVisit* visit, unsigned state, unsigned length)
+{
+    if (state == 0)
+        return true;
+
+    /* The depth bound also stops the walk on a malformed image. */
+    const DawgArc* arcs = visit->arcs_;
+    char* record = visit->record_;
+    unsigned i;
+    for (i = state ; i < visit->count_arc_ && length < visit->depth_ ; ++i) {
+        const DawgArc* arc = arcs + i;
+        record[length] = (char)arc->label_;
+
+        if (arc->flag_ & DAWG_FINAL) {
+            if (visit->limit_ && visit->count_ == visit->limit_)
+                return false;
+            record[length + 1] = 0;
+            ++visit->count_;
+            if (!visit->func_(record, visit->arg_))
+                return false;
+        }
+        if (!_DawgVisit(visit, arc->target_, length + 1))
+            return false;
+
+        if (arc->flag_ & DAWG_LAST)
+            break;
+    }
+
+    return true;
+}
+
+void _TrieRefresh(TrieNode* node)
+{
+    while (node) {
+        unsigned best = (node->endstr_)? node->score_ : 0;
+        if (node->left_ && node->left_->best_ > best)
+            best = node->left_->best_;
+        if (node->middle_ && node->middle_->best_ > best)
+            best = node->middle_->best_;
+        if (node->right_ && node->right_->best_ > best)
+            best = node->right_->best_;
+
+        /* The ancestors depend only on this maximum. */
+        if (best == node->best_)
+            break;
+        node->best_ = best;
+        node = node->parent_;
+    }
+    return;
+}
+
+bool _TrieHeapPush(TrieHeap* heap, unsigned score, bool single, TrieNode* node)
+{
+    if (heap->size_ == heap->capacity_) {
+        unsigned capacity = (heap->capacity_)? (heap->capacity_ << 1) : 64;
+        TrieRank* ranks = (TrieRank*)realloc(heap->ranks_, sizeof(TrieRank) * capacity);
+        if (unlikely(!ranks))
+            return false;
+        heap->ranks_ = ranks;
+        heap->capacity_ = capacity;
+    }
+
+    /* A string wins the tie against a subtree so that it is emitted before the
+       subtree of the same maximum score is expanded. */
+    TrieRank* ranks = heap->ranks_;
+    unsigned curr = heap->size_++;
+    while (curr > 0) {
+        unsigned parent = (curr - 1) >> 1;
+        TrieRank* upper = ranks + parent;
+        if (upper->score_ > score || (upper->score_ == score &&
+            (upper->single_ || !single)))
+            break;
+        ranks[curr] = *upper;
+        curr = parent;
+    }
+
+    ranks[curr].score_ = score;
+    ranks[curr].single_ = single;
+    ranks[curr].node_ = node;
+    return true;
+}
+
+void _TrieHeapPop(TrieHeap* heap, TrieRank* rank)
+{
+    TrieRank* ranks = heap->ranks_;
+    *rank = ranks[0];
+
+    TrieRank last = ranks[--heap->size_];
+    unsigned size = heap->size_;
+    unsigned curr = 0;
+    while (true) {
+        unsigned child = (curr << 1) + 1;
+        if (child >= size)
+            break;
+        if (child + 1 < size) {
+            TrieRank* lhs = ranks + child;
+            TrieRank* rhs = lhs + 1;
+            if (rhs->score_ > lhs->score_ ||
+                (rhs->score_ == lhs->score_ && rhs->single_ && !lhs->single_))
+                ++child;
+        }
+
+        TrieRank* lower = ranks + child;
+        if (last.score_ > lower->score_ || (last.score_ == lower->score_ &&
+            (last.single_ || !lower->single_)))
+            break;
+        ranks[curr] = *lower;
+        curr = child;
+    }
+
+    ranks[curr] = last;
+    return;
+}
+
+void _TrieSpell(TrieNode* node, TrieNode* stop, char* record, unsigned length)
+{
+    /* Count the tokens between the prefix and the node, which are carried by
+       the nodes left through their middle links. */
+    unsigned count = 0;
+    TrieNode* curr = node;
+    while (curr != stop) {
+        TrieNode* parent = curr->parent_;
+        if (parent == stop || parent->middle_ == curr)
+            ++count;
+        curr = parent;
+    }
+
+    record[length + count] = 0;
+    if (node == stop)
+        return;
+
+    unsigned pos = length + count - 1;
+    record[pos] = node->token_;
+    curr = node;
+    while (curr != stop) {
+        TrieNode* parent = curr->parent_;
+        if (parent != stop && parent->middle_ == curr)
+            record[--pos] = parent->token_;
+        curr = parent;
+    }
     return;
-}
\ No newline at end of file
+}
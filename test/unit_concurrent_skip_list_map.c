@@ -0,0 +1,411 @@
+#include "container/concurrent_skip_list_map.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+#include <pthread.h>
+
+
+static const int SIZE_SML_TEST = 512;
+static const int SIZE_MID_TEST = 1024;
+static const int SIZE_LGE_TEST = 4096;
+static const int SIZE_HUG_TEST = 50000;
+static const int SIZE_MID_STR = 32;
+static const int NUM_THREAD = 4;
+
+static const int RANGE_CHAR = 26;
+static const int BASE_CHAR = 97;
+
+typedef struct Worker_ {
+    pthread_t thread;
+    ConcurrentSkipListMap* map;
+    int id;
+    int count;
+} Worker;
+
+
+/*-----------------------------------------------------------------------------*
+ * The utilities for hash value generation, key comparison, and resource clean *
+ *-----------------------------------------------------------------------------*/
+int CompareKey(void* lhs, void* rhs)
+{
+    return strcmp((char*)lhs, (char*)rhs);
+}
+
+void CleanKey(void* key)
+{
+    free(key);
+}
+
+void CleanValue(void* value)
+{
+    free(value);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    ConcurrentSkipListMap* map;
+    CU_ASSERT((map = ConcurrentSkipListMapInit()) != NULL);
+    ConcurrentSkipListMapDeinit(map);
+
+    /* Enlarge the map size to test the destructor. */
+    CU_ASSERT((map = ConcurrentSkipListMapInit()) != NULL);
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+    for (i = SIZE_MID_TEST - 1; i >= SIZE_SML_TEST; --i)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+    for (i = 0 ; i < SIZE_MID_TEST ; i += 2)
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)i) == true);
+    ConcurrentSkipListMapDeinit(map);
+}
+
+void TestPutGetRemove()
+{
+    ConcurrentSkipListMap* map = ConcurrentSkipListMapInit();
+
+    CU_ASSERT(map->minimum(map) == NULL);
+    CU_ASSERT(map->maximum(map) == NULL);
+    CU_ASSERT(map->remove(map, (void*)(intptr_t)1) == false);
+
+    int i;
+    for (i = SIZE_MID_TEST - 2 ; i >= 0 ; i -= 2)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST / 2);
+
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        bool exist = ((i & 1) == 0);
+        CU_ASSERT(map->find(map, (void*)(intptr_t)i) == exist);
+        if (exist)
+            CU_ASSERT_EQUAL((int)(intptr_t)map->get(map, (void*)(intptr_t)i), i);
+    }
+
+    Pair* ptr_pair = map->minimum(map);
+    CU_ASSERT_EQUAL((int)(intptr_t)ptr_pair->key, 0);
+    ptr_pair = map->maximum(map);
+    CU_ASSERT_EQUAL((int)(intptr_t)ptr_pair->key, SIZE_MID_TEST - 2);
+
+    /* Replace the value. */
+    CU_ASSERT(map->put(map, (void*)(intptr_t)0, (void*)(intptr_t)-1) == true);
+    CU_ASSERT_EQUAL((int)(intptr_t)map->get(map, (void*)(intptr_t)0), -1);
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST / 2);
+
+    /* Walk through the map in ascending order. */
+    ConcurrentSkipListMapCursor cursor;
+    map->first(map, &cursor);
+    int expect = 0;
+    while ((ptr_pair = ConcurrentSkipListMapCursorNext(&cursor)) != NULL) {
+        CU_ASSERT_EQUAL((int)(intptr_t)ptr_pair->key, expect);
+        expect += 2;
+    }
+    CU_ASSERT_EQUAL(expect, SIZE_MID_TEST);
+
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        bool exist = ((i & 1) == 0);
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)i) == exist);
+    }
+    CU_ASSERT_EQUAL(map->size(map), 0);
+    CU_ASSERT(map->minimum(map) == NULL);
+    CU_ASSERT(map->maximum(map) == NULL);
+
+    map->reclaim(map);
+    CU_ASSERT(map->put(map, (void*)(intptr_t)1, (void*)(intptr_t)1) == true);
+    CU_ASSERT(map->find(map, (void*)(intptr_t)1) == true);
+
+    ConcurrentSkipListMapDeinit(map);
+}
+
+void TestRandomMaintenance()
+{
+    ConcurrentSkipListMap* map = ConcurrentSkipListMapInit();
+    char mirror[SIZE_LGE_TEST];
+    memset(mirror, 0, sizeof(char) * SIZE_LGE_TEST);
+
+    srand(time(NULL));
+    int i, size = 0;
+    for (i = 0 ; i < SIZE_HUG_TEST ; ++i) {
+        int key = rand() % SIZE_LGE_TEST;
+        if (rand() & 1) {
+            CU_ASSERT(map->put(map, (void*)(intptr_t)key, (void*)(intptr_t)key) == true);
+            if (!mirror[key])
+                ++size;
+            mirror[key] = 1;
+        } else {
+            CU_ASSERT(map->remove(map, (void*)(intptr_t)key) == (mirror[key] == 1));
+            if (mirror[key])
+                --size;
+            mirror[key] = 0;
+        }
+    }
+    CU_ASSERT_EQUAL(map->size(map), size);
+
+    ConcurrentSkipListMapCursor cursor;
+    map->first(map, &cursor);
+    Pair* ptr_pair;
+    int last = -1, count = 0;
+    while ((ptr_pair = ConcurrentSkipListMapCursorNext(&cursor)) != NULL) {
+        int key = (int)(intptr_t)ptr_pair->key;
+        CU_ASSERT(key > last);
+        CU_ASSERT(mirror[key] == 1);
+        last = key;
+        ++count;
+    }
+    CU_ASSERT_EQUAL(count, size);
+
+    ConcurrentSkipListMapDeinit(map);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *              Unit tests relevant to multi-threaded access                   *
+ *-----------------------------------------------------------------------------*/
+void* PutDisjoint(void* arg)
+{
+    Worker* worker = (Worker*)arg;
+    ConcurrentSkipListMap* map = worker->map;
+
+    /* Each thread owns the keys congruent to its id. */
+    int i;
+    for (i = worker->id ; i < SIZE_HUG_TEST ; i += NUM_THREAD)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+    return NULL;
+}
+
+void* RemoveShared(void* arg)
+{
+    Worker* worker = (Worker*)arg;
+    ConcurrentSkipListMap* map = worker->map;
+
+    /* All threads race to remove the same keys. */
+    int i;
+    for (i = 0 ; i < SIZE_HUG_TEST ; i += 2) {
+        if (map->remove(map, (void*)(intptr_t)i))
+            ++worker->count;
+    }
+    return NULL;
+}
+
+void* MixOperation(void* arg)
+{
+    Worker* worker = (Worker*)arg;
+    ConcurrentSkipListMap* map = worker->map;
+
+    unsigned seed = worker->id + 1;
+    int i;
+    for (i = 0 ; i < SIZE_HUG_TEST ; ++i) {
+        seed = seed * 1103515245 + 12345;
+        int key = (seed >> 8) % SIZE_MID_TEST;
+        switch (seed % 3) {
+            case 0:
+                map->put(map, (void*)(intptr_t)key, (void*)(intptr_t)key);
+                break;
+            case 1:
+                map->remove(map, (void*)(intptr_t)key);
+                break;
+            default: {
+                void* value = map->get(map, (void*)(intptr_t)key);
+                if (value && (int)(intptr_t)value != key)
+                    ++worker->count;
+            }
+        }
+    }
+    return NULL;
+}
+
+void RunWorkers(ConcurrentSkipListMap* map, void* (*func)(void*),
+                Worker* workers)
+{
+    int i;
+    for (i = 0 ; i < NUM_THREAD ; ++i) {
+        workers[i].map = map;
+        workers[i].id = i;
+        workers[i].count = 0;
+        pthread_create(&workers[i].thread, NULL, func, &workers[i]);
+    }
+    for (i = 0 ; i < NUM_THREAD ; ++i)
+        pthread_join(workers[i].thread, NULL);
+}
+
+void TestConcurrentPutRemove()
+{
+    ConcurrentSkipListMap* map = ConcurrentSkipListMapInit();
+    Worker workers[NUM_THREAD];
+
+    RunWorkers(map, PutDisjoint, workers);
+    CU_ASSERT_EQUAL(map->size(map), SIZE_HUG_TEST);
+
+    int i;
+    for (i = 0 ; i < SIZE_HUG_TEST ; ++i)
+        CU_ASSERT_EQUAL((int)(intptr_t)map->get(map, (void*)(intptr_t)i), i);
+
+    /* Each key is removed by exactly one thread. */
+    RunWorkers(map, RemoveShared, workers);
+    int count = 0;
+    for (i = 0 ; i < NUM_THREAD ; ++i)
+        count += workers[i].count;
+    CU_ASSERT_EQUAL(count, SIZE_HUG_TEST / 2);
+    CU_ASSERT_EQUAL(map->size(map), SIZE_HUG_TEST / 2);
+
+    map->reclaim(map);
+
+    ConcurrentSkipListMapCursor cursor;
+    map->first(map, &cursor);
+    Pair* ptr_pair;
+    int expect = 1;
+    while ((ptr_pair = ConcurrentSkipListMapCursorNext(&cursor)) != NULL) {
+        CU_ASSERT_EQUAL((int)(intptr_t)ptr_pair->key, expect);
+        expect += 2;
+    }
+    CU_ASSERT_EQUAL(expect, SIZE_HUG_TEST + 1);
+
+    ConcurrentSkipListMapDeinit(map);
+}
+
+void TestConcurrentMix()
+{
+    ConcurrentSkipListMap* map = ConcurrentSkipListMapInit();
+    Worker workers[NUM_THREAD];
+
+    RunWorkers(map, MixOperation, workers);
+    int i;
+    for (i = 0 ; i < NUM_THREAD ; ++i)
+        CU_ASSERT_EQUAL(workers[i].count, 0);
+
+    /* After the threads stop, the map should be consistent. */
+    map->reclaim(map);
+    ConcurrentSkipListMapCursor cursor;
+    map->first(map, &cursor);
+    Pair* ptr_pair;
+    int last = -1, count = 0;
+    while ((ptr_pair = ConcurrentSkipListMapCursorNext(&cursor)) != NULL) {
+        int key = (int)(intptr_t)ptr_pair->key;
+        CU_ASSERT(key > last);
+        CU_ASSERT(map->find(map, (void*)(intptr_t)key) == true);
+        last = key;
+        ++count;
+    }
+    CU_ASSERT_EQUAL(count, map->size(map));
+
+    ConcurrentSkipListMapDeinit(map);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *        Unit tests relevant to complex data maintenance operations           *
+ *-----------------------------------------------------------------------------*/
+void TestTextReclaim()
+{
+    ConcurrentSkipListMap* map = ConcurrentSkipListMapInit();
+    map->set_compare(map, CompareKey);
+    map->set_clean_key(map, CleanKey);
+    map->set_clean_value(map, CleanValue);
+
+    char* keys[SIZE_SML_TEST];
+    int i, j;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        keys[i] = (char*)malloc(sizeof(char) * SIZE_MID_STR);
+        for (j = 0 ; j < SIZE_MID_STR - 1 ; ++j)
+            keys[i][j] = (char)(rand() % RANGE_CHAR + BASE_CHAR);
+        keys[i][SIZE_MID_STR - 1] = 0;
+        map->put(map, strdup(keys[i]), strdup(keys[i]));
+    }
+
+    /* Replace and remove the pairs. The retired ones remain readable. */
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        if (i & 1) {
+            char* val = (char*)map->get(map, keys[i]);
+            map->put(map, strdup(keys[i]), strdup("replaced"));
+            CU_ASSERT(strcmp(val, keys[i]) == 0);
+        } else
+            map->remove(map, keys[i]);
+    }
+    map->reclaim(map);
+
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        char* val = (char*)map->get(map, keys[i]);
+        if (i & 1)
+            CU_ASSERT(val != NULL && strcmp(val, "replaced") == 0);
+        free(keys[i]);
+    }
+
+    ConcurrentSkipListMapDeinit(map);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *               The driver for ConcurrentSkipListMap unit test                *
+ *-----------------------------------------------------------------------------*/
+bool AddSuite()
+{
+    {
+        /* Verify the basic operations and the structural correctness. */
+        CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "New and Delete", TestNewDelete);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Put Get and Remove", TestPutGetRemove);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Randomized Maintenance", TestRandomMaintenance);
+        if (!unit)
+            return false;
+    }
+    {
+        /* Verify the correctness under multi-threaded access. */
+        CU_pSuite suite = CU_add_suite("Concurrent Access", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Concurrent Put and Remove", TestConcurrentPutRemove);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Concurrent Mixed Operations", TestConcurrentMix);
+        if (!unit)
+            return false;
+    }
+    {
+        /* Test its robustness to maintain complex data types. */
+        CU_pSuite suite = CU_add_suite("Complex Data Maintenance", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Text Remove and Reclamation", TestTextReclaim);
+        if (!unit)
+            return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suite for map structure verification. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}
@@ -0,0 +1,153 @@
+#include "container/count_min_sketch.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+
+
+static const int SIZE_TNY_TEST = 128;
+static const int SIZE_LGE_TEST = 100000;
+
+static const unsigned WIDTH_DEFAULT = 2048;
+static const unsigned DEPTH_DEFAULT = 5;
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    CountMinSketch* cms;
+    CU_ASSERT((cms = CountMinSketchInit(0, DEPTH_DEFAULT)) == NULL);
+    CU_ASSERT((cms = CountMinSketchInit(WIDTH_DEFAULT, 0)) == NULL);
+
+    CU_ASSERT((cms = CountMinSketchInit(WIDTH_DEFAULT, DEPTH_DEFAULT)) != NULL);
+    CU_ASSERT_EQUAL(cms->total(cms), 0);
+
+    int key = 1;
+    CU_ASSERT_EQUAL(cms->estimate(cms, &key, sizeof(int)), 0);
+    CountMinSketchDeinit(cms);
+}
+
+void TestUpdateEstimate()
+{
+    CountMinSketch* cms = CountMinSketchInit(WIDTH_DEFAULT, DEPTH_DEFAULT);
+
+    /* Record the heavy hitters whose frequency is i + 1. */
+    int i;
+    uint64_t total = 0;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        cms->update(cms, &i, sizeof(int), i + 1);
+        total += i + 1;
+    }
+
+    /* Record the long tail of singletons. */
+    for (i = SIZE_TNY_TEST ; i < SIZE_LGE_TEST ; ++i) {
+        cms->update(cms, &i, sizeof(int), 1);
+        ++total;
+    }
+    CU_ASSERT_EQUAL(cms->total(cms), total);
+
+    /* The estimation never underestimates, and the overestimation is bounded
+       by e * total / width with high probability. */
+    uint64_t bound = (uint64_t)(2.72 * total / WIDTH_DEFAULT);
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        uint64_t est = cms->estimate(cms, &i, sizeof(int));
+        CU_ASSERT(est >= (uint64_t)(i + 1));
+        CU_ASSERT(est <= (uint64_t)(i + 1) + bound);
+    }
+
+    /* The string elements. */
+    char* str = "frequent";
+    cms->update(cms, str, strlen(str), 1000);
+    CU_ASSERT(cms->estimate(cms, str, strlen(str)) >= 1000);
+    CU_ASSERT(cms->estimate(cms, str, strlen(str)) <= 1000 + bound);
+
+    CountMinSketchDeinit(cms);
+}
+
+void TestMerge()
+{
+    CountMinSketch* lhs = CountMinSketchInit(WIDTH_DEFAULT, DEPTH_DEFAULT);
+    CountMinSketch* rhs = CountMinSketchInit(WIDTH_DEFAULT, DEPTH_DEFAULT);
+    CountMinSketch* all = CountMinSketchInit(WIDTH_DEFAULT, DEPTH_DEFAULT);
+
+    int i;
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i) {
+        int key = i % SIZE_TNY_TEST;
+        CountMinSketch* part = (i & 1)? lhs : rhs;
+        part->update(part, &key, sizeof(int), 1);
+        all->update(all, &key, sizeof(int), 1);
+    }
+
+    /* Merging is lossless so the result equals the combined sketch. */
+    CU_ASSERT(lhs->merge(lhs, rhs) == true);
+    CU_ASSERT_EQUAL(lhs->total(lhs), SIZE_LGE_TEST);
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        CU_ASSERT_EQUAL(lhs->estimate(lhs, &i, sizeof(int)),
+                        all->estimate(all, &i, sizeof(int)));
+    }
+
+    /* The sketches with different dimensions cannot be merged. */
+    CountMinSketch* other = CountMinSketchInit(WIDTH_DEFAULT, DEPTH_DEFAULT + 1);
+    CU_ASSERT(lhs->merge(lhs, other) == false);
+    CountMinSketchDeinit(other);
+    other = CountMinSketchInit(WIDTH_DEFAULT + 1, DEPTH_DEFAULT);
+    CU_ASSERT(lhs->merge(lhs, other) == false);
+    CountMinSketchDeinit(other);
+
+    CountMinSketchDeinit(all);
+    CountMinSketchDeinit(rhs);
+    CountMinSketchDeinit(lhs);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *                      The driver for CountMinSketch                          *
+ *-----------------------------------------------------------------------------*/
+bool AddSuite()
+{
+    {
+        /* Verify the basic operations and the estimation accuracy. */
+        CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Sketch New and Delete", TestNewDelete);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Element Update and Estimate", TestUpdateEstimate);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Sketch Merge", TestMerge);
+        if (!unit)
+            return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suites for CountMinSketch verification. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}
@@ -14,6 +14,7 @@ typedef struct _Employ {
 
 bool AddBasicSuite();
 void TestMurMur32();
+void TestJenkins();
 
 
 int main()
@@ -54,6 +55,10 @@ bool AddBasicSuite()
     if (!test)
         return false;
 
+    test = CU_add_test(suite, "Jenkins one-at-a-time hash", TestJenkins);
+    if (!test)
+        return false;
+
     return true;
 }
 
@@ -94,4 +99,21 @@ void TestMurMur32()
     free(employ);
 
     return;
-}
\ No newline at end of file
+}
+
+void TestJenkins()
+{
+    unsigned value = HashJenkins(NULL, 32);
+    CU_ASSERT_EQUAL(value, 0);
+
+    value = HashJenkins("NULL", 0);
+    CU_ASSERT_EQUAL(value, 0);
+
+    /* Test the well-known reference values. */
+    value = HashJenkins((void*)"a", 1);
+    CU_ASSERT_EQUAL(value, 0xca2e9442);
+    value = HashJenkins((void*)"The quick brown fox jumps over the lazy dog", 43);
+    CU_ASSERT_EQUAL(value, 0x519e91f5);
+
+    return;
+}
@@ -145,6 +145,81 @@ void TestIterateNum()
     HashMapDeinit(map);
 }
 
+/* The visitor which accumulates the values and stops at the designated count. */
+typedef struct _VisitRecord {
+    int sum;
+    int count;
+    int stop;
+} VisitRecord;
+
+bool VisitPair(Pair* pair, void* arg)
+{
+    VisitRecord* record = (VisitRecord*)arg;
+    record->sum += (int)(intptr_t)pair->value;
+    ++(record->count);
+    return record->count != record->stop;
+}
+
+void TestBatchForEach()
+{
+    HashMap* map = HashMapInit();
+
+    /* Enlarge the map to trigger re-hashing. */
+    int i;
+    int sum = 0;
+    for (i = 1 ; i <= SIZE_MID_TEST ; ++i) {
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)(i * 2));
+        sum += i * 2;
+    }
+
+    /* The batch iteration should yield the same order as the single step one. */
+    void* order[SIZE_MID_TEST];
+    int size = 0;
+    Pair* ptr_pair;
+    map->first(map);
+    while ((ptr_pair = map->next(map)) != NULL)
+        order[size++] = ptr_pair->key;
+    CU_ASSERT_EQUAL(size, SIZE_MID_TEST);
+
+    Pair batch[SIZE_TNY_TEST - 1];
+    int idx = 0;
+    unsigned count;
+    map->first(map);
+    while ((count = map->next_batch(map, batch, SIZE_TNY_TEST - 1)) > 0) {
+        CU_ASSERT(count <= SIZE_TNY_TEST - 1);
+        for (i = 0 ; i < (int)count ; ++i) {
+            CU_ASSERT_EQUAL(batch[i].key, order[idx + i]);
+            CU_ASSERT_EQUAL((intptr_t)batch[i].value, (intptr_t)batch[i].key * 2);
+        }
+        idx += count;
+    }
+    CU_ASSERT_EQUAL(idx, SIZE_MID_TEST);
+    CU_ASSERT(map->next(map) == NULL);
+
+    /* The batch and the single step iterations share the same iterator. */
+    map->first(map);
+    CU_ASSERT_EQUAL(map->next(map)->key, order[0]);
+    CU_ASSERT_EQUAL(map->next_batch(map, batch, 2), 2);
+    CU_ASSERT_EQUAL(batch[0].key, order[1]);
+    CU_ASSERT_EQUAL(batch[1].key, order[2]);
+    CU_ASSERT_EQUAL(map->next(map)->key, order[3]);
+
+    /* Visit all the pairs. */
+    VisitRecord record = {0, 0, -1};
+    CU_ASSERT(map->for_each(map, VisitPair, &record) == true);
+    CU_ASSERT_EQUAL(record.count, SIZE_MID_TEST);
+    CU_ASSERT_EQUAL(record.sum, sum);
+
+    /* Stop the traversal early. */
+    record.sum = 0;
+    record.count = 0;
+    record.stop = SIZE_TNY_TEST;
+    CU_ASSERT(map->for_each(map, VisitPair, &record) == false);
+    CU_ASSERT_EQUAL(record.count, SIZE_TNY_TEST);
+
+    HashMapDeinit(map);
+}
+
 void TestPutGetTxt()
 {
     char buf[SIZE_TNY_TEST];
@@ -318,6 +393,10 @@ bool AddSuite()
         unit = CU_add_test(suite, "Map Iterator", TestIterateNum);
         if (!unit)
             return false;
+
+        unit = CU_add_test(suite, "Map Batch Iterator and Visitor", TestBatchForEach);
+        if (!unit)
+            return false;
     }
     {
         /* Test its robustness to maintain complex data types and large data set. */
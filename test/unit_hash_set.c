@@ -6,6 +6,7 @@
 static const int SIZE_TNY_TEST = 128;
 static const int SIZE_SML_TEST = 512;
 static const int SIZE_MID_TEST = 1024;
+static const int SIZE_LGE_TEST = 100000;
 
 
 /*-----------------------------------------------------------------------------*
@@ -37,6 +38,12 @@ void CleanKey(void* key)
     free(key);
 }
 
+/* The weak hash function to produce plenty of collisions. */
+unsigned HashWeak(void* key)
+{
+    return (unsigned)(uintptr_t)key % 7;
+}
+
 
 /*-----------------------------------------------------------------------------*
  *            Unit tests relevant to basic structure verification              *
@@ -124,6 +131,86 @@ void TestIterateNum()
     HashSetDeinit(set);
 }
 
+/* The visitor which accumulates the keys and stops at the designated count. */
+typedef struct _VisitRecord {
+    int sum;
+    int count;
+    int stop;
+} VisitRecord;
+
+bool VisitKey(void* key, void* arg)
+{
+    VisitRecord* record = (VisitRecord*)arg;
+    record->sum += (int)(intptr_t)key;
+    ++(record->count);
+    return record->count != record->stop;
+}
+
+void TestBatchForEach()
+{
+    HashSet* set = HashSetInit();
+
+    /* Enlarge the set to trigger re-hashing. */
+    int i;
+    int sum = 0;
+    for (i = 1 ; i <= SIZE_MID_TEST ; ++i) {
+        set->add(set, (void*)(intptr_t)i);
+        sum += i;
+    }
+
+    /* The batch iteration should yield the same order as the single step one. */
+    void* order[SIZE_MID_TEST];
+    int size = 0;
+    void* key;
+    set->first(set);
+    while ((key = set->next(set)) != NULL)
+        order[size++] = key;
+    CU_ASSERT_EQUAL(size, SIZE_MID_TEST);
+
+    void* batch[SIZE_TNY_TEST - 1];
+    int idx = 0;
+    unsigned count;
+    set->first(set);
+    while ((count = set->next_batch(set, batch, SIZE_TNY_TEST - 1)) > 0) {
+        CU_ASSERT(count <= SIZE_TNY_TEST - 1);
+        for (i = 0 ; i < (int)count ; ++i)
+            CU_ASSERT_EQUAL(batch[i], order[idx + i]);
+        idx += count;
+    }
+    CU_ASSERT_EQUAL(idx, SIZE_MID_TEST);
+    CU_ASSERT(set->next(set) == NULL);
+
+    /* The batch and the single step iterations share the same iterator. */
+    set->first(set);
+    CU_ASSERT_EQUAL(set->next(set), order[0]);
+    CU_ASSERT_EQUAL(set->next_batch(set, batch, 2), 2);
+    CU_ASSERT_EQUAL(batch[0], order[1]);
+    CU_ASSERT_EQUAL(batch[1], order[2]);
+    CU_ASSERT_EQUAL(set->next(set), order[3]);
+
+    /* Visit all the keys. */
+    VisitRecord record = {0, 0, -1};
+    CU_ASSERT(set->for_each(set, VisitKey, &record) == true);
+    CU_ASSERT_EQUAL(record.count, SIZE_MID_TEST);
+    CU_ASSERT_EQUAL(record.sum, sum);
+
+    /* Stop the traversal early. */
+    record.sum = 0;
+    record.count = 0;
+    record.stop = SIZE_TNY_TEST;
+    CU_ASSERT(set->for_each(set, VisitKey, &record) == false);
+    CU_ASSERT_EQUAL(record.count, SIZE_TNY_TEST);
+
+    HashSetDeinit(set);
+
+    /* The empty set. */
+    set = HashSetInit();
+    set->first(set);
+    CU_ASSERT_EQUAL(set->next_batch(set, batch, SIZE_TNY_TEST - 1), 0);
+    CU_ASSERT(set->for_each(set, VisitKey, &record) == true);
+    HashSetDeinit(set);
+}
+
 
 /*-----------------------------------------------------------------------------*
  *              Unit tests relevant to complex data maintenance                *
@@ -471,6 +558,110 @@ void TestDifferenceOperation()
 }
 
 
+void TestIntersectStrategy()
+{
+    {
+        /* The sort strategy must be requested explicitly. */
+        HashSet* set_lhs = HashSetInit();
+        HashSet* set_rhs = HashSetInit();
+        int i;
+        for (i = 0 ; i < SIZE_LGE_TEST ; ++i)
+            set_lhs->add(set_lhs, (void*)(intptr_t)(i * 2));
+        for (i = 0 ; i < SIZE_LGE_TEST ; ++i)
+            set_rhs->add(set_rhs, (void*)(intptr_t)(i * 3));
+
+        HashSetIntersectMode used;
+        HashSet* sort = HashSetIntersectEx(set_lhs, set_rhs,
+                                           HASH_SET_INTERSECT_SORT, &used);
+        CU_ASSERT(sort != NULL);
+        CU_ASSERT_EQUAL(used, HASH_SET_INTERSECT_SORT);
+
+        HashSet* probe = HashSetIntersectEx(set_lhs, set_rhs,
+                                            HASH_SET_INTERSECT_AUTO, &used);
+        CU_ASSERT(probe != NULL);
+        CU_ASSERT_EQUAL(used, HASH_SET_INTERSECT_PROBE);
+
+        /* Both strategies yield the multiples of 6. */
+        int expect = (SIZE_LGE_TEST * 2 + 5) / 6;
+        CU_ASSERT_EQUAL(sort->size(sort), expect);
+        CU_ASSERT_EQUAL(probe->size(probe), expect);
+        for (i = 0 ; i < SIZE_LGE_TEST * 2 ; ++i) {
+            bool exist = (i % 6 == 0);
+            CU_ASSERT(sort->find(sort, (void*)(intptr_t)i) == exist);
+        }
+
+        HashSetDeinit(probe);
+        HashSetDeinit(sort);
+        HashSetDeinit(set_lhs);
+        HashSetDeinit(set_rhs);
+    }
+    {
+        /* The skewed sizes use the probe strategy, but the sort strategy can
+           still be forced. */
+        HashSet* set_lhs = HashSetInit();
+        HashSet* set_rhs = HashSetInit();
+        int i;
+        for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+            set_lhs->add(set_lhs, (void*)(intptr_t)(i * 97));
+        for (i = 0 ; i < SIZE_LGE_TEST ; ++i)
+            set_rhs->add(set_rhs, (void*)(intptr_t)i);
+
+        HashSetIntersectMode used;
+        HashSet* result = HashSetIntersectEx(set_lhs, set_rhs,
+                                             HASH_SET_INTERSECT_AUTO, &used);
+        CU_ASSERT_EQUAL(used, HASH_SET_INTERSECT_PROBE);
+        CU_ASSERT_EQUAL(result->size(result), SIZE_MID_TEST);
+        HashSetDeinit(result);
+
+        result = HashSetIntersectEx(set_lhs, set_rhs, HASH_SET_INTERSECT_SORT, &used);
+        CU_ASSERT_EQUAL(used, HASH_SET_INTERSECT_SORT);
+        CU_ASSERT_EQUAL(result->size(result), SIZE_MID_TEST);
+        for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+            CU_ASSERT(result->find(result, (void*)(intptr_t)(i * 97)) == true);
+        HashSetDeinit(result);
+
+        HashSetDeinit(set_lhs);
+        HashSetDeinit(set_rhs);
+    }
+    {
+        /* The keys sharing the same hash value are compared one by one. */
+        HashSet* set_lhs = HashSetInit();
+        HashSet* set_rhs = HashSetInit();
+        set_lhs->set_hash(set_lhs, HashWeak);
+        set_rhs->set_hash(set_rhs, HashWeak);
+        int i;
+        for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+            set_lhs->add(set_lhs, (void*)(intptr_t)i);
+        for (i = SIZE_TNY_TEST ; i < SIZE_MID_TEST ; ++i)
+            set_rhs->add(set_rhs, (void*)(intptr_t)i);
+
+        HashSetIntersectMode used;
+        HashSet* result = HashSetIntersectEx(set_lhs, set_rhs,
+                                             HASH_SET_INTERSECT_SORT, &used);
+        CU_ASSERT_EQUAL(used, HASH_SET_INTERSECT_SORT);
+        CU_ASSERT_EQUAL(result->size(result), SIZE_SML_TEST - SIZE_TNY_TEST);
+        for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+            bool exist = (i >= SIZE_TNY_TEST && i < SIZE_SML_TEST);
+            CU_ASSERT(result->find(result, (void*)(intptr_t)i) == exist);
+        }
+        HashSetDeinit(result);
+
+        /* The sets with different hash functions can only be probed. */
+        HashSet* other = HashSetInit();
+        for (i = SIZE_TNY_TEST ; i < SIZE_MID_TEST ; ++i)
+            other->add(other, (void*)(intptr_t)i);
+        result = HashSetIntersectEx(set_lhs, other, HASH_SET_INTERSECT_SORT, &used);
+        CU_ASSERT_EQUAL(used, HASH_SET_INTERSECT_PROBE);
+        CU_ASSERT_EQUAL(result->size(result), SIZE_SML_TEST - SIZE_TNY_TEST);
+        HashSetDeinit(result);
+
+        HashSetDeinit(other);
+        HashSetDeinit(set_lhs);
+        HashSetDeinit(set_rhs);
+    }
+}
+
+
 /*-----------------------------------------------------------------------------*
  *                      The driver for HashSet unit test                       *
  *-----------------------------------------------------------------------------*/
@@ -497,6 +688,10 @@ bool AddSuite()
         unit = CU_add_test(suite, "Set Iterator", TestIterateNum);
         if (!unit)
             return false;
+
+        unit = CU_add_test(suite, "Set Batch Iterator and Visitor", TestBatchForEach);
+        if (!unit)
+            return false;
     }
     {
         /* Test its robustness to maintain complex data types and large data set. */
@@ -534,6 +729,10 @@ bool AddSuite()
         if (!unit)
             return false;
 
+        unit = CU_add_test(suite, "Intersection Strategy", TestIntersectStrategy);
+        if (!unit)
+            return false;
+
         unit = CU_add_test(suite, "Difference", TestDifferenceOperation);
         if (!unit)
             return false;
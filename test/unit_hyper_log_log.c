@@ -0,0 +1,162 @@
+#include "container/hyper_log_log.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+
+
+static const int SIZE_TNY_TEST = 128;
+static const int SIZE_SML_TEST = 512;
+static const int SIZE_LGE_TEST = 100000;
+
+static const unsigned PREC_DEFAULT = 14;
+
+
+/* Check whether the estimation is within the given relative error. */
+static bool WithinError(uint64_t estimate, uint64_t truth, double ratio)
+{
+    double diff = (double)estimate - (double)truth;
+    if (diff < 0)
+        diff = -diff;
+    return diff <= ratio * truth;
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    HyperLogLog* hll;
+    CU_ASSERT((hll = HyperLogLogInit(3)) == NULL);
+    CU_ASSERT((hll = HyperLogLogInit(19)) == NULL);
+
+    CU_ASSERT((hll = HyperLogLogInit(4)) != NULL);
+    HyperLogLogDeinit(hll);
+    CU_ASSERT((hll = HyperLogLogInit(18)) != NULL);
+    HyperLogLogDeinit(hll);
+
+    CU_ASSERT((hll = HyperLogLogInit(PREC_DEFAULT)) != NULL);
+    CU_ASSERT_EQUAL(hll->count(hll), 0);
+    HyperLogLogDeinit(hll);
+}
+
+void TestAddCount()
+{
+    HyperLogLog* hll = HyperLogLogInit(PREC_DEFAULT);
+
+    /* The small cardinality is handled by linear counting. */
+    int i;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        hll->add(hll, &i, sizeof(int));
+    CU_ASSERT(WithinError(hll->count(hll), SIZE_TNY_TEST, 0.02));
+
+    /* The duplicated elements should not change the estimation. */
+    uint64_t before = hll->count(hll);
+    int j;
+    for (j = 0 ; j < 4 ; ++j) {
+        for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+            hll->add(hll, &i, sizeof(int));
+    }
+    CU_ASSERT_EQUAL(hll->count(hll), before);
+
+    /* The large cardinality. */
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i)
+        hll->add(hll, &i, sizeof(int));
+    CU_ASSERT(WithinError(hll->count(hll), SIZE_LGE_TEST, 0.05));
+
+    /* The string elements. */
+    HyperLogLog* str = HyperLogLogInit(PREC_DEFAULT);
+    char buf[32];
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        int len = snprintf(buf, sizeof(buf), "key-%d", i);
+        str->add(str, buf, len);
+    }
+    CU_ASSERT(WithinError(str->count(str), SIZE_SML_TEST, 0.05));
+
+    HyperLogLogDeinit(str);
+    HyperLogLogDeinit(hll);
+}
+
+void TestMerge()
+{
+    HyperLogLog* lhs = HyperLogLogInit(PREC_DEFAULT);
+    HyperLogLog* rhs = HyperLogLogInit(PREC_DEFAULT);
+    HyperLogLog* all = HyperLogLogInit(PREC_DEFAULT);
+
+    /* The two estimators share half of their elements. */
+    int i;
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i) {
+        lhs->add(lhs, &i, sizeof(int));
+        all->add(all, &i, sizeof(int));
+    }
+    for (i = SIZE_LGE_TEST >> 1 ; i < SIZE_LGE_TEST + (SIZE_LGE_TEST >> 1) ; ++i) {
+        rhs->add(rhs, &i, sizeof(int));
+        all->add(all, &i, sizeof(int));
+    }
+
+    /* Merging is lossless so the result equals the combined estimator. */
+    CU_ASSERT(lhs->merge(lhs, rhs) == true);
+    CU_ASSERT_EQUAL(lhs->count(lhs), all->count(all));
+    CU_ASSERT(WithinError(lhs->count(lhs), SIZE_LGE_TEST + (SIZE_LGE_TEST >> 1), 0.05));
+
+    /* The estimators with different precisions cannot be merged. */
+    HyperLogLog* other = HyperLogLogInit(PREC_DEFAULT - 1);
+    CU_ASSERT(lhs->merge(lhs, other) == false);
+
+    HyperLogLogDeinit(other);
+    HyperLogLogDeinit(all);
+    HyperLogLogDeinit(rhs);
+    HyperLogLogDeinit(lhs);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *                      The driver for HyperLogLog                             *
+ *-----------------------------------------------------------------------------*/
+bool AddSuite()
+{
+    {
+        /* Verify the basic operations and the estimation accuracy. */
+        CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Estimator New and Delete", TestNewDelete);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Element Add and Count", TestAddCount);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Estimator Merge", TestMerge);
+        if (!unit)
+            return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suites for HyperLogLog verification. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}
@@ -0,0 +1,300 @@
+#include "container/interval_map.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+
+
+static const int SIZE_SML_TEST = 512;
+static const int SIZE_MID_TEST = 1024;
+static const int SIZE_LGE_TEST = 4096;
+static const int RANGE_POINT = 10000;
+static const int RANGE_SPAN = 300;
+
+typedef struct Span_ {
+    int low;
+    int high;
+} Span;
+
+typedef struct Collect_ {
+    int count;
+    int last;
+    bool order;
+    int limit;
+} Collect;
+
+
+/*-----------------------------------------------------------------------------*
+ * The utilities for hash value generation, key comparison, and resource clean *
+ *-----------------------------------------------------------------------------*/
+int CompareSpan(void* lhs, void* rhs)
+{
+    return strcmp((char*)lhs, (char*)rhs);
+}
+
+void CleanValue(void* value)
+{
+    free(value);
+}
+
+bool CollectInterval(Interval* interval, void* arg)
+{
+    Collect* collect = (Collect*)arg;
+    int low = (int)(intptr_t)interval->low;
+    if (collect->count > 0 && low < collect->last)
+        collect->order = false;
+    collect->last = low;
+    ++collect->count;
+    return (collect->limit == 0 || collect->count < collect->limit);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    IntervalMap* map;
+    CU_ASSERT((map = IntervalMapInit()) != NULL);
+    IntervalMapDeinit(map);
+
+    /* Enlarge the map size to test the destructor. */
+    CU_ASSERT((map = IntervalMapInit()) != NULL);
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        void* low = (void*)(intptr_t)i;
+        void* high = (void*)(intptr_t)(i + 10);
+        CU_ASSERT(map->put(map, low, high, NULL) == true);
+    }
+    IntervalMapDeinit(map);
+}
+
+void TestPutGetRemove()
+{
+    IntervalMap* map = IntervalMapInit();
+
+    /* The reversed interval is rejected. */
+    CU_ASSERT(map->put(map, (void*)(intptr_t)5, (void*)(intptr_t)1, NULL) == false);
+
+    CU_ASSERT(map->put(map, (void*)(intptr_t)1, (void*)(intptr_t)5, (void*)(intptr_t)15) == true);
+    CU_ASSERT(map->put(map, (void*)(intptr_t)1, (void*)(intptr_t)3, (void*)(intptr_t)13) == true);
+    CU_ASSERT(map->put(map, (void*)(intptr_t)2, (void*)(intptr_t)8, (void*)(intptr_t)28) == true);
+    CU_ASSERT_EQUAL(map->size(map), 3);
+
+    /* The intervals sharing the lower endpoint are distinct keys. */
+    CU_ASSERT_EQUAL((int)(intptr_t)map->get(map, (void*)(intptr_t)1, (void*)(intptr_t)5), 15);
+    CU_ASSERT_EQUAL((int)(intptr_t)map->get(map, (void*)(intptr_t)1, (void*)(intptr_t)3), 13);
+    CU_ASSERT(map->find(map, (void*)(intptr_t)1, (void*)(intptr_t)4) == false);
+
+    /* Replace the value. */
+    CU_ASSERT(map->put(map, (void*)(intptr_t)1, (void*)(intptr_t)5, (void*)(intptr_t)99) == true);
+    CU_ASSERT_EQUAL((int)(intptr_t)map->get(map, (void*)(intptr_t)1, (void*)(intptr_t)5), 99);
+    CU_ASSERT_EQUAL(map->size(map), 3);
+
+    CU_ASSERT(map->remove(map, (void*)(intptr_t)1, (void*)(intptr_t)4) == false);
+    CU_ASSERT(map->remove(map, (void*)(intptr_t)1, (void*)(intptr_t)5) == true);
+    CU_ASSERT(map->find(map, (void*)(intptr_t)1, (void*)(intptr_t)5) == false);
+    CU_ASSERT_EQUAL(map->size(map), 2);
+
+    IntervalMapDeinit(map);
+}
+
+void TestStabOverlap()
+{
+    IntervalMap* map = IntervalMapInit();
+
+    /* [0,10) [5,15) [10,20) [20,30) [25,26) */
+    map->put(map, (void*)(intptr_t)0, (void*)(intptr_t)10, NULL);
+    map->put(map, (void*)(intptr_t)5, (void*)(intptr_t)15, NULL);
+    map->put(map, (void*)(intptr_t)10, (void*)(intptr_t)20, NULL);
+    map->put(map, (void*)(intptr_t)20, (void*)(intptr_t)30, NULL);
+    map->put(map, (void*)(intptr_t)25, (void*)(intptr_t)26, NULL);
+
+    Collect collect = {0, 0, true, 0};
+    CU_ASSERT(map->stab(map, (void*)(intptr_t)10, CollectInterval, &collect) == true);
+    CU_ASSERT_EQUAL(collect.count, 2);
+    CU_ASSERT(collect.order == true);
+
+    collect.count = 0;
+    map->stab(map, (void*)(intptr_t)25, CollectInterval, &collect);
+    CU_ASSERT_EQUAL(collect.count, 2);
+
+    collect.count = 0;
+    map->stab(map, (void*)(intptr_t)30, CollectInterval, &collect);
+    CU_ASSERT_EQUAL(collect.count, 0);
+
+    /* The half-open query [15,20) does not touch [5,15). */
+    collect.count = 0;
+    map->overlap(map, (void*)(intptr_t)15, (void*)(intptr_t)20, CollectInterval, &collect);
+    CU_ASSERT_EQUAL(collect.count, 1);
+
+    collect.count = 0;
+    map->overlap(map, (void*)(intptr_t)9, (void*)(intptr_t)21, CollectInterval, &collect);
+    CU_ASSERT_EQUAL(collect.count, 4);
+
+    /* The visitor stops the query early. */
+    collect.count = 0;
+    collect.limit = 2;
+    CU_ASSERT(map->overlap(map, (void*)(intptr_t)0, (void*)(intptr_t)100, CollectInterval, &collect) == false);
+    CU_ASSERT_EQUAL(collect.count, 2);
+
+    IntervalMapDeinit(map);
+}
+
+void TestRandomQuery()
+{
+    IntervalMap* map = IntervalMapInit();
+    Span spans[SIZE_LGE_TEST];
+    bool alive[SIZE_LGE_TEST];
+
+    /* Draw the distinct intervals. */
+    srand(time(NULL));
+    int i, j, size = 0;
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i) {
+        spans[i].low = rand() % RANGE_POINT;
+        spans[i].high = spans[i].low + rand() % RANGE_SPAN;
+        alive[i] = map->put(map, (void*)(intptr_t)spans[i].low,
+                            (void*)(intptr_t)spans[i].high, NULL);
+        for (j = 0 ; j < i ; ++j) {
+            if (alive[j] && spans[j].low == spans[i].low &&
+                spans[j].high == spans[i].high)
+                alive[i] = false;
+        }
+        if (alive[i])
+            ++size;
+    }
+    CU_ASSERT_EQUAL(map->size(map), size);
+
+    /* Remove some of them to exercise the delete fixup. */
+    for (i = 0 ; i < SIZE_LGE_TEST ; i += 3) {
+        if (!alive[i])
+            continue;
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)spans[i].low,
+                              (void*)(intptr_t)spans[i].high) == true);
+        alive[i] = false;
+        --size;
+    }
+    CU_ASSERT_EQUAL(map->size(map), size);
+
+    /* Compare the queries against the brute force answers. */
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        int lo = rand() % RANGE_POINT;
+        int hi = lo + rand() % RANGE_SPAN;
+
+        int expect_stab = 0, expect_overlap = 0;
+        for (j = 0 ; j < SIZE_LGE_TEST ; ++j) {
+            if (!alive[j])
+                continue;
+            if (spans[j].low <= lo && lo < spans[j].high)
+                ++expect_stab;
+            if (spans[j].low < hi && lo < spans[j].high)
+                ++expect_overlap;
+        }
+
+        Collect collect = {0, 0, true, 0};
+        map->stab(map, (void*)(intptr_t)lo, CollectInterval, &collect);
+        CU_ASSERT_EQUAL(collect.count, expect_stab);
+        CU_ASSERT(collect.order == true);
+
+        collect.count = 0;
+        map->overlap(map, (void*)(intptr_t)lo, (void*)(intptr_t)hi, CollectInterval, &collect);
+        CU_ASSERT_EQUAL(collect.count, expect_overlap);
+        CU_ASSERT(collect.order == true);
+    }
+
+    IntervalMapDeinit(map);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *        Unit tests relevant to complex data maintenance operations           *
+ *-----------------------------------------------------------------------------*/
+void TestTextEndpoint()
+{
+    IntervalMap* map = IntervalMapInit();
+    map->set_compare(map, CompareSpan);
+    map->set_clean_value(map, CleanValue);
+
+    /* Map the alphabetical ranges to the owners. */
+    map->put(map, "apple", "banana", strdup("shelf 1"));
+    map->put(map, "banana", "cherry", strdup("shelf 2"));
+    map->put(map, "avocado", "blueberry", strdup("shelf 3"));
+    map->put(map, "banana", "cherry", strdup("shelf 4"));
+    CU_ASSERT_EQUAL(map->size(map), 3);
+
+    Collect collect = {0, 0, true, 0};
+    map->stab(map, "b", CollectInterval, &collect);
+    CU_ASSERT_EQUAL(collect.count, 2);
+
+    char* shelf = (char*)map->get(map, "banana", "cherry");
+    CU_ASSERT(strcmp(shelf, "shelf 4") == 0);
+
+    CU_ASSERT(map->remove(map, "apple", "banana") == true);
+
+    IntervalMapDeinit(map);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *                    The driver for IntervalMap unit test                     *
+ *-----------------------------------------------------------------------------*/
+bool AddSuite()
+{
+    {
+        /* Verify the basic operations and the structural correctness. */
+        CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "New and Delete", TestNewDelete);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Put Get and Remove", TestPutGetRemove);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Stab and Overlap", TestStabOverlap);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Randomized Query", TestRandomQuery);
+        if (!unit)
+            return false;
+    }
+    {
+        /* Test its robustness to maintain complex data types. */
+        CU_pSuite suite = CU_add_suite("Complex Data Maintenance", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Text Endpoint", TestTextEndpoint);
+        if (!unit)
+            return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suite for map structure verification. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}
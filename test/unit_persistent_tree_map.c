@@ -0,0 +1,406 @@
+#include "container/persistent_tree_map.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+
+
+static const int SIZE_SML_TEST = 512;
+static const int SIZE_MID_TEST = 1024;
+static const int SIZE_LGE_TEST = 4096;
+static const int SIZE_MID_STR = 32;
+static const int NUM_SNAPSHOT = 16;
+
+static const int RANGE_CHAR = 26;
+static const int BASE_CHAR = 97;
+
+static int count_clean;
+
+
+/*-----------------------------------------------------------------------------*
+ * The utilities for hash value generation, key comparison, and resource clean *
+ *-----------------------------------------------------------------------------*/
+int CompareKey(void* lhs, void* rhs)
+{
+    return strcmp((char*)lhs, (char*)rhs);
+}
+
+void CleanKey(void* key)
+{
+    free(key);
+}
+
+void CleanValue(void* value)
+{
+    free(value);
+}
+
+void CountValue(void* value)
+{
+    ++count_clean;
+}
+
+typedef struct Collect_ {
+    int count;
+    int last;
+    bool order;
+} Collect;
+
+bool VisitPair(Pair* pair, void* arg)
+{
+    Collect* collect = (Collect*)arg;
+    int key = (int)(intptr_t)pair->key;
+    if (collect->count > 0 && key <= collect->last)
+        collect->order = false;
+    if ((int)(intptr_t)pair->value != key)
+        collect->order = false;
+    collect->last = key;
+    ++collect->count;
+    return true;
+}
+
+bool StopPair(Pair* pair, void* arg)
+{
+    int* count = (int*)arg;
+    return (++(*count) < 10);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    PersistentTreeMap* map;
+    CU_ASSERT((map = PersistentTreeMapInit()) != NULL);
+    PersistentTreeMapDeinit(map);
+
+    /* Enlarge the map size to test the destructor. */
+    CU_ASSERT((map = PersistentTreeMapInit()) != NULL);
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+    for (i = SIZE_MID_TEST - 1; i >= SIZE_SML_TEST; --i)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+    PersistentTreeMapDeinit(map);
+
+    /* The snapshot outlives the map which creates it. */
+    CU_ASSERT((map = PersistentTreeMapInit()) != NULL);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+    TreeSnapshot* snap = map->snapshot(map);
+    CU_ASSERT(snap != NULL);
+    PersistentTreeMapDeinit(map);
+    CU_ASSERT_EQUAL(TreeSnapshotSize(snap), SIZE_SML_TEST);
+    CU_ASSERT(TreeSnapshotFind(snap, (void*)(intptr_t)0) == true);
+    TreeSnapshotRelease(snap);
+}
+
+void TestPutGetRemove()
+{
+    PersistentTreeMap* map = PersistentTreeMapInit();
+
+    CU_ASSERT(map->minimum(map) == NULL);
+    CU_ASSERT(map->maximum(map) == NULL);
+    CU_ASSERT(map->remove(map, (void*)(intptr_t)1) == false);
+
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; i += 2)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST / 2);
+
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        bool exist = ((i & 1) == 0);
+        CU_ASSERT(map->find(map, (void*)(intptr_t)i) == exist);
+        if (exist)
+            CU_ASSERT_EQUAL((int)(intptr_t)map->get(map, (void*)(intptr_t)i), i);
+    }
+
+    Pair* ptr_pair = map->minimum(map);
+    CU_ASSERT_EQUAL((int)(intptr_t)ptr_pair->key, 0);
+    ptr_pair = map->maximum(map);
+    CU_ASSERT_EQUAL((int)(intptr_t)ptr_pair->key, SIZE_MID_TEST - 2);
+
+    /* Replace the values. */
+    CU_ASSERT(map->put(map, (void*)(intptr_t)0, (void*)(intptr_t)-1) == true);
+    CU_ASSERT_EQUAL((int)(intptr_t)map->get(map, (void*)(intptr_t)0), -1);
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST / 2);
+
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        bool exist = ((i & 1) == 0);
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)i) == exist);
+    }
+    CU_ASSERT_EQUAL(map->size(map), 0);
+    CU_ASSERT(map->minimum(map) == NULL);
+
+    PersistentTreeMapDeinit(map);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *                 Unit tests relevant to snapshot isolation                   *
+ *-----------------------------------------------------------------------------*/
+void TestSnapshotIsolation()
+{
+    PersistentTreeMap* map = PersistentTreeMapInit();
+
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+    TreeSnapshot* snap = map->snapshot(map);
+
+    /* Modify the writer version heavily. */
+    for (i = 0 ; i < SIZE_MID_TEST ; i += 2)
+        map->remove(map, (void*)(intptr_t)i);
+    for (i = 1 ; i < SIZE_MID_TEST ; i += 2)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)(i + 1));
+    for (i = SIZE_MID_TEST ; i < SIZE_MID_TEST * 2 ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+
+    /* The snapshot still reflects the old version. */
+    CU_ASSERT_EQUAL(TreeSnapshotSize(snap), SIZE_MID_TEST);
+    for (i = 0 ; i < SIZE_MID_TEST * 2 ; ++i) {
+        bool exist = (i < SIZE_MID_TEST);
+        CU_ASSERT(TreeSnapshotFind(snap, (void*)(intptr_t)i) == exist);
+        if (exist)
+            CU_ASSERT_EQUAL((int)(intptr_t)TreeSnapshotGet(snap, (void*)(intptr_t)i), i);
+    }
+
+    Collect collect = {0, 0, true};
+    CU_ASSERT(TreeSnapshotForEach(snap, VisitPair, &collect) == true);
+    CU_ASSERT_EQUAL(collect.count, SIZE_MID_TEST);
+    CU_ASSERT(collect.order == true);
+
+    int count = 0;
+    CU_ASSERT(TreeSnapshotForEach(snap, StopPair, &count) == false);
+    CU_ASSERT_EQUAL(count, 10);
+
+    /* And the writer version reflects the updates. */
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST / 2 + SIZE_MID_TEST);
+    CU_ASSERT(map->find(map, (void*)(intptr_t)0) == false);
+    CU_ASSERT_EQUAL((int)(intptr_t)map->get(map, (void*)(intptr_t)1), 2);
+
+    TreeSnapshotRelease(snap);
+    PersistentTreeMapDeinit(map);
+}
+
+void TestSnapshotReclaim()
+{
+    PersistentTreeMap* map = PersistentTreeMapInit();
+    map->set_clean_value(map, CountValue);
+    count_clean = 0;
+
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+    TreeSnapshot* snap = map->snapshot(map);
+
+    /* The pairs referred by the snapshot are not cleaned yet. */
+    for (i = 0 ; i < SIZE_SML_TEST ; i += 2)
+        map->remove(map, (void*)(intptr_t)i);
+    map->put(map, (void*)(intptr_t)1, (void*)(intptr_t)1);
+    CU_ASSERT_EQUAL(count_clean, 0);
+
+    /* Releasing the snapshot reclaims the pairs owned only by it. */
+    TreeSnapshotRelease(snap);
+    CU_ASSERT_EQUAL(count_clean, SIZE_SML_TEST / 2 + 1);
+
+    /* Without snapshot, the pairs are cleaned immediately. */
+    map->remove(map, (void*)(intptr_t)1);
+    CU_ASSERT_EQUAL(count_clean, SIZE_SML_TEST / 2 + 2);
+    map->put(map, (void*)(intptr_t)3, (void*)(intptr_t)3);
+    CU_ASSERT_EQUAL(count_clean, SIZE_SML_TEST / 2 + 3);
+
+    PersistentTreeMapDeinit(map);
+    CU_ASSERT_EQUAL(count_clean, SIZE_SML_TEST + 2);
+}
+
+void TestRandomSnapshot()
+{
+    PersistentTreeMap* map = PersistentTreeMapInit();
+    TreeSnapshot* snaps[NUM_SNAPSHOT];
+    int* mirrors[NUM_SNAPSHOT];
+    int mirror[SIZE_LGE_TEST];
+    int sizes[NUM_SNAPSHOT];
+    int size = 0;
+
+    srand(time(NULL));
+    memset(mirror, 0, sizeof(int) * SIZE_LGE_TEST);
+
+    /* Interleave random updates with snapshots and record the expected view. */
+    int i, j;
+    for (i = 0 ; i < NUM_SNAPSHOT ; ++i) {
+        for (j = 0 ; j < SIZE_LGE_TEST ; ++j) {
+            int key = rand() % SIZE_LGE_TEST;
+            if (rand() % 3 == 0) {
+                bool exist = (mirror[key] != 0);
+                CU_ASSERT(map->remove(map, (void*)(intptr_t)key) == exist);
+                if (exist)
+                    --size;
+                mirror[key] = 0;
+            } else {
+                int val = rand() % SIZE_LGE_TEST + 1;
+                CU_ASSERT(map->put(map, (void*)(intptr_t)key, (void*)(intptr_t)val) == true);
+                if (mirror[key] == 0)
+                    ++size;
+                mirror[key] = val;
+            }
+        }
+        CU_ASSERT_EQUAL(map->size(map), size);
+
+        snaps[i] = map->snapshot(map);
+        sizes[i] = size;
+        mirrors[i] = (int*)malloc(sizeof(int) * SIZE_LGE_TEST);
+        memcpy(mirrors[i], mirror, sizeof(int) * SIZE_LGE_TEST);
+    }
+
+    /* Every snapshot preserves its own version. */
+    for (i = 0 ; i < NUM_SNAPSHOT ; ++i) {
+        CU_ASSERT_EQUAL(TreeSnapshotSize(snaps[i]), sizes[i]);
+        for (j = 0 ; j < SIZE_LGE_TEST ; ++j) {
+            int val = (int)(intptr_t)TreeSnapshotGet(snaps[i], (void*)(intptr_t)j);
+            CU_ASSERT_EQUAL(val, mirrors[i][j]);
+        }
+    }
+
+    /* Release the snapshots in the interleaved order. */
+    for (i = 0 ; i < NUM_SNAPSHOT ; i += 2)
+        TreeSnapshotRelease(snaps[i]);
+    for (i = 1 ; i < NUM_SNAPSHOT ; i += 2) {
+        for (j = 0 ; j < SIZE_LGE_TEST ; ++j) {
+            int val = (int)(intptr_t)TreeSnapshotGet(snaps[i], (void*)(intptr_t)j);
+            CU_ASSERT_EQUAL(val, mirrors[i][j]);
+        }
+        TreeSnapshotRelease(snaps[i]);
+    }
+
+    for (i = 0 ; i < NUM_SNAPSHOT ; ++i)
+        free(mirrors[i]);
+    PersistentTreeMapDeinit(map);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *        Unit tests relevant to complex data maintenance operations           *
+ *-----------------------------------------------------------------------------*/
+void TestTextSnapshot()
+{
+    PersistentTreeMap* map = PersistentTreeMapInit();
+    map->set_compare(map, CompareKey);
+    map->set_clean_key(map, CleanKey);
+    map->set_clean_value(map, CleanValue);
+
+    /* Prepare the text keys and values. */
+    char* keys[SIZE_SML_TEST];
+    int i, j;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        keys[i] = (char*)malloc(sizeof(char) * SIZE_MID_STR);
+        for (j = 0 ; j < SIZE_MID_STR - 1 ; ++j)
+            keys[i][j] = (char)(rand() % RANGE_CHAR + BASE_CHAR);
+        keys[i][SIZE_MID_STR - 1] = 0;
+        char* val = strdup(keys[i]);
+        map->put(map, keys[i], val);
+    }
+
+    TreeSnapshot* snap = map->snapshot(map);
+
+    /* Replace and remove the pairs referred by the snapshot. */
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        if (i & 1) {
+            char* key = strdup(keys[i]);
+            char* val = strdup("replaced");
+            map->put(map, key, val);
+        } else {
+            char* key = strdup(keys[i]);
+            map->remove(map, key);
+            free(key);
+        }
+    }
+
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        char* val = (char*)TreeSnapshotGet(snap, keys[i]);
+        CU_ASSERT(val != NULL && strcmp(val, keys[i]) == 0);
+    }
+    TreeSnapshotRelease(snap);
+
+    /* The original keys are reclaimed, so look up with the remaining ones. */
+    Pair* ptr_pair = map->minimum(map);
+    CU_ASSERT(ptr_pair != NULL && strcmp((char*)ptr_pair->value, "replaced") == 0);
+
+    PersistentTreeMapDeinit(map);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *                 The driver for PersistentTreeMap unit test                  *
+ *-----------------------------------------------------------------------------*/
+bool AddSuite()
+{
+    {
+        /* Verify the basic operations and the structural correctness. */
+        CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "New and Delete", TestNewDelete);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Put Get and Remove", TestPutGetRemove);
+        if (!unit)
+            return false;
+    }
+    {
+        /* Verify the isolation and the reclamation of the snapshots. */
+        CU_pSuite suite = CU_add_suite("Snapshot Maintenance", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Snapshot Isolation", TestSnapshotIsolation);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Snapshot Reclamation", TestSnapshotReclaim);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Randomized Snapshots", TestRandomSnapshot);
+        if (!unit)
+            return false;
+    }
+    {
+        /* Test its robustness to maintain complex data types. */
+        CU_pSuite suite = CU_add_suite("Complex Data Maintenance", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Text Snapshot", TestTextSnapshot);
+        if (!unit)
+            return false;
+    }
+
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suite for map structure verification. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}
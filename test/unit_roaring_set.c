@@ -0,0 +1,361 @@
+#include "container/roaring_set.h"
+#include "CUnit/Util.h"
+#include "CUnit/Basic.h"
+
+
+static const int SIZE_TNY_TEST = 128;
+static const int SIZE_SML_TEST = 512;
+static const int SIZE_LGE_TEST = 65536;
+
+static const uint32_t BASE_SPARSE = 0x00010000;
+static const uint32_t BASE_DENSE = 0x00050000;
+static const uint32_t STEP_SPARSE = 97;
+
+
+/*-----------------------------------------------------------------------------*
+ *            Unit tests relevant to basic structure verification              *
+ *-----------------------------------------------------------------------------*/
+void TestNewDelete()
+{
+    RoaringSet* set;
+    CU_ASSERT((set = RoaringSetInit()) != NULL);
+
+    /* Enlarge the set size to test the destructor. */
+    uint32_t i;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        CU_ASSERT(set->add(set, i * STEP_SPARSE) == true);
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i)
+        CU_ASSERT(set->add(set, BASE_DENSE + i) == true);
+
+    RoaringSetDeinit(set);
+}
+
+void TestPutGetNum()
+{
+    RoaringSet* set = RoaringSetInit();
+
+    /* The sparse keys are kept in array containers. */
+    uint32_t i;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        CU_ASSERT(set->add(set, BASE_SPARSE + i * STEP_SPARSE) == true);
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        CU_ASSERT(set->find(set, BASE_SPARSE + i * STEP_SPARSE) == true);
+        CU_ASSERT(set->find(set, BASE_SPARSE + i * STEP_SPARSE + 1) == false);
+    }
+
+    /* The dense keys force the array to bitmap conversion. */
+    for (i = 0 ; i < SIZE_LGE_TEST ; i += 2)
+        CU_ASSERT(set->add(set, BASE_DENSE + i) == true);
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i)
+        CU_ASSERT(set->find(set, BASE_DENSE + i) == ((i & 1) == 0));
+
+    /* The duplicated keys should not change the set size. */
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        CU_ASSERT(set->add(set, BASE_SPARSE + i * STEP_SPARSE) == true);
+    CU_ASSERT_EQUAL(set->size(set), SIZE_TNY_TEST + (SIZE_LGE_TEST >> 1));
+
+    /* The boundary keys. */
+    CU_ASSERT(set->add(set, 0) == true);
+    CU_ASSERT(set->add(set, UINT32_MAX) == true);
+    CU_ASSERT(set->find(set, 0) == true);
+    CU_ASSERT(set->find(set, UINT32_MAX) == true);
+
+    RoaringSetDeinit(set);
+}
+
+void TestRemoveNum()
+{
+    RoaringSet* set = RoaringSetInit();
+
+    uint32_t i;
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i)
+        set->add(set, BASE_DENSE + i);
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        set->add(set, BASE_SPARSE + i);
+
+    /* Remove most of the dense keys to force the bitmap to array conversion. */
+    for (i = 0 ; i < SIZE_LGE_TEST - SIZE_TNY_TEST ; ++i)
+        CU_ASSERT(set->remove(set, BASE_DENSE + i) == true);
+    for (i = 0 ; i < SIZE_LGE_TEST - SIZE_TNY_TEST ; ++i) {
+        CU_ASSERT(set->remove(set, BASE_DENSE + i) == false);
+        CU_ASSERT(set->find(set, BASE_DENSE + i) == false);
+    }
+    for (i = SIZE_LGE_TEST - SIZE_TNY_TEST ; i < SIZE_LGE_TEST ; ++i)
+        CU_ASSERT(set->find(set, BASE_DENSE + i) == true);
+
+    /* Drain the sparse container completely. */
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        CU_ASSERT(set->remove(set, BASE_SPARSE + i) == true);
+    CU_ASSERT(set->find(set, BASE_SPARSE) == false);
+
+    CU_ASSERT_EQUAL(set->size(set), SIZE_TNY_TEST);
+
+    RoaringSetDeinit(set);
+}
+
+void TestIterateNum()
+{
+    RoaringSet* set = RoaringSetInit();
+
+    /* Insert the keys in descending order. */
+    int i;
+    for (i = SIZE_LGE_TEST - 1 ; i >= 0 ; --i)
+        set->add(set, BASE_DENSE + i);
+    for (i = SIZE_TNY_TEST - 1 ; i >= 0 ; --i)
+        set->add(set, BASE_SPARSE + i * STEP_SPARSE);
+
+    /* The keys should be visited in ascending order. */
+    uint32_t key;
+    uint32_t count = 0;
+    set->first(set);
+    while (set->next(set, &key)) {
+        if (count < SIZE_TNY_TEST)
+            CU_ASSERT_EQUAL(key, BASE_SPARSE + count * STEP_SPARSE);
+        else
+            CU_ASSERT_EQUAL(key, BASE_DENSE + count - SIZE_TNY_TEST);
+        ++count;
+    }
+    CU_ASSERT_EQUAL(count, SIZE_TNY_TEST + SIZE_LGE_TEST);
+    CU_ASSERT(set->next(set, &key) == false);
+
+    RoaringSetDeinit(set);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *             Unit tests relevant to set arithmetic operations                *
+ *-----------------------------------------------------------------------------*/
+RoaringSet* PrepareSet(uint32_t bgn, uint32_t end, uint32_t step)
+{
+    RoaringSet* set = RoaringSetInit();
+    uint32_t i;
+    for (i = bgn ; i < end ; i += step)
+        set->add(set, i);
+    return set;
+}
+
+void TestUnionOperation()
+{
+    /* The array-array, bitmap-array, and bitmap-bitmap combinations. */
+    RoaringSet* lhs = PrepareSet(0, SIZE_LGE_TEST * 2, 2);
+    RoaringSet* rhs = PrepareSet(SIZE_LGE_TEST, SIZE_LGE_TEST * 3, 3);
+    RoaringSetAdd(lhs, BASE_DENSE);
+    RoaringSetAdd(rhs, BASE_DENSE + 1);
+
+    RoaringSet* result = RoaringSetUnion(lhs, rhs);
+    CU_ASSERT(result != NULL);
+
+    uint32_t i;
+    unsigned count = 0;
+    for (i = 0 ; i < SIZE_LGE_TEST * 3 ; ++i) {
+        bool expect = (i < SIZE_LGE_TEST * 2 && i % 2 == 0) ||
+                      (i >= SIZE_LGE_TEST && (i - SIZE_LGE_TEST) % 3 == 0);
+        CU_ASSERT(RoaringSetFind(result, i) == expect);
+        count += expect;
+    }
+    CU_ASSERT(RoaringSetFind(result, BASE_DENSE) == true);
+    CU_ASSERT(RoaringSetFind(result, BASE_DENSE + 1) == true);
+    CU_ASSERT_EQUAL(RoaringSetSize(result), count + 2);
+
+    RoaringSetDeinit(result);
+    RoaringSetDeinit(lhs);
+    RoaringSetDeinit(rhs);
+}
+
+void TestIntersectOperation()
+{
+    RoaringSet* lhs = PrepareSet(0, SIZE_LGE_TEST * 2, 2);
+    RoaringSet* rhs = PrepareSet(SIZE_LGE_TEST >> 1, SIZE_LGE_TEST * 3, 3);
+
+    RoaringSet* result = RoaringSetIntersect(lhs, rhs);
+    CU_ASSERT(result != NULL);
+
+    uint32_t i;
+    unsigned count = 0;
+    for (i = 0 ; i < SIZE_LGE_TEST * 3 ; ++i) {
+        bool expect = (i < SIZE_LGE_TEST * 2 && i % 2 == 0) &&
+                      (i >= (SIZE_LGE_TEST >> 1) && (i - (SIZE_LGE_TEST >> 1)) % 3 == 0);
+        CU_ASSERT(RoaringSetFind(result, i) == expect);
+        count += expect;
+    }
+    CU_ASSERT_EQUAL(RoaringSetSize(result), count);
+    RoaringSetDeinit(result);
+
+    /* The skewed array sizes trigger the galloping search. */
+    RoaringSet* small = PrepareSet(0, SIZE_LGE_TEST, SIZE_LGE_TEST >> 3);
+    RoaringSet* large = PrepareSet(0, 4096 * 4, 4);
+    result = RoaringSetIntersect(small, large);
+    CU_ASSERT_EQUAL(RoaringSetSize(result), 2);
+    CU_ASSERT(RoaringSetFind(result, 0) == true);
+    CU_ASSERT(RoaringSetFind(result, SIZE_LGE_TEST >> 3) == true);
+    RoaringSetDeinit(result);
+
+    RoaringSetDeinit(small);
+    RoaringSetDeinit(large);
+    RoaringSetDeinit(lhs);
+    RoaringSetDeinit(rhs);
+}
+
+void TestDifferenceOperation()
+{
+    RoaringSet* lhs = PrepareSet(0, SIZE_LGE_TEST * 2, 2);
+    RoaringSet* rhs = PrepareSet(SIZE_LGE_TEST >> 1, SIZE_LGE_TEST * 3, 3);
+
+    RoaringSet* lhs_only = RoaringSetDifference(lhs, rhs);
+    RoaringSet* rhs_only = RoaringSetDifference(rhs, lhs);
+    CU_ASSERT(lhs_only != NULL);
+    CU_ASSERT(rhs_only != NULL);
+
+    uint32_t i;
+    unsigned count_lhs = 0, count_rhs = 0;
+    for (i = 0 ; i < SIZE_LGE_TEST * 3 ; ++i) {
+        bool in_lhs = (i < SIZE_LGE_TEST * 2 && i % 2 == 0);
+        bool in_rhs = (i >= (SIZE_LGE_TEST >> 1) && (i - (SIZE_LGE_TEST >> 1)) % 3 == 0);
+        CU_ASSERT(RoaringSetFind(lhs_only, i) == (in_lhs && !in_rhs));
+        CU_ASSERT(RoaringSetFind(rhs_only, i) == (in_rhs && !in_lhs));
+        count_lhs += (in_lhs && !in_rhs);
+        count_rhs += (in_rhs && !in_lhs);
+    }
+    CU_ASSERT_EQUAL(RoaringSetSize(lhs_only), count_lhs);
+    CU_ASSERT_EQUAL(RoaringSetSize(rhs_only), count_rhs);
+
+    RoaringSetDeinit(lhs_only);
+    RoaringSetDeinit(rhs_only);
+    RoaringSetDeinit(lhs);
+    RoaringSetDeinit(rhs);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *                Unit tests relevant to set serialization                     *
+ *-----------------------------------------------------------------------------*/
+void TestSerialize()
+{
+    RoaringSet* set = PrepareSet(0, SIZE_LGE_TEST, 1);
+    uint32_t i;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        RoaringSetAdd(set, BASE_DENSE + i * STEP_SPARSE);
+    RoaringSetAdd(set, UINT32_MAX);
+
+    uint8_t* buf;
+    size_t size;
+    CU_ASSERT(RoaringSetSerialize(set, &buf, &size) == true);
+
+    /* The restored set should contain exactly the same keys. */
+    RoaringSet* dup = RoaringSetDeserialize(buf, size);
+    CU_ASSERT(dup != NULL);
+    CU_ASSERT_EQUAL(RoaringSetSize(dup), RoaringSetSize(set));
+
+    uint32_t key_src, key_dup;
+    RoaringSetFirst(set);
+    RoaringSetFirst(dup);
+    while (RoaringSetNext(set, &key_src)) {
+        CU_ASSERT(RoaringSetNext(dup, &key_dup) == true);
+        CU_ASSERT_EQUAL(key_src, key_dup);
+    }
+    CU_ASSERT(RoaringSetNext(dup, &key_dup) == false);
+    RoaringSetDeinit(dup);
+
+    /* The truncated or corrupted stream should be rejected. */
+    CU_ASSERT(RoaringSetDeserialize(buf, size - 1) == NULL);
+    CU_ASSERT(RoaringSetDeserialize(buf, 4) == NULL);
+    buf[0] = 'X';
+    CU_ASSERT(RoaringSetDeserialize(buf, size) == NULL);
+
+    free(buf);
+    RoaringSetDeinit(set);
+
+    /* The empty set. */
+    set = RoaringSetInit();
+    CU_ASSERT(RoaringSetSerialize(set, &buf, &size) == true);
+    dup = RoaringSetDeserialize(buf, size);
+    CU_ASSERT(dup != NULL);
+    CU_ASSERT_EQUAL(RoaringSetSize(dup), 0);
+    free(buf);
+    RoaringSetDeinit(dup);
+    RoaringSetDeinit(set);
+}
+
+
+/*-----------------------------------------------------------------------------*
+ *                    The driver for RoaringSet unit test                      *
+ *-----------------------------------------------------------------------------*/
+bool AddSuite()
+{
+    {
+        /* Verify the basic operations and the structural correctness. */
+        CU_pSuite suite = CU_add_suite("Structure Verification", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Set New and Delete", TestNewDelete);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Numeric Key Put and Get", TestPutGetNum);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Numeric Key Remove", TestRemoveNum);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Set Iterator", TestIterateNum);
+        if (!unit)
+            return false;
+    }
+    {
+        /* Test set arithmetic operation. */
+        CU_pSuite suite = CU_add_suite("Set Arithmetic", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Union", TestUnionOperation);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Intersection", TestIntersectOperation);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Difference", TestDifferenceOperation);
+        if (!unit)
+            return false;
+    }
+    {
+        /* Test the portable serialized format. */
+        CU_pSuite suite = CU_add_suite("Serialization", NULL, NULL);
+        if (!suite)
+            return false;
+
+        CU_pTest unit = CU_add_test(suite, "Serialize and Deserialize", TestSerialize);
+        if (!unit)
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    int rc = 0;
+
+    if (CU_initialize_registry() != CUE_SUCCESS) {
+        rc = CU_get_error();
+        goto EXIT;
+    }
+
+    /* Register the test suites for RoaringSet verification. */
+    if (AddSuite() == false) {
+        rc = CU_get_error();
+        goto CLEAN;
+    }
+
+    /* Launch all the tests. */
+    CU_basic_set_mode(CU_BRM_VERBOSE);
+    CU_basic_run_tests();
+
+CLEAN:
+    CU_cleanup_registry();
+EXIT:
+    return rc;
+}
@@ -382,6 +382,498 @@ void TestReverseIterate()
     TreeMapDeinit(map);
 }
 
+void TestBoundRange()
+{
+    /* Store only the even keys so that every odd key is absent. */
+    TreeMap* map = TreeMapInit();
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; i += 2)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+
+    Pair* ptr_pair;
+    for (i = -1 ; i < SIZE_SML_TEST - 2 ; ++i) {
+        int lower = (i % 2 == 0)? i : i + 1;
+        int upper = (i % 2 == 0)? i + 2 : i + 1;
+
+        ptr_pair = map->lower_bound(map, (void*)(intptr_t)i);
+        CU_ASSERT(ptr_pair != NULL);
+        if (ptr_pair)
+            CU_ASSERT_EQUAL(lower, (int)(intptr_t)ptr_pair->key);
+
+        ptr_pair = map->upper_bound(map, (void*)(intptr_t)i);
+        CU_ASSERT(ptr_pair != NULL);
+        if (ptr_pair)
+            CU_ASSERT_EQUAL(upper, (int)(intptr_t)ptr_pair->key);
+    }
+    CU_ASSERT(map->lower_bound(map, (void*)(intptr_t)SIZE_SML_TEST) == NULL);
+    CU_ASSERT(map->upper_bound(map, (void*)(intptr_t)(SIZE_SML_TEST - 2)) == NULL);
+
+    /* Walk through the ranges with both present and absent boundaries. */
+    int lo, hi;
+    for (lo = -3 ; lo < SIZE_SML_TEST + 3 ; lo += 7) {
+        for (hi = lo ; hi < SIZE_SML_TEST + 5 ; hi += 13) {
+            TreeMapCursor cursor;
+            map->range(map, (void*)(intptr_t)lo, (void*)(intptr_t)hi, &cursor);
+
+            int expect = (lo <= 0)? 0 : (lo + 1) / 2 * 2;
+            while ((ptr_pair = TreeMapCursorNext(&cursor)) != NULL) {
+                CU_ASSERT_EQUAL(expect, (int)(intptr_t)ptr_pair->key);
+                expect += 2;
+            }
+            CU_ASSERT(expect >= hi || expect >= SIZE_SML_TEST);
+            CU_ASSERT(TreeMapCursorNext(&cursor) == NULL);
+        }
+    }
+
+    /* The empty map yields the empty range. */
+    TreeMapDeinit(map);
+    map = TreeMapInit();
+    CU_ASSERT(map->lower_bound(map, (void*)(intptr_t)0) == NULL);
+    CU_ASSERT(map->upper_bound(map, (void*)(intptr_t)0) == NULL);
+
+    TreeMapCursor cursor;
+    map->range(map, (void*)(intptr_t)0, (void*)(intptr_t)SIZE_SML_TEST, &cursor);
+    CU_ASSERT(TreeMapCursorNext(&cursor) == NULL);
+
+    TreeMapDeinit(map);
+}
+
+void TestCursor()
+{
+    TreeMap* map = TreeMapInit();
+
+    /* Store the even keys. */
+    int i;
+    for (i = 0 ; i < SIZE_SML_TEST ; i += 2)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+
+    /* Interleave the ascending and the descending walks. */
+    TreeMapCursor forward, backward;
+    map->begin(map, &forward);
+    map->reverse_begin(map, &backward);
+    int head = 0, tail = SIZE_SML_TEST - 2;
+    Pair* ptr_pair;
+    while ((ptr_pair = TreeMapCursorNext(&forward)) != NULL) {
+        CU_ASSERT_EQUAL(head, (int)(intptr_t)ptr_pair->key);
+        head += 2;
+        ptr_pair = TreeMapCursorNext(&backward);
+        CU_ASSERT(ptr_pair != NULL);
+        if (ptr_pair)
+            CU_ASSERT_EQUAL(tail, (int)(intptr_t)ptr_pair->key);
+        tail -= 2;
+    }
+    CU_ASSERT_EQUAL(head, SIZE_SML_TEST);
+    CU_ASSERT(TreeMapCursorNext(&backward) == NULL);
+
+    /* Walk through the ranges in descending order. */
+    int lo, hi;
+    for (lo = -3 ; lo < SIZE_SML_TEST + 3 ; lo += 7) {
+        for (hi = lo - 2 ; hi < SIZE_SML_TEST + 5 ; hi += 13) {
+            TreeMapCursor cursor;
+            map->reverse_range(map, (void*)(intptr_t)lo, (void*)(intptr_t)hi, &cursor);
+
+            int expect = (hi > SIZE_SML_TEST)? SIZE_SML_TEST - 2 : (hi - 1) / 2 * 2;
+            if (hi <= 0)
+                expect = -2;
+            int count = 0;
+            while ((ptr_pair = TreeMapCursorNext(&cursor)) != NULL) {
+                CU_ASSERT_EQUAL(expect, (int)(intptr_t)ptr_pair->key);
+                CU_ASSERT((int)(intptr_t)ptr_pair->key >= lo);
+                expect -= 2;
+                ++count;
+            }
+            if (lo >= hi)
+                CU_ASSERT_EQUAL(count, 0);
+            if (lo < hi)
+                CU_ASSERT(expect < lo || expect < 0);
+        }
+    }
+
+    /* Partition the map and check the ranges cover all the keys once. */
+    int count;
+    for (count = 1 ; count <= 9 ; ++count) {
+        TreeMapCursor cursors[9];
+        unsigned num = map->partition(map, cursors, count);
+        CU_ASSERT_EQUAL(num, count);
+
+        int expect = 0;
+        unsigned j;
+        for (j = 0 ; j < num ; ++j) {
+            int size = 0;
+            while ((ptr_pair = TreeMapCursorNext(&cursors[j])) != NULL) {
+                CU_ASSERT_EQUAL(expect, (int)(intptr_t)ptr_pair->key);
+                expect += 2;
+                ++size;
+            }
+            int quota = SIZE_SML_TEST / 2 / count;
+            CU_ASSERT(size == quota || size == quota + 1);
+        }
+        CU_ASSERT_EQUAL(expect, SIZE_SML_TEST);
+    }
+    TreeMapDeinit(map);
+
+    /* The small map yields fewer ranges and the empty map yields none. */
+    map = TreeMapInit();
+    TreeMapCursor cursors[4];
+    CU_ASSERT_EQUAL(map->partition(map, cursors, 4), 0);
+    map->begin(map, &cursors[0]);
+    CU_ASSERT(TreeMapCursorNext(&cursors[0]) == NULL);
+    map->reverse_begin(map, &cursors[0]);
+    CU_ASSERT(TreeMapCursorNext(&cursors[0]) == NULL);
+
+    map->put(map, (void*)(intptr_t)1, (void*)(intptr_t)1);
+    map->put(map, (void*)(intptr_t)2, (void*)(intptr_t)2);
+    CU_ASSERT_EQUAL(map->partition(map, cursors, 4), 2);
+    CU_ASSERT_EQUAL((int)(intptr_t)TreeMapCursorNext(&cursors[0])->key, 1);
+    CU_ASSERT(TreeMapCursorNext(&cursors[0]) == NULL);
+    CU_ASSERT_EQUAL((int)(intptr_t)TreeMapCursorNext(&cursors[1])->key, 2);
+    CU_ASSERT(TreeMapCursorNext(&cursors[1]) == NULL);
+    TreeMapDeinit(map);
+}
+
+void TestRankSelect()
+{
+    srand(time(NULL));
+
+    /* Store the even keys in random order. */
+    int elems[SIZE_MID_TEST];
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        elems[i] = i * 2;
+
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        int src = rand() % SIZE_MID_TEST;
+        int tge = rand() % SIZE_MID_TEST;
+        int temp = elems[src];
+        elems[src] = elems[tge];
+        elems[tge] = temp;
+    }
+
+    TreeMap* map = TreeMapInit();
+    CU_ASSERT(map->select(map, 0) == NULL);
+    CU_ASSERT_EQUAL(map->rank(map, (void*)(intptr_t)0), 0);
+
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)elems[i], (void*)(intptr_t)elems[i]);
+
+    /* Replacing the existing pairs should not change the subtree sizes. */
+    for (i = 0 ; i < SIZE_MID_TEST ; i += 3)
+        map->put(map, (void*)(intptr_t)elems[i], (void*)(intptr_t)elems[i]);
+
+    Pair* ptr_pair;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        CU_ASSERT_EQUAL(map->rank(map, (void*)(intptr_t)(i * 2)), i);
+        CU_ASSERT_EQUAL(map->rank(map, (void*)(intptr_t)(i * 2 + 1)), i + 1);
+        ptr_pair = map->select(map, i);
+        CU_ASSERT(ptr_pair != NULL);
+        if (ptr_pair)
+            CU_ASSERT_EQUAL(i * 2, (int)(intptr_t)ptr_pair->key);
+    }
+    CU_ASSERT(map->select(map, SIZE_MID_TEST) == NULL);
+
+    /* Remove the keys whose order is a multiple of 4 and recheck the orders. */
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        if (elems[i] % 8 == 0)
+            map->remove(map, (void*)(intptr_t)elems[i]);
+    }
+
+    int size = map->size(map);
+    CU_ASSERT_EQUAL(size, SIZE_MID_TEST - SIZE_MID_TEST / 4);
+    for (i = 0 ; i < size ; ++i) {
+        ptr_pair = map->select(map, i);
+        CU_ASSERT(ptr_pair != NULL);
+        if (!ptr_pair)
+            continue;
+        int key = (int)(intptr_t)ptr_pair->key;
+        CU_ASSERT(key % 8 != 0);
+        CU_ASSERT_EQUAL(map->rank(map, ptr_pair->key), i);
+        CU_ASSERT_EQUAL(key, (i / 3) * 8 + (i % 3 + 1) * 2);
+    }
+    CU_ASSERT(map->select(map, size) == NULL);
+
+    TreeMapDeinit(map);
+}
+
+void TestBuildSorted()
+{
+    Pair pairs[SIZE_MID_TEST];
+    int i;
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        pairs[i].key = (void*)(intptr_t)(i * 2);
+        pairs[i].value = (void*)(intptr_t)i;
+    }
+
+    /* The input should be strictly ascending. */
+    TreeMap* map = TreeMapInit();
+    pairs[1].key = (void*)(intptr_t)0;
+    CU_ASSERT(map->build_sorted(map, pairs, SIZE_MID_TEST) == false);
+    CU_ASSERT_EQUAL(map->size(map), 0);
+    pairs[1].key = (void*)(intptr_t)2;
+
+    CU_ASSERT(map->build_sorted(map, pairs, 0) == true);
+    CU_ASSERT(map->build_sorted(map, pairs, SIZE_MID_TEST) == true);
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST);
+
+    /* The map should be empty before bulk loading. */
+    CU_ASSERT(map->build_sorted(map, pairs, SIZE_MID_TEST) == false);
+
+    Pair* ptr_pair;
+    map->first(map);
+    i = 0;
+    while ((ptr_pair = map->next(map)) != NULL) {
+        CU_ASSERT_EQUAL(i * 2, (int)(intptr_t)ptr_pair->key);
+        CU_ASSERT_EQUAL(i, (int)(intptr_t)ptr_pair->value);
+        ++i;
+    }
+    CU_ASSERT_EQUAL(i, SIZE_MID_TEST);
+
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        CU_ASSERT_EQUAL(map->rank(map, (void*)(intptr_t)(i * 2)), i);
+        ptr_pair = map->select(map, i);
+        CU_ASSERT(ptr_pair != NULL);
+        if (ptr_pair)
+            CU_ASSERT_EQUAL(i * 2, (int)(intptr_t)ptr_pair->key);
+    }
+
+    /* Mix the bulk loaded nodes with the individually allocated ones. */
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)(i * 2 + 1), NULL) == true);
+    for (i = 0 ; i < SIZE_MID_TEST * 2 ; i += 3)
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)i) == true);
+
+    int size = map->size(map);
+    CU_ASSERT_EQUAL(size, SIZE_MID_TEST * 2 - (SIZE_MID_TEST * 2 + 2) / 3);
+    for (i = 0 ; i < size ; ++i) {
+        ptr_pair = map->select(map, i);
+        CU_ASSERT(ptr_pair != NULL);
+        if (ptr_pair)
+            CU_ASSERT((int)(intptr_t)ptr_pair->key % 3 != 0);
+    }
+    TreeMapDeinit(map);
+
+    /* Let the map manage the bulk loaded text keys and values. */
+    char buf[SIZE_MID_STR];
+    map = TreeMapInit();
+    map->set_compare(map, CompareKey);
+    map->set_clean_key(map, CleanKey);
+    map->set_clean_value(map, CleanValue);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        snprintf(buf, SIZE_MID_STR, "%08d", i);
+        pairs[i].key = strdup(buf);
+        pairs[i].value = strdup(buf);
+    }
+    CU_ASSERT(map->build_sorted(map, pairs, SIZE_MID_TEST) == true);
+
+    for (i = 0 ; i < SIZE_MID_TEST ; i += 2) {
+        snprintf(buf, SIZE_MID_STR, "%08d", i);
+        CU_ASSERT(map->remove(map, buf) == true);
+    }
+    for (i = 1 ; i < SIZE_MID_TEST ; i += 2) {
+        snprintf(buf, SIZE_MID_STR, "%08d", i);
+        char* value = (char*)map->get(map, buf);
+        CU_ASSERT(value != NULL);
+        if (value)
+            CU_ASSERT(strcmp(value, buf) == 0);
+    }
+    TreeMapDeinit(map);
+}
+
+void TestArena()
+{
+    srand(time(NULL));
+
+    int elems[SIZE_LGE_TEST];
+    int i;
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i)
+        elems[i] = i;
+
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i) {
+        int src = rand() % SIZE_LGE_TEST;
+        int tge = rand() % SIZE_LGE_TEST;
+        int temp = elems[src];
+        elems[src] = elems[tge];
+        elems[tge] = temp;
+    }
+
+    /* Enable the arena after some nodes are individually allocated. */
+    TreeMap* map = TreeMapInit();
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)elems[i], (void*)(intptr_t)elems[i]);
+    map->set_arena(map, SIZE_TNY_TEST);
+    for (i = SIZE_TNY_TEST ; i < SIZE_LGE_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)elems[i], (void*)(intptr_t)elems[i]);
+
+    /* The removed nodes should be recycled by the subsequent insertion. */
+    int round;
+    for (round = 0 ; round < 2 ; ++round) {
+        for (i = 0 ; i < SIZE_LGE_TEST ; i += 2)
+            CU_ASSERT(map->remove(map, (void*)(intptr_t)elems[i]) == true);
+        CU_ASSERT_EQUAL(map->size(map), SIZE_LGE_TEST / 2);
+        for (i = 0 ; i < SIZE_LGE_TEST ; i += 2)
+            map->put(map, (void*)(intptr_t)elems[i], (void*)(intptr_t)elems[i]);
+        CU_ASSERT_EQUAL(map->size(map), SIZE_LGE_TEST);
+    }
+
+    Pair* ptr_pair;
+    map->first(map);
+    i = 0;
+    while ((ptr_pair = map->next(map)) != NULL) {
+        CU_ASSERT_EQUAL(i, (int)(intptr_t)ptr_pair->key);
+        CU_ASSERT_EQUAL(i, (int)(intptr_t)ptr_pair->value);
+        CU_ASSERT_EQUAL(map->rank(map, ptr_pair->key), i);
+        ++i;
+    }
+    CU_ASSERT_EQUAL(i, SIZE_LGE_TEST);
+    TreeMapDeinit(map);
+
+    /* Destruct the map holding only the arena nodes without visiting them. */
+    map = TreeMapInit();
+    map->set_arena(map, SIZE_TNY_TEST);
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)elems[i], (void*)(intptr_t)elems[i]);
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i)
+        CU_ASSERT(map->find(map, (void*)(intptr_t)i) == true);
+    TreeMapDeinit(map);
+
+    /* The cleanup functions should still be applied to the arena nodes. */
+    char buf[SIZE_MID_STR];
+    map = TreeMapInit();
+    map->set_arena(map, SIZE_TNY_TEST);
+    map->set_compare(map, CompareKey);
+    map->set_clean_key(map, CleanKey);
+    map->set_clean_value(map, CleanValue);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        snprintf(buf, SIZE_MID_STR, "%d", elems[i]);
+        map->put(map, strdup(buf), strdup(buf));
+    }
+    for (i = 0 ; i < SIZE_MID_TEST ; i += 2) {
+        snprintf(buf, SIZE_MID_STR, "%d", elems[i]);
+        CU_ASSERT(map->remove(map, buf) == true);
+    }
+    TreeMapDeinit(map);
+}
+
+void TestSplitJoinMerge()
+{
+    TreeMap* map = TreeMapInit();
+    map->set_arena(map, SIZE_TNY_TEST);
+    int i;
+    for (i = 0 ; i < SIZE_LGE_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+
+    /* Split at the absent key and the present key. */
+    TreeMap* right = map->split(map, (void*)(intptr_t)(SIZE_LGE_TEST + 1));
+    CU_ASSERT(right != NULL);
+    CU_ASSERT_EQUAL(right->size(right), 0);
+    TreeMapDeinit(right);
+
+    right = map->split(map, (void*)(intptr_t)SIZE_MID_TEST);
+    CU_ASSERT(right != NULL);
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST);
+    CU_ASSERT_EQUAL(right->size(right), SIZE_LGE_TEST - SIZE_MID_TEST);
+    CU_ASSERT_EQUAL((intptr_t)map->maximum(map)->key, SIZE_MID_TEST - 1);
+    CU_ASSERT_EQUAL((intptr_t)right->minimum(right)->key, SIZE_MID_TEST);
+
+    /* Both parts remain fully functional. */
+    for (i = 0 ; i < SIZE_MID_TEST ; i += 2) {
+        CU_ASSERT(map->remove(map, (void*)(intptr_t)i) == true);
+        CU_ASSERT(right->remove(right, (void*)(intptr_t)(i + SIZE_MID_TEST)) == true);
+    }
+    for (i = 0 ; i < SIZE_MID_TEST ; i += 2)
+        CU_ASSERT(map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i) == true);
+
+    /* The overlapped key ranges cannot be joined. */
+    CU_ASSERT(right->join(right, map) == false);
+    CU_ASSERT(map->join(map, right) == true);
+    CU_ASSERT_EQUAL(right->size(right), 0);
+    CU_ASSERT_EQUAL(map->size(map), SIZE_LGE_TEST - SIZE_MID_TEST / 2);
+    TreeMapDeinit(right);
+
+    Pair* ptr_pair;
+    for (i = 0 ; i < (int)map->size(map) ; ++i) {
+        ptr_pair = map->select(map, i);
+        CU_ASSERT(ptr_pair != NULL);
+        if (ptr_pair)
+            CU_ASSERT_EQUAL(map->rank(map, ptr_pair->key), i);
+    }
+
+    /* Merge the interleaved keys. The pairs from the other map win. */
+    TreeMap* other = TreeMapInit();
+    for (i = 0 ; i < SIZE_LGE_TEST * 2 ; i += 3)
+        other->put(other, (void*)(intptr_t)i, (void*)(intptr_t)-i);
+    int size_other = other->size(other);
+    CU_ASSERT(map->merge(map, other) == true);
+    CU_ASSERT_EQUAL(other->size(other), 0);
+    TreeMapDeinit(other);
+
+    int expect = 0;
+    for (i = 0 ; i < SIZE_LGE_TEST * 2 ; ++i) {
+        bool in_map = (i < SIZE_LGE_TEST) &&
+                      !(i >= SIZE_MID_TEST && i < SIZE_MID_TEST * 2 && i % 2 == 0);
+        bool in_other = (i % 3 == 0);
+        if (!in_map && !in_other) {
+            CU_ASSERT(map->find(map, (void*)(intptr_t)i) == false);
+            continue;
+        }
+        ++expect;
+        int value = (int)(intptr_t)map->get(map, (void*)(intptr_t)i);
+        CU_ASSERT_EQUAL(value, (in_other)? -i : i);
+    }
+    CU_ASSERT_EQUAL(map->size(map), expect);
+    CU_ASSERT(size_other < expect);
+
+    map->first(map);
+    i = -1;
+    while ((ptr_pair = map->next(map)) != NULL) {
+        CU_ASSERT(i < (int)(intptr_t)ptr_pair->key);
+        i = (int)(intptr_t)ptr_pair->key;
+    }
+    TreeMapDeinit(map);
+
+    /* The replaced text pairs should be released by this map. */
+    char buf[SIZE_MID_STR];
+    map = TreeMapInit();
+    other = TreeMapInit();
+    TreeMap* maps[2] = {map, other};
+    for (i = 0 ; i < 2 ; ++i) {
+        maps[i]->set_compare(maps[i], CompareKey);
+        maps[i]->set_clean_key(maps[i], CleanKey);
+        maps[i]->set_clean_value(maps[i], CleanValue);
+    }
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        snprintf(buf, SIZE_MID_STR, "%d", i);
+        map->put(map, strdup(buf), strdup(buf));
+        if (i % 2 == 0)
+            other->put(other, strdup(buf), strdup("other"));
+    }
+    CU_ASSERT(map->merge(map, other) == true);
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST);
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i) {
+        snprintf(buf, SIZE_MID_STR, "%d", i);
+        char* value = (char*)map->get(map, buf);
+        CU_ASSERT(value != NULL);
+        if (value)
+            CU_ASSERT(strcmp(value, (i % 2 == 0)? "other" : buf) == 0);
+    }
+    TreeMapDeinit(other);
+    TreeMapDeinit(map);
+
+    /* The individually allocated nodes must survive the repeated splits and
+       merges, and be released by the final map. */
+    map = TreeMapInit();
+    for (i = 0 ; i < SIZE_MID_TEST ; ++i)
+        map->put(map, (void*)(intptr_t)i, (void*)(intptr_t)i);
+    int round;
+    for (round = 0 ; round < 64 ; ++round) {
+        right = map->split(map, (void*)(intptr_t)(round % SIZE_MID_TEST));
+        CU_ASSERT(right != NULL);
+        CU_ASSERT(map->merge(map, right) == true);
+        TreeMapDeinit(right);
+    }
+    CU_ASSERT_EQUAL(map->size(map), SIZE_MID_TEST);
+    TreeMapDeinit(map);
+}
+
 void TestPutDupText()
 {
     char buf[SIZE_TNY_TEST];
@@ -535,6 +1027,30 @@ bool AddSuite()
         unit = CU_add_test(suite, "Reverse Iterator", TestReverseIterate);
         if (!unit)
             return false;
+
+        unit = CU_add_test(suite, "Bound and Range", TestBoundRange);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Cursor and Partition", TestCursor);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Rank and Select", TestRankSelect);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Sorted Bulk Load", TestBuildSorted);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Arena Allocation", TestArena);
+        if (!unit)
+            return false;
+
+        unit = CU_add_test(suite, "Split Join and Merge", TestSplitJoinMerge);
+        if (!unit)
+            return false;
     }
     {
         /* Test its robustness to maintain complex data types and large data set. */
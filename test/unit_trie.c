@@ -1,4 +1,5 @@
 #include "container/trie.h"
+#include <unistd.h>
 #include "CUnit/Util.h"
 #include "CUnit/Basic.h"
 
@@ -8,6 +9,12 @@ static const int SIZE_TNY_TEST = 128;
 static const int SIZE_SML_TEST = 512;
 
 
+void CleanValue(void* value)
+{
+    free(value);
+}
+
+
 /*-----------------------------------------------------------------------------*
  *            Unit tests relevant to basic structure verification              *
  *-----------------------------------------------------------------------------*/
@@ -505,6 +512,1115 @@ void TestGetPrefix()
     TrieDeinit(trie);
 }
 
+typedef struct _Collect {
+    char** strs;
+    unsigned size;
+    unsigned stop;
+} Collect;
+
+bool CollectString(const char* str, void* arg)
+{
+    Collect* collect = (Collect*)arg;
+    collect->strs[collect->size++] = strdup(str);
+    return collect->size != collect->stop;
+}
+
+void VerifySameTrie(Trie* lhs, Trie* rhs, unsigned size)
+{
+    /* Both tries should enumerate the same strings in the same order. */
+    char** lhs_strs = (char**)malloc(sizeof(char*) * size);
+    char** rhs_strs = (char**)malloc(sizeof(char*) * size);
+    Collect lhs_collect, rhs_collect;
+    lhs_collect.strs = lhs_strs;
+    lhs_collect.size = 0;
+    lhs_collect.stop = 0;
+    rhs_collect.strs = rhs_strs;
+    rhs_collect.size = 0;
+    rhs_collect.stop = 0;
+
+    char prefix[2] = {0, 0};
+    int ch;
+    for (ch = CHAR_MIN ; ch <= CHAR_MAX ; ++ch) {
+        if (ch == 0)
+            continue;
+        prefix[0] = ch;
+        lhs->for_each_prefix(lhs, prefix, 0, CollectString, &lhs_collect);
+        rhs->for_each_prefix(rhs, prefix, 0, CollectString, &rhs_collect);
+    }
+
+    CU_ASSERT_EQUAL(lhs_collect.size, size);
+    CU_ASSERT_EQUAL(rhs_collect.size, size);
+    unsigned i;
+    for (i = 0 ; i < size ; ++i) {
+        CU_ASSERT(strcmp(lhs_strs[i], rhs_strs[i]) == 0);
+        CU_ASSERT(lhs->has_exact(lhs, rhs_strs[i]) == true);
+        free(lhs_strs[i]);
+        free(rhs_strs[i]);
+    }
+    free(lhs_strs);
+    free(rhs_strs);
+}
+
+void TestBulkBuild()
+{
+    /* Mix the short strings with the duplicates and the non ASCII bytes. */
+    unsigned count = SIZE_SML_TEST * 40;
+    char** strs = (char**)malloc(sizeof(char*) * (count + 2));
+    unsigned i, j;
+    for (i = 0 ; i < count ; ++i) {
+        unsigned len = 1 + random() % 12;
+        strs[i] = (char*)malloc(sizeof(char) * (len + 1));
+        for (j = 0 ; j < len ; ++j) {
+            unsigned pick = random() % 16;
+            strs[i][j] = (pick == 0)? (char)(0x80 + random() % 128) :
+                         'a' + pick % 4;
+        }
+        strs[i][len] = 0;
+    }
+    strs[count] = NULL;
+    strs[count + 1] = "";
+
+    Trie* expect = TrieInit();
+    for (i = 0 ; i < count ; ++i)
+        expect->insert(expect, strs[i]);
+    unsigned size = expect->size(expect);
+
+    unsigned threads[] = {0, 1, 4};
+    for (i = 0 ; i < 3 ; ++i) {
+        Trie* trie = TrieInit();
+        CU_ASSERT(trie->bulk_build(trie, (const char**)strs, count + 2,
+                                   threads[i]) == true);
+        CU_ASSERT_EQUAL(trie->size(trie), size);
+        VerifySameTrie(trie, expect, size);
+        TrieDeinit(trie);
+    }
+
+    /* Build in two halves, where the second half merges into the first. */
+    Trie* trie = TrieInit();
+    trie->set_clean_value(trie, CleanValue);
+    CU_ASSERT(trie->bulk_build(trie, (const char**)strs, count >> 1, 2) == true);
+    CU_ASSERT(trie->bulk_build(trie, (const char**)strs + (count >> 1),
+                               count - (count >> 1) + 2, 2) == true);
+    CU_ASSERT_EQUAL(trie->size(trie), size);
+    VerifySameTrie(trie, expect, size);
+
+    /* The built trie supports all the updates. */
+    for (i = 0 ; i < count ; i += 3) {
+        int* value = (int*)malloc(sizeof(int));
+        *value = i;
+        CU_ASSERT(trie->put(trie, strs[i], value) == true);
+        CU_ASSERT(trie->set_score(trie, strs[i], i) == true);
+    }
+    for (i = 0 ; i < count ; i += 7) {
+        trie->remove(trie, strs[i]);
+        expect->remove(expect, strs[i]);
+        CU_ASSERT(trie->has_exact(trie, strs[i]) == false);
+    }
+    CU_ASSERT(trie->insert(trie, "zzz") == true);
+    CU_ASSERT(expect->insert(expect, "zzz") == true);
+    CU_ASSERT_EQUAL(trie->size(trie), expect->size(expect));
+    VerifySameTrie(trie, expect, expect->size(expect));
+
+    /* Build nothing. */
+    Trie* empty = TrieInit();
+    CU_ASSERT(empty->bulk_build(empty, (const char**)strs + count, 2, 4) == true);
+    CU_ASSERT_EQUAL(empty->size(empty), 0);
+    TrieDeinit(empty);
+
+    TrieDeinit(trie);
+    TrieDeinit(expect);
+    for (i = 0 ; i < count ; ++i)
+        free(strs[i]);
+    free(strs);
+}
+
+void TestForEachPrefix()
+{
+    Trie* trie = TrieInit();
+
+    char buf[4];
+    char ch_i, ch_j, ch_k;
+    for (ch_i = 'a' ; ch_i <= 'e' ; ++ch_i) {
+        for (ch_j = 'a' ; ch_j <= 'e' ; ++ch_j) {
+            for (ch_k = 'a' ; ch_k <= 'e' ; ++ch_k) {
+                buf[0] = ch_i;
+                buf[1] = ch_j;
+                buf[2] = ch_k;
+                buf[3] = 0;
+                trie->insert(trie, buf);
+            }
+            buf[2] = 0;
+            trie->insert(trie, buf);
+        }
+    }
+
+    char* strs[SIZE_TNY_TEST];
+    Collect collect;
+    collect.strs = strs;
+
+    /* Pass dummy and non-existing prefixes. */
+    collect.size = 0;
+    collect.stop = 0;
+    CU_ASSERT_EQUAL(trie->for_each_prefix(trie, NULL, 0, CollectString, &collect), 0);
+    CU_ASSERT_EQUAL(trie->for_each_prefix(trie, "\0", 0, CollectString, &collect), 0);
+    CU_ASSERT_EQUAL(trie->for_each_prefix(trie, "f", 0, CollectString, &collect), 0);
+    CU_ASSERT_EQUAL(trie->for_each_prefix(trie, "abcd", 0, CollectString, &collect), 0);
+
+    /* The visitor must see exactly what get_prefix_as() returns. */
+    const char* prefixes[] = {"a", "c", "e", "ab", "ee", "abc", "eed"};
+    int i, j;
+    for (i = 0 ; i < 7 ; ++i) {
+        const char** rets;
+        unsigned size;
+        CU_ASSERT(trie->get_prefix_as(trie, prefixes[i], &rets, &size) == true);
+
+        collect.size = 0;
+        collect.stop = 0;
+        CU_ASSERT_EQUAL(trie->for_each_prefix(trie, prefixes[i], 0, CollectString,
+                                              &collect), size);
+        CU_ASSERT_EQUAL(collect.size, size);
+        for (j = 0 ; j < (int)size ; ++j) {
+            CU_ASSERT(strcmp(rets[j], strs[j]) == 0);
+            free((char*)rets[j]);
+            free(strs[j]);
+        }
+        free(rets);
+    }
+
+    /* Bound the traversal by the limit and by the visitor. */
+    collect.size = 0;
+    collect.stop = 0;
+    CU_ASSERT_EQUAL(trie->for_each_prefix(trie, "b", 3, CollectString, &collect), 3);
+    CU_ASSERT(strcmp(strs[0], "ba") == 0);
+    CU_ASSERT(strcmp(strs[1], "baa") == 0);
+    CU_ASSERT(strcmp(strs[2], "bab") == 0);
+    for (i = 0 ; i < 3 ; ++i)
+        free(strs[i]);
+
+    collect.size = 0;
+    collect.stop = 2;
+    CU_ASSERT_EQUAL(trie->for_each_prefix(trie, "d", 0, CollectString, &collect), 2);
+    CU_ASSERT(strcmp(strs[1], "daa") == 0);
+    for (i = 0 ; i < 2 ; ++i)
+        free(strs[i]);
+
+    TrieDeinit(trie);
+}
+
+void TestPrefixCursor()
+{
+    Trie* trie = TrieInit();
+
+    const char* words[] = {"car", "card", "care", "cared", "cars", "cat", "do",
+                           "dog", "dot", "c"};
+    int count = 10;
+    int i;
+    for (i = 0 ; i < count ; ++i)
+        CU_ASSERT(trie->insert(trie, words[i]) == true);
+
+    char buf[SIZE_TXT_BUFF];
+    TrieCursor cursor;
+
+    /* The buffer must hold the longest string. */
+    CU_ASSERT(trie->prefix(trie, "ca", buf, 5, &cursor) == false);
+    CU_ASSERT(TrieCursorNext(&cursor) == NULL);
+    CU_ASSERT(trie->prefix(trie, "x", buf, SIZE_TXT_BUFF, &cursor) == false);
+    CU_ASSERT(TrieCursorNext(&cursor) == NULL);
+
+    /* Interleave two cursors sharing no state. */
+    char other[SIZE_TXT_BUFF];
+    TrieCursor second;
+    CU_ASSERT(trie->prefix(trie, "c", buf, SIZE_TXT_BUFF, &cursor) == true);
+    CU_ASSERT(trie->prefix(trie, "do", other, SIZE_TXT_BUFF, &second) == true);
+
+    const char* expect_c[] = {"c", "car", "card", "care", "cared", "cars", "cat"};
+    const char* expect_d[] = {"do", "dog", "dot"};
+    const char* str;
+    for (i = 0 ; i < 7 ; ++i) {
+        CU_ASSERT((str = TrieCursorNext(&cursor)) != NULL);
+        CU_ASSERT(str == buf);
+        CU_ASSERT(strcmp(str, expect_c[i]) == 0);
+        if (i < 3) {
+            CU_ASSERT((str = TrieCursorNext(&second)) != NULL);
+            CU_ASSERT(strcmp(str, expect_d[i]) == 0);
+        }
+    }
+    CU_ASSERT(TrieCursorNext(&cursor) == NULL);
+    CU_ASSERT(TrieCursorNext(&cursor) == NULL);
+    CU_ASSERT(TrieCursorNext(&second) == NULL);
+
+    /* The removed strings are skipped, and the prefix covering only removed
+       strings is rejected like TrieHasPrefixAs does. */
+    CU_ASSERT(trie->remove(trie, "card") == true);
+    CU_ASSERT(trie->remove(trie, "cared") == true);
+    CU_ASSERT(trie->has_prefix_as(trie, "card") == false);
+    CU_ASSERT(trie->prefix(trie, "card", buf, SIZE_TXT_BUFF, &cursor) == false);
+    CU_ASSERT(TrieCursorNext(&cursor) == NULL);
+    CU_ASSERT(trie->prefix(trie, "care", buf, SIZE_TXT_BUFF, &cursor) == true);
+    CU_ASSERT(strcmp(TrieCursorNext(&cursor), "care") == 0);
+    CU_ASSERT(TrieCursorNext(&cursor) == NULL);
+    CU_ASSERT(trie->prefix(trie, "car", buf, SIZE_TXT_BUFF, &cursor) == true);
+    CU_ASSERT(strcmp(TrieCursorNext(&cursor), "car") == 0);
+    CU_ASSERT(strcmp(TrieCursorNext(&cursor), "care") == 0);
+    CU_ASSERT(strcmp(TrieCursorNext(&cursor), "cars") == 0);
+    CU_ASSERT(TrieCursorNext(&cursor) == NULL);
+
+    CU_ASSERT(trie->remove(trie, "do") == true);
+    CU_ASSERT(trie->remove(trie, "dog") == true);
+    CU_ASSERT(trie->prefix(trie, "d", buf, SIZE_TXT_BUFF, &cursor) == true);
+    CU_ASSERT(trie->remove(trie, "dot") == true);
+    CU_ASSERT(trie->prefix(trie, "d", buf, SIZE_TXT_BUFF, &cursor) == false);
+    CU_ASSERT(trie->prefix(trie, "do", buf, SIZE_TXT_BUFF, &cursor) == false);
+    CU_ASSERT(TrieCursorNext(&cursor) == NULL);
+
+    TrieDeinit(trie);
+}
+
+void TestFreeze()
+{
+    char path[] = "/tmp/unit_trie_XXXXXX";
+    int fd = mkstemp(path);
+    CU_ASSERT(fd >= 0);
+    close(fd);
+
+    /* Freeze an empty trie. */
+    Trie* trie = TrieInit();
+    CU_ASSERT(trie->freeze(trie, path) == true);
+    FrozenTrie* frozen = FrozenTrieOpen(path);
+    CU_ASSERT(frozen != NULL);
+    CU_ASSERT_EQUAL(frozen->size(frozen), 0);
+    CU_ASSERT(frozen->has_exact(frozen, "a") == false);
+    CU_ASSERT(frozen->has_prefix_as(frozen, "a") == false);
+    FrozenTrieClose(frozen);
+
+    /* Mix the bytes above 127 whose signed order differs from the unsigned. */
+    char* strs[SIZE_SML_TEST];
+    int i, j;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        int len = 1 + random() % 8;
+        strs[i] = (char*)malloc(sizeof(char) * (len + 1));
+        for (j = 0 ; j < len ; ++j) {
+            int pick = random() % 4;
+            strs[i][j] = (pick == 3)? (char)(0xc0 + random() % 2) : 'a' + pick;
+        }
+        strs[i][len] = 0;
+        CU_ASSERT(trie->insert(trie, strs[i]) == true);
+    }
+    for (i = 0 ; i < SIZE_SML_TEST ; i += 5)
+        trie->remove(trie, strs[i]);
+
+    CU_ASSERT(trie->freeze(trie, path) == true);
+    CU_ASSERT((frozen = FrozenTrieOpen(path)) != NULL);
+    CU_ASSERT_EQUAL(frozen->size(frozen), trie->size(trie));
+
+    /* The frozen trie must answer exactly like the source trie. */
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        CU_ASSERT(frozen->has_exact(frozen, strs[i]) == trie->has_exact(trie, strs[i]));
+        int len = strlen(strs[i]);
+        for (j = len ; j > 0 ; --j) {
+            char ch = strs[i][j];
+            strs[i][j] = 0;
+            CU_ASSERT(frozen->has_prefix_as(frozen, strs[i]) ==
+                      trie->has_prefix_as(trie, strs[i]));
+            strs[i][j] = ch;
+        }
+    }
+    CU_ASSERT(frozen->has_exact(frozen, NULL) == false);
+    CU_ASSERT(frozen->has_exact(frozen, "\0") == false);
+    CU_ASSERT(frozen->has_prefix_as(frozen, "e") == false);
+
+    char* expect_strs[SIZE_SML_TEST];
+    char* actual_strs[SIZE_SML_TEST];
+    Collect expect, actual;
+    expect.strs = expect_strs;
+    expect.stop = 0;
+    actual.strs = actual_strs;
+    actual.stop = 0;
+
+    const char* prefixes[] = {"a", "b", "c", "d", "ab", "ba", "\xc0", "\xc1" "a"};
+    for (i = 0 ; i < 8 ; ++i) {
+        expect.size = 0;
+        actual.size = 0;
+        trie->for_each_prefix(trie, prefixes[i], 0, CollectString, &expect);
+        CU_ASSERT_EQUAL(frozen->for_each_prefix(frozen, prefixes[i], 0,
+                        CollectString, &actual), actual.size);
+        CU_ASSERT_EQUAL(expect.size, actual.size);
+
+        /* The frozen order is the unsigned byte order, so compare the sets. */
+        for (j = 0 ; j < (int)actual.size ; ++j) {
+            CU_ASSERT(frozen->has_exact(frozen, actual.strs[j]) == true);
+            CU_ASSERT(strncmp(actual.strs[j], prefixes[i], strlen(prefixes[i])) == 0);
+            if (j > 0)
+                CU_ASSERT(strcmp(actual.strs[j - 1], actual.strs[j]) < 0);
+        }
+        for (j = 0 ; j < (int)actual.size ; ++j)
+            free(actual.strs[j]);
+        for (j = 0 ; j < (int)expect.size ; ++j)
+            free(expect.strs[j]);
+    }
+
+    actual.size = 0;
+    CU_ASSERT_EQUAL(frozen->for_each_prefix(frozen, "a", 2, CollectString, &actual), 2);
+    for (j = 0 ; j < (int)actual.size ; ++j)
+        free(actual.strs[j]);
+
+    FrozenTrieClose(frozen);
+
+    /* The crafted root base must not overflow the child index. The root unit
+       follows the 32 byte header. */
+    int32_t base = INT_MAX;
+    FILE* file = fopen(path, "r+b");
+    CU_ASSERT(fseek(file, 32, SEEK_SET) == 0);
+    CU_ASSERT(fwrite(&base, sizeof(int32_t), 1, file) == 1);
+    fclose(file);
+    CU_ASSERT((frozen = FrozenTrieOpen(path)) != NULL);
+    CU_ASSERT(frozen->has_exact(frozen, "a") == false);
+    CU_ASSERT(frozen->has_prefix_as(frozen, "a") == false);
+    CU_ASSERT_EQUAL(frozen->for_each_prefix(frozen, "a", 0, CollectString, &actual), 0);
+    FrozenTrieClose(frozen);
+
+    /* Reject the truncated and the foreign images. */
+    CU_ASSERT(truncate(path, sizeof(int) * 3) == 0);
+    CU_ASSERT(FrozenTrieOpen(path) == NULL);
+    file = fopen(path, "wb");
+    fputs("this is not a frozen trie image", file);
+    fclose(file);
+    CU_ASSERT(FrozenTrieOpen(path) == NULL);
+    CU_ASSERT(FrozenTrieOpen("/nonexistent/unit_trie") == NULL);
+
+    remove(path);
+    TrieDeinit(trie);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        free(strs[i]);
+}
+
+int CompareBytes(const void* lhs, const void* rhs)
+{
+    return strcmp(*(char* const*)lhs, *(char* const*)rhs);
+}
+
+void TestDawg()
+{
+    char path[] = "/tmp/unit_trie_XXXXXX";
+    int fd = mkstemp(path);
+    CU_ASSERT(fd >= 0);
+    close(fd);
+
+    /* Compile an empty trie. */
+    Trie* trie = TrieInit();
+    Dawg* dawg = DawgInit(trie);
+    CU_ASSERT(dawg != NULL);
+    CU_ASSERT_EQUAL(dawg->size(dawg), 0);
+    CU_ASSERT(dawg->has_exact(dawg, "a") == false);
+    CU_ASSERT(dawg->has_prefix_as(dawg, "a") == false);
+    DawgDeinit(dawg);
+
+    /* Share the suffixes among the stems, and mix the bytes above 127. */
+    const char* stems[] = {"walk", "talk", "jump", "\xc0pen", "w", "ta"};
+    const char* suffixes[] = {"", "s", "ed", "ing", "er", "ers"};
+    char* strs[36];
+    int i, j;
+    for (i = 0 ; i < 6 ; ++i) {
+        for (j = 0 ; j < 6 ; ++j) {
+            char* str = (char*)malloc(sizeof(char) * 16);
+            strcpy(str, stems[i]);
+            strcat(str, suffixes[j]);
+            strs[i * 6 + j] = str;
+            if ((i + j) % 7 != 3)
+                trie->insert(trie, str);
+        }
+    }
+
+    CU_ASSERT((dawg = DawgInit(trie)) != NULL);
+    CU_ASSERT_EQUAL(dawg->size(dawg), trie->size(trie));
+    CU_ASSERT(dawg->save(dawg, path) == true);
+    DawgDeinit(dawg);
+    CU_ASSERT((dawg = DawgOpen(path)) != NULL);
+    CU_ASSERT_EQUAL(dawg->size(dawg), trie->size(trie));
+
+    /* The word graph must answer exactly like the source trie. */
+    for (i = 0 ; i < 36 ; ++i) {
+        CU_ASSERT(dawg->has_exact(dawg, strs[i]) == trie->has_exact(trie, strs[i]));
+        int len = strlen(strs[i]);
+        for (j = len ; j > 0 ; --j) {
+            char ch = strs[i][j];
+            strs[i][j] = 0;
+            CU_ASSERT(dawg->has_prefix_as(dawg, strs[i]) ==
+                      trie->has_prefix_as(trie, strs[i]));
+            strs[i][j] = ch;
+        }
+    }
+    CU_ASSERT(dawg->has_exact(dawg, NULL) == false);
+    CU_ASSERT(dawg->has_exact(dawg, "walkin") == false);
+    CU_ASSERT(dawg->has_prefix_as(dawg, "x") == false);
+
+    /* The strings are enumerated in unsigned byte order and ranked by it. */
+    char** sorted = (char**)malloc(sizeof(char*) * 36);
+    unsigned count = 0;
+    for (i = 0 ; i < 36 ; ++i) {
+        if (trie->has_exact(trie, strs[i]))
+            sorted[count++] = strs[i];
+    }
+    qsort(sorted, count, sizeof(char*), CompareBytes);
+
+    unsigned index;
+    for (i = 0 ; i < (int)count ; ++i) {
+        CU_ASSERT(dawg->index(dawg, sorted[i], &index) == true);
+        CU_ASSERT_EQUAL(index, i);
+    }
+    CU_ASSERT(dawg->index(dawg, "walkin", &index) == false);
+    CU_ASSERT(dawg->index(dawg, "x", &index) == false);
+
+    char* actual_strs[36];
+    Collect actual;
+    actual.strs = actual_strs;
+    actual.size = 0;
+    actual.stop = 0;
+    unsigned total = 0;
+    total += dawg->for_each_prefix(dawg, "j", 0, CollectString, &actual);
+    total += dawg->for_each_prefix(dawg, "t", 0, CollectString, &actual);
+    total += dawg->for_each_prefix(dawg, "w", 0, CollectString, &actual);
+    total += dawg->for_each_prefix(dawg, "\xc0", 0, CollectString, &actual);
+    CU_ASSERT_EQUAL(total, count);
+    CU_ASSERT_EQUAL(actual.size, count);
+    for (i = 0 ; i < (int)actual.size ; ++i) {
+        if (i < (int)count)
+            CU_ASSERT(strcmp(actual.strs[i], sorted[i]) == 0);
+        free(actual.strs[i]);
+    }
+
+    actual.size = 0;
+    CU_ASSERT_EQUAL(dawg->for_each_prefix(dawg, "w", 3, CollectString, &actual), 3);
+    CU_ASSERT_EQUAL(actual.size, 3);
+    for (i = 0 ; i < (int)actual.size ; ++i)
+        free(actual.strs[i]);
+
+    DawgDeinit(dawg);
+    free(sorted);
+
+    /* Reject the truncated and the foreign images. */
+    CU_ASSERT(truncate(path, sizeof(int) * 3) == 0);
+    CU_ASSERT(DawgOpen(path) == NULL);
+    FILE* file = fopen(path, "wb");
+    fputs("this is not a word graph image", file);
+    fclose(file);
+    CU_ASSERT(DawgOpen(path) == NULL);
+    CU_ASSERT(DawgOpen("/nonexistent/unit_trie") == NULL);
+
+    remove(path);
+    TrieDeinit(trie);
+    for (i = 0 ; i < 36 ; ++i)
+        free(strs[i]);
+}
+
+typedef struct _Rank {
+    char** strs;
+    unsigned* scores;
+    unsigned size;
+} Rank;
+
+bool RankString(const char* str, unsigned score, void* arg)
+{
+    Rank* rank = (Rank*)arg;
+    rank->strs[rank->size] = strdup(str);
+    rank->scores[rank->size++] = score;
+    return true;
+}
+
+void VerifyTopK(Trie* trie, const char* prefix, unsigned k)
+{
+    /* Rank all the matches by brute force. */
+    char* strs[SIZE_SML_TEST];
+    Collect collect;
+    collect.strs = strs;
+    collect.size = 0;
+    collect.stop = 0;
+    trie->for_each_prefix(trie, prefix, 0, CollectString, &collect);
+
+    unsigned scores[SIZE_SML_TEST];
+    unsigned i, j;
+    for (i = 0 ; i < collect.size ; ++i)
+        CU_ASSERT(trie->get_score(trie, strs[i], &scores[i]) == true);
+
+    char* rank_strs[SIZE_TNY_TEST];
+    unsigned rank_scores[SIZE_TNY_TEST];
+    Rank rank_buf;
+    Rank* rank = &rank_buf;
+    rank->strs = rank_strs;
+    rank->scores = rank_scores;
+    rank->size = 0;
+    unsigned expect = (collect.size < k)? collect.size : k;
+    CU_ASSERT_EQUAL(trie->top_k(trie, prefix, k, RankString, rank), expect);
+    CU_ASSERT_EQUAL(rank->size, expect);
+
+    /* Each returned string must outrank every match not returned. */
+    for (i = 0 ; i < rank->size ; ++i) {
+        if (i > 0)
+            CU_ASSERT(rank->scores[i - 1] >= rank->scores[i]);
+        unsigned score;
+        CU_ASSERT(trie->get_score(trie, rank->strs[i], &score) == true);
+        CU_ASSERT_EQUAL(score, rank->scores[i]);
+        CU_ASSERT(strncmp(rank->strs[i], prefix, strlen(prefix)) == 0);
+    }
+    for (i = 0 ; i < collect.size ; ++i) {
+        bool picked = false;
+        for (j = 0 ; j < rank->size ; ++j)
+            picked |= strcmp(strs[i], rank->strs[j]) == 0;
+        if (!picked && rank->size > 0)
+            CU_ASSERT(scores[i] <= rank->scores[rank->size - 1]);
+        free(strs[i]);
+    }
+
+    for (i = 0 ; i < rank->size ; ++i)
+        free(rank->strs[i]);
+}
+
+void TestTopK()
+{
+    Trie* trie = TrieInit();
+
+    char* rank_strs[SIZE_TNY_TEST];
+    unsigned rank_scores[SIZE_TNY_TEST];
+    Rank rank_buf;
+    Rank* rank = &rank_buf;
+    rank->strs = rank_strs;
+    rank->scores = rank_scores;
+    rank->size = 0;
+    CU_ASSERT_EQUAL(trie->top_k(trie, "a", 3, RankString, rank), 0);
+    CU_ASSERT(trie->set_score(trie, "a", 1) == false);
+
+    /* Score the strings by a pseudo random popularity. */
+    char buf[SIZE_TXT_BUFF];
+    int i, j;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        int len = 1 + random() % 6;
+        for (j = 0 ; j < len ; ++j)
+            buf[j] = 'a' + random() % 4;
+        buf[len] = 0;
+        CU_ASSERT(trie->insert(trie, buf) == true);
+        CU_ASSERT(trie->set_score(trie, buf, random() % 1000) == true);
+    }
+
+    const char* prefixes[] = {"a", "b", "ab", "dd", "abc", "cab"};
+    unsigned ks[] = {1, 3, 10, 100};
+    for (i = 0 ; i < 6 ; ++i) {
+        for (j = 0 ; j < 4 ; ++j)
+            VerifyTopK(trie, prefixes[i], ks[j]);
+    }
+
+    /* Promote, demote, and remove strings, and then verify again. */
+    char* strs[SIZE_SML_TEST];
+    Collect collect;
+    collect.strs = strs;
+    collect.size = 0;
+    collect.stop = 0;
+    trie->for_each_prefix(trie, "a", 0, CollectString, &collect);
+    for (i = 0 ; i < (int)collect.size ; ++i) {
+        if (i % 3 == 0)
+            CU_ASSERT(trie->set_score(trie, strs[i], 5000 + i) == true);
+        if (i % 3 == 1)
+            CU_ASSERT(trie->set_score(trie, strs[i], 0) == true);
+        if (i % 3 == 2)
+            CU_ASSERT(trie->remove(trie, strs[i]) == true);
+    }
+    for (i = 0 ; i < 6 ; ++i) {
+        for (j = 0 ; j < 4 ; ++j)
+            VerifyTopK(trie, prefixes[i], ks[j]);
+    }
+
+    /* The best string is the promoted one visited last. */
+    int top = (collect.size - 1) / 3 * 3;
+    rank->size = 0;
+    CU_ASSERT_EQUAL(trie->top_k(trie, "a", 1, RankString, rank), 1);
+    CU_ASSERT(strcmp(rank->strs[0], strs[top]) == 0);
+    CU_ASSERT_EQUAL(rank->scores[0], 5000 + top);
+    free(rank->strs[0]);
+
+    /* The prefix itself takes part in the ranking. */
+    CU_ASSERT(trie->insert(trie, "a") == true);
+    CU_ASSERT(trie->set_score(trie, "a", 9999) == true);
+    rank->size = 0;
+    CU_ASSERT_EQUAL(trie->top_k(trie, "a", 2, RankString, rank), 2);
+    CU_ASSERT(strcmp(rank->strs[0], "a") == 0);
+    CU_ASSERT(strcmp(rank->strs[1], strs[top]) == 0);
+    free(rank->strs[0]);
+    free(rank->strs[1]);
+
+    unsigned score;
+    CU_ASSERT(trie->remove(trie, "a") == true);
+    CU_ASSERT(trie->get_score(trie, "a", &score) == false);
+    CU_ASSERT(trie->insert(trie, "a") == true);
+    CU_ASSERT(trie->get_score(trie, "a", &score) == true);
+    CU_ASSERT_EQUAL(score, 0);
+
+    for (i = 0 ; i < (int)collect.size ; ++i)
+        free(strs[i]);
+    TrieDeinit(trie);
+}
+
+typedef struct _Match {
+    const char* text;
+    unsigned size;
+    unsigned stop;
+    size_t sum;
+    size_t last;
+    bool valid;
+} Match;
+
+bool MatchString(const char* str, size_t end, void* arg)
+{
+    Match* match = (Match*)arg;
+    size_t len = strlen(str);
+    if (len > end || strncmp(match->text + end - len, str, len) != 0)
+        match->valid = false;
+    match->sum += end * 31 + len;
+    match->last = end;
+    ++match->size;
+    return match->size != match->stop;
+}
+
+void CountMatch(char** strs, unsigned count, const char* text, size_t from,
+                size_t to, Match* match)
+{
+    /* Count the matches ending in (from, to] by brute force. */
+    match->size = 0;
+    match->sum = 0;
+    size_t end;
+    unsigned i, j;
+    for (end = from + 1 ; end <= to ; ++end) {
+        for (i = 0 ; i < count ; ++i) {
+            size_t size = strlen(strs[i]);
+            bool dup = false;
+            for (j = 0 ; j < i ; ++j)
+                dup |= strcmp(strs[i], strs[j]) == 0;
+            if (dup || size > end - from)
+                continue;
+            if (strncmp(text + end - size, strs[i], size) == 0) {
+                ++match->size;
+                match->sum += end * 31 + size;
+            }
+        }
+    }
+}
+
+void TestScan()
+{
+    Trie* trie = TrieInit();
+    char text[SIZE_SML_TEST * 4];
+    unsigned len = SIZE_SML_TEST * 4;
+
+    /* Scan with an empty dictionary. */
+    TrieScanner* scanner = TrieScannerInit(trie);
+    CU_ASSERT(scanner != NULL);
+    CU_ASSERT_EQUAL(scanner->scan(scanner, "abc", 3, MatchString, NULL), 0);
+    TrieScannerDeinit(scanner);
+
+    /* Use a small alphabet so that the strings overlap a lot. */
+    char* strs[SIZE_TNY_TEST];
+    int i, j;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        int size = 1 + random() % 6;
+        strs[i] = (char*)malloc(sizeof(char) * (size + 1));
+        for (j = 0 ; j < size ; ++j)
+            strs[i][j] = 'a' + random() % 3;
+        strs[i][size] = 0;
+        trie->insert(trie, strs[i]);
+    }
+    for (i = 0 ; i < (int)len ; ++i)
+        text[i] = (i % 97 == 96)? 0 : 'a' + random() % 3;
+
+    Match expect;
+    CountMatch(strs, SIZE_TNY_TEST, text, 0, len, &expect);
+
+    scanner = TrieScannerInit(trie);
+    CU_ASSERT(scanner != NULL);
+
+    /* Update to the trie should not affect the compiled scanner. */
+    CU_ASSERT(trie->insert(trie, "ccccccc") == true);
+
+    Match match;
+    match.text = text;
+    match.size = 0;
+    match.stop = 0;
+    match.sum = 0;
+    match.valid = true;
+    CU_ASSERT_EQUAL(scanner->scan(scanner, text, len, MatchString, &match),
+                    expect.size);
+    CU_ASSERT_EQUAL(match.size, expect.size);
+    CU_ASSERT_EQUAL(match.sum, expect.sum);
+    CU_ASSERT(match.valid == true);
+
+    /* Split the stream into two chunks at various positions. */
+    unsigned split;
+    for (split = 0 ; split <= len ; split += 7) {
+        scanner->reset(scanner);
+        match.size = 0;
+        match.sum = 0;
+        unsigned count = scanner->scan(scanner, text, split, MatchString,
+                                       &match);
+        count += scanner->scan(scanner, text + split, len - split, MatchString,
+                               &match);
+        CU_ASSERT_EQUAL(count, expect.size);
+        CU_ASSERT_EQUAL(match.sum, expect.sum);
+    }
+
+    /* Feed the stream byte by byte. */
+    scanner->reset(scanner);
+    match.size = 0;
+    match.sum = 0;
+    for (i = 0 ; i < (int)len ; ++i)
+        scanner->scan(scanner, text + i, 1, MatchString, &match);
+    CU_ASSERT_EQUAL(match.size, expect.size);
+    CU_ASSERT_EQUAL(match.sum, expect.sum);
+    CU_ASSERT(match.valid == true);
+
+    /* Stop at the first match and restart right after it. */
+    scanner->reset(scanner);
+    match.size = 0;
+    match.stop = 1;
+    CU_ASSERT_EQUAL(scanner->scan(scanner, text, len, MatchString, &match), 1);
+    size_t first = match.last;
+
+    scanner->reset(scanner);
+    match.text = text + first;
+    match.size = 0;
+    match.sum = 0;
+    match.stop = 0;
+    scanner->scan(scanner, text + first, len - first, MatchString, &match);
+    CountMatch(strs, SIZE_TNY_TEST, text, first, len, &expect);
+    CU_ASSERT_EQUAL(match.size, expect.size);
+    CU_ASSERT_EQUAL(match.sum + first * match.size * 31, expect.sum);
+    CU_ASSERT(match.valid == true);
+
+    TrieScannerDeinit(scanner);
+    TrieDeinit(trie);
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i)
+        free(strs[i]);
+}
+
+unsigned Distance(const char* lhs, const char* rhs)
+{
+    unsigned row[SIZE_TXT_BUFF];
+    unsigned len = strlen(rhs);
+    unsigned i, j;
+    for (j = 0 ; j <= len ; ++j)
+        row[j] = j;
+
+    for (i = 0 ; lhs[i] ; ++i) {
+        unsigned diag = row[0];
+        row[0] = i + 1;
+        for (j = 1 ; j <= len ; ++j) {
+            unsigned dist = diag + ((lhs[i] == rhs[j - 1])? 0 : 1);
+            if (row[j] + 1 < dist)
+                dist = row[j] + 1;
+            if (row[j - 1] + 1 < dist)
+                dist = row[j - 1] + 1;
+            diag = row[j];
+            row[j] = dist;
+        }
+    }
+    return row[len];
+}
+
+bool RankDistance(const char* str, unsigned dist, void* arg)
+{
+    Rank* rank = (Rank*)arg;
+    rank->strs[rank->size] = strdup(str);
+    rank->scores[rank->size++] = dist;
+    return rank->size < SIZE_SML_TEST;
+}
+
+void TestFuzzySearch()
+{
+    Trie* trie = TrieInit();
+
+    char* rank_strs[SIZE_SML_TEST];
+    unsigned rank_scores[SIZE_SML_TEST];
+    Rank rank_buf;
+    Rank* rank = &rank_buf;
+    rank->strs = rank_strs;
+    rank->scores = rank_scores;
+    rank->size = 0;
+    CU_ASSERT_EQUAL(trie->fuzzy_search(trie, "abc", 2, RankDistance, rank), 0);
+
+    char buf[SIZE_TXT_BUFF];
+    int i, j;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        int len = 1 + random() % 7;
+        for (j = 0 ; j < len ; ++j)
+            buf[j] = 'a' + random() % 4;
+        buf[len] = 0;
+        trie->insert(trie, buf);
+    }
+
+    char* strs[SIZE_SML_TEST];
+    Collect collect;
+    collect.strs = strs;
+    collect.size = 0;
+    collect.stop = 0;
+    trie->for_each_prefix(trie, "a", 0, CollectString, &collect);
+    trie->for_each_prefix(trie, "b", 0, CollectString, &collect);
+    trie->for_each_prefix(trie, "c", 0, CollectString, &collect);
+    trie->for_each_prefix(trie, "d", 0, CollectString, &collect);
+
+    /* Compare against the brute force distances in lexical order. */
+    const char* queries[] = {"", "a", "abcd", "dcba", "bbbbbbb", "cadabra"};
+    unsigned q, k;
+    for (q = 0 ; q < 6 ; ++q) {
+        for (k = 0 ; k <= 3 ; ++k) {
+            rank->size = 0;
+            unsigned count = trie->fuzzy_search(trie, queries[q], k,
+                                                RankDistance, rank);
+            CU_ASSERT_EQUAL(count, rank->size);
+
+            unsigned pos = 0;
+            for (i = 0 ; i < (int)collect.size ; ++i) {
+                unsigned dist = Distance(strs[i], queries[q]);
+                if (dist > k)
+                    continue;
+                CU_ASSERT(pos < rank->size);
+                if (pos >= rank->size)
+                    break;
+                CU_ASSERT(strcmp(rank->strs[pos], strs[i]) == 0);
+                CU_ASSERT_EQUAL(rank->scores[pos], dist);
+                ++pos;
+            }
+            CU_ASSERT_EQUAL(pos, rank->size);
+
+            for (i = 0 ; i < (int)rank->size ; ++i)
+                free(rank->strs[i]);
+        }
+    }
+
+    /* The exact match is reported with distance 0. */
+    rank->size = 0;
+    CU_ASSERT_EQUAL(trie->fuzzy_search(trie, strs[0], 0, RankDistance, rank), 1);
+    CU_ASSERT(strcmp(rank->strs[0], strs[0]) == 0);
+    CU_ASSERT_EQUAL(rank->scores[0], 0);
+    free(rank->strs[0]);
+
+    for (i = 0 ; i < (int)collect.size ; ++i)
+        free(strs[i]);
+    TrieDeinit(trie);
+
+    /* The huge bounds mean no bound at all. */
+    trie = TrieInit();
+    const char* words[] = {"abc", "abd", "xyz", "a", "abcdef"};
+    for (i = 0 ; i < 5 ; ++i)
+        trie->insert(trie, words[i]);
+    const char* expect_strs[] = {"a", "abc", "abcdef", "abd", "xyz"};
+    unsigned expect_dists[] = {2, 0, 3, 1, 3};
+    unsigned bounds[] = {UINT_MAX, UINT_MAX - 1, 3};
+    for (k = 0 ; k < 3 ; ++k) {
+        rank->size = 0;
+        CU_ASSERT_EQUAL(trie->fuzzy_search(trie, "abc", bounds[k],
+                                           RankDistance, rank), 5);
+        for (i = 0 ; i < (int)rank->size ; ++i) {
+            if (i < 5) {
+                CU_ASSERT(strcmp(rank->strs[i], expect_strs[i]) == 0);
+                CU_ASSERT_EQUAL(rank->scores[i], expect_dists[i]);
+            }
+            free(rank->strs[i]);
+        }
+    }
+    TrieDeinit(trie);
+}
+
+void TestPutGet()
+{
+    char buf[SIZE_TXT_BUFF];
+    Trie* trie = TrieInit();
+    trie->set_clean_value(trie, CleanValue);
+
+    CU_ASSERT(trie->put(trie, NULL, NULL) == false);
+    CU_ASSERT(trie->put(trie, "", NULL) == false);
+    CU_ASSERT(trie->get(trie, "a") == NULL);
+
+    int i;
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        snprintf(buf, SIZE_TXT_BUFF, "key%d", i);
+        int* value = (int*)malloc(sizeof(int));
+        *value = i;
+        CU_ASSERT(trie->put(trie, buf, value) == true);
+    }
+    CU_ASSERT_EQUAL(trie->size(trie), SIZE_TNY_TEST);
+
+    /* Replace the values, and the old ones should be released. */
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        snprintf(buf, SIZE_TXT_BUFF, "key%d", i);
+        int* value = (int*)malloc(sizeof(int));
+        *value = SIZE_TNY_TEST - i;
+        CU_ASSERT(trie->put(trie, buf, value) == true);
+    }
+    CU_ASSERT_EQUAL(trie->size(trie), SIZE_TNY_TEST);
+
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        snprintf(buf, SIZE_TXT_BUFF, "key%d", i);
+        int* value = (int*)trie->get(trie, buf);
+        CU_ASSERT(value != NULL);
+        if (value)
+            CU_ASSERT_EQUAL(*value, SIZE_TNY_TEST - i);
+        CU_ASSERT(trie->has_exact(trie, buf) == true);
+    }
+
+    /* The inner prefixes carry no value. */
+    CU_ASSERT(trie->get(trie, "key") == NULL);
+    CU_ASSERT(trie->insert(trie, "key") == true);
+    CU_ASSERT(trie->get(trie, "key") == NULL);
+
+    /* Insertion keeps the value of the existing string. */
+    CU_ASSERT(trie->insert(trie, "key7") == true);
+    CU_ASSERT_EQUAL(*(int*)trie->get(trie, "key7"), SIZE_TNY_TEST - 7);
+
+    /* Remove half of the strings, and the rest are released by the destructor. */
+    for (i = 0 ; i < SIZE_TNY_TEST ; i += 2) {
+        snprintf(buf, SIZE_TXT_BUFF, "key%d", i);
+        CU_ASSERT(trie->remove(trie, buf) == true);
+        CU_ASSERT(trie->get(trie, buf) == NULL);
+    }
+    CU_ASSERT(trie->put(trie, "key0", NULL) == true);
+    CU_ASSERT(trie->get(trie, "key0") == NULL);
+    CU_ASSERT(trie->has_exact(trie, "key0") == true);
+
+    TrieDeinit(trie);
+}
+
+void TestLongestPrefixMatch()
+{
+    Trie* trie = TrieInit();
+    void* value = NULL;
+
+    CU_ASSERT_EQUAL(trie->longest_prefix_match(trie, "abc", &value), 0);
+    CU_ASSERT(value == NULL);
+
+    static int routes[4] = {0, 1, 2, 3};
+    CU_ASSERT(trie->put(trie, "/", &routes[0]) == true);
+    CU_ASSERT(trie->put(trie, "/api/", &routes[1]) == true);
+    CU_ASSERT(trie->put(trie, "/api/v2/", &routes[2]) == true);
+    CU_ASSERT(trie->put(trie, "/static", &routes[3]) == true);
+    CU_ASSERT(trie->insert(trie, "/api/v1") == true);
+
+    CU_ASSERT_EQUAL(trie->longest_prefix_match(trie, "/api/v2/users", &value), 8);
+    CU_ASSERT(value == &routes[2]);
+    CU_ASSERT_EQUAL(trie->longest_prefix_match(trie, "/api/v3", &value), 5);
+    CU_ASSERT(value == &routes[1]);
+    CU_ASSERT_EQUAL(trie->longest_prefix_match(trie, "/api/v1", &value), 7);
+    CU_ASSERT(value == NULL);
+    CU_ASSERT_EQUAL(trie->longest_prefix_match(trie, "/api", &value), 1);
+    CU_ASSERT(value == &routes[0]);
+    CU_ASSERT_EQUAL(trie->longest_prefix_match(trie, "/statics", NULL), 7);
+
+    value = &routes[3];
+    CU_ASSERT_EQUAL(trie->longest_prefix_match(trie, "api", &value), 0);
+    CU_ASSERT(value == &routes[3]);
+    CU_ASSERT_EQUAL(trie->longest_prefix_match(trie, "", &value), 0);
+    CU_ASSERT_EQUAL(trie->longest_prefix_match(trie, NULL, &value), 0);
+
+    /* Compare against the brute force search over the random strings. */
+    char* strs[SIZE_SML_TEST];
+    char buf[SIZE_TXT_BUFF];
+    int i, j;
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        int len = 1 + random() % 8;
+        strs[i] = (char*)malloc(sizeof(char) * (len + 1));
+        for (j = 0 ; j < len ; ++j)
+            strs[i][j] = 'a' + random() % 3;
+        strs[i][len] = 0;
+        trie->put(trie, strs[i], strs[i]);
+    }
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i) {
+        int len = 1 + random() % 12;
+        for (j = 0 ; j < len ; ++j)
+            buf[j] = 'a' + random() % 3;
+        buf[len] = 0;
+
+        unsigned expect = 0;
+        for (j = 0 ; j < SIZE_SML_TEST ; ++j) {
+            unsigned size = strlen(strs[j]);
+            if (size > expect && strncmp(buf, strs[j], size) == 0)
+                expect = size;
+        }
+        value = NULL;
+        CU_ASSERT_EQUAL(trie->longest_prefix_match(trie, buf, &value), expect);
+        if (expect > 0) {
+            CU_ASSERT(value != NULL);
+            if (value) {
+                CU_ASSERT_EQUAL(strlen((char*)value), expect);
+                CU_ASSERT(strncmp(buf, (char*)value, expect) == 0);
+            }
+        }
+    }
+
+    TrieDeinit(trie);
+    for (i = 0 ; i < SIZE_SML_TEST ; ++i)
+        free(strs[i]);
+}
+
+void TestArenaAndStats()
+{
+    Trie* heap = TrieInit();
+    Trie* arena = TrieInit();
+    arena->set_arena(arena, SIZE_TNY_TEST);
+
+    TrieStats stats, stats_heap;
+    arena->get_stats(arena, &stats);
+    CU_ASSERT_EQUAL(stats.size, 0);
+    CU_ASSERT_EQUAL(stats.count_node, 0);
+    CU_ASSERT_EQUAL(stats.depth, 0);
+    size_t empty = stats.bytes;
+    CU_ASSERT(empty > 0);
+
+    char buf[SIZE_TXT_BUFF];
+    int i, j;
+    for (i = 0 ; i < SIZE_SML_TEST * 4 ; ++i) {
+        int len = 1 + random() % (SIZE_TXT_BUFF - 1);
+        for (j = 0 ; j < len ; ++j)
+            buf[j] = 'a' + random() % 26;
+        buf[len] = 0;
+        CU_ASSERT(heap->insert(heap, buf) == true);
+        CU_ASSERT(arena->insert(arena, buf) == true);
+    }
+
+    /* Both tries hold the same nodes, where the arena rounds up to chunks. */
+    heap->get_stats(heap, &stats_heap);
+    arena->get_stats(arena, &stats);
+    CU_ASSERT_EQUAL(stats.size, stats_heap.size);
+    CU_ASSERT_EQUAL(stats.count_node, stats_heap.count_node);
+    CU_ASSERT_EQUAL(stats.depth, stats_heap.depth);
+    CU_ASSERT_EQUAL(stats.depth, SIZE_TXT_BUFF - 1);
+    CU_ASSERT(stats_heap.bytes > empty);
+    CU_ASSERT(stats.bytes >= stats_heap.bytes);
+    /* Besides the unused tail of the last chunk, each chunk has its header. */
+    size_t node = (stats_heap.bytes - empty) / stats_heap.count_node;
+    size_t num_chunk = (stats.count_node + SIZE_TNY_TEST - 1) / SIZE_TNY_TEST;
+    CU_ASSERT(stats.bytes - stats_heap.bytes <=
+              node * SIZE_TNY_TEST + num_chunk * sizeof(void*));
+
+    /* The nodes survive the string removal. */
+    CU_ASSERT(arena->remove(arena, buf) == true);
+    arena->get_stats(arena, &stats);
+    CU_ASSERT_EQUAL(stats.size, stats_heap.size - 1);
+    CU_ASSERT_EQUAL(stats.count_node, stats_heap.count_node);
+    CU_ASSERT(arena->insert(arena, buf) == true);
+    CU_ASSERT(arena->has_exact(arena, buf) == true);
+
+    /* Mix the arena nodes with the individually allocated ones and values. */
+    arena->set_clean_value(arena, CleanValue);
+    arena->set_arena(arena, 0);
+    for (i = 0 ; i < SIZE_TNY_TEST ; ++i) {
+        snprintf(buf, SIZE_TXT_BUFF, "value%d", i);
+        int* value = (int*)malloc(sizeof(int));
+        *value = i;
+        CU_ASSERT(arena->put(arena, buf, value) == true);
+    }
+    arena->get_stats(arena, &stats);
+    CU_ASSERT(stats.count_node > stats_heap.count_node);
+    CU_ASSERT_EQUAL(*(int*)arena->get(arena, "value7"), 7);
+
+    TrieDeinit(heap);
+    TrieDeinit(arena);
+}
+
 /*-----------------------------------------------------------------------------*
  *                       The driver for Trie unit test                         *
  *-----------------------------------------------------------------------------*/
@@ -534,6 +1650,10 @@ bool AddSuite()
     if (!unit)
         return false;
 
+    unit = CU_add_test(suite, "String Sorted Bulk Build", TestBulkBuild);
+    if (!unit)
+        return false;
+
     unit = CU_add_test(suite, "String Remove and Search Verification", TestRemoveAndVerify);
     if (!unit)
         return false;
@@ -542,6 +1662,46 @@ bool AddSuite()
     if (!unit)
         return false;
 
+    unit = CU_add_test(suite, "String Visit Prefix As", TestForEachPrefix);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "String Prefix Cursor", TestPrefixCursor);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Frozen Double Array Image", TestFreeze);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Minimized Word Graph", TestDawg);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Top K Scored Strings", TestTopK);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Multiple String Scan", TestScan);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Approximate String Search", TestFuzzySearch);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "String Value Put and Get", TestPutGet);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "String Longest Prefix Match", TestLongestPrefixMatch);
+    if (!unit)
+        return false;
+
+    unit = CU_add_test(suite, "Node Arena and Memory Statistics", TestArenaAndStats);
+    if (!unit)
+        return false;
+
     return true;
 }
 